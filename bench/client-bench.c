@@ -0,0 +1,151 @@
+/**
+ * Compares request latency with a new client per call (cold connection) and a
+ * single reused client (warm connection, cached DNS and TLS session).
+ *
+ * The benchmark needs a local HTTPS stand-in for Helix API. Any HTTPS server
+ * will do, since only the latency is measured and the responses are ignored.
+ * For example, with OpenSSL:
+ *
+ *   openssl req -x509 -newkey rsa:2048 -nodes -days 1 -subj /CN=localhost \
+ *     -keyout key.pem -out cert.pem
+ *   openssl s_server -accept 8443 -cert cert.pem -key key.pem -www
+ *
+ * Then run:
+ *
+ *   client-bench https://localhost:8443 500 cert.pem
+ *
+ * Note that `s_server -www` closes the connection after every response, so
+ * with it the warm run only saves DNS lookup and full TLS handshake (session
+ * is resumed). A keep-alive server will show connection reuse as well.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ctwitch/ctwitch.h>
+#include <ctwitch/helix.h>
+
+/** Helpers **/
+
+double now_ms() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+int compare_doubles(const void *a, const void *b) {
+	double da = *(const double *)a, db = *(const double *)b;
+	return (da > db) - (da < db);
+}
+
+/**
+ * Performs one request with given client.
+ *
+ * @param client Client context.
+ *
+ * @return Request duration in milliseconds.
+ */
+double timed_request(twitch_client *client) {
+	const char *logins[1] = { "twitch" };
+	twitch_error error = { 0 };
+
+	double start = now_ms();
+	twitch_helix_user_list *users = twitch_helix_get_users(
+		client,
+		"bench",
+		"bench",
+		&error,
+		1,
+		logins
+	);
+	double duration = now_ms() - start;
+
+	twitch_helix_user_list_free(users);
+	twitch_error_clear(&error);
+
+	return duration;
+}
+
+/**
+ * Prints latency percentiles for given samples.
+ *
+ * @param name Run name.
+ * @param count Number of samples.
+ * @param samples Samples array. Gets sorted in place.
+ */
+void report(const char *name, int count, double *samples) {
+	double sum = 0;
+	for (int idx = 0; idx < count; idx++) {
+		sum += samples[idx];
+	}
+
+	qsort(samples, count, sizeof(double), compare_doubles);
+
+	printf(
+		"%-6s n=%d mean=%.3fms p50=%.3fms p95=%.3fms p99=%.3fms\n",
+		name,
+		count,
+		sum / count,
+		samples[count / 2],
+		samples[(int)(count * 0.95)],
+		samples[(int)(count * 0.99)]
+	);
+}
+
+/** Main **/
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		fprintf(stderr, "Usage: client-bench <api-url> [iterations] [ca-file]\n");
+		return EXIT_FAILURE;
+	}
+
+	const char *api_url = argv[1];
+	int iterations = (argc > 2) ? atoi(argv[2]) : 200;
+	const char *ca_info = (argc > 3) ? argv[3] : NULL;
+
+	if (iterations <= 0) {
+		fprintf(stderr, "Error: iterations must be a positive number.\n");
+		return EXIT_FAILURE;
+	}
+
+	double *samples = malloc(sizeof(double) * iterations);
+
+	twitch_helix_init();
+
+	// Cold: every request gets its own client, so it pays for DNS lookup, TCP
+	// connect and TLS handshake.
+	for (int idx = 0; idx < iterations; idx++) {
+		twitch_client *client = twitch_client_alloc();
+		twitch_client_set_api_url(client, api_url);
+		twitch_client_set_ca_info(client, ca_info);
+
+		samples[idx] = timed_request(client);
+
+		twitch_client_free(client);
+	}
+	report("cold", iterations, samples);
+
+	// Warm: one client for all requests.
+	twitch_client *client = twitch_client_alloc();
+	twitch_client_set_api_url(client, api_url);
+	twitch_client_set_ca_info(client, ca_info);
+
+	// Don't count the first connection.
+	timed_request(client);
+
+	for (int idx = 0; idx < iterations; idx++) {
+		samples[idx] = timed_request(client);
+	}
+	report("reused", iterations, samples);
+
+	twitch_client_free(client);
+	free(samples);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,259 @@
+/**
+ * Measures how much bandwidth gzip compression saves on Helix responses, and
+ * how much CPU time it costs to decompress them.
+ *
+ * Each payload is compressed once with default gzip settings, the way servers
+ * usually do it, and then decompressed repeatedly. For every payload the
+ * benchmark prints raw and compressed sizes, decompression time, and the link
+ * speed below which compression makes the response arrive sooner, i.e. the
+ * point where transferring the saved bytes takes as long as decompressing.
+ *
+ * Run with recorded response bodies, e.g. saved with `curl -o`:
+ *
+ *   compression-bench 1000 followers.json videos.json
+ *
+ * Without files, it uses a generated page of 100 streams.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <zlib.h>
+
+/** Helpers **/
+
+double cpu_seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Reads the whole file into memory.
+ *
+ * @param path File path.
+ * @param size Returns file size.
+ *
+ * @return File contents, or NULL on error.
+ */
+char *read_file(const char *path, size_t *size) {
+	FILE *file = fopen(path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	char *data = malloc(length > 0 ? length : 1);
+	if (data == NULL || fread(data, 1, length, file) != (size_t)length) {
+		free(data);
+		fclose(file);
+		return NULL;
+	}
+
+	fclose(file);
+	*size = length;
+	return data;
+}
+
+/**
+ * Generates a page of 100 streams that looks like a real Helix response.
+ *
+ * @param size Returns page size.
+ *
+ * @return Page text.
+ */
+char *generate_page(size_t *size) {
+	size_t capacity = 128 * 1024, length = 0;
+	char *data = malloc(capacity);
+	if (data == NULL) {
+		fprintf(stderr, "Failed to allocate memory for payload.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	length += sprintf(data + length, "{\"data\":[");
+	for (int idx = 0; idx < 100; idx++) {
+		length += sprintf(
+			data + length,
+			"%s{\"id\":\"%d\",\"user_id\":\"%d\",\"user_login\":\"streamer%d\","
+			"\"user_name\":\"Streamer%d\",\"game_id\":\"%d\","
+			"\"game_name\":\"Game %d\",\"type\":\"live\","
+			"\"title\":\"Stream number %d, come and say hi!\","
+			"\"viewer_count\":%d,\"started_at\":\"2024-01-%02dT%02d:00:00Z\","
+			"\"language\":\"en\",\"thumbnail_url\":"
+			"\"https://static-cdn.jtvnw.net/previews-ttv/live_user_streamer%d"
+			"-{width}x{height}.jpg\",\"tag_ids\":[],\"tags\":[\"English\"],"
+			"\"is_mature\":false}",
+			idx > 0 ? "," : "",
+			40000000 + idx * 7919, 100000 + idx * 31, idx, idx,
+			500000 + idx % 13, idx % 13, idx, 10000 - idx * 97,
+			1 + idx % 28, idx % 24, idx
+		);
+	}
+	length += sprintf(
+		data + length,
+		"],\"pagination\":{\"cursor\":"
+		"\"eyJiIjp7IkN1cnNvciI6ImV5SnpJam8xTURBd01Dd2laQ0k2Wm1Gc2MyVjkifX0\"}}"
+	);
+
+	*size = length;
+	return data;
+}
+
+/** Benchmark **/
+
+/**
+ * Compresses given payload as gzip.
+ *
+ * @param data Payload.
+ * @param size Payload size.
+ * @param compressed_size Returns compressed size.
+ *
+ * @return Compressed data.
+ */
+unsigned char *compress_gzip(
+	const char *data,
+	size_t size,
+	size_t *compressed_size
+) {
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+
+	// 16 added to window bits selects gzip wrapper.
+	deflateInit2(
+		&stream,
+		Z_DEFAULT_COMPRESSION,
+		Z_DEFLATED,
+		15 + 16,
+		8,
+		Z_DEFAULT_STRATEGY
+	);
+
+	size_t capacity = deflateBound(&stream, size);
+	unsigned char *output = malloc(capacity);
+	if (output == NULL) {
+		fprintf(stderr, "Failed to allocate memory for compressed data.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	stream.next_in = (unsigned char *)data;
+	stream.avail_in = size;
+	stream.next_out = output;
+	stream.avail_out = capacity;
+	deflate(&stream, Z_FINISH);
+
+	*compressed_size = stream.total_out;
+	deflateEnd(&stream);
+
+	return output;
+}
+
+/**
+ * Decompresses gzip data into given buffer.
+ *
+ * @return Decompressed size.
+ */
+size_t decompress_gzip(
+	const unsigned char *data,
+	size_t size,
+	char *output,
+	size_t capacity
+) {
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	inflateInit2(&stream, 15 + 16);
+
+	stream.next_in = (unsigned char *)data;
+	stream.avail_in = size;
+	stream.next_out = (unsigned char *)output;
+	stream.avail_out = capacity;
+	inflate(&stream, Z_FINISH);
+
+	size_t length = stream.total_out;
+	inflateEnd(&stream);
+
+	return length;
+}
+
+void run_bench(const char *name, const char *data, size_t size, int count) {
+	size_t compressed_size = 0;
+	unsigned char *compressed = compress_gzip(data, size, &compressed_size);
+
+	char *output = malloc(size);
+	if (output == NULL) {
+		fprintf(stderr, "Failed to allocate memory for decompressed data.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	double start = cpu_seconds();
+	for (int idx = 0; idx < count; idx++) {
+		if (decompress_gzip(compressed, compressed_size, output, size) != size) {
+			fprintf(stderr, "%s: decompressed size mismatch\n", name);
+			break;
+		}
+	}
+	double seconds = (cpu_seconds() - start) / count;
+
+	if (memcmp(output, data, size) != 0) {
+		fprintf(stderr, "%s: decompressed data mismatch\n", name);
+	}
+
+	size_t saved = size - compressed_size;
+	printf(
+		"%-20s %9zu %9zu %6.2fx %9.1f us %8.1f MB/s %9.1f MB/s\n",
+		name,
+		size,
+		compressed_size,
+		(double)size / compressed_size,
+		seconds * 1e6,
+		size / seconds / 1e6,
+		saved / seconds / 1e6
+	);
+
+	free(output);
+	free(compressed);
+}
+
+int main(int argc, char **argv) {
+	int count = (argc > 1) ? atoi(argv[1]) : 1000;
+	if (count <= 0) {
+		fprintf(stderr, "Usage: compression-bench [iterations] [payload...]\n");
+		return 1;
+	}
+
+	printf(
+		"%-20s %9s %9s %7s %12s %13s %14s\n",
+		"payload", "raw", "gzip", "ratio", "inflate", "throughput",
+		"break-even"
+	);
+
+	if (argc <= 2) {
+		size_t size = 0;
+		char *page = generate_page(&size);
+		run_bench("streams (generated)", page, size, count);
+		free(page);
+		return 0;
+	}
+
+	for (int idx = 2; idx < argc; idx++) {
+		size_t size = 0;
+		char *data = read_file(argv[idx], &size);
+		if (data == NULL || size == 0) {
+			fprintf(stderr, "Failed to read %s\n", argv[idx]);
+			free(data);
+			continue;
+		}
+
+		const char *name = strrchr(argv[idx], '/');
+		run_bench(name != NULL ? name + 1 : argv[idx], data, size, count);
+		free(data);
+	}
+
+	return 0;
+}
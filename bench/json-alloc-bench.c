@@ -0,0 +1,219 @@
+/**
+ * Counts memory allocations made while parsing Helix pages, and compares
+ * plain json_parse() against parsing into a reusable arena, the way clients
+ * parse pages of a crawl.
+ *
+ * Each payload is parsed and freed repeatedly, like consecutive pages of a
+ * crawl. For both ways the benchmark prints the number of malloc() calls per
+ * page and CPU time per page including freeing.
+ *
+ * Run with recorded response bodies, e.g. saved with `curl -o`:
+ *
+ *   json-alloc-bench 1000 streams-1.json streams-2.json
+ *
+ * Without files, it uses a generated page of 100 streams.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "json/json.h"
+#include "utils/arena/arena.h"
+
+/** Helpers **/
+
+double cpu_seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Reads the whole file into memory.
+ *
+ * @param path File path.
+ * @param size Returns file size.
+ *
+ * @return File contents, or NULL on error.
+ */
+char *read_file(const char *path, size_t *size) {
+	FILE *file = fopen(path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	char *data = malloc(length > 0 ? length : 1);
+	if (data == NULL || fread(data, 1, length, file) != (size_t)length) {
+		free(data);
+		fclose(file);
+		return NULL;
+	}
+
+	fclose(file);
+	*size = length;
+	return data;
+}
+
+/**
+ * Generates a page of 100 streams that looks like a real Helix response.
+ *
+ * @param size Returns page size.
+ *
+ * @return Page text.
+ */
+char *generate_page(size_t *size) {
+	size_t capacity = 128 * 1024, length = 0;
+	char *data = malloc(capacity);
+	if (data == NULL) {
+		fprintf(stderr, "Failed to allocate memory for payload.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	length += sprintf(data + length, "{\"data\":[");
+	for (int idx = 0; idx < 100; idx++) {
+		length += sprintf(
+			data + length,
+			"%s{\"id\":\"%d\",\"user_id\":\"%d\",\"user_login\":\"streamer%d\","
+			"\"user_name\":\"Streamer%d\",\"game_id\":\"%d\","
+			"\"game_name\":\"Game %d\",\"type\":\"live\","
+			"\"title\":\"Stream number %d, come and say hi!\","
+			"\"viewer_count\":%d,\"started_at\":\"2024-01-%02dT%02d:00:00Z\","
+			"\"language\":\"en\",\"thumbnail_url\":"
+			"\"https://static-cdn.jtvnw.net/previews-ttv/live_user_streamer%d"
+			"-{width}x{height}.jpg\",\"tag_ids\":[],\"tags\":[\"English\"],"
+			"\"is_mature\":false}",
+			idx > 0 ? "," : "",
+			40000000 + idx * 7919, 100000 + idx * 31, idx, idx,
+			500000 + idx % 13, idx % 13, idx, 10000 - idx * 97,
+			1 + idx % 28, idx % 24, idx
+		);
+	}
+	length += sprintf(
+		data + length,
+		"],\"pagination\":{\"cursor\":"
+		"\"eyJiIjp7IkN1cnNvciI6ImV5SnpJam8xTURBd01Dd2laQ0k2Wm1Gc2MyVjkifX0\"}}"
+	);
+
+	*size = length;
+	return data;
+}
+
+/** Allocators **/
+
+unsigned long malloc_count = 0;
+unsigned long free_count = 0;
+
+void *counting_alloc(size_t size, int zero, void *user_data) {
+	malloc_count++;
+	return zero ? calloc(1, size) : malloc(size);
+}
+
+void counting_free(void *ptr, void *user_data) {
+	free_count++;
+	free(ptr);
+}
+
+void *arena_json_alloc(size_t size, int zero, void *user_data) {
+	return arena_malloc((arena_t *)user_data, size, zero);
+}
+
+void arena_json_free(void *ptr, void *user_data) {
+}
+
+/** Benchmark **/
+
+void run_bench(const char *name, const char *data, size_t size, int count) {
+	char error[json_error_max];
+
+	// Plain parsing, every node is a separate allocation.
+	json_settings settings = { 0 };
+	settings.mem_alloc = &counting_alloc;
+	settings.mem_free = &counting_free;
+
+	malloc_count = 0;
+	free_count = 0;
+	double start = cpu_seconds();
+	for (int idx = 0; idx < count; idx++) {
+		json_value *value = json_parse_ex(&settings, data, size, error);
+		if (value == NULL) {
+			fprintf(stderr, "%s: %s\n", name, error);
+			return;
+		}
+		json_value_free_ex(&settings, value);
+	}
+	double plain_seconds = (cpu_seconds() - start) / count;
+	double plain_mallocs = (double)malloc_count / count;
+
+	// Arena parsing, the arena is emptied after every page.
+	arena_t *arena = arena_init();
+	settings.mem_alloc = &arena_json_alloc;
+	settings.mem_free = &arena_json_free;
+	settings.user_data = arena;
+
+	start = cpu_seconds();
+	for (int idx = 0; idx < count; idx++) {
+		json_value *value = json_parse_ex(&settings, data, size, error);
+		arena_release(arena, value);
+	}
+	double arena_seconds = (cpu_seconds() - start) / count;
+	unsigned long arena_blocks = arena->blocks;
+	arena_free(arena);
+
+	printf(
+		"%-20s %9zu %9.1f %9.3f %9lu %9.1f us %9.1f us\n",
+		name,
+		size,
+		plain_mallocs,
+		(double)arena_blocks / count,
+		arena_blocks,
+		plain_seconds * 1e6,
+		arena_seconds * 1e6
+	);
+}
+
+int main(int argc, char **argv) {
+	int count = (argc > 1) ? atoi(argv[1]) : 1000;
+	if (count <= 0) {
+		fprintf(stderr, "Usage: json-alloc-bench [iterations] [payload...]\n");
+		return 1;
+	}
+
+	printf(
+		"%-20s %9s %9s %9s %9s %12s %12s\n",
+		"payload", "size", "malloc/pg", "arena/pg", "blocks",
+		"plain", "arena"
+	);
+
+	if (argc <= 2) {
+		size_t size = 0;
+		char *page = generate_page(&size);
+		run_bench("streams (generated)", page, size, count);
+		free(page);
+		return 0;
+	}
+
+	for (int idx = 2; idx < argc; idx++) {
+		size_t size = 0;
+		char *data = read_file(argv[idx], &size);
+		if (data == NULL || size == 0) {
+			fprintf(stderr, "Failed to read %s\n", argv[idx]);
+			free(data);
+			continue;
+		}
+
+		const char *name = strrchr(argv[idx], '/');
+		run_bench(name != NULL ? name + 1 : argv[idx], data, size, count);
+		free(data);
+	}
+
+	return 0;
+}
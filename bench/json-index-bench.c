@@ -0,0 +1,271 @@
+/**
+ * Measures throughput of structural indexing of JSON with each available
+ * kernel, and of whole parsing with the bundled parser and the single-pass
+ * one, with and without the index.
+ *
+ * Large pages are where character-by-character scanning hurts most, so by
+ * default it uses generated pages of 100 videos with long descriptions and of
+ * 100 channel search results with tag arrays. Every kernel's index is checked
+ * against the scalar one before it's timed.
+ *
+ * Run with recorded response bodies, e.g. saved with `curl -o`:
+ *
+ *   json-index-bench 1000 videos.json search.json
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "json/json.h"
+#include "utils/json/json_single.h"
+#include "utils/json/json_index.h"
+
+/** Helpers **/
+
+double cpu_seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Reads the whole file into memory.
+ *
+ * @param path File path.
+ * @param size Returns file size.
+ *
+ * @return File contents, or NULL on error.
+ */
+char *read_file(const char *path, size_t *size) {
+	FILE *file = fopen(path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	char *data = malloc(length > 0 ? length : 1);
+	if (data == NULL || fread(data, 1, length, file) != (size_t)length) {
+		free(data);
+		fclose(file);
+		return NULL;
+	}
+
+	fclose(file);
+	*size = length;
+	return data;
+}
+
+/**
+ * Generates a page of 100 videos with long descriptions, or 100 channel
+ * search results with tags, that looks like a real Helix response.
+ *
+ * @param search Whether to generate search results instead of videos.
+ * @param size Returns page size.
+ *
+ * @return Page text.
+ */
+char *generate_page(bool search, size_t *size) {
+	size_t capacity = 512 * 1024, length = 0;
+	char *data = malloc(capacity);
+	if (data == NULL) {
+		fprintf(stderr, "Failed to allocate memory for payload.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	length += sprintf(data + length, "{\"data\":[");
+	for (int idx = 0; idx < 100; idx++) {
+		if (search) {
+			length += sprintf(
+				data + length,
+				"%s{\"broadcaster_language\":\"en\","
+				"\"broadcaster_login\":\"streamer%d\","
+				"\"display_name\":\"Streamer%d\",\"game_id\":\"%d\","
+				"\"game_name\":\"Game %d\",\"id\":\"%d\",\"is_live\":%s,"
+				"\"tag_ids\":[],\"tags\":[\"English\",\"Chill\","
+				"\"NoBackseating\",\"Speedrun\",\"Competitive\",\"Casual\","
+				"\"FamilyFriendly\",\"LGBTQIAPlus\"],"
+				"\"thumbnail_url\":\"https://static-cdn.jtvnw.net/"
+				"jtv_user_pictures/streamer%d-profile_image-300x300.png\","
+				"\"title\":\"Grinding ranked until I hit the top 500, "
+				"come hang out and chat!\","
+				"\"started_at\":\"2024-01-%02dT%02d:00:00Z\"}",
+				idx > 0 ? "," : "",
+				idx, idx, 500000 + idx % 13, idx % 13, 100000 + idx * 31,
+				(idx % 2) ? "true" : "false", idx, 1 + idx % 28, idx % 24
+			);
+		} else {
+			length += sprintf(
+				data + length,
+				"%s{\"id\":\"%d\",\"stream_id\":\"%d\",\"user_id\":\"%d\","
+				"\"user_login\":\"streamer%d\",\"user_name\":\"Streamer%d\","
+				"\"title\":\"Full run with commentary, part %d\","
+				"\"description\":\"",
+				idx > 0 ? "," : "",
+				1900000000 + idx, 40000000 + idx, 100000 + idx * 31,
+				idx, idx, idx
+			);
+			for (int line = 0; line < 6; line++) {
+				length += sprintf(
+					data + length,
+					"Part %d of the series. Thanks to everyone who watched "
+					"live, subscribed and raided, you're the best! Timestamps, "
+					"splits and route notes are in the pinned comment. ",
+					line + 1
+				);
+			}
+			length += sprintf(
+				data + length,
+				"\\u2764\\nFollow for more.\","
+				"\"created_at\":\"2024-01-%02dT%02d:00:00Z\","
+				"\"published_at\":\"2024-01-%02dT%02d:00:00Z\","
+				"\"url\":\"https://www.twitch.tv/videos/%d\","
+				"\"thumbnail_url\":\"https://static-cdn.jtvnw.net/cf_vods/"
+				"%d/thumb/thumb0-%%{width}x%%{height}.jpg\","
+				"\"viewable\":\"public\",\"view_count\":%d,"
+				"\"language\":\"en\",\"type\":\"archive\","
+				"\"duration\":\"%dh%dm%ds\",\"muted_segments\":null}",
+				1 + idx % 28, idx % 24, 1 + idx % 28, idx % 24,
+				1900000000 + idx, 1900000000 + idx, idx * 517,
+				idx % 12, idx % 60, idx % 60
+			);
+		}
+	}
+	length += sprintf(
+		data + length,
+		"],\"pagination\":{\"cursor\":"
+		"\"eyJiIjp7IkN1cnNvciI6ImV5SnpJam8xTURBd01Dd2laQ0k2Wm1Gc2MyVjkifX0\"}}"
+	);
+
+	*size = length;
+	return data;
+}
+
+/** Benchmark **/
+
+void print_result(const char *name, size_t size, double seconds) {
+	printf(
+		"  %-28s %9.2f us %8.3f GB/s\n",
+		name,
+		seconds * 1e6,
+		size / seconds / 1e9
+	);
+}
+
+void run_bench(const char *name, const char *data, size_t size, int count) {
+	printf("%s, %zu bytes\n", name, size);
+
+	json_index expected = { 0 };
+	json_index index = { 0 };
+	json_index_use(JSON_INDEX_SCALAR);
+	json_index_build(&expected, data, size);
+
+	json_index_kernel kernels[] = {
+		JSON_INDEX_SCALAR,
+		JSON_INDEX_SSE2,
+		JSON_INDEX_AVX2
+	};
+
+	for (int kernel = 0; kernel < 3; kernel++) {
+		if (!json_index_use(kernels[kernel])) {
+			continue;
+		}
+
+		json_index_build(&index, data, size);
+		if (
+			index.count != expected.count ||
+			memcmp(
+				index.positions,
+				expected.positions,
+				index.count * sizeof(uint32_t)
+			) != 0
+		) {
+			fprintf(stderr, "  %s: index mismatch\n", json_index_kernel_name());
+			continue;
+		}
+
+		double start = cpu_seconds();
+		for (int idx = 0; idx < count; idx++) {
+			json_index_build(&index, data, size);
+		}
+
+		char label[64];
+		snprintf(label, sizeof(label), "index (%s)", json_index_kernel_name());
+		print_result(label, size, (cpu_seconds() - start) / count);
+	}
+
+	json_index_clear(&expected);
+	json_index_clear(&index);
+	json_index_use(JSON_INDEX_AUTO);
+
+	double start = cpu_seconds();
+	for (int idx = 0; idx < count; idx++) {
+		json_value_free(json_parse(data, size));
+	}
+	print_result("parse (two-pass)", size, (cpu_seconds() - start) / count);
+
+	json_single_scratch *scratch = json_single_scratch_init();
+	for (int indexing = 0; indexing <= 1; indexing++) {
+		json_single_scratch_set_indexing(scratch, indexing);
+
+		start = cpu_seconds();
+		for (int idx = 0; idx < count; idx++) {
+			json_value_free(json_single_parse(scratch, NULL, data, size, NULL));
+		}
+
+		char label[64];
+		snprintf(
+			label,
+			sizeof(label),
+			"parse (single-pass%s%s)",
+			indexing ? ", " : "",
+			indexing ? json_index_kernel_name() : ""
+		);
+		print_result(label, size, (cpu_seconds() - start) / count);
+	}
+	json_single_scratch_free(scratch);
+}
+
+int main(int argc, char **argv) {
+	int count = (argc > 1) ? atoi(argv[1]) : 1000;
+	if (count <= 0) {
+		fprintf(stderr, "Usage: json-index-bench [iterations] [payload...]\n");
+		return 1;
+	}
+
+	if (argc <= 2) {
+		size_t size = 0;
+		char *page = generate_page(false, &size);
+		run_bench("videos (generated)", page, size, count);
+		free(page);
+
+		page = generate_page(true, &size);
+		run_bench("search (generated)", page, size, count);
+		free(page);
+		return 0;
+	}
+
+	for (int idx = 2; idx < argc; idx++) {
+		size_t size = 0;
+		char *data = read_file(argv[idx], &size);
+		if (data == NULL || size == 0) {
+			fprintf(stderr, "Failed to read %s\n", argv[idx]);
+			free(data);
+			continue;
+		}
+
+		const char *name = strrchr(argv[idx], '/');
+		run_bench(name != NULL ? name + 1 : argv[idx], data, size, count);
+		free(data);
+	}
+
+	return 0;
+}
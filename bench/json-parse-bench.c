@@ -0,0 +1,281 @@
+/**
+ * Compares the bundled two-pass JSON parser with the single-pass one on
+ * Helix pages.
+ *
+ * Each payload is parsed and freed repeatedly by both parsers, and the
+ * benchmark prints CPU time per page and throughput of each, along with the
+ * speedup. Trees built by both parsers are compared first, and a payload
+ * they disagree on is reported and skipped.
+ *
+ * Run with recorded response bodies, e.g. saved with `curl -o`:
+ *
+ *   json-parse-bench 1000 streams.json users.json
+ *
+ * Without files, it uses generated pages of 20, 50 and 100 streams and users.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "json/json.h"
+#include "utils/json/json_single.h"
+
+/** Helpers **/
+
+double cpu_seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Reads the whole file into memory.
+ *
+ * @param path File path.
+ * @param size Returns file size.
+ *
+ * @return File contents, or NULL on error.
+ */
+char *read_file(const char *path, size_t *size) {
+	FILE *file = fopen(path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	char *data = malloc(length > 0 ? length : 1);
+	if (data == NULL || fread(data, 1, length, file) != (size_t)length) {
+		free(data);
+		fclose(file);
+		return NULL;
+	}
+
+	fclose(file);
+	*size = length;
+	return data;
+}
+
+/**
+ * Generates a page of streams or users that looks like a real Helix
+ * response.
+ *
+ * @param users Whether to generate users instead of streams.
+ * @param count Number of items.
+ * @param size Returns page size.
+ *
+ * @return Page text.
+ */
+char *generate_page(bool users, int count, size_t *size) {
+	size_t capacity = 1024 + count * 1024, length = 0;
+	char *data = malloc(capacity);
+	if (data == NULL) {
+		fprintf(stderr, "Failed to allocate memory for payload.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	length += sprintf(data + length, "{\"data\":[");
+	for (int idx = 0; idx < count; idx++) {
+		if (users) {
+			length += sprintf(
+				data + length,
+				"%s{\"id\":\"%d\",\"login\":\"user%d\","
+				"\"display_name\":\"User%d\",\"type\":\"\","
+				"\"broadcaster_type\":\"%s\",\"description\":\"Caf\\u00e9 "
+				"streams \\ud83c\\udfae every day.\\nCome and \\\"chill\\\"!\","
+				"\"profile_image_url\":\"https://static-cdn.jtvnw.net/"
+				"jtv_user_pictures/user%d-profile_image-300x300.png\","
+				"\"offline_image_url\":\"\",\"view_count\":%d,"
+				"\"created_at\":\"2016-%02d-%02dT12:00:00Z\"}",
+				idx > 0 ? "," : "",
+				100000 + idx * 31, idx, idx,
+				(idx % 3 == 0) ? "partner" : "affiliate",
+				idx, idx * 1234, 1 + idx % 12, 1 + idx % 28
+			);
+		} else {
+			length += sprintf(
+				data + length,
+				"%s{\"id\":\"%d\",\"user_id\":\"%d\","
+				"\"user_login\":\"streamer%d\",\"user_name\":\"Streamer%d\","
+				"\"game_id\":\"%d\",\"game_name\":\"Game %d\","
+				"\"type\":\"live\","
+				"\"title\":\"Stream number %d, come and say hi!\","
+				"\"viewer_count\":%d,"
+				"\"started_at\":\"2024-01-%02dT%02d:00:00Z\","
+				"\"language\":\"en\",\"thumbnail_url\":"
+				"\"https://static-cdn.jtvnw.net/previews-ttv/"
+				"live_user_streamer%d-{width}x{height}.jpg\","
+				"\"tag_ids\":[],\"tags\":[\"English\"],\"is_mature\":false}",
+				idx > 0 ? "," : "",
+				40000000 + idx * 7919, 100000 + idx * 31, idx, idx,
+				500000 + idx % 13, idx % 13, idx, 10000 - idx * 97,
+				1 + idx % 28, idx % 24, idx
+			);
+		}
+	}
+	length += sprintf(
+		data + length,
+		"],\"pagination\":{\"cursor\":"
+		"\"eyJiIjp7IkN1cnNvciI6ImV5SnpJam8xTURBd01Dd2laQ0k2Wm1Gc2MyVjkifX0\"}}"
+	);
+
+	*size = length;
+	return data;
+}
+
+/**
+ * Checks whether two trees are identical.
+ */
+bool json_equals(json_value *a, json_value *b) {
+	if (a == NULL || b == NULL || a->type != b->type) {
+		return a == b;
+	}
+
+	switch (a->type) {
+		case json_object:
+			if (a->u.object.length != b->u.object.length) {
+				return false;
+			}
+			for (unsigned int idx = 0; idx < a->u.object.length; idx++) {
+				json_object_entry *x = &a->u.object.values[idx];
+				json_object_entry *y = &b->u.object.values[idx];
+				if (
+					x->name_length != y->name_length ||
+					memcmp(x->name, y->name, x->name_length) != 0 ||
+					!json_equals(x->value, y->value)
+				) {
+					return false;
+				}
+			}
+			return true;
+		case json_array:
+			if (a->u.array.length != b->u.array.length) {
+				return false;
+			}
+			for (unsigned int idx = 0; idx < a->u.array.length; idx++) {
+				json_value *x = a->u.array.values[idx];
+				json_value *y = b->u.array.values[idx];
+				if (!json_equals(x, y)) {
+					return false;
+				}
+			}
+			return true;
+		case json_string:
+			return a->u.string.length == b->u.string.length && memcmp(
+				a->u.string.ptr,
+				b->u.string.ptr,
+				a->u.string.length
+			) == 0;
+		case json_integer:
+			return a->u.integer == b->u.integer;
+		case json_double:
+			return a->u.dbl == b->u.dbl;
+		case json_boolean:
+			return a->u.boolean == b->u.boolean;
+		default:
+			return true;
+	}
+}
+
+/** Benchmark **/
+
+void run_bench(const char *name, const char *data, size_t size, int count) {
+	json_single_scratch *scratch = json_single_scratch_init();
+	char error[json_error_max];
+
+	json_value *expected = json_parse(data, size);
+	json_value *actual = json_single_parse(scratch, NULL, data, size, error);
+	bool equal = json_equals(expected, actual);
+	json_value_free(expected);
+	json_value_free(actual);
+	if (!equal) {
+		fprintf(stderr, "%s: parsers disagree, skipped\n", name);
+		json_single_scratch_free(scratch);
+		return;
+	}
+
+	double start = cpu_seconds();
+	for (int idx = 0; idx < count; idx++) {
+		json_value_free(json_parse(data, size));
+	}
+	double two_pass = (cpu_seconds() - start) / count;
+
+	start = cpu_seconds();
+	for (int idx = 0; idx < count; idx++) {
+		json_value_free(json_single_parse(scratch, NULL, data, size, NULL));
+	}
+	double single_pass = (cpu_seconds() - start) / count;
+
+	printf(
+		"%-20s %9zu %9.1f us %8.1f MB/s %9.1f us %8.1f MB/s %7.2fx\n",
+		name,
+		size,
+		two_pass * 1e6,
+		size / two_pass / 1e6,
+		single_pass * 1e6,
+		size / single_pass / 1e6,
+		two_pass / single_pass
+	);
+
+	json_single_scratch_free(scratch);
+}
+
+int main(int argc, char **argv) {
+	int count = (argc > 1) ? atoi(argv[1]) : 1000;
+	if (count <= 0) {
+		fprintf(stderr, "Usage: json-parse-bench [iterations] [payload...]\n");
+		return 1;
+	}
+
+	printf(
+		"%-20s %9s %12s %13s %12s %13s %8s\n",
+		"payload", "size", "two-pass", "throughput", "single-pass",
+		"throughput", "speedup"
+	);
+
+	if (argc <= 2) {
+		int sizes[] = { 20, 50, 100 };
+		for (int users = 0; users <= 1; users++) {
+			for (int idx = 0; idx < 3; idx++) {
+				char name[32];
+				snprintf(
+					name,
+					sizeof(name),
+					"%s x%d",
+					users ? "users" : "streams",
+					sizes[idx]
+				);
+
+				size_t size = 0;
+				char *page = generate_page(users, sizes[idx], &size);
+				run_bench(name, page, size, count);
+				free(page);
+			}
+		}
+		return 0;
+	}
+
+	for (int idx = 2; idx < argc; idx++) {
+		size_t size = 0;
+		char *data = read_file(argv[idx], &size);
+		if (data == NULL || size == 0) {
+			fprintf(stderr, "Failed to read %s\n", argv[idx]);
+			free(data);
+			continue;
+		}
+
+		const char *name = strrchr(argv[idx], '/');
+		run_bench(name != NULL ? name + 1 : argv[idx], data, size, count);
+		free(data);
+	}
+
+	return 0;
+}
@@ -0,0 +1,316 @@
+/**
+ * Load generator. Drives the library's public API at a target request rate
+ * and reports throughput and latency percentiles.
+ *
+ * Requests are sent on a fixed open-loop schedule: request N is due at
+ * start + N / QPS, no matter how long earlier requests took. Latency is
+ * measured from the moment the request was due, not from the moment it was
+ * actually sent, so a slow server shows up as growing latency instead of as
+ * a silently lower request rate. Service time, measured from the actual send,
+ * is reported separately.
+ *
+ * Meant to be used with `mock-helix`:
+ *
+ *   mock-helix --port=8080 --latency=20 &
+ *   load-gen http://127.0.0.1:8080 200 10 8 mixed
+ *
+ * Arguments are API URL, target QPS, duration in seconds, number of threads
+ * (each with its own client), and endpoint: users, streams, followers, videos
+ * or mixed.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <ctwitch/ctwitch.h>
+#include <ctwitch/helix.h>
+
+/** Helpers **/
+
+double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void sleep_until(double deadline) {
+	double delay = deadline - now();
+	if (delay <= 0) {
+		return;
+	}
+
+	struct timespec ts;
+	ts.tv_sec = (time_t)delay;
+	ts.tv_nsec = (long)((delay - ts.tv_sec) * 1e9);
+	nanosleep(&ts, NULL);
+}
+
+int compare_doubles(const void *a, const void *b) {
+	double da = *(const double *)a, db = *(const double *)b;
+	return (da > db) - (da < db);
+}
+
+/** Requests **/
+
+typedef enum {
+	ENDPOINT_USERS,
+	ENDPOINT_STREAMS,
+	ENDPOINT_FOLLOWERS,
+	ENDPOINT_VIDEOS,
+	ENDPOINT_MIXED
+} endpoint_t;
+
+/**
+ * Performs request number `index` to given endpoint.
+ *
+ * @return true if the request succeeded.
+ */
+bool perform(twitch_client *client, endpoint_t endpoint, long index) {
+	twitch_error error = { 0 };
+	bool success = false;
+
+	if (endpoint == ENDPOINT_MIXED) {
+		endpoint = (endpoint_t)(index % ENDPOINT_MIXED);
+	}
+
+	switch (endpoint) {
+		case ENDPOINT_USERS: {
+			char login[32];
+			snprintf(login, sizeof(login), "user%ld", index % 10000);
+			const char *logins[1] = { login };
+
+			twitch_helix_user_list *users = twitch_helix_get_users(
+				client, "load-gen", "token", &error, 1, logins
+			);
+			success = users != NULL;
+			twitch_helix_user_list_free(users);
+			break;
+		}
+		case ENDPOINT_STREAMS: {
+			char *next = NULL;
+			twitch_helix_stream_list *streams = twitch_helix_get_streams(
+				client, "load-gen", "token", &error, NULL, NULL, 0, NULL, 0, NULL,
+				100, NULL, NULL, &next
+			);
+			success = streams != NULL;
+			twitch_helix_stream_list_free(streams);
+			free(next);
+			break;
+		}
+		case ENDPOINT_FOLLOWERS: {
+			char *next = NULL;
+			int total = 0;
+			twitch_helix_follower_list *followers =
+				twitch_helix_get_channel_followers(
+					client, "load-gen", "token", &error, "12345", NULL, 100, NULL,
+					&total, &next
+				);
+			success = followers != NULL;
+			twitch_helix_follower_list_free(followers);
+			free(next);
+			break;
+		}
+		default: {
+			char *next = NULL;
+			twitch_helix_video_list *videos = twitch_helix_get_videos(
+				client, "load-gen", "token", &error, "12345", NULL, 0, NULL, NULL,
+				NULL, NULL, NULL, 100, NULL, &next
+			);
+			success = videos != NULL;
+			twitch_helix_video_list_free(videos);
+			free(next);
+			break;
+		}
+	}
+
+	twitch_error_clear(&error);
+	return success && error.curl_code == 0;
+}
+
+/** Workers **/
+
+typedef struct {
+	const char *api_url;
+	endpoint_t endpoint;
+	double qps;
+	double start;
+	long total;      // Requests in the whole run.
+	int thread;      // Worker index.
+	int threads;     // Number of workers.
+
+	long count;      // Requests sent by this worker.
+	long errors;     // Failed requests.
+	double *latency; // Time from due to done, per request.
+	double *service; // Time from send to done, per request.
+} worker_t;
+
+/**
+ * Sends every `threads`-th request of the schedule, starting with `thread`.
+ */
+void *worker_run(void *arg) {
+	worker_t *worker = arg;
+
+	twitch_client *client = twitch_client_alloc();
+	twitch_client_set_api_url(client, worker->api_url);
+
+	for (long idx = worker->thread; idx < worker->total; idx += worker->threads) {
+		double due = worker->start + idx / worker->qps;
+		sleep_until(due);
+
+		double sent = now();
+		if (!perform(client, worker->endpoint, idx)) {
+			worker->errors++;
+		}
+		double done = now();
+
+		worker->latency[worker->count] = done - due;
+		worker->service[worker->count] = done - sent;
+		worker->count++;
+	}
+
+	twitch_client_free(client);
+	return NULL;
+}
+
+/** Report **/
+
+double percentile(double *samples, long count, double fraction) {
+	long index = (long)(count * fraction);
+	return samples[index < count ? index : count - 1] * 1000;
+}
+
+void report(const char *name, double *samples, long count) {
+	qsort(samples, count, sizeof(double), compare_doubles);
+	printf(
+		"%-8s p50=%.2fms p90=%.2fms p99=%.2fms p99.9=%.2fms max=%.2fms\n",
+		name,
+		percentile(samples, count, 0.5),
+		percentile(samples, count, 0.9),
+		percentile(samples, count, 0.99),
+		percentile(samples, count, 0.999),
+		samples[count - 1] * 1000
+	);
+}
+
+/** Main **/
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		fprintf(
+			stderr,
+			"Usage: load-gen <api-url> [qps] [seconds] [threads] "
+			"[users|streams|followers|videos|mixed]\n"
+		);
+		return EXIT_FAILURE;
+	}
+
+	const char *api_url = argv[1];
+	double qps = (argc > 2) ? atof(argv[2]) : 100;
+	double seconds = (argc > 3) ? atof(argv[3]) : 10;
+	int threads = (argc > 4) ? atoi(argv[4]) : 4;
+	const char *endpoint_name = (argc > 5) ? argv[5] : "users";
+
+	const char *names[] = { "users", "streams", "followers", "videos", "mixed" };
+	endpoint_t endpoint = ENDPOINT_MIXED + 1;
+	for (int idx = 0; idx <= ENDPOINT_MIXED; idx++) {
+		if (strcmp(endpoint_name, names[idx]) == 0) {
+			endpoint = (endpoint_t)idx;
+		}
+	}
+
+	if (qps <= 0 || seconds <= 0 || threads <= 0 || endpoint > ENDPOINT_MIXED) {
+		fprintf(stderr, "Error: invalid arguments.\n");
+		return EXIT_FAILURE;
+	}
+
+	long total = (long)(qps * seconds);
+	if (total < 1) {
+		total = 1;
+	}
+
+	twitch_helix_init();
+
+	worker_t *workers = calloc(threads, sizeof(worker_t));
+	pthread_t *ids = calloc(threads, sizeof(pthread_t));
+	if (workers == NULL || ids == NULL) {
+		fprintf(stderr, "Failed to allocate memory for workers.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// Give threads time to create their clients before the first request is due.
+	double start = now() + 0.1;
+
+	for (int idx = 0; idx < threads; idx++) {
+		worker_t *worker = &workers[idx];
+		worker->api_url = api_url;
+		worker->endpoint = endpoint;
+		worker->qps = qps;
+		worker->start = start;
+		worker->total = total;
+		worker->thread = idx;
+		worker->threads = threads;
+
+		long capacity = total / threads + 1;
+		worker->latency = malloc(sizeof(double) * capacity);
+		worker->service = malloc(sizeof(double) * capacity);
+		if (worker->latency == NULL || worker->service == NULL) {
+			fprintf(stderr, "Failed to allocate memory for samples.\n");
+			exit(EXIT_FAILURE);
+		}
+
+		pthread_create(&ids[idx], NULL, &worker_run, worker);
+	}
+
+	long count = 0, errors = 0;
+	for (int idx = 0; idx < threads; idx++) {
+		pthread_join(ids[idx], NULL);
+		count += workers[idx].count;
+		errors += workers[idx].errors;
+	}
+	double elapsed = now() - start;
+
+	// Merge samples.
+	double *latency = malloc(sizeof(double) * count);
+	double *service = malloc(sizeof(double) * count);
+	if (latency == NULL || service == NULL) {
+		fprintf(stderr, "Failed to allocate memory for samples.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	long offset = 0;
+	for (int idx = 0; idx < threads; idx++) {
+		memcpy(latency + offset, workers[idx].latency,
+			sizeof(double) * workers[idx].count);
+		memcpy(service + offset, workers[idx].service,
+			sizeof(double) * workers[idx].count);
+		offset += workers[idx].count;
+		free(workers[idx].latency);
+		free(workers[idx].service);
+	}
+
+	printf(
+		"%s: %ld requests, %ld errors in %.2fs, %.1f req/s (target %.1f)\n",
+		endpoint_name,
+		count,
+		errors,
+		elapsed,
+		count / elapsed,
+		qps
+	);
+	report("latency", latency, count);
+	report("service", service, count);
+
+	free(latency);
+	free(service);
+	free(workers);
+	free(ids);
+
+	return errors > 0 ? 1 : 0;
+}
@@ -0,0 +1,968 @@
+/**
+ * Mock Helix API server for load testing and benchmarks.
+ *
+ * Serves synthetic but well-formed responses for the endpoints the library
+ * implements, with opaque cursors, `total` fields, and optional latency and
+ * rate limiting, so the library can be driven at high request rates without
+ * touching Twitch. Every collection has the same number of items, which sets
+ * the number of pages a crawl takes.
+ *
+ * Usage:
+ *
+ *   mock-helix [options]
+ *
+ *   --port=N        Port to listen on, 8080 by default. 0 picks a free one,
+ *                   which is printed on startup.
+ *   --items=N       Items in every paged collection, 1000 by default.
+ *   --latency=MS    Delay before every response, 0 by default.
+ *   --jitter=MS     Max random deviation of the delay, 0 by default.
+ *   --rate-limit=N  Points per minute per client ID. Requests over the limit
+ *                   get 429 response. 0 (default) disables rate limiting.
+ *   --fail-every=N  Answer every Nth request with 503, to exercise retries.
+ *                   0 (default) never fails.
+ *
+ * Point the library at it with twitch_client_set_api_url(), e.g.
+ * "http://127.0.0.1:8080". The server is single-threaded and keeps
+ * connections alive, and it's not meant to be exposed to a network.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#define MAX_CONNECTIONS 1024
+#define MAX_REQUEST_SIZE 65536
+#define MAX_PAGE_SIZE 100
+#define DEFAULT_PAGE_SIZE 20
+#define MAX_QUERY_VALUES 100
+#define MAX_BUCKETS 64
+
+/** Settings **/
+
+typedef struct {
+	int port;
+	int items;
+	long latency;
+	long jitter;
+	long rate_limit;
+	long fail_every;
+} mock_settings;
+
+mock_settings settings = { 8080, 1000, 0, 0, 0, 0 };
+long requests_count = 0;
+
+/** Helpers **/
+
+double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Growing output buffer.
+ */
+typedef struct {
+	char *ptr;
+	size_t len;
+	size_t capacity;
+} buffer_t;
+
+void buffer_reserve(buffer_t *buffer, size_t size) {
+	if (buffer->len + size + 1 <= buffer->capacity) {
+		return;
+	}
+
+	while (buffer->len + size + 1 > buffer->capacity) {
+		buffer->capacity = (buffer->capacity == 0) ? 4096 : buffer->capacity * 2;
+	}
+
+	buffer->ptr = realloc(buffer->ptr, buffer->capacity);
+	if (buffer->ptr == NULL) {
+		fprintf(stderr, "Failed to allocate memory for buffer.\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+void buffer_append(buffer_t *buffer, const char *data, size_t size) {
+	buffer_reserve(buffer, size);
+	memcpy(buffer->ptr + buffer->len, data, size);
+	buffer->len += size;
+	buffer->ptr[buffer->len] = '\0';
+}
+
+void buffer_printf(buffer_t *buffer, const char *format, ...) {
+	va_list args;
+
+	va_start(args, format);
+	int size = vsnprintf(NULL, 0, format, args);
+	va_end(args);
+
+	buffer_reserve(buffer, size);
+
+	va_start(args, format);
+	vsnprintf(buffer->ptr + buffer->len, size + 1, format, args);
+	va_end(args);
+
+	buffer->len += size;
+}
+
+void buffer_consume(buffer_t *buffer, size_t size) {
+	memmove(buffer->ptr, buffer->ptr + size, buffer->len - size);
+	buffer->len -= size;
+}
+
+/**
+ * Stable pseudo-random number for given key, so the same item looks the same
+ * in every response.
+ */
+unsigned long hash(const char *key) {
+	unsigned long value = 1469598103934665603UL;
+	for (; *key != '\0'; key++) {
+		value = (value ^ (unsigned char)*key) * 1099511628211UL;
+	}
+	return value;
+}
+
+/** Cursors **/
+
+static const char BASE64[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/**
+ * Encodes an offset into an opaque cursor, the way Helix does it: base64 of a
+ * small JSON document.
+ */
+void cursor_encode(int offset, char *cursor) {
+	char plain[64];
+	int length = sprintf(plain, "{\"b\":null,\"a\":{\"Offset\":%d}}", offset);
+
+	int out = 0;
+	for (int idx = 0; idx < length; idx += 3) {
+		unsigned int chunk = (unsigned char)plain[idx] << 16;
+		if (idx + 1 < length) chunk |= (unsigned char)plain[idx + 1] << 8;
+		if (idx + 2 < length) chunk |= (unsigned char)plain[idx + 2];
+
+		cursor[out++] = BASE64[(chunk >> 18) & 63];
+		cursor[out++] = BASE64[(chunk >> 12) & 63];
+		cursor[out++] = (idx + 1 < length) ? BASE64[(chunk >> 6) & 63] : '=';
+		cursor[out++] = (idx + 2 < length) ? BASE64[chunk & 63] : '=';
+	}
+	cursor[out] = '\0';
+}
+
+/**
+ * Decodes an offset from a cursor.
+ *
+ * @return Offset, or 0 if the cursor is not valid.
+ */
+int cursor_decode(const char *cursor) {
+	char plain[64];
+	int out = 0;
+	unsigned int chunk = 0;
+	int bits = 0;
+
+	for (; *cursor != '\0' && *cursor != '=' && out < 63; cursor++) {
+		const char *position = strchr(BASE64, *cursor);
+		if (position == NULL) {
+			return 0;
+		}
+
+		chunk = (chunk << 6) | (unsigned int)(position - BASE64);
+		bits += 6;
+		if (bits >= 8) {
+			bits -= 8;
+			plain[out++] = (char)((chunk >> bits) & 0xFF);
+		}
+	}
+	plain[out] = '\0';
+
+	const char *value = strstr(plain, "\"Offset\":");
+	return (value != NULL) ? atoi(value + 9) : 0;
+}
+
+/** Requests **/
+
+typedef struct {
+	char name[32];
+	char *value;
+} query_param;
+
+typedef struct {
+	char method[8];
+	char path[256];
+	char client_id[64];
+	bool close;
+	int params_count;
+	query_param params[MAX_QUERY_VALUES * 2];
+} mock_request;
+
+void url_decode(char *value) {
+	char *out = value;
+	for (char *in = value; *in != '\0'; in++) {
+		if (*in == '%' && in[1] != '\0' && in[2] != '\0') {
+			char hex[3] = { in[1], in[2], '\0' };
+			*out++ = (char)strtol(hex, NULL, 16);
+			in += 2;
+		} else if (*in == '+') {
+			*out++ = ' ';
+		} else {
+			*out++ = *in;
+		}
+	}
+	*out = '\0';
+}
+
+/**
+ * Parses request line and headers. Query values point into the request text.
+ *
+ * @return false if the request is malformed.
+ */
+bool parse_request(char *text, mock_request *request) {
+	memset(request, 0, sizeof(mock_request));
+
+	char *line_end = strstr(text, "\r\n");
+	if (line_end == NULL) {
+		return false;
+	}
+	*line_end = '\0';
+
+	char target[4096];
+	if (sscanf(text, "%7s %4095s", request->method, target) != 2) {
+		return false;
+	}
+
+	// Headers.
+	for (char *line = line_end + 2; *line != '\0' && *line != '\r';) {
+		char *next = strstr(line, "\r\n");
+		if (next == NULL) {
+			break;
+		}
+		*next = '\0';
+
+		if (strncasecmp(line, "Client-ID:", 10) == 0) {
+			sscanf(line + 10, " %63s", request->client_id);
+		} else if (strncasecmp(line, "Connection:", 11) == 0) {
+			request->close = strstr(line + 11, "close") != NULL;
+		}
+
+		line = next + 2;
+	}
+
+	// Path and query. Target is copied into the request text's first line,
+	// which is not needed anymore.
+	char *query = strchr(target, '?');
+	if (query != NULL) {
+		*query++ = '\0';
+	}
+
+	// Paths that don't fit can't match any route, so they're rejected.
+	size_t path_length = strlen(target);
+	if (path_length >= sizeof(request->path)) {
+		return false;
+	}
+	memcpy(request->path, target, path_length + 1);
+
+	if (query == NULL) {
+		return true;
+	}
+
+	strcpy(text, query);
+	for (char *pair = strtok(text, "&"); pair != NULL; pair = strtok(NULL, "&")) {
+		char *value = strchr(pair, '=');
+		if (value == NULL || request->params_count == MAX_QUERY_VALUES * 2) {
+			continue;
+		}
+		*value++ = '\0';
+
+		query_param *param = &request->params[request->params_count++];
+		snprintf(param->name, sizeof(param->name), "%s", pair);
+		url_decode(value);
+		param->value = value;
+	}
+
+	return true;
+}
+
+const char *get_param(mock_request *request, const char *name) {
+	for (int idx = 0; idx < request->params_count; idx++) {
+		if (strcmp(request->params[idx].name, name) == 0) {
+			return request->params[idx].value;
+		}
+	}
+	return NULL;
+}
+
+/** Rate limiting **/
+
+typedef struct {
+	char client_id[64];
+	double tokens;
+	double updated;
+} mock_bucket;
+
+mock_bucket buckets[MAX_BUCKETS];
+int buckets_count = 0;
+
+/**
+ * Takes a point from client ID's bucket.
+ *
+ * @param client_id Client ID of the request.
+ * @param headers Buffer to write rate limit headers to.
+ *
+ * @return false if the bucket is empty.
+ */
+bool take_point(const char *client_id, buffer_t *headers) {
+	if (settings.rate_limit <= 0) {
+		return true;
+	}
+
+	mock_bucket *bucket = NULL;
+	for (int idx = 0; idx < buckets_count; idx++) {
+		if (strcmp(buckets[idx].client_id, client_id) == 0) {
+			bucket = &buckets[idx];
+			break;
+		}
+	}
+
+	if (bucket == NULL) {
+		bucket = &buckets[buckets_count < MAX_BUCKETS ? buckets_count++ : 0];
+		snprintf(bucket->client_id, sizeof(bucket->client_id), "%s", client_id);
+		bucket->tokens = settings.rate_limit;
+		bucket->updated = now();
+	}
+
+	// Refill continuously, like Helix does.
+	double current = now();
+	bucket->tokens += (current - bucket->updated) * settings.rate_limit / 60.0;
+	if (bucket->tokens > settings.rate_limit) {
+		bucket->tokens = settings.rate_limit;
+	}
+	bucket->updated = current;
+
+	bool allowed = bucket->tokens >= 1;
+	if (allowed) {
+		bucket->tokens -= 1;
+	}
+
+	long missing = settings.rate_limit - (long)bucket->tokens;
+	buffer_printf(
+		headers,
+		"Ratelimit-Limit: %ld\r\nRatelimit-Remaining: %ld\r\n"
+		"Ratelimit-Reset: %ld\r\n",
+		settings.rate_limit,
+		(long)bucket->tokens,
+		(long)time(NULL) + missing * 60 / settings.rate_limit + 1
+	);
+
+	return allowed;
+}
+
+/** Responses **/
+
+/**
+ * Writes a page of a paged collection, calling the item writer for each item.
+ */
+void write_page(
+	mock_request *request,
+	buffer_t *body,
+	void (*writer)(buffer_t *, int, mock_request *)
+) {
+	const char *first_param = get_param(request, "first");
+	const char *after_param = get_param(request, "after");
+
+	int first = (first_param != NULL) ? atoi(first_param) : DEFAULT_PAGE_SIZE;
+	if (first <= 0 || first > MAX_PAGE_SIZE) {
+		first = DEFAULT_PAGE_SIZE;
+	}
+
+	int offset = (after_param != NULL) ? cursor_decode(after_param) : 0;
+	int count = settings.items - offset;
+	if (count > first) {
+		count = first;
+	}
+	if (count < 0) {
+		count = 0;
+	}
+
+	buffer_printf(body, "{\"data\":[");
+	for (int idx = 0; idx < count; idx++) {
+		if (idx > 0) {
+			buffer_append(body, ",", 1);
+		}
+		writer(body, offset + idx, request);
+	}
+	buffer_printf(body, "],\"total\":%d,\"pagination\":{", settings.items);
+
+	if (offset + count < settings.items) {
+		char cursor[128];
+		cursor_encode(offset + count, cursor);
+		buffer_printf(body, "\"cursor\":\"%s\"", cursor);
+	}
+
+	buffer_printf(body, "}}");
+}
+
+void write_user(buffer_t *body, const char *login, unsigned long id) {
+	buffer_printf(
+		body,
+		"{\"id\":\"%lu\",\"login\":\"%s\",\"display_name\":\"%s\","
+		"\"type\":\"\",\"broadcaster_type\":\"%s\","
+		"\"description\":\"Mock channel of %s.\","
+		"\"profile_image_url\":\"https://static-cdn.jtvnw.net/jtv_user_pictures/"
+		"%s-profile_image-300x300.png\",\"offline_image_url\":\"\","
+		"\"view_count\":%lu,\"created_at\":\"2016-12-14T20:32:28Z\"}",
+		id, login, login, (id % 3 == 0) ? "partner" : "affiliate", login, login,
+		id % 100000
+	);
+}
+
+void write_stream(buffer_t *body, int index, mock_request *request) {
+	(void)request;
+
+	buffer_printf(
+		body,
+		"{\"id\":\"%d\",\"user_id\":\"%d\",\"user_login\":\"streamer%d\","
+		"\"user_name\":\"Streamer%d\",\"game_id\":\"%d\","
+		"\"game_name\":\"Game %d\",\"type\":\"live\","
+		"\"title\":\"Mock stream number %d\",\"viewer_count\":%d,"
+		"\"started_at\":\"2024-01-01T00:00:00Z\",\"language\":\"en\","
+		"\"thumbnail_url\":\"https://static-cdn.jtvnw.net/previews-ttv/"
+		"live_user_streamer%d-{width}x{height}.jpg\",\"tag_ids\":[],"
+		"\"tags\":[\"English\"],\"is_mature\":false}",
+		40000000 + index, 100000 + index, index, index, 500000 + index % 50,
+		index % 50, index, settings.items - index, index
+	);
+}
+
+void write_follower(buffer_t *body, int index, mock_request *request) {
+	(void)request;
+
+	buffer_printf(
+		body,
+		"{\"user_id\":\"%d\",\"user_login\":\"follower%d\","
+		"\"user_name\":\"Follower%d\",\"followed_at\":\"2024-01-01T00:00:00Z\"}",
+		200000 + index, index, index
+	);
+}
+
+void write_followed(buffer_t *body, int index, mock_request *request) {
+	(void)request;
+
+	buffer_printf(
+		body,
+		"{\"broadcaster_id\":\"%d\",\"broadcaster_login\":\"streamer%d\","
+		"\"broadcaster_name\":\"Streamer%d\","
+		"\"followed_at\":\"2024-01-01T00:00:00Z\"}",
+		100000 + index, index, index
+	);
+}
+
+void write_video(buffer_t *body, int index, mock_request *request) {
+	const char *user_id = get_param(request, "user_id");
+	buffer_printf(
+		body,
+		"{\"id\":\"%d\",\"stream_id\":null,\"user_id\":\"%s\","
+		"\"user_login\":\"streamer\",\"user_name\":\"Streamer\","
+		"\"title\":\"Mock video number %d\",\"description\":\"\","
+		"\"created_at\":\"2024-01-01T00:00:00Z\","
+		"\"published_at\":\"2024-01-01T00:00:00Z\","
+		"\"url\":\"https://www.twitch.tv/videos/%d\",\"thumbnail_url\":\"\","
+		"\"viewable\":\"public\",\"view_count\":%d,\"language\":\"en\","
+		"\"type\":\"archive\",\"duration\":\"3h8m33s\","
+		"\"muted_segments\":[{\"duration\":30,\"offset\":120}]}",
+		300000000 + index, user_id != NULL ? user_id : "1", index,
+		300000000 + index, index * 7
+	);
+}
+
+void write_game(buffer_t *body, int index, mock_request *request) {
+	(void)request;
+
+	buffer_printf(
+		body,
+		"{\"id\":\"%d\",\"name\":\"Game %d\",\"box_art_url\":"
+		"\"https://static-cdn.jtvnw.net/ttv-boxart/%d-{width}x{height}.jpg\","
+		"\"igdb_id\":\"%d\"}",
+		500000 + index, index, 500000 + index, 1000 + index
+	);
+}
+
+void write_channel(buffer_t *body, int index, mock_request *request) {
+	(void)request;
+
+	buffer_printf(
+		body,
+		"{\"broadcaster_language\":\"en\",\"broadcaster_login\":\"streamer%d\","
+		"\"display_name\":\"Streamer%d\",\"game_id\":\"%d\","
+		"\"game_name\":\"Game %d\",\"id\":\"%d\",\"is_live\":%s,"
+		"\"tags\":[\"English\"],\"thumbnail_url\":\"\","
+		"\"title\":\"Mock channel number %d\",\"started_at\":\"\"}",
+		index, index, 500000 + index % 50, index % 50, 100000 + index,
+		(index % 3 == 0) ? "true" : "false", index
+	);
+}
+
+/**
+ * Writes users matching login and id params.
+ */
+void write_users(mock_request *request, buffer_t *body) {
+	buffer_printf(body, "{\"data\":[");
+
+	bool first = true;
+	for (int idx = 0; idx < request->params_count; idx++) {
+		query_param *param = &request->params[idx];
+		if (strcmp(param->name, "login") == 0) {
+			if (!first) buffer_append(body, ",", 1);
+			write_user(body, param->value, 100000 + hash(param->value) % 900000);
+			first = false;
+		} else if (strcmp(param->name, "id") == 0) {
+			char login[64];
+			snprintf(login, sizeof(login), "user%s", param->value);
+			if (!first) buffer_append(body, ",", 1);
+			write_user(body, login, strtoul(param->value, NULL, 10));
+			first = false;
+		}
+	}
+
+	buffer_printf(body, "]}");
+}
+
+/**
+ * Writes live streams of users given with user_login and user_id params.
+ * About a third of users are live.
+ */
+void write_user_streams(mock_request *request, buffer_t *body) {
+	buffer_printf(body, "{\"data\":[");
+
+	bool first = true;
+	for (int idx = 0; idx < request->params_count; idx++) {
+		query_param *param = &request->params[idx];
+		if (
+			strcmp(param->name, "user_login") != 0 &&
+			strcmp(param->name, "user_id") != 0
+		) {
+			continue;
+		}
+
+		unsigned long key = hash(param->value);
+		if (key % 3 != 0) {
+			continue;
+		}
+
+		if (!first) buffer_append(body, ",", 1);
+		write_stream(body, (int)(key % 1000000), request);
+		first = false;
+	}
+
+	buffer_printf(body, "],\"pagination\":{}}");
+}
+
+void write_games(mock_request *request, buffer_t *body) {
+	buffer_printf(body, "{\"data\":[");
+
+	bool first = true;
+	for (int idx = 0; idx < request->params_count; idx++) {
+		query_param *param = &request->params[idx];
+		int index = -1;
+		if (strcmp(param->name, "id") == 0) {
+			index = atoi(param->value) - 500000;
+		} else if (strcmp(param->name, "name") == 0) {
+			sscanf(param->value, "Game %d", &index);
+		}
+
+		if (index < 0 || index >= settings.items) {
+			continue;
+		}
+
+		if (!first) buffer_append(body, ",", 1);
+		write_game(body, index, request);
+		first = false;
+	}
+
+	buffer_printf(body, "]}");
+}
+
+void write_team(buffer_t *body, const char *name) {
+	buffer_printf(
+		body,
+		"{\"id\":\"%lu\",\"team_name\":\"%s\",\"team_display_name\":\"%s\","
+		"\"info\":\"Mock team\",\"thumbnail_url\":\"\",\"banner\":null,"
+		"\"background_image_url\":null,\"created_at\":\"2019-01-01T00:00:00Z\","
+		"\"updated_at\":\"2024-01-01T00:00:00Z\",\"users\":[",
+		hash(name) % 10000, name, name
+	);
+
+	for (int idx = 0; idx < 10; idx++) {
+		buffer_printf(
+			body,
+			"%s{\"user_id\":\"%d\",\"user_name\":\"Member%d\","
+			"\"user_login\":\"member%d\"}",
+			idx > 0 ? "," : "", 100000 + idx, idx, idx
+		);
+	}
+
+	buffer_printf(body, "]}");
+}
+
+/**
+ * Produces the response body for given request.
+ *
+ * @return HTTP status code.
+ */
+int route(mock_request *request, buffer_t *body) {
+	const char *path = request->path;
+
+	if (strcmp(request->method, "GET") != 0) {
+		buffer_printf(body, "{\"error\":\"Method Not Allowed\",\"status\":405}");
+		return 405;
+	}
+
+	if (strcmp(path, "/helix/users") == 0) {
+		write_users(request, body);
+	} else if (strcmp(path, "/helix/streams") == 0) {
+		if (get_param(request, "user_login") || get_param(request, "user_id")) {
+			write_user_streams(request, body);
+		} else {
+			write_page(request, body, &write_stream);
+		}
+	} else if (strcmp(path, "/helix/channels/followers") == 0) {
+		write_page(request, body, &write_follower);
+	} else if (strcmp(path, "/helix/channels/followed") == 0) {
+		write_page(request, body, &write_followed);
+	} else if (strcmp(path, "/helix/videos") == 0) {
+		write_page(request, body, &write_video);
+	} else if (strcmp(path, "/helix/games/top") == 0) {
+		write_page(request, body, &write_game);
+	} else if (strcmp(path, "/helix/games") == 0) {
+		write_games(request, body);
+	} else if (strcmp(path, "/helix/search/categories") == 0) {
+		write_page(request, body, &write_game);
+	} else if (strcmp(path, "/helix/search/channels") == 0) {
+		write_page(request, body, &write_channel);
+	} else if (
+		strcmp(path, "/helix/teams") == 0 ||
+		strcmp(path, "/helix/teams/channel") == 0
+	) {
+		const char *name = get_param(request, "name");
+		buffer_printf(body, "{\"data\":[");
+		write_team(body, name != NULL ? name : "mockteam");
+		buffer_printf(body, "]}");
+	} else {
+		buffer_printf(
+			body,
+			"{\"error\":\"Not Found\",\"status\":404,\"message\":\"\"}"
+		);
+		return 404;
+	}
+
+	return 200;
+}
+
+/** Connections **/
+
+typedef struct {
+	int fd;
+	buffer_t input;
+	buffer_t output;
+	size_t sent;
+	double respond_at;  // Time to start sending the output, or 0.
+	bool close;         // Close after the output is sent.
+} mock_connection;
+
+mock_connection connections[MAX_CONNECTIONS];
+int connections_count = 0;
+
+void connection_close(int idx) {
+	close(connections[idx].fd);
+	free(connections[idx].input.ptr);
+	free(connections[idx].output.ptr);
+	connections[idx] = connections[--connections_count];
+}
+
+const char *status_text(int status) {
+	switch (status) {
+		case 200: return "OK";
+		case 404: return "Not Found";
+		case 405: return "Method Not Allowed";
+		case 429: return "Too Many Requests";
+		case 503: return "Service Unavailable";
+		default: return "Error";
+	}
+}
+
+/**
+ * Handles the next complete request in connection's input, if there is one.
+ *
+ * @return true if a request was handled.
+ */
+bool connection_handle(mock_connection *connection) {
+	char *end = strstr(connection->input.ptr, "\r\n\r\n");
+	if (end == NULL) {
+		return false;
+	}
+
+	size_t length = end - connection->input.ptr + 4;
+	char *text = malloc(length + 1);
+	if (text == NULL) {
+		fprintf(stderr, "Failed to allocate memory for request.\n");
+		exit(EXIT_FAILURE);
+	}
+	memcpy(text, connection->input.ptr, length);
+	text[length] = '\0';
+	buffer_consume(&connection->input, length);
+
+	buffer_t headers = { 0 }, body = { 0 };
+	mock_request request;
+	int status = 400;
+
+	if (parse_request(text, &request)) {
+		connection->close = request.close;
+		bool unavailable = settings.fail_every > 0 &&
+			++requests_count % settings.fail_every == 0;
+		if (unavailable) {
+			status = 503;
+			buffer_printf(
+				&body,
+				"{\"error\":\"Service Unavailable\",\"status\":503,"
+				"\"message\":\"\"}"
+			);
+		} else if (take_point(request.client_id, &headers)) {
+			status = route(&request, &body);
+		} else {
+			status = 429;
+			buffer_printf(
+				&body,
+				"{\"error\":\"Too Many Requests\",\"status\":429,"
+				"\"message\":\"Rate limit exceeded\"}"
+			);
+		}
+	} else {
+		connection->close = true;
+	}
+
+	buffer_printf(
+		&connection->output,
+		"HTTP/1.1 %d %s\r\nContent-Type: application/json\r\n"
+		"Content-Length: %zu\r\n%s\r\n",
+		status, status_text(status), body.len,
+		headers.ptr != NULL ? headers.ptr : ""
+	);
+	if (body.len > 0) {
+		buffer_append(&connection->output, body.ptr, body.len);
+	}
+
+	free(text);
+	free(headers.ptr);
+	free(body.ptr);
+
+	// Delay the response.
+	double delay = settings.latency / 1000.0;
+	if (settings.jitter > 0) {
+		delay += ((double)rand() / RAND_MAX * 2 - 1) * settings.jitter / 1000.0;
+	}
+	connection->respond_at = now() + (delay > 0 ? delay : 0);
+
+	return true;
+}
+
+/** Server **/
+
+int open_listener(int port) {
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (fd < 0) {
+		perror("socket");
+		exit(EXIT_FAILURE);
+	}
+
+	int yes = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(port);
+
+	if (bind(fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
+		perror("bind");
+		exit(EXIT_FAILURE);
+	}
+
+	if (listen(fd, 128) < 0) {
+		perror("listen");
+		exit(EXIT_FAILURE);
+	}
+
+	// Port 0 gets a free one from the system.
+	socklen_t length = sizeof(address);
+	if (getsockname(fd, (struct sockaddr *)&address, &length) == 0) {
+		settings.port = ntohs(address.sin_port);
+	}
+
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	return fd;
+}
+
+void parse_settings(int argc, char **argv) {
+	for (int idx = 1; idx < argc; idx++) {
+		if (sscanf(argv[idx], "--port=%d", &settings.port) == 1) continue;
+		if (sscanf(argv[idx], "--items=%d", &settings.items) == 1) continue;
+		if (sscanf(argv[idx], "--latency=%ld", &settings.latency) == 1) continue;
+		if (sscanf(argv[idx], "--jitter=%ld", &settings.jitter) == 1) continue;
+		if (sscanf(argv[idx], "--rate-limit=%ld", &settings.rate_limit) == 1) {
+			continue;
+		}
+		if (sscanf(argv[idx], "--fail-every=%ld", &settings.fail_every) == 1) {
+			continue;
+		}
+
+		fprintf(stderr, "Unknown option: %s\n", argv[idx]);
+		exit(EXIT_FAILURE);
+	}
+}
+
+int main(int argc, char **argv) {
+	parse_settings(argc, argv);
+	signal(SIGPIPE, SIG_IGN);
+	srand(1);
+
+	int listener = open_listener(settings.port);
+	printf(
+		"Mock Helix API on http://127.0.0.1:%d, %d items per collection\n",
+		settings.port, settings.items
+	);
+	fflush(stdout);
+
+	struct pollfd fds[MAX_CONNECTIONS + 1];
+
+	while (true) {
+		// Wait for network activity or the next delayed response.
+		double current = now();
+		int timeout = -1;
+
+		fds[0].fd = listener;
+		fds[0].events = POLLIN;
+
+		for (int idx = 0; idx < connections_count; idx++) {
+			mock_connection *connection = &connections[idx];
+			fds[idx + 1].fd = connection->fd;
+			fds[idx + 1].events = POLLIN;
+
+			if (connection->output.len > connection->sent) {
+				if (connection->respond_at <= current) {
+					fds[idx + 1].events |= POLLOUT;
+				} else {
+					int wait = (int)((connection->respond_at - current) * 1000) + 1;
+					if (timeout < 0 || wait < timeout) {
+						timeout = wait;
+					}
+				}
+			}
+		}
+
+		if (poll(fds, connections_count + 1, timeout) < 0 && errno != EINTR) {
+			perror("poll");
+			return 1;
+		}
+
+		// Accept new connections.
+		if (fds[0].revents & POLLIN) {
+			int fd;
+			while ((fd = accept(listener, NULL, NULL)) >= 0) {
+				if (connections_count == MAX_CONNECTIONS) {
+					close(fd);
+					continue;
+				}
+
+				int yes = 1;
+				setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+				fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+				mock_connection *connection = &connections[connections_count++];
+				memset(connection, 0, sizeof(mock_connection));
+				connection->fd = fd;
+			}
+		}
+
+		// Serve existing ones. Walk backwards, so closing doesn't skip any.
+		int polled = connections_count;
+		current = now();
+		for (int idx = polled - 1; idx >= 0; idx--) {
+			if (idx >= connections_count) {
+				continue;
+			}
+
+			mock_connection *connection = &connections[idx];
+			short revents = fds[idx + 1].revents;
+			bool failed = false;
+
+			if (revents & (POLLIN | POLLHUP | POLLERR)) {
+				char chunk[16384];
+				ssize_t received = recv(connection->fd, chunk, sizeof(chunk), 0);
+				if (received > 0) {
+					buffer_append(&connection->input, chunk, received);
+				} else if (received == 0 || errno != EAGAIN) {
+					failed = true;
+				}
+			}
+
+			// Answer one request at a time, in order.
+			if (
+				!failed &&
+				connection->output.len == connection->sent &&
+				connection->input.len > 0
+			) {
+				connection->output.len = 0;
+				connection->sent = 0;
+				connection_handle(connection);
+
+				if (connection->input.len > MAX_REQUEST_SIZE) {
+					failed = true;
+				}
+			}
+
+			if (
+				!failed &&
+				connection->output.len > connection->sent &&
+				connection->respond_at <= current
+			) {
+				ssize_t sent = send(
+					connection->fd,
+					connection->output.ptr + connection->sent,
+					connection->output.len - connection->sent,
+					0
+				);
+				if (sent > 0) {
+					connection->sent += sent;
+				} else if (sent < 0 && errno != EAGAIN) {
+					failed = true;
+				}
+
+				if (connection->sent == connection->output.len && connection->close) {
+					failed = true;
+				}
+			}
+
+			if (failed) {
+				connection_close(idx);
+			}
+		}
+	}
+
+	return 0;
+}
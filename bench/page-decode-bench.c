@@ -0,0 +1,329 @@
+/**
+ * Compares materializing Helix pages from a parsed JSON tree with decoding
+ * them straight into entity structs from JSON tokens.
+ *
+ * Each payload is turned into a list of entities repeatedly both ways, and
+ * the benchmark prints CPU time per page of each, the speedup, and the size
+ * of the JSON tree the first way has to build. Both ways are checked to give
+ * the same number of items and the same cursor first, and a payload they
+ * disagree on is reported and skipped.
+ *
+ * Run with recorded response bodies of a given entity type, e.g. saved with
+ * `curl -o`:
+ *
+ *   page-decode-bench 1000 streams streams.json users users.json
+ *
+ * Types are users, streams, games, videos and search. Without files, it uses
+ * generated pages of 100 streams and 100 users.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "json/json.h"
+#include "utils/json/json_single.h"
+#include "utils/network/helix.h"
+#include "utils/parser/parser.h"
+#include "utils/parser/page_decoder.h"
+
+/** Helpers **/
+
+double cpu_seconds() {
+	struct timespec ts;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Reads the whole file into memory.
+ *
+ * @param path File path.
+ * @param size Returns file size.
+ *
+ * @return File contents, or NULL on error.
+ */
+char *read_file(const char *path, size_t *size) {
+	FILE *file = fopen(path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	char *data = malloc(length > 0 ? length : 1);
+	if (data == NULL || fread(data, 1, length, file) != (size_t)length) {
+		free(data);
+		fclose(file);
+		return NULL;
+	}
+
+	fclose(file);
+	*size = length;
+	return data;
+}
+
+/**
+ * Generates a page of 100 streams or 100 users that looks like a real Helix
+ * response.
+ *
+ * @param users Whether to generate users instead of streams.
+ * @param size Returns page size.
+ *
+ * @return Page text.
+ */
+char *generate_page(bool users, size_t *size) {
+	size_t capacity = 128 * 1024, length = 0;
+	char *data = malloc(capacity);
+	if (data == NULL) {
+		fprintf(stderr, "Failed to allocate memory for payload.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	length += sprintf(data + length, "{\"data\":[");
+	for (int idx = 0; idx < 100; idx++) {
+		if (users) {
+			length += sprintf(
+				data + length,
+				"%s{\"id\":\"%d\",\"login\":\"viewer%d\","
+				"\"display_name\":\"Viewer%d\",\"type\":\"\","
+				"\"broadcaster_type\":\"%s\",\"description\":\"Just a viewer "
+				"number %d, \\\"hi\\\" \\u2764\",\"profile_image_url\":"
+				"\"https://static-cdn.jtvnw.net/jtv_user_pictures/"
+				"viewer%d-profile_image-300x300.png\",\"offline_image_url\":"
+				"\"\",\"view_count\":%d,\"email\":\"viewer%d@example.com\","
+				"\"created_at\":\"2016-12-%02dT20:32:28Z\"}",
+				idx > 0 ? "," : "",
+				100000 + idx * 31, idx, idx,
+				idx % 3 == 0 ? "partner" : "affiliate", idx, idx,
+				idx * 1371, idx, 1 + idx % 28
+			);
+		} else {
+			length += sprintf(
+				data + length,
+				"%s{\"id\":\"%d\",\"user_id\":\"%d\","
+				"\"user_login\":\"streamer%d\",\"user_name\":\"Streamer%d\","
+				"\"game_id\":\"%d\",\"game_name\":\"Game %d\","
+				"\"type\":\"live\","
+				"\"title\":\"Stream number %d, come and say hi!\","
+				"\"viewer_count\":%d,"
+				"\"started_at\":\"2024-01-%02dT%02d:00:00Z\","
+				"\"language\":\"en\",\"thumbnail_url\":"
+				"\"https://static-cdn.jtvnw.net/previews-ttv/live_user_"
+				"streamer%d-{width}x{height}.jpg\",\"tag_ids\":[],"
+				"\"tags\":[\"English\"],\"is_mature\":false}",
+				idx > 0 ? "," : "",
+				40000000 + idx * 7919, 100000 + idx * 31, idx, idx,
+				500000 + idx % 13, idx % 13, idx, 10000 - idx * 97,
+				1 + idx % 28, idx % 24, idx
+			);
+		}
+	}
+	length += sprintf(
+		data + length,
+		"],\"pagination\":{\"cursor\":"
+		"\"eyJiIjp7IkN1cnNvciI6ImV5SnpJam8xTURBd01Dd2laQ0k2Wm1Gc2MyVjkifX0\"}}"
+	);
+
+	*size = length;
+	return data;
+}
+
+/**
+ * Finds the parser of given entity type.
+ *
+ * @param type Entity type name.
+ *
+ * @return Parser function, or NULL if the type is unknown.
+ */
+parser_func find_parser(const char *type) {
+	if (strcmp(type, "users") == 0) {
+		return parse_helix_user;
+	} else if (strcmp(type, "streams") == 0) {
+		return parse_helix_stream;
+	} else if (strcmp(type, "games") == 0) {
+		return parse_helix_game;
+	} else if (strcmp(type, "videos") == 0) {
+		return parse_helix_video;
+	} else if (strcmp(type, "search") == 0) {
+		return parse_helix_channel_search_item;
+	}
+
+	return NULL;
+}
+
+/**
+ * Frees a page of entities.
+ *
+ * @param schema Schema of page items.
+ * @param items Items to free.
+ * @param size Number of items.
+ * @param next Cursor to free.
+ */
+void free_page(
+	const entity_schema *schema,
+	void **items,
+	int size,
+	char *next
+) {
+	for (int idx = 0; idx < size; idx++) {
+		schema->free(items[idx]);
+	}
+	free(items);
+	free(next);
+}
+
+/** Allocators **/
+
+size_t tree_bytes = 0;
+
+void *counting_alloc(size_t size, int zero, void *user_data) {
+	tree_bytes += size;
+	return zero ? calloc(1, size) : malloc(size);
+}
+
+void counting_free(void *ptr, void *user_data) {
+	free(ptr);
+}
+
+/** Benchmark **/
+
+void run_bench(
+	const char *name,
+	parser_func parser,
+	const char *data,
+	size_t size,
+	int count
+) {
+	const entity_schema *schema = parser_schema(parser);
+	json_settings settings = { 0 };
+	settings.mem_alloc = &counting_alloc;
+	settings.mem_free = &counting_free;
+
+	// Both ways should give the same page.
+	tree_bytes = 0;
+	json_value *value = json_single_parse(NULL, &settings, data, size, NULL);
+	size_t bytes = tree_bytes;
+	int tree_size = 0, decoded_size = 0;
+	char *tree_next = NULL, *decoded_next = NULL;
+	void **tree_items = helix_parse_page(
+		value, parser, &tree_size, &tree_next, NULL
+	);
+	void **decoded_items = page_decode(
+		schema, data, size, &decoded_size, &decoded_next, NULL
+	);
+
+	bool same = value != NULL && tree_size == decoded_size && (
+		(tree_next == NULL && decoded_next == NULL) ||
+		(
+			tree_next != NULL && decoded_next != NULL &&
+			strcmp(tree_next, decoded_next) == 0
+		)
+	);
+
+	if (value != NULL) {
+		json_value_free_ex(&settings, value);
+	}
+	free_page(schema, tree_items, tree_size, tree_next);
+	free_page(schema, decoded_items, decoded_size, decoded_next);
+
+	if (!same) {
+		fprintf(stderr, "%s: pages differ, skipped\n", name);
+		return;
+	}
+
+	// Parsing into a tree, then materializing entities from it.
+	double start = cpu_seconds();
+	for (int idx = 0; idx < count; idx++) {
+		int items_size = 0;
+		char *next = NULL;
+		value = json_single_parse(NULL, NULL, data, size, NULL);
+		void **items = helix_parse_page(
+			value, parser, &items_size, &next, NULL
+		);
+		json_value_free(value);
+		free_page(schema, items, items_size, next);
+	}
+	double tree_seconds = (cpu_seconds() - start) / count;
+
+	// Decoding entities straight from tokens.
+	start = cpu_seconds();
+	for (int idx = 0; idx < count; idx++) {
+		int items_size = 0;
+		char *next = NULL;
+		void **items = page_decode(
+			schema, data, size, &items_size, &next, NULL
+		);
+		free_page(schema, items, items_size, next);
+	}
+	double decode_seconds = (cpu_seconds() - start) / count;
+
+	printf(
+		"%-20s %9zu %9d %9zu %9.1f us %9.1f us %8.2fx\n",
+		name,
+		size,
+		tree_size,
+		bytes,
+		tree_seconds * 1e6,
+		decode_seconds * 1e6,
+		decode_seconds > 0 ? tree_seconds / decode_seconds : 0
+	);
+}
+
+int main(int argc, char **argv) {
+	int count = (argc > 1) ? atoi(argv[1]) : 1000;
+	if (count <= 0 || (argc > 2 && argc % 2 != 0)) {
+		fprintf(
+			stderr,
+			"Usage: page-decode-bench [iterations] [type payload...]\n"
+		);
+		return 1;
+	}
+
+	printf(
+		"%-20s %9s %9s %9s %12s %12s %9s\n",
+		"payload", "size", "items", "tree B", "tree", "decode", "speedup"
+	);
+
+	if (argc <= 2) {
+		size_t size = 0;
+		char *page = generate_page(false, &size);
+		run_bench("streams (generated)", parse_helix_stream, page, size, count);
+		free(page);
+
+		page = generate_page(true, &size);
+		run_bench("users (generated)", parse_helix_user, page, size, count);
+		free(page);
+		return 0;
+	}
+
+	for (int idx = 2; idx + 1 < argc; idx += 2) {
+		parser_func parser = find_parser(argv[idx]);
+		if (parser == NULL) {
+			fprintf(stderr, "Unknown type %s\n", argv[idx]);
+			continue;
+		}
+
+		size_t size = 0;
+		char *data = read_file(argv[idx + 1], &size);
+		if (data == NULL || size == 0) {
+			fprintf(stderr, "Failed to read %s\n", argv[idx + 1]);
+			free(data);
+			continue;
+		}
+
+		const char *name = strrchr(argv[idx + 1], '/');
+		name = (name != NULL) ? name + 1 : argv[idx + 1];
+		run_bench(name, parser, data, size, count);
+		free(data);
+	}
+
+	return 0;
+}
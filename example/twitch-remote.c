@@ -20,6 +20,18 @@
  **/
 extern char *immutable_string_copy(const char *src);
 
+/**
+ * Client context shared by all commands, so consecutive requests can reuse the
+ * same connection.
+ */
+twitch_client *client = NULL;
+
+/**
+ * Optional on-disk store of user records, so repeated lookups of the same
+ * channels don't need an API request.
+ */
+twitch_helix_store *store = NULL;
+
 /** Helpers **/
 
 void print_error(twitch_error *error) {
@@ -36,9 +48,16 @@ void print_error(twitch_error *error) {
 		error->curl_code, error->http_code
 	);
 
-	if (error->output != NULL) {
+	const twitch_error_details *details = twitch_error_get_details(error);
+	if (details != NULL && details->message != NULL) {
+		fprintf(stderr, "  Message: %s\n", details->message);
+	} else if (error->output_length > 0) {
 		fprintf(stderr, "  Response: %s\n", error->output);
 	}
+
+	if (error->retry_after > 0) {
+		fprintf(stderr, "  Retry after: %ld s\n", error->retry_after);
+	}
 }
 
 /** Command-line data **/
@@ -104,6 +123,9 @@ void print_usage(int count, command_spec *commands) {
 	printf("	%-25s\t(REQUIRED) Registered Twitch API Client ID string.\n",
 		"--client-id=client_id\t"
 	);
+	printf("	%-25s\tFile to keep user records in between runs.\n",
+		"--store=path\t"
+	);
 }
 
 /**
@@ -122,16 +144,27 @@ char *get_param(
 	int options_count,
 	const char **options
 ) {
-	char sparam_name[16];
-	char sparam_value[32];
+	size_t name_length = strlen(param_name);
 
 	for (int idx = 0; idx < options_count; idx++) {
-		int parsed = sscanf(options[idx], "--%[^=]=%s", sparam_name, sparam_value);
-		if (parsed > 0 && strcmp(param_name, sparam_name) == 0) {
-			char *output = malloc(strlen(sparam_value));
-			strcpy(output, sparam_value);
-			return output;
+		const char *option = options[idx];
+		if (
+			strncmp(option, "--", 2) != 0 ||
+			strncmp(option + 2, param_name, name_length) != 0 ||
+			option[name_length + 2] != '='
+		) {
+			continue;
 		}
+
+		// Values like store paths can be of any length.
+		const char *value = option + name_length + 3;
+		char *output = malloc(strlen(value) + 1);
+		if (output == NULL) {
+			fprintf(stderr, "Failed to allocate memory for parameter.\n");
+			exit(EXIT_FAILURE);
+		}
+		strcpy(output, value);
+		return output;
 	}
 
 	return NULL;
@@ -251,9 +284,11 @@ char *get_bearer_token(int options_count, const char **options) {
  */
 char *find_user_id(char *client_id, char *bearer, const char *query) {
 	const char *usernames[1] = { query };
-	twitch_error error = { 0, 0, 0 };
+	twitch_error error = { 0 };
 
-	twitch_helix_user_list *users = twitch_helix_get_users(
+	twitch_helix_user_list *users = twitch_helix_store_get_users(
+		store,
+		client,
 		client_id,
 		bearer,
 		&error,
@@ -263,17 +298,20 @@ char *find_user_id(char *client_id, char *bearer, const char *query) {
 
 	if (error.curl_code != CURLE_OK) {
 		print_error(&error);
+		twitch_error_clear(&error);
 		return NULL;
 	}
 
 	if (users == NULL) {
 		fprintf(stderr, "Error: failed to get user info\n");
+		twitch_error_clear(&error);
 		return NULL;
 	}
 
 	if (users->count == 0) {
 		fprintf(stderr, "Error: user not found\n");
 		twitch_helix_user_list_free(users);
+		twitch_error_clear(&error);
 		return NULL;
 	}
 
@@ -284,6 +322,7 @@ char *find_user_id(char *client_id, char *bearer, const char *query) {
 	strcpy(channel_id, user->id);
 
 	twitch_helix_user_list_free(users);
+	twitch_error_clear(&error);
 	return channel_id;
 }
 
@@ -295,11 +334,12 @@ char *find_user_id(char *client_id, char *bearer, const char *query) {
  * @param options List of command line arguments.
  */
 void get_games(const char *name, int options_count, const char **options) {
-	twitch_error error = { 0, 0, 0 };
+	twitch_error error = { 0 };
 	char *client_id = get_client_id(options_count, options);
 	char *bearer = get_bearer_token(options_count, options);
 
 	twitch_helix_category_list *games = twitch_helix_get_all_categories(
+		client,
 		client_id,
 		bearer,
 		&error,
@@ -310,6 +350,7 @@ void get_games(const char *name, int options_count, const char **options) {
 	if (error.curl_code != CURLE_OK) {
 		print_error(&error);
 		free(client_id); free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
@@ -328,6 +369,7 @@ void get_games(const char *name, int options_count, const char **options) {
 
 	free(client_id);
 	free(bearer);
+	twitch_error_clear(&error);
 }
 
 /**
@@ -338,12 +380,13 @@ void get_games(const char *name, int options_count, const char **options) {
  * @param options List of command line arguments.
  */
 void get_streams(const char *query, int options_count, const char **options) {
-	twitch_error error = { 0, 0, 0 };
+	twitch_error error = { 0 };
 	char *client_id = get_client_id(options_count, options);
 	char *bearer = get_bearer_token(options_count, options);
 
 	twitch_helix_channel_search_item_list *streams =
 		twitch_helix_search_all_channels(
+		client,
 		client_id,
 		bearer,
 		&error,
@@ -355,6 +398,7 @@ void get_streams(const char *query, int options_count, const char **options) {
 	if (error.curl_code != CURLE_OK) {
 		print_error(&error);
 		free(client_id); free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
@@ -389,6 +433,7 @@ void get_streams(const char *query, int options_count, const char **options) {
 
 	free(client_id);
 	free(bearer);
+	twitch_error_clear(&error);
 }
 
 /**
@@ -399,7 +444,7 @@ void get_streams(const char *query, int options_count, const char **options) {
  * @param options List of command line arguments.
  */
 void get_top_games(const char *query, int options_count, const char **options) {
-	twitch_error error = { 0, 0, 0 };
+	twitch_error error = { 0 };
 	char *client_id = get_client_id(options_count, options);
 	char *bearer = get_bearer_token(options_count, options);
 
@@ -415,11 +460,13 @@ void get_top_games(const char *query, int options_count, const char **options) {
 	if (error.curl_code != CURLE_OK) {
 		print_error(&error);
 		free(client_id); free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
 	int size = 0, total = 0;
 	twitch_helix_game_list *games = twitch_helix_get_all_top_games(
+		client,
 		client_id,
 		bearer,
 		&error,
@@ -443,6 +490,7 @@ void get_top_games(const char *query, int options_count, const char **options) {
 
 	free(client_id);
 	free(bearer);
+	twitch_error_clear(&error);
 }
 
 /**
@@ -457,12 +505,13 @@ void get_channel_followers(
 	int options_count,
 	const char **options
 ) {
-	twitch_error error = { 0, 0, 0 };
+	twitch_error error = { 0 };
 	char *client_id = get_client_id(options_count, options);
 	char *bearer = get_user_token(options_count, options, 1);
 	const char *usernames[1] = { query };
 
 	twitch_helix_user_list *users = twitch_helix_get_users(
+		client,
 		client_id,
 		bearer,
 		&error,
@@ -473,12 +522,14 @@ void get_channel_followers(
 	if (error.curl_code != CURLE_OK) {
 		print_error(&error);
 		free(client_id); free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
 	if (users == NULL) {
 		fprintf(stderr, "Error: failed to get user info\n");
 		free(client_id); free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
@@ -486,12 +537,14 @@ void get_channel_followers(
 		fprintf(stderr, "Error: user not found\n");
 		twitch_helix_user_list_free(users);
 		free(client_id); free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
 	twitch_helix_user *user = users->items[0];
 
 	twitch_helix_follower_list *followers = twitch_helix_get_all_channel_followers(
+		client,
 		client_id,
 		bearer,
 		&error,
@@ -515,6 +568,7 @@ void get_channel_followers(
 	free(client_id);
 	free(bearer);
 	twitch_helix_user_list_free(users);
+	twitch_error_clear(&error);
 }
 
 /**
@@ -529,13 +583,14 @@ void get_channel_teams(
 	int options_count,
 	const char **options
 ) {
-	twitch_error error = { 0, 0, 0 };
+	twitch_error error = { 0 };
 	char *client_id = get_client_id(options_count, options);
 	char *bearer = get_bearer_token(options_count, options);
 
 	const char *usernames[1] = { query };
 
 	twitch_helix_user_list *users = twitch_helix_get_users(
+		client,
 		client_id,
 		bearer,
 		&error,
@@ -546,6 +601,7 @@ void get_channel_teams(
 	if (error.curl_code != CURLE_OK) {
 		print_error(&error);
 		free(client_id); free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
@@ -553,6 +609,7 @@ void get_channel_teams(
 		fprintf(stderr, "Error: failed to get user info\n");
 		free(client_id);
 		free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
@@ -561,12 +618,14 @@ void get_channel_teams(
 		twitch_helix_user_list_free(users);
 		free(client_id);
 		free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
 	twitch_helix_user *user = users->items[0];
 
 	twitch_helix_team_list *teams = twitch_helix_get_channel_teams(
+		client,
 		client_id,
 		bearer,
 		&error,
@@ -576,6 +635,7 @@ void get_channel_teams(
 	if (error.curl_code != CURLE_OK) {
 		print_error(&error);
 		free(client_id); free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
@@ -591,6 +651,7 @@ void get_channel_teams(
 	free(client_id);
 	free(bearer);
 	twitch_helix_user_list_free(users);
+	twitch_error_clear(&error);
 }
 
 /**
@@ -605,7 +666,7 @@ void get_channel_videos(
 	int options_count,
 	const char **options
 ) {
-	twitch_error error = { 0, 0, 0 };
+	twitch_error error = { 0 };
 	char *client_id = get_client_id(options_count, options);
 	char *bearer = get_bearer_token(options_count, options);
 	char *channel_id = find_user_id(client_id, bearer, query);
@@ -613,16 +674,19 @@ void get_channel_videos(
 	if (error.curl_code != CURLE_OK) {
 		print_error(&error);
 		free(client_id); free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
 	if (channel_id == NULL) {
 		printf("Channel '%s' not found\n", query);
 		free(client_id); free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
 	twitch_helix_video_list *videos = twitch_helix_get_all_videos(
+		client,
 		client_id,
 		bearer,
 		&error,
@@ -640,6 +704,7 @@ void get_channel_videos(
 	if (error.curl_code != CURLE_OK) {
 		print_error(&error);
 		free(client_id); free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
@@ -675,6 +740,7 @@ void get_channel_videos(
 	free(client_id);
 	free(bearer);
 	free(channel_id);
+	twitch_error_clear(&error);
 }
 
 /**
@@ -685,11 +751,12 @@ void get_channel_videos(
  * @param options List of command line arguments.
  */
 void get_team(const char *query, int options_count, const char **options) {
-	twitch_error error = { 0, 0, 0 };
+	twitch_error error = { 0 };
 	char *client_id = get_client_id(options_count, options);
 	char *bearer = get_bearer_token(options_count, options);
 
 	twitch_helix_team *team = twitch_helix_get_team(
+		client,
 		client_id,
 		bearer,
 		&error,
@@ -700,6 +767,7 @@ void get_team(const char *query, int options_count, const char **options) {
 	if (error.curl_code != CURLE_OK) {
 		print_error(&error);
 		free(client_id); free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
@@ -725,6 +793,7 @@ void get_team(const char *query, int options_count, const char **options) {
 
 	free(client_id);
 	free(bearer);
+	twitch_error_clear(&error);
 }
 
 /**
@@ -769,13 +838,14 @@ void get_user(
 	int options_count,
 	const char **options
 ) {
-	twitch_error error = { 0, 0, 0 };
+	twitch_error error = { 0 };
 	char *client_id = get_client_id(options_count, options);
 	char *bearer = get_bearer_token(options_count, options);
 
 	const char *usernames[1] = { username };
 
 	twitch_helix_user_list *users = twitch_helix_get_users(
+		client,
 		client_id,
 		bearer,
 		&error,
@@ -786,6 +856,7 @@ void get_user(
 	if (error.curl_code != CURLE_OK) {
 		print_error(&error);
 		free(client_id); free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
@@ -814,6 +885,7 @@ void get_user(
 
 	free(client_id);
 	free(bearer);
+	twitch_error_clear(&error);
 }
 
 /**
@@ -828,12 +900,13 @@ void get_channel_follows(
 	int options_count,
 	const char **options
 ) {
-	twitch_error error = { 0, 0, 0 };
+	twitch_error error = { 0 };
 	char *client_id = get_client_id(options_count, options);
 	char *bearer = get_user_token(options_count, options, 1);
 	const char *usernames[1] = { username };
 
 	twitch_helix_user_list *users = twitch_helix_get_users(
+		client,
 		client_id,
 		bearer,
 		&error,
@@ -845,6 +918,7 @@ void get_channel_follows(
 		print_error(&error);
 		free(client_id);
 		free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
@@ -855,6 +929,7 @@ void get_channel_follows(
 	twitch_helix_user *user = users->items[0];
 	twitch_helix_channel_follow_list *follows =
 		twitch_helix_get_all_channel_follows(
+			client,
 			client_id,
 			bearer,
 			&error,
@@ -867,6 +942,7 @@ void get_channel_follows(
 		twitch_helix_user_list_free(users);
 		free(client_id);
 		free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
@@ -886,6 +962,7 @@ void get_channel_follows(
 	twitch_helix_user_list_free(users);
 	free(client_id);
 	free(bearer);
+	twitch_error_clear(&error);
 }
 
 /**
@@ -900,12 +977,13 @@ void get_live_channel_follows(
 	int options_count,
 	const char **options
 ) {
-	twitch_error error = { 0, 0, 0 };
+	twitch_error error = { 0 };
 	char *client_id = get_client_id(options_count, options);
 	char *bearer = get_user_token(options_count, options, 1);
 	const char *usernames[1] = { username };
 
 	twitch_helix_user_list *users = twitch_helix_get_users(
+		client,
 		client_id,
 		bearer,
 		&error,
@@ -916,6 +994,7 @@ void get_live_channel_follows(
 	if (error.curl_code != CURLE_OK) {
 		print_error(&error);
 		free(client_id); free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
@@ -924,6 +1003,7 @@ void get_live_channel_follows(
 		twitch_helix_user_list_free(users);
 		free(client_id);
 		free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
@@ -931,6 +1011,7 @@ void get_live_channel_follows(
 
 	twitch_helix_channel_follow_list *follows =
 		twitch_helix_get_all_channel_follows(
+			client,
 			client_id,
 			bearer,
 			&error,
@@ -942,6 +1023,7 @@ void get_live_channel_follows(
 		fprintf(stderr, "Error getting follows for %s\n", username);
 		print_error(&error);
 		free(client_id); free(bearer); twitch_helix_user_list_free(users);
+		twitch_error_clear(&error);
 		return;
 	}
 
@@ -951,6 +1033,7 @@ void get_live_channel_follows(
 		twitch_helix_channel_follow_list_free(follows);
 		free(client_id);
 		free(bearer);
+		twitch_error_clear(&error);
 		return;
 	}
 
@@ -960,6 +1043,7 @@ void get_live_channel_follows(
 	}
 
 	twitch_helix_stream_list *streams = twitch_helix_get_all_streams(
+		client,
 		client_id,
 		bearer,
 		&error,
@@ -982,6 +1066,7 @@ void get_live_channel_follows(
 			print_error(&error);
 		}
 
+		twitch_error_clear(&error);
 		return;
 	} else {
 		for (int idx = 0; idx < streams->count; idx++) {
@@ -1001,6 +1086,7 @@ void get_live_channel_follows(
 	twitch_helix_channel_follow_list_free(follows);
 	free(client_id);
 	free(bearer);
+	twitch_error_clear(&error);
 }
 
 /** Main **/
@@ -1101,6 +1187,14 @@ int main(int argc, char **argv) {
 			if (command.handler != NULL) {
 				// Don't forget to initialize the library!
 				twitch_helix_init();
+				client = twitch_client_alloc();
+
+				// Open user records store, if it's requested.
+				for (int arg_idx = 2; arg_idx < argc; arg_idx++) {
+					if (strncmp(argv[arg_idx], "--store=", 8) == 0) {
+						store = twitch_helix_store_open(argv[arg_idx] + 8);
+					}
+				}
 
 				// Handle the command. We currently only support one additional
 				// argument/param.
@@ -1109,6 +1203,13 @@ int main(int argc, char **argv) {
 				} else {
 					command.handler(NULL, argc - 2, (const char **)(&argv[2]));
 				}
+
+				if (store != NULL) {
+					twitch_helix_store_save(store);
+					twitch_helix_store_close(store);
+				}
+
+				twitch_client_free(client);
 				return 0;
 			}
 		}
@@ -0,0 +1,267 @@
+/**
+ * Twitch API: Client context.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * A client holds network state that can be reused between requests: an easy
+ * handle and a cURL share object with DNS cache, TLS sessions and connection
+ * cache. Passing the same client to consecutive API calls lets them skip DNS
+ * lookup, TCP connect and TLS handshake whenever the server keeps the
+ * connection alive.
+ *
+ * Every Helix API method accepts a client as its first parameter. Passing NULL
+ * is allowed, in which case the request is performed with a one-off handle,
+ * just like before.
+ *
+ * Client is not thread-safe. Use one client per thread.
+ */
+
+#ifndef _H_TWITCH_CLIENT
+#define _H_TWITCH_CLIENT
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Client **/
+
+typedef struct twitch_client twitch_client;
+
+/**
+ * Rate limit budget of a client ID, as last reported by Helix API and
+ * refilled locally since then.
+ */
+typedef struct {
+	long limit;      // Bucket size, in points.
+	long remaining;  // Points left.
+	long reset;      // Unix time when the bucket is full again, or 0 if it is.
+} twitch_rate_limit;
+
+/**
+ * Response cache counters.
+ */
+typedef struct {
+	unsigned long hits;         // Requests served from the cache.
+	unsigned long misses;       // Cacheable requests that went to the network.
+	unsigned long evictions;    // Entries dropped to stay within the size cap.
+	unsigned long expirations;  // Entries dropped because their TTL ran out.
+	unsigned long entries;      // Number of cached responses.
+	size_t bytes;               // Estimated size of cached responses.
+	size_t max_bytes;           // Size cap.
+} twitch_cache_stats;
+
+/**
+ * Transfer size counters. Wire bytes are response bodies as received, before
+ * decompression, and decoded bytes are the same bodies after it, so the
+ * difference is the bandwidth saved by compression.
+ */
+typedef struct {
+	unsigned long requests;            // Number of finished requests.
+	unsigned long long wire_bytes;     // Body bytes received over the network.
+	unsigned long long decoded_bytes;  // Body bytes after decompression.
+	unsigned long last_wire_bytes;     // Wire bytes of the last request.
+	unsigned long last_decoded_bytes;  // Decoded bytes of the last request.
+} twitch_transfer_stats;
+
+/**
+ * Retry policy for failed requests. Delay before retry N is
+ * min(max_delay, base_delay * 2^(N-1)), of which a random part, set by
+ * jitter, is dropped, so many clients failing at once don't retry in sync.
+ */
+typedef struct {
+	int max_attempts;     // Total number of attempts, 1 disables retries.
+	long base_delay;      // Delay before the first retry, in milliseconds.
+	long max_delay;       // Delay cap, in milliseconds.
+	double jitter;        // Random share of the delay, from 0 to 1.
+	int statuses_count;   // Number of retryable HTTP status codes.
+	const long *statuses; // Retryable HTTP status codes.
+} twitch_retry_policy;
+
+/**
+ * Allocates and initializes new client context.
+ *
+ * @return Pointer to new client. Deallocate with twitch_client_free().
+ */
+twitch_client *twitch_client_alloc();
+
+/**
+ * Closes all connections held by the client and frees its memory.
+ *
+ * @param client Client to deallocate.
+ */
+void twitch_client_free(twitch_client *client);
+
+/**
+ * Overrides the base URL of Helix API for all requests made with given
+ * client. Useful for pointing the library to a local proxy or a mock server.
+ *
+ * @param client Client to configure.
+ * @param url Base URL without trailing slash, e.g. "https://localhost:8443".
+ * Pass NULL to restore the default "https://api.twitch.tv".
+ */
+void twitch_client_set_api_url(twitch_client *client, const char *url);
+
+/**
+ * Overrides the base URL of Twitch authentication server, which client's
+ * managed credentials get their tokens from.
+ *
+ * @param client Client to configure.
+ * @param url Base URL without trailing slash, e.g. "http://localhost:8080".
+ * Pass NULL to restore the default "https://id.twitch.tv".
+ */
+void twitch_client_set_auth_url(twitch_client *client, const char *url);
+
+/**
+ * Sets the path to a CA certificates bundle to verify server certificates
+ * with, instead of the system default.
+ *
+ * @param client Client to configure.
+ * @param path Path to PEM file with CA certificates, or NULL to use defaults.
+ */
+void twitch_client_set_ca_info(twitch_client *client, const char *path);
+
+/**
+ * Enables or disables pipelined pagination. When enabled, methods that fetch
+ * all pages of a collection start downloading the next page as soon as its
+ * cursor is seen in the raw response, and parse the current page while the
+ * next one is in flight. Results are the same as without pipelining, but
+ * latency of a multi-page crawl drops to roughly max(RTT, parse time) per
+ * page instead of their sum.
+ *
+ * When the crawl ends, at most one extra page may have been requested and
+ * discarded. Disabled by default.
+ *
+ * @param client Client to configure.
+ * @param enabled Whether to pipeline page requests.
+ */
+void twitch_client_set_pipelining(twitch_client *client, bool enabled);
+
+/**
+ * Enables or disables rate limit scheduling. When enabled, the client tracks
+ * Ratelimit-* headers of Helix responses for each client ID, delays requests
+ * while the budget is exhausted instead of sending them, and retries requests
+ * rejected with 429 Too Many Requests after the bucket is refilled. Enabled by
+ * default.
+ *
+ * @param client Client to configure.
+ * @param enabled Whether to schedule requests according to rate limits.
+ */
+void twitch_client_set_rate_limiting(twitch_client *client, bool enabled);
+
+/**
+ * Returns the current rate limit budget of given client ID. Useful for slowing
+ * down a bulk crawl before the budget runs out.
+ *
+ * @param client Client to query.
+ * @param client_id Twitch API client ID.
+ * @param rate_limit Returns the budget.
+ *
+ * @return true if the budget is known, i.e. at least one request with given
+ * client ID was made with the client.
+ */
+bool twitch_client_get_rate_limit(
+	twitch_client *client,
+	const char *client_id,
+	twitch_rate_limit *rate_limit
+);
+
+/**
+ * Enables or reconfigures the response cache. When enabled, parsed responses
+ * of Helix GET requests are kept in memory, keyed by request URL, client ID
+ * and token, and repeated requests are served from memory without network
+ * round trip or JSON parsing. When the total size of cached responses exceeds
+ * the cap, the least recently used ones are evicted.
+ *
+ * @param client Client to configure.
+ * @param max_bytes Cache size cap, in bytes. Pass 0 to disable the cache and
+ * drop all cached responses.
+ * @param ttl Default time to live of cached responses, in seconds. Pass 0 to
+ * cache only endpoints with TTL set by twitch_client_set_cache_ttl().
+ */
+void twitch_client_set_cache(twitch_client *client, size_t max_bytes, int ttl);
+
+/**
+ * Sets time to live of cached responses of given endpoint, overriding the
+ * default one. Useful to keep rarely changing data, like users or games,
+ * longer than live data, like streams. Takes effect only while the cache is
+ * enabled.
+ *
+ * @param client Client to configure.
+ * @param endpoint Endpoint path, like "/helix/users". Matches the endpoint and
+ * all paths under it.
+ * @param ttl Time to live in seconds. Pass 0 to never cache the endpoint.
+ */
+void twitch_client_set_cache_ttl(
+	twitch_client *client,
+	const char *endpoint,
+	int ttl
+);
+
+/**
+ * Returns response cache counters.
+ *
+ * @param client Client to query.
+ * @param stats Returns the counters. All zeroes if the cache is disabled.
+ */
+void twitch_client_get_cache_stats(
+	twitch_client *client,
+	twitch_cache_stats *stats
+);
+
+/**
+ * Sets how requests are retried after transient failures: connection errors,
+ * timeouts, and HTTP status codes from the policy's list. Each page of a
+ * multi-page crawl is retried on its own, so the crawl continues from the
+ * last good cursor instead of failing as a whole. Requests rejected with 429
+ * are retried by the rate limit scheduler regardless of the policy.
+ *
+ * By default requests are made in up to 3 attempts, 100 ms apart at first,
+ * with full jitter, on 500, 502, 503 and 504 responses.
+ *
+ * @param client Client to configure.
+ * @param policy Retry policy. The client keeps its own copy. Pass NULL to
+ * restore the default policy.
+ */
+void twitch_client_set_retry_policy(
+	twitch_client *client,
+	const twitch_retry_policy *policy
+);
+
+/**
+ * Enables or disables hedged requests. When enabled, if a single request
+ * doesn't get a response within given delay, the client sends a duplicate,
+ * and the first successful response wins while the other one is canceled.
+ * This trims tail latency of interactive lookups at the cost of a few extra
+ * requests. Requests made in parallel, like batches, sharded queries and
+ * pipelined crawls, are not hedged. Disabled by default.
+ *
+ * @param client Client to configure.
+ * @param enabled Whether to hedge requests.
+ * @param delay Delay before the duplicate is sent, in milliseconds. Pass 0 to
+ * use the 95th percentile of recent response times measured by the client.
+ */
+void twitch_client_set_hedging(twitch_client *client, bool enabled, long delay);
+
+/**
+ * Enables or disables compressed responses. When enabled, requests advertise
+ * all encodings supported by cURL, like gzip, deflate and brotli, in the
+ * Accept-Encoding header, and responses are decompressed transparently. Large
+ * pages of JSON shrink several times on the wire. Enabled by default.
+ *
+ * @param client Client to configure.
+ * @param enabled Whether to accept compressed responses.
+ */
+void twitch_client_set_compression(twitch_client *client, bool enabled);
+
+/**
+ * Returns response size counters of all requests made with the client.
+ *
+ * @param client Client to query.
+ * @param stats Returns the counters.
+ */
+void twitch_client_get_transfer_stats(
+	twitch_client *client,
+	twitch_transfer_stats *stats
+);
+
+#endif
@@ -8,6 +8,8 @@
 #ifndef _H_TWITCH_COMMON
 #define _H_TWITCH_COMMON
 
+#include <stddef.h>
+
 /** String list **/
 
 typedef struct {
@@ -31,11 +33,61 @@ void twitch_string_list_free(twitch_string_list *list);
 
 /** Errors **/
 
+/**
+ * Error details Twitch API returns in the body of a failed response.
+ */
+typedef struct {
+	char *error;    // Short error name, like "Unauthorized".
+	long status;    // HTTP status code repeated in the body.
+	char *message;  // Error description. Can be empty.
+} twitch_error_details;
+
+/**
+ * Error info of a request.
+ *
+ * The struct owns its response body buffer, and reuses it for the following
+ * requests made with the same struct, so repeated failures don't allocate
+ * anything. Release it with twitch_error_clear() when the struct is no longer
+ * needed. A zero-initialized struct is a valid empty one.
+ */
 typedef struct {
 	long curl_code; // curl result code.
 	long http_code; // HTTP response code.
-	char *output;   // Response body, if any was returned. Currently not used.
+	char *output;   // Response body of a failed request. NULL or empty if none.
+	size_t output_length;    // Length of the response body.
+	size_t output_capacity;  // Size of the body buffer.
+	long retry_after;        // Retry-After header in seconds, or 0.
+	long ratelimit_limit;    // Ratelimit-Limit header, or 0 if not present.
+	long ratelimit_remaining;  // Ratelimit-Remaining header, or 0.
+	long ratelimit_reset;    // Ratelimit-Reset header, or 0 if not present.
+	twitch_error_details *details;  // See twitch_error_get_details().
 } twitch_error;
 
+/**
+ * Returns error details from the response body of a failed request. The body
+ * is parsed on the first call only.
+ *
+ * @param error Error to get details of.
+ *
+ * @return Error details, or NULL if the request didn't fail with HTTP error or
+ * its response didn't have them. Owned by the error struct, and valid until
+ * it's used for another request.
+ */
+const twitch_error_details *twitch_error_get_details(twitch_error *error);
+
+/**
+ * Releases memory held by the error struct and resets it.
+ *
+ * @param error Error struct to clear. Can be NULL.
+ */
+void twitch_error_clear(twitch_error *error);
+
+/**
+ * Frees error details struct and its properties.
+ *
+ * @param details Struct to deallocate.
+ */
+void twitch_error_details_free(twitch_error_details *details);
+
 #endif
 
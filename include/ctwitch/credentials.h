@@ -0,0 +1,118 @@
+/**
+ * Twitch API: Managed credentials.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * Instead of passing client ID and access token to every request, a client
+ * can be given the app credentials and keep the token itself. Requests made
+ * with NULL token then use client's credentials, and the client ID passed
+ * along with it is ignored.
+ *
+ * With app credentials, the client obtains an app access token on the first
+ * request. With user credentials, it takes a user access token and refreshes
+ * it with its refresh token. Either way the token is replaced once most of
+ * its lifetime has passed, before it expires, so requests don't fail with 401
+ * and wait for a refresh. If a token gets rejected anyway, e.g. because it was
+ * revoked, it is replaced, and the request is repeated once. Requests that
+ * got rejected with the same token share one refresh, and requests waiting
+ * in a queue pick up the new token when they are sent.
+ *
+ * Helix rate limits apply per client ID, so a client can be given a pool of
+ * several app credentials to spread the load over. Every request is sent with
+ * the credentials that have the most rate limit budget left, and if it gets
+ * rejected with 429 anyway, it is repeated with the next best ones.
+ *
+ * The library doesn't start threads, so tokens are refreshed by requests
+ * made with the client. A client that stays idle for long periods can keep
+ * its token fresh by calling twitch_client_refresh_credentials() after
+ * twitch_client_get_credentials_refresh_delay() seconds.
+ */
+
+#ifndef _H_TWITCH_CREDENTIALS
+#define _H_TWITCH_CREDENTIALS
+
+#include <stdbool.h>
+
+#include <ctwitch/client.h>
+#include <ctwitch/auth.h>
+
+/**
+ * Makes the client manage an app access token for given app, replacing all
+ * credentials it had. The token is obtained on the first request that needs
+ * it.
+ *
+ * @param client Client to configure.
+ * @param client_id Client ID string, or NULL to drop client's credentials.
+ * @param client_secret Client secret string.
+ */
+void twitch_client_set_app_credentials(
+	twitch_client *client,
+	const char *client_id,
+	const char *client_secret
+);
+
+/**
+ * Adds app credentials to client's pool. The token is obtained on the first
+ * request that gets to use them.
+ *
+ * @param client Client to configure.
+ * @param client_id Client ID string.
+ * @param client_secret Client secret string.
+ */
+void twitch_client_add_app_credentials(
+	twitch_client *client,
+	const char *client_id,
+	const char *client_secret
+);
+
+/**
+ * Makes the client manage given user access token, refreshing it with its
+ * refresh token. Replaces all credentials the client had.
+ *
+ * @param client Client to configure.
+ * @param client_id Client ID string the token was issued to.
+ * @param client_secret Client secret string.
+ * @param token User access token, obtained with
+ * twitch_get_user_access_token() just now. The client copies it.
+ */
+void twitch_client_set_user_credentials(
+	twitch_client *client,
+	const char *client_id,
+	const char *client_secret,
+	const twitch_user_access_token *token
+);
+
+/**
+ * Returns the access token client's next request would be made with,
+ * obtaining or refreshing it first if needed.
+ *
+ * @param client Client to query.
+ *
+ * @return Access token, or NULL if the client has no credentials or couldn't
+ * get a token. The string is owned by the client and stays valid until the
+ * next request.
+ */
+const char *twitch_client_get_access_token(twitch_client *client);
+
+/**
+ * Replaces client's access tokens with new ones right away.
+ *
+ * @param client Client to refresh.
+ *
+ * @return true if all new tokens were obtained. Credentials that failed to
+ * get one keep their current token.
+ */
+bool twitch_client_refresh_credentials(twitch_client *client);
+
+/**
+ * Returns time left until the client will refresh one of its tokens.
+ *
+ * @param client Client to query.
+ *
+ * @return Delay in seconds, 0 if the token is due for refresh, or -1 if the
+ * client has no credentials or its token doesn't expire.
+ */
+long twitch_client_get_credentials_refresh_delay(twitch_client *client);
+
+#endif
@@ -10,7 +10,16 @@
 
 #include <ctwitch/common.h>
 #include <ctwitch/auth.h>
+#include <ctwitch/credentials.h>
+#include <ctwitch/client.h>
+#include <ctwitch/transport.h>
+#include <ctwitch/stats.h>
+#include <ctwitch/metrics.h>
+#include <ctwitch/trace.h>
 #include <ctwitch/helix/data.h>
+#include <ctwitch/helix/batch.h>
+#include <ctwitch/helix/iter.h>
+#include <ctwitch/helix/store.h>
 #include <ctwitch/helix/users.h>
 #include <ctwitch/helix/streams.h>
 #include <ctwitch/helix/games.h>
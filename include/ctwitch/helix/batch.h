@@ -0,0 +1,103 @@
+/**
+ * Twitch Helix API - Batches
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * A batch collects any number of Helix requests and performs them all at once,
+ * in parallel, on the calling thread. Results are delivered to per-request
+ * callbacks as soon as each request finishes, so a set of independent queries
+ * takes about as long as the slowest one of them instead of their sum.
+ *
+ * Requests are added with twitch_helix_batch_get_*() functions declared next to
+ * their blocking counterparts, and performed with twitch_helix_batch_perform().
+ * Callbacks may add more requests to the same batch, e.g. to fetch the next
+ * page, and perform call won't return until they are finished too.
+ *
+ * Requests for the same URL that are in flight at the same time are sent only
+ * once. Each of their callbacks gets its own result list, made from the one
+ * response, so callers don't need to know about each other.
+ *
+ * Single users and games can be looked up by key with
+ * twitch_helix_batch_load_*() functions. Such lookups don't go out one by
+ * one: they are collected until the batch is performed, or until there are
+ * 100 of them, and sent as one request with all their keys. Results are then
+ * handed back to each lookup's callback. Lookups added by callbacks while the
+ * batch is running are collected the same way until the next round of
+ * transfers.
+ */
+
+#ifndef _H_TWITCH_HELIX_BATCH
+#define _H_TWITCH_HELIX_BATCH
+
+#include <ctwitch/common.h>
+#include <ctwitch/client.h>
+
+typedef struct twitch_helix_batch twitch_helix_batch;
+
+/**
+ * Batch request completion callback.
+ *
+ * @param error Error info of the request. Only valid during the call.
+ * @param list Result list, like twitch_helix_user_list for users request. The
+ * callee owns it and has to free it with the corresponding free function.
+ * Never NULL, but can be empty in case of an error.
+ * @param next Cursor string to fetch the next page with, or NULL. Only valid
+ * during the call.
+ * @param user_data User data passed along with the request.
+ */
+typedef void (*twitch_helix_batch_callback)(
+	twitch_error *error,
+	void *list,
+	const char *next,
+	void *user_data
+);
+
+/**
+ * Batch lookup completion callback.
+ *
+ * @param error Error info of the request. Only valid during the call.
+ * @param item Found entity, like twitch_helix_user for user lookup, or NULL
+ * if there is no entity with given key or the request failed. The callee owns
+ * it and has to free it with the corresponding free function.
+ * @param user_data User data passed along with the lookup.
+ */
+typedef void (*twitch_helix_batch_load_callback)(
+	twitch_error *error,
+	void *item,
+	void *user_data
+);
+
+/**
+ * Creates a new empty batch.
+ *
+ * @param client Client context to share connections with. Can be NULL.
+ * @param client_id Twitch API client ID used for all requests in the batch.
+ * @param auth Authorization token used for all requests in the batch.
+ *
+ * @return New batch. Free it with twitch_helix_batch_free().
+ */
+twitch_helix_batch *twitch_helix_batch_alloc(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth
+);
+
+/**
+ * Performs all requests added to the batch and waits until they are finished,
+ * invoking callbacks as results arrive. The batch can be reused afterwards.
+ *
+ * @param batch Batch to perform.
+ */
+void twitch_helix_batch_perform(twitch_helix_batch *batch);
+
+/**
+ * Aborts unfinished requests and lookups and frees the batch. Callbacks of
+ * aborted requests are called with CURLE_ABORTED_BY_CALLBACK error code, so
+ * they can release their user data.
+ *
+ * @param batch Batch to deallocate.
+ */
+void twitch_helix_batch_free(twitch_helix_batch *batch);
+
+#endif
@@ -4,12 +4,16 @@
 #include <stdlib.h>
 
 #include <ctwitch/common.h>
+#include <ctwitch/client.h>
+#include <ctwitch/helix/batch.h>
+#include <ctwitch/helix/iter.h>
 #include <ctwitch/helix/data.h>
 
 /**
  * Download one page of followers data for given channel and returns an array of
  * twitch_helix_follower structs with that data.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch API client ID.
  * @param token User access token. Must be issued with
  * "moderator:read:followers" permission.
@@ -24,6 +28,7 @@
  * @return Followers list. Deallocate with twitch_helix_follower_list_free().
  * */
 twitch_helix_follower_list *twitch_helix_get_channel_followers(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -38,6 +43,7 @@ twitch_helix_follower_list *twitch_helix_get_channel_followers(
 /**
  * Downloads up to `limit` number of channel followers for given channel.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch API client ID.
  * @param token User access token. Must be issued with
  * "moderator:read:followers" permission.
@@ -53,6 +59,7 @@ twitch_helix_follower_list *twitch_helix_get_channel_followers(
  * twitch_helix_follower_list struct.
  * */
 twitch_helix_follower_list *twitch_helix_get_all_channel_followers(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -64,6 +71,7 @@ twitch_helix_follower_list *twitch_helix_get_all_channel_followers(
 /**
  * Downloads the list of teams a channel belongs to.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch API client ID.
  * @param token Bearer token.
  * @param error Error holder struct.
@@ -72,11 +80,75 @@ twitch_helix_follower_list *twitch_helix_get_all_channel_followers(
  * @return Instance of twitch_team_list containing all channel's teams.
  * */
 twitch_helix_team_list *twitch_helix_get_channel_teams(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
 	const char *channel_id
 );
 
-#endif
+/**
+ * Adds a request for one page of channel followers to the batch. The callback
+ * receives a twitch_helix_follower_list.
+ *
+ * @param batch Batch to add request to.
+ * @param channel_id Channel ID.
+ * @param user_id Specific user to check, or NULL.
+ * @param first Page size. Must be between 1 and 100, including.
+ * @param after Pagination cursor.
+ * @param callback Completion callback.
+ * @param user_data Value to pass to the callback.
+ */
+void twitch_helix_batch_get_channel_followers(
+	twitch_helix_batch *batch,
+	const char *channel_id,
+	const char *user_id,
+	int first,
+	const char *after,
+	twitch_helix_batch_callback callback,
+	void *user_data
+);
+
+/**
+ * Adds a request for the list of teams a channel belongs to to the batch. The
+ * callback receives a twitch_helix_team_list.
+ *
+ * @param batch Batch to add request to.
+ * @param channel_id Channel ID.
+ * @param callback Completion callback.
+ * @param user_data Value to pass to the callback.
+ */
+void twitch_helix_batch_get_channel_teams(
+	twitch_helix_batch *batch,
+	const char *channel_id,
+	twitch_helix_batch_callback callback,
+	void *user_data
+);
+
+/**
+ * Creates an iterator over followers of given channel.
+ *
+ * @param client Client context to reuse connections from. Can be NULL.
+ * @param client_id Twitch API client ID.
+ * @param token Bearer token.
+ * @param channel_id Channel ID.
+ * @param user_id Used to check if a specific user follows given channel ID. Can be
+ * NULL.
+ * @param first Page size. Min 1, max 100. 0 means server's default.
+ * @param limit Max number of items to return. Pass 0 to iterate over all of
+ * them.
+ *
+ * @return New iterator, returning pages as twitch_helix_follower_list
+ * structs. Free it with twitch_helix_page_iter_free().
+ */
+twitch_helix_page_iter *twitch_helix_iter_get_channel_followers(
+	twitch_client *client,
+	const char *client_id,
+	const char *token,
+	const char *channel_id,
+	const char *user_id,
+	int first,
+	int limit
+);
 
+#endif
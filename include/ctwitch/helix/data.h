@@ -41,6 +41,16 @@ twitch_helix_user *twitch_helix_user_alloc();
  */
 void twitch_helix_user_free(twitch_helix_user *user);
 
+/**
+ * Makes a deep copy of given twitch_helix_user struct.
+ *
+ * @param user User data to copy.
+ *
+ * @return Pointer to dynamically allocated copy. Free it with
+ * twitch_helix_user_free().
+ */
+twitch_helix_user *twitch_helix_user_copy(const twitch_helix_user *user);
+
 typedef struct {
 	int count;
 	twitch_helix_user **items;
@@ -180,6 +190,16 @@ twitch_helix_game *twitch_helix_game_alloc();
  */
 void twitch_helix_game_free(twitch_helix_game *game);
 
+/**
+ * Makes a deep copy of given twitch_helix_game struct.
+ *
+ * @param game Game data to copy.
+ *
+ * @return Pointer to dynamically allocated copy. Free it with
+ * twitch_helix_game_free().
+ */
+twitch_helix_game *twitch_helix_game_copy(const twitch_helix_game *game);
+
 typedef struct {
 	int count;
 	twitch_helix_game **items;
@@ -12,34 +12,42 @@
 #include <stdint.h>
 
 #include <ctwitch/common.h>
+#include <ctwitch/client.h>
+#include <ctwitch/helix/batch.h>
+#include <ctwitch/helix/iter.h>
 #include <ctwitch/helix/data.h>
 
 /**
  * Returns one page of games data sorted by number of current viewers, most
  * popular first.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch API client ID.
  * @param token Bearer token.
  * @param error Error holder struct.
  * @param first Page size. Min 1, max 100.
  * @param after Cursor value to get next page. Can be NULL.
+ * @param next Returns cursor string to fetch the next page.
  *
  * @return An array of pointers to dynamically allocated twitch_helix_game
  * structs. You will have to deallocate it, either manually or using
  * twitch_helix_game_list_free() function.
  */
 twitch_helix_game_list *twitch_helix_get_top_games(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
 	int first,
-	const char *after
+	const char *after,
+	char **next
 );
 
 /**
  * Returns list of games data sorted by number of current viewers, most
  * popular first.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch API client ID.
  * @param token Bearer token.
  * @param error Error holder struct.
@@ -50,11 +58,85 @@ twitch_helix_game_list *twitch_helix_get_top_games(
  * twitch_helix_game_list_free() function.
  */
 twitch_helix_game_list *twitch_helix_get_all_top_games(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
 	int limit
 );
 
-#endif
+/**
+ * Adds a request for one page of top games to the batch. The callback receives
+ * a twitch_helix_game_list.
+ *
+ * @param batch Batch to add request to.
+ * @param first Page size. Min 1, max 100.
+ * @param after Cursor value to get next page. Can be NULL.
+ * @param callback Completion callback.
+ * @param user_data Value to pass to the callback.
+ */
+void twitch_helix_batch_get_top_games(
+	twitch_helix_batch *batch,
+	int first,
+	const char *after,
+	twitch_helix_batch_callback callback,
+	void *user_data
+);
+
+/**
+ * Adds a lookup of a single game by ID to the batch. Lookups added before the
+ * batch is performed are combined into requests of up to 100 IDs and names
+ * each. The callback receives a twitch_helix_game, or NULL if there's no such
+ * game.
+ *
+ * @param batch Batch to add lookup to.
+ * @param id Game ID.
+ * @param callback Completion callback.
+ * @param user_data Value to pass to the callback.
+ */
+void twitch_helix_batch_load_game(
+	twitch_helix_batch *batch,
+	const char *id,
+	twitch_helix_batch_load_callback callback,
+	void *user_data
+);
+
+/**
+ * Adds a lookup of a single game by its exact name to the batch. Works like
+ * twitch_helix_batch_load_game().
+ *
+ * @param batch Batch to add lookup to.
+ * @param name Game name.
+ * @param callback Completion callback.
+ * @param user_data Value to pass to the callback.
+ */
+void twitch_helix_batch_load_game_by_name(
+	twitch_helix_batch *batch,
+	const char *name,
+	twitch_helix_batch_load_callback callback,
+	void *user_data
+);
+
+/**
+ * Creates an iterator over games sorted by number of current viewers, most
+ * popular first.
+ *
+ * @param client Client context to reuse connections from. Can be NULL.
+ * @param client_id Twitch API client ID.
+ * @param token Bearer token.
+ * @param first Page size. Min 1, max 100. 0 means server's default.
+ * @param limit Max number of items to return. Pass 0 to iterate over all of
+ * them.
+ *
+ * @return New iterator, returning pages as twitch_helix_game_list
+ * structs. Free it with twitch_helix_page_iter_free().
+ */
+twitch_helix_page_iter *twitch_helix_iter_get_top_games(
+	twitch_client *client,
+	const char *client_id,
+	const char *token,
+	int first,
+	int limit
+);
 
+#endif
@@ -0,0 +1,69 @@
+/**
+ * Twitch Helix API - Page iterators
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * An iterator walks a paged collection one page at a time, keeping the
+ * pagination cursor internally. Unlike twitch_helix_get_all_*() methods, it
+ * never holds more than one page in memory, and the first items are available
+ * as soon as the first page arrives, regardless of the collection size.
+ *
+ * Iterators are created with twitch_helix_iter_get_*() functions declared next
+ * to their blocking counterparts:
+ *
+ *   twitch_helix_page_iter *iter = twitch_helix_iter_get_channel_followers(
+ *     client, client_id, token, channel_id, NULL, 100, 0
+ *   );
+ *
+ *   twitch_helix_follower_list *page;
+ *   while ((page = twitch_helix_page_iter_next(iter, &error)) != NULL) {
+ *     ...
+ *     twitch_helix_follower_list_free(page);
+ *   }
+ *
+ *   twitch_helix_page_iter_free(iter);
+ */
+
+#ifndef _H_TWITCH_HELIX_ITER
+#define _H_TWITCH_HELIX_ITER
+
+#include <ctwitch/common.h>
+#include <ctwitch/client.h>
+
+typedef struct twitch_helix_page_iter twitch_helix_page_iter;
+
+/**
+ * Downloads the next page of the collection.
+ *
+ * @param iter Iterator.
+ * @param error Error holder struct.
+ *
+ * @return List with the next page of items, like twitch_helix_follower_list for
+ * followers iterator. The caller owns it and has to free it with the
+ * corresponding free function. NULL when there are no more items or the request
+ * has failed, in which case error is filled in. Once NULL is returned, all
+ * further calls return NULL too.
+ */
+void *twitch_helix_page_iter_next(
+	twitch_helix_page_iter *iter,
+	twitch_error *error
+);
+
+/**
+ * Returns the number of items returned by the iterator so far.
+ *
+ * @param iter Iterator.
+ *
+ * @return Number of items in all pages returned so far.
+ */
+int twitch_helix_page_iter_count(twitch_helix_page_iter *iter);
+
+/**
+ * Frees the iterator. Pages returned by it are not affected.
+ *
+ * @param iter Iterator to deallocate.
+ */
+void twitch_helix_page_iter_free(twitch_helix_page_iter *iter);
+
+#endif
@@ -13,11 +13,14 @@
 #include <stdbool.h>
 
 #include <ctwitch/common.h>
+#include <ctwitch/client.h>
+#include <ctwitch/helix/iter.h>
 #include <ctwitch/helix/data.h>
 
 /**
  * Returns a page of games/categories matching given query.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Client ID.
  * @param token Access token.
  * @oaram error Error holder struct.
@@ -28,6 +31,7 @@
  * @return List of games/categories.
  */
 twitch_helix_category_list *twitch_helix_get_categories(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -40,6 +44,7 @@ twitch_helix_category_list *twitch_helix_get_categories(
 /**
  * Returns a full list of games/categories matching given query.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Client ID.
  * @param token Access token.
  * @oaram error Error holder struct.
@@ -50,6 +55,7 @@ twitch_helix_category_list *twitch_helix_get_categories(
  * @return List of games/categories.
  */
 twitch_helix_category_list *twitch_helix_get_all_categories(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -60,6 +66,7 @@ twitch_helix_category_list *twitch_helix_get_all_categories(
 /**
  * Returns a page of channels matching given query.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Client ID.
  * @param token Access token.
  * @param error Error holder struct.
@@ -71,6 +78,7 @@ twitch_helix_category_list *twitch_helix_get_all_categories(
  * @return List of channels matching query and live filter value.
  */
 twitch_helix_channel_search_item_list *twitch_helix_search_channels(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -84,6 +92,7 @@ twitch_helix_channel_search_item_list *twitch_helix_search_channels(
 /**
  * Returns a full list of channels matching given query.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Client ID.
  * @param token Access token.
  * @param error Error holder struct.
@@ -94,6 +103,7 @@ twitch_helix_channel_search_item_list *twitch_helix_search_channels(
  * @return List of games/categories.
  */
 twitch_helix_channel_search_item_list *twitch_helix_search_all_channels(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -102,5 +112,53 @@ twitch_helix_channel_search_item_list *twitch_helix_search_all_channels(
 	int limit
 );
 
+/**
+ * Creates an iterator over games/categories matching given query.
+ *
+ * @param client Client context to reuse connections from. Can be NULL.
+ * @param client_id Twitch API client ID.
+ * @param token Bearer token.
+ * @param query Query string.
+ * @param first Page size. Min 1, max 100. 0 means server's default.
+ * @param limit Max number of items to return. Pass 0 to iterate over all of
+ * them.
+ *
+ * @return New iterator, returning pages as twitch_helix_category_list
+ * structs. Free it with twitch_helix_page_iter_free().
+ */
+twitch_helix_page_iter *twitch_helix_iter_get_categories(
+	twitch_client *client,
+	const char *client_id,
+	const char *token,
+	const char *query,
+	int first,
+	int limit
+);
+
+/**
+ * Creates an iterator over channels matching given query.
+ *
+ * @param client Client context to reuse connections from. Can be NULL.
+ * @param client_id Twitch API client ID.
+ * @param token Bearer token.
+ * @param query Query string.
+ * @param live_only Whether to return only live channels.
+ * @param first Page size. Min 1, max 100. 0 means server's default.
+ * @param limit Max number of items to return. Pass 0 to iterate over all of
+ * them.
+ *
+ * @return New iterator, returning pages as twitch_helix_channel_search_item_list
+ * structs. Free it with twitch_helix_page_iter_free().
+ */
+twitch_helix_page_iter *twitch_helix_iter_search_channels(
+	twitch_client *client,
+	const char *client_id,
+	const char *token,
+	const char *query,
+	int live_only,
+	int first,
+	int limit
+);
+
 #endif
 
@@ -0,0 +1,162 @@
+/**
+ * Twitch Helix API - Entity store
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * A store keeps user and game records in a compact binary file, so they can
+ * survive process restarts. The file is memory-mapped when the store is
+ * opened, and records are looked up in place with binary search, without
+ * reading the whole file, so warm start costs a single mmap() call instead of
+ * an API request per record.
+ *
+ * Records added with twitch_helix_store_put_*() are kept in memory and written
+ * to the file by twitch_helix_store_save(), which replaces the file atomically.
+ *
+ * Records don't expire. Data that matters to be fresh should be requested from
+ * the API instead.
+ */
+
+#ifndef _H_TWITCH_HELIX_STORE
+#define _H_TWITCH_HELIX_STORE
+
+#include <stdbool.h>
+
+#include <ctwitch/common.h>
+#include <ctwitch/client.h>
+#include <ctwitch/helix/data.h>
+
+typedef struct twitch_helix_store twitch_helix_store;
+
+/**
+ * Opens a store backed by given file. If the file doesn't exist or is not a
+ * valid store file, the store starts empty and the file is created or
+ * replaced on save.
+ *
+ * @param path Path to the store file.
+ *
+ * @return New store instance. Close it with twitch_helix_store_close().
+ */
+twitch_helix_store *twitch_helix_store_open(const char *path);
+
+/**
+ * Writes all records to the store file. The new file is written next to the
+ * old one and then renamed over it, so a crash never leaves a broken file.
+ *
+ * @param store Store to save.
+ *
+ * @return true on success.
+ */
+bool twitch_helix_store_save(twitch_helix_store *store);
+
+/**
+ * Closes the store without saving it and frees its memory.
+ *
+ * @param store Store to close.
+ */
+void twitch_helix_store_close(twitch_helix_store *store);
+
+/**
+ * Finds a user by login.
+ *
+ * @param store Store to look in.
+ * @param login User's login name.
+ *
+ * @return Copy of the user record, or NULL if it's not found. Free it with
+ * twitch_helix_user_free().
+ */
+twitch_helix_user *twitch_helix_store_get_user(
+	twitch_helix_store *store,
+	const char *login
+);
+
+/**
+ * Finds a user by ID.
+ *
+ * @param store Store to look in.
+ * @param id User's ID.
+ *
+ * @return Copy of the user record, or NULL if it's not found. Free it with
+ * twitch_helix_user_free().
+ */
+twitch_helix_user *twitch_helix_store_get_user_by_id(
+	twitch_helix_store *store,
+	const char *id
+);
+
+/**
+ * Finds a game by ID.
+ *
+ * @param store Store to look in.
+ * @param id Game's ID.
+ *
+ * @return Copy of the game record, or NULL if it's not found. Free it with
+ * twitch_helix_game_free().
+ */
+twitch_helix_game *twitch_helix_store_get_game(
+	twitch_helix_store *store,
+	const char *id
+);
+
+/**
+ * Finds a game by name.
+ *
+ * @param store Store to look in.
+ * @param name Game's name.
+ *
+ * @return Copy of the game record, or NULL if it's not found. Free it with
+ * twitch_helix_game_free().
+ */
+twitch_helix_game *twitch_helix_store_get_game_by_name(
+	twitch_helix_store *store,
+	const char *name
+);
+
+/**
+ * Adds a user record to the store, replacing the one with the same ID.
+ *
+ * @param store Store to add the record to.
+ * @param user User to add. The store keeps its own copy.
+ */
+void twitch_helix_store_put_user(
+	twitch_helix_store *store,
+	twitch_helix_user *user
+);
+
+/**
+ * Adds a game record to the store, replacing the one with the same ID.
+ *
+ * @param store Store to add the record to.
+ * @param game Game to add. The store keeps its own copy.
+ */
+void twitch_helix_store_put_game(
+	twitch_helix_store *store,
+	twitch_helix_game *game
+);
+
+/**
+ * Same as twitch_helix_get_users(), but looks up the store first, and requests
+ * only the users that are not there. Downloaded users are added to the store.
+ *
+ * @param store Store to use. Can be NULL, in which case all users are
+ * requested from the API.
+ * @param client Client context to reuse connections from. Can be NULL.
+ * @param client_id Twitch API client ID.
+ * @param auth Authorization token.
+ * @param error Error holder struct.
+ * @param logins_count Number of login names.
+ * @param logins List of login names.
+ *
+ * @return List of found users, in the order of given logins.
+ */
+twitch_helix_user_list *twitch_helix_store_get_users(
+	twitch_helix_store *store,
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	twitch_error *error,
+	int logins_count,
+	const char **logins
+);
+
+#endif
@@ -13,11 +13,15 @@
 #include <stdbool.h>
 
 #include <ctwitch/common.h>
+#include <ctwitch/client.h>
+#include <ctwitch/helix/batch.h>
+#include <ctwitch/helix/iter.h>
 #include <ctwitch/helix/data.h>
 
 /**
  * Returns one page of live streams data for given parameters.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch Client ID.
  * @param auth Authorization token.
  * @param error Error holder struct.
@@ -36,10 +40,11 @@
  * @return List of live streams matching given parameters.
  */
 twitch_helix_stream_list *twitch_helix_get_streams(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
-	long long game_id,
+	const char *game_id,
 	const char *language,
 	int users_count,
 	const char **users,
@@ -52,8 +57,12 @@ twitch_helix_stream_list *twitch_helix_get_streams(
 );
 
 /**
- * Returns full list of live streams data for given parameters.
+ * Returns full list of live streams data for given parameters. Any number of
+ * user IDs or logins can be given: if there are more than 100 of them, they are
+ * split into requests of 100 each, which are performed in parallel, and the
+ * results are returned in the order of IDs, then logins.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch Client ID.
  * @param auth Authorization token.
  * @param error Error holder struct.
@@ -67,6 +76,7 @@ twitch_helix_stream_list *twitch_helix_get_streams(
  * @return List of live streams matching given parameters.
  */
 twitch_helix_stream_list *twitch_helix_get_all_streams(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -78,4 +88,68 @@ twitch_helix_stream_list *twitch_helix_get_all_streams(
 	const char **logins
 );
 
+/**
+ * Adds a request for one page of live streams data to the batch. The callback
+ * receives a twitch_helix_stream_list.
+ *
+ * @param batch Batch to add request to.
+ * @param game_id ID of the specific game to query.
+ * @param language Language filter.
+ * @param users_count Number of user IDs in the users list.
+ * @param users ID of specific users to query.
+ * @param logins_count Number of user names in the users list.
+ * @param logins User names to query.
+ * @param limit Page size.
+ * @param after Page offset cursor.
+ * @param callback Completion callback.
+ * @param user_data Value to pass to the callback.
+ */
+void twitch_helix_batch_get_streams(
+	twitch_helix_batch *batch,
+	const char *game_id,
+	const char *language,
+	int users_count,
+	const char **users,
+	int logins_count,
+	const char **logins,
+	int limit,
+	const char *after,
+	twitch_helix_batch_callback callback,
+	void *user_data
+);
+
+/**
+ * Creates an iterator over live streams matching given parameters. Only the
+ * first 100 user IDs and 100 logins are used.
+ *
+ * @param client Client context to reuse connections from. Can be NULL.
+ * @param client_id Twitch API client ID.
+ * @param auth Authorization token.
+ * @param game_id ID of the specific game to query.
+ * @param language Language filter.
+ * @param users_count Number of user IDs in the users list.
+ * @param users ID of specific users to query.
+ * @param logins_count Number of user names in the logins list.
+ * @param logins User names to query.
+ * @param first Page size. Min 1, max 100. 0 means server's default.
+ * @param limit Max number of items to return. Pass 0 to iterate over all of
+ * them.
+ *
+ * @return New iterator, returning pages as twitch_helix_stream_list
+ * structs. Free it with twitch_helix_page_iter_free().
+ */
+twitch_helix_page_iter *twitch_helix_iter_get_streams(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	const char *game_id,
+	const char *language,
+	int users_count,
+	const char **users,
+	int logins_count,
+	const char **logins,
+	int first,
+	int limit
+);
+
 #endif
@@ -13,12 +13,14 @@
 #include <stdbool.h>
 
 #include <ctwitch/common.h>
+#include <ctwitch/client.h>
 #include <ctwitch/helix/data.h>
 
 /**
  * Gets details for one team identified by its name or ID. Specify either ID or
  * name. If ID is provided, name parameter will be ignored.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch API client ID.
  * @param token Bearer token.
  * @param error Error holder.
@@ -28,6 +30,7 @@
  * @return Team details inside twitch_team struct.
  */
 twitch_helix_team *twitch_helix_get_team(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -13,6 +13,9 @@
 #include <stdbool.h>
 
 #include <ctwitch/common.h>
+#include <ctwitch/client.h>
+#include <ctwitch/helix/batch.h>
+#include <ctwitch/helix/iter.h>
 #include <ctwitch/helix/data.h>
 
 /**
@@ -20,6 +23,7 @@
  * given user ID.
  *
  * @param login User login name.
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch API client ID.
  * @param error Error holder to fill with error info.
  * @param auth Authorization token.
@@ -28,6 +32,7 @@
  * You have to manually free the memory using twitch_helix_user_free() function.
  */
 twitch_helix_user *twitch_helix_get_user(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -35,10 +40,14 @@ twitch_helix_user *twitch_helix_get_user(
 );
 
 /**
- * Returns a list of user data for given logins.
+ * Returns a list of user data for given logins. Any number of logins can be
+ * given: if there are more than 100 of them, they are split into requests of
+ * 100 logins each, which are performed in parallel, and the results are
+ * returned in the order of logins.
  *
  * @param login_count Number of login names.
  * @param login_names Login names array.
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch API client ID.
  * @param auth Authorization token.
  * @param error Error holder struct.
@@ -48,6 +57,7 @@ twitch_helix_user *twitch_helix_get_user(
  * function.
  */
 twitch_helix_user_list *twitch_helix_get_users(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -63,6 +73,7 @@ twitch_helix_user_list *twitch_helix_get_users(
  * Requires a valid user access token obtained with "user:read:follows" scope
  * instead of standard app access token.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch Client ID.
  * @param auth Authorization token.
  * @param error Error holder struct.
@@ -77,6 +88,7 @@ twitch_helix_user_list *twitch_helix_get_users(
  * @return List of follows matching given parameters.
  */
 twitch_helix_channel_follow_list *twitch_helix_get_channel_follows(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -85,7 +97,7 @@ twitch_helix_channel_follow_list *twitch_helix_get_channel_follows(
 	int limit,
 	const char *after,
 	int *total,
-	char *next
+	char **next
 );
 
 /**
@@ -96,6 +108,7 @@ twitch_helix_channel_follow_list *twitch_helix_get_channel_follows(
  * Requires a valid user access token obtained with "user:read:follows" scope
  * instead of standard app access token.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch Client ID.
  * @param auth Authorization token.
  * @param error Error holder struct.
@@ -105,6 +118,7 @@ twitch_helix_channel_follow_list *twitch_helix_get_channel_follows(
  * @return List of follows matching given parameters.
  */
 twitch_helix_channel_follow_list *twitch_helix_get_all_channel_follows(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -112,4 +126,83 @@ twitch_helix_channel_follow_list *twitch_helix_get_all_channel_follows(
 	const char *broadcaster_id
 );
 
+/**
+ * Adds a request for user data for given logins to the batch. The callback
+ * receives a twitch_helix_user_list.
+ *
+ * @param batch Batch to add request to.
+ * @param logins_count Number of login names.
+ * @param logins Login names array.
+ * @param callback Completion callback.
+ * @param user_data Value to pass to the callback.
+ */
+void twitch_helix_batch_get_users(
+	twitch_helix_batch *batch,
+	int logins_count,
+	const char **logins,
+	twitch_helix_batch_callback callback,
+	void *user_data
+);
+
+/**
+ * Adds a lookup of a single user by login to the batch. Lookups added before
+ * the batch is performed are combined into requests of up to 100 logins and
+ * IDs each. The callback receives a twitch_helix_user, or NULL if there's no
+ * such user.
+ *
+ * @param batch Batch to add lookup to.
+ * @param login User login name.
+ * @param callback Completion callback.
+ * @param user_data Value to pass to the callback.
+ */
+void twitch_helix_batch_load_user(
+	twitch_helix_batch *batch,
+	const char *login,
+	twitch_helix_batch_load_callback callback,
+	void *user_data
+);
+
+/**
+ * Adds a lookup of a single user by ID to the batch. Works like
+ * twitch_helix_batch_load_user().
+ *
+ * @param batch Batch to add lookup to.
+ * @param id User ID.
+ * @param callback Completion callback.
+ * @param user_data Value to pass to the callback.
+ */
+void twitch_helix_batch_load_user_by_id(
+	twitch_helix_batch *batch,
+	const char *id,
+	twitch_helix_batch_load_callback callback,
+	void *user_data
+);
+
+/**
+ * Creates an iterator over follow data for given user or broadcaster.
+ *
+ * Requires a valid user access token obtained with "user:read:follows" scope.
+ *
+ * @param client Client context to reuse connections from. Can be NULL.
+ * @param client_id Twitch API client ID.
+ * @param auth Authorization token.
+ * @param user_id ID of a user to query for outgoing follows.
+ * @param broadcaster_id ID of a user to query for incoming follows.
+ * @param first Page size. Min 1, max 100. 0 means server's default.
+ * @param limit Max number of items to return. Pass 0 to iterate over all of
+ * them.
+ *
+ * @return New iterator, returning pages as twitch_helix_channel_follow_list
+ * structs. Free it with twitch_helix_page_iter_free().
+ */
+twitch_helix_page_iter *twitch_helix_iter_get_channel_follows(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	const char *user_id,
+	const char *broadcaster_id,
+	int first,
+	int limit
+);
+
 #endif
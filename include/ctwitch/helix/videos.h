@@ -11,6 +11,8 @@
 #include <stdlib.h>
 
 #include <ctwitch/common.h>
+#include <ctwitch/client.h>
+#include <ctwitch/helix/iter.h>
 #include <ctwitch/helix/data.h>
 
 /**
@@ -20,6 +22,7 @@
  * only one of them, i.e. you can search for either videos for specific user,
  * specific game/category, or specific videos.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch API client ID.
  * @param token Bearer token.
  * @param error Error holder struct.
@@ -41,6 +44,7 @@
  * @return List of videos in a twitch_helix_video_list struct.
  * */
 twitch_helix_video_list *twitch_helix_get_videos(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -64,6 +68,7 @@ twitch_helix_video_list *twitch_helix_get_videos(
  * only one of them, i.e. you can search for either videos for specific user,
  * specific game/category, or specific videos.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch API client ID.
  * @param token Bearer token.
  * @oaram error Error holder struct.
@@ -84,6 +89,7 @@ twitch_helix_video_list *twitch_helix_get_videos(
  * @return List of videos in a twitch_helix_video_list struct.
  */
 twitch_helix_video_list *twitch_helix_get_all_videos(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -98,4 +104,42 @@ twitch_helix_video_list *twitch_helix_get_all_videos(
 	int limit
 );
 
+/**
+ * Creates an iterator over videos matching given search parameters. See
+ * twitch_helix_get_all_videos() for parameters description.
+ *
+ * @param client Client context to reuse connections from. Can be NULL.
+ * @param client_id Twitch API client ID.
+ * @param token Bearer token.
+ * @param user_id ID of user from whom to fetch videos.
+ * @param game_id ID of the game or category.
+ * @param id_count Number of video IDs in `ids` param.
+ * @param ids List of video IDS.
+ * @param language Language filter. Can be NULL.
+ * @param period Time period filter. Can be NULL.
+ * @param sort Sorting parameter. Can be NULL.
+ * @param type Video type filter. Can be NULL.
+ * @param first Page size. Min 1, max 100. 0 means server's default.
+ * @param limit Max number of items to return. Pass 0 to iterate over all of
+ * them.
+ *
+ * @return New iterator, returning pages as twitch_helix_video_list
+ * structs. Free it with twitch_helix_page_iter_free().
+ */
+twitch_helix_page_iter *twitch_helix_iter_get_videos(
+	twitch_client *client,
+	const char *client_id,
+	const char *token,
+	const char *user_id,
+	const char *game_id,
+	int id_count,
+	const char **ids,
+	const char *language,
+	const char *period,
+	const char *sort,
+	const char *type,
+	int first,
+	int limit
+);
+
 #endif
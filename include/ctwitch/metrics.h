@@ -0,0 +1,83 @@
+/**
+ * Twitch API: Prometheus metrics.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * Client's counters and histograms can be exported in Prometheus text
+ * exposition format, for a sidecar to scrape from a file or a socket. The
+ * export includes requests by endpoint and HTTP status code, failed and
+ * retried requests, bytes received, request phase histograms, response cache
+ * counters and rate limit budget of every client ID.
+ *
+ * Exporting is split in two steps, so the request path is never held up by
+ * rendering or by a slow reader. twitch_client_get_metrics() copies the
+ * counters, which is cheap and must be done on the thread that uses the
+ * client. The copy is independent of the client, so twitch_metrics_write()
+ * can render and write it on any thread.
+ */
+
+#ifndef _H_TWITCH_METRICS
+#define _H_TWITCH_METRICS
+
+#include <ctwitch/client.h>
+#include <ctwitch/stats.h>
+
+/**
+ * Rate limit budget of one client ID.
+ */
+typedef struct {
+	char *client_id;
+	twitch_rate_limit rate_limit;
+} twitch_rate_limit_entry;
+
+/**
+ * Snapshot of client's metrics.
+ */
+typedef struct {
+	twitch_stats *stats;             // Per-endpoint statistics.
+	twitch_cache_stats cache;        // Response cache counters.
+	twitch_transfer_stats transfer;  // Response size counters.
+	int rate_limits_count;           // Number of known client IDs.
+	twitch_rate_limit_entry *rate_limits;  // Budget of every client ID.
+} twitch_metrics;
+
+/**
+ * Copies all metrics of given client.
+ *
+ * @param client Client to query.
+ *
+ * @return Metrics snapshot. Free it with twitch_metrics_free().
+ */
+twitch_metrics *twitch_client_get_metrics(twitch_client *client);
+
+/**
+ * Frees a metrics snapshot.
+ *
+ * @param metrics Snapshot to free.
+ */
+void twitch_metrics_free(twitch_metrics *metrics);
+
+/**
+ * Writes a metrics snapshot to given file descriptor in Prometheus text
+ * exposition format. The whole text is rendered in memory first.
+ *
+ * @param metrics Snapshot to write.
+ * @param fd File descriptor to write to, e.g. an accepted socket connection.
+ *
+ * @return 0 on success, or -1 if writing failed, with errno set.
+ */
+int twitch_metrics_write(const twitch_metrics *metrics, int fd);
+
+/**
+ * Takes a snapshot of client's metrics and writes it to given file
+ * descriptor in Prometheus text exposition format.
+ *
+ * @param client Client to export.
+ * @param fd File descriptor to write to.
+ *
+ * @return 0 on success, or -1 if writing failed, with errno set.
+ */
+int twitch_client_metrics_write(twitch_client *client, int fd);
+
+#endif
@@ -0,0 +1,143 @@
+/**
+ * Twitch API: Request statistics.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * Every client records where the time of each request goes: DNS lookup, TCP
+ * connect, TLS handshake, time to first byte and total transfer time as
+ * reported by cURL, then JSON parsing and conversion of parsed JSON into
+ * entity structs, along with the number of bytes received. Measurements are
+ * rolled up into per-endpoint histograms, which can be read at any time with
+ * twitch_client_get_stats().
+ *
+ * Histograms are log-linear, like HdrHistogram: every power of two range is
+ * split into 32 equal buckets, so any reported percentile is within about 3%
+ * of the real value, and memory doesn't depend on the number of samples.
+ */
+
+#ifndef _H_TWITCH_STATS
+#define _H_TWITCH_STATS
+
+#include <ctwitch/client.h>
+
+/**
+ * Number of buckets in a histogram. Values from 0 to 2^32 - 1 are tracked,
+ * larger ones are counted in the last bucket.
+ */
+#define TWITCH_HISTOGRAM_BUCKETS 896
+
+/**
+ * Measured phases of a request. Times are in microseconds.
+ */
+typedef enum {
+	TWITCH_METRIC_DNS,          // Name lookup, only for new connections.
+	TWITCH_METRIC_CONNECT,      // TCP connect, only for new connections.
+	TWITCH_METRIC_TLS,          // TLS handshake, only for new connections.
+	TWITCH_METRIC_TTFB,         // From request start to the first byte.
+	TWITCH_METRIC_TOTAL,        // From request start to the last byte.
+	TWITCH_METRIC_PARSE,        // JSON parsing.
+	TWITCH_METRIC_MATERIALIZE,  // Converting JSON into entity structs. Pages
+	                            // decoded straight from the text without
+	                            // parsing are timed here as a whole, summed
+	                            // over the chunks if decoded while
+	                            // downloading.
+	TWITCH_METRIC_BYTES,        // Response body size as received, in bytes.
+	TWITCH_METRIC_COUNT
+} twitch_metric;
+
+/**
+ * Distribution of a metric.
+ */
+typedef struct {
+	unsigned long count;      // Number of samples.
+	unsigned long long sum;   // Sum of all samples.
+	unsigned long long min;   // Smallest sample.
+	unsigned long long max;   // Largest sample.
+	unsigned int buckets[TWITCH_HISTOGRAM_BUCKETS];
+} twitch_histogram;
+
+/**
+ * Number of responses with one HTTP status code.
+ */
+typedef struct {
+	long code;            // HTTP status code, or 0 if there was no response.
+	unsigned long count;  // Number of responses.
+} twitch_status_count;
+
+/**
+ * Statistics of one endpoint.
+ */
+typedef struct {
+	char *endpoint;           // URL path, like "/helix/streams".
+	unsigned long requests;   // Number of attempts, including retries.
+	unsigned long errors;     // Number of failed attempts.
+	unsigned long retries;    // Number of attempts that were retries.
+	int statuses_count;       // Number of distinct status codes.
+	twitch_status_count *statuses;  // Attempts by status code, ascending.
+	twitch_histogram metrics[TWITCH_METRIC_COUNT];
+} twitch_endpoint_stats;
+
+/**
+ * Statistics of all endpoints used by a client.
+ */
+typedef struct {
+	int count;
+	twitch_endpoint_stats **items;  // Sorted by endpoint.
+} twitch_stats;
+
+/**
+ * Returns a snapshot of client's request statistics.
+ *
+ * @param client Client to query.
+ *
+ * @return Copy of current statistics. Free with twitch_stats_free().
+ */
+twitch_stats *twitch_client_get_stats(twitch_client *client);
+
+/**
+ * Drops all request statistics collected by the client.
+ *
+ * @param client Client to reset.
+ */
+void twitch_client_reset_stats(twitch_client *client);
+
+/**
+ * Frees a statistics snapshot.
+ *
+ * @param stats Snapshot to free.
+ */
+void twitch_stats_free(twitch_stats *stats);
+
+/**
+ * Returns the name of given metric, like "ttfb".
+ *
+ * @param metric Metric.
+ *
+ * @return Static string.
+ */
+const char *twitch_metric_name(twitch_metric metric);
+
+/**
+ * Returns the value below which given share of samples falls.
+ *
+ * @param histogram Histogram to query.
+ * @param percentile Percentile, from 0 to 100, e.g. 99.9.
+ *
+ * @return Value at the percentile, or 0 if the histogram is empty.
+ */
+unsigned long long twitch_histogram_percentile(
+	const twitch_histogram *histogram,
+	double percentile
+);
+
+/**
+ * Returns the mean of all samples.
+ *
+ * @param histogram Histogram to query.
+ *
+ * @return Mean value, or 0 if the histogram is empty.
+ */
+double twitch_histogram_mean(const twitch_histogram *histogram);
+
+#endif
@@ -0,0 +1,46 @@
+/**
+ * Twitch API: Tracing.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * An opt-in tracer records spans of the work done by a client: URL building,
+ * network transfers, JSON parsing, conversion of JSON into entity structs and
+ * merging of pages during full collection downloads. Spans can be written as
+ * Chrome trace event JSON, which can be opened in Perfetto
+ * (https://ui.perfetto.dev) or chrome://tracing.
+ *
+ * Spans are stored in a ring buffer allocated when tracing is enabled.
+ * Recording a span takes no locks and no allocations, so the tracer can be
+ * left on in production. When the buffer is full, the oldest spans are
+ * overwritten.
+ */
+
+#ifndef _H_TWITCH_TRACE
+#define _H_TWITCH_TRACE
+
+#include <stddef.h>
+
+#include <ctwitch/client.h>
+
+/**
+ * Enables or disables tracing. Enabling drops previously recorded spans.
+ *
+ * @param client Client to configure.
+ * @param capacity Number of most recent spans to keep, or 0 to disable
+ * tracing.
+ */
+void twitch_client_set_tracing(twitch_client *client, size_t capacity);
+
+/**
+ * Writes recorded spans to given file descriptor as Chrome trace event JSON.
+ * Spans stay in the buffer.
+ *
+ * @param client Client to export.
+ * @param fd File descriptor to write to.
+ *
+ * @return 0 on success, or -1 if writing failed, with errno set.
+ */
+int twitch_client_trace_write(twitch_client *client, int fd);
+
+#endif
@@ -0,0 +1,131 @@
+/**
+ * Twitch API: Pluggable transport.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * By default all requests go through cURL. A client can be given a custom
+ * transport instead, which receives every request as a plain struct and
+ * returns the response status, headers and body. Everything above the network
+ * (rate limiting, retries, caching, parsing) works the same with any
+ * transport.
+ *
+ * The library comes with two transports:
+ *
+ * - a recording one, which performs requests with cURL and appends every
+ *   exchange to an archive file;
+ * - a replaying one, which answers requests with responses from such an
+ *   archive, with optional latency and jitter.
+ *
+ * Together they make it possible to benchmark the library's own CPU and
+ * memory costs deterministically, without network access.
+ *
+ * Custom transports are synchronous, so with them parallel requests, like
+ * batches, sharded queries and pipelined crawls, are performed one after
+ * another, and requests are never hedged.
+ */
+
+#ifndef _H_TWITCH_TRANSPORT
+#define _H_TWITCH_TRANSPORT
+
+#include <stddef.h>
+
+#include <ctwitch/client.h>
+
+/**
+ * Request passed to a transport.
+ */
+typedef struct {
+	const char *method;    // "GET" or "POST".
+	const char *url;       // Full URL, including API URL override.
+	int headers_count;     // Number of header lines.
+	const char **headers;  // Header lines, like "Client-ID: abc".
+} twitch_transport_request;
+
+/**
+ * Response filled by a transport. Buffers must be allocated with malloc(),
+ * the library frees them.
+ */
+typedef struct {
+	long status;            // HTTP status code.
+	char *headers;          // Raw header block, one header per line, or NULL.
+	size_t headers_length;  // Length of the header block.
+	char *body;             // Response body, or NULL.
+	size_t body_length;     // Length of the body.
+} twitch_transport_response;
+
+typedef struct twitch_transport twitch_transport;
+
+/**
+ * Transport interface. Custom transports embed this struct as their first
+ * member.
+ */
+struct twitch_transport {
+	/**
+	 * Performs a request.
+	 *
+	 * @param transport Transport instance.
+	 * @param request Request to perform.
+	 * @param response Zeroed response struct to fill.
+	 *
+	 * @return 0 if a response was received, whatever its status is, or a
+	 * cURL error code if the request failed, e.g. CURLE_COULDNT_CONNECT.
+	 */
+	long (*perform)(
+		twitch_transport *transport,
+		const twitch_transport_request *request,
+		twitch_transport_response *response
+	);
+
+	/**
+	 * Frees the transport.
+	 *
+	 * @param transport Transport instance.
+	 */
+	void (*free)(twitch_transport *transport);
+};
+
+/**
+ * Makes the client send all requests through given transport.
+ *
+ * @param client Client to configure.
+ * @param transport Transport to use. The client takes ownership of it and
+ * frees it along with itself. Pass NULL to go back to cURL.
+ */
+void twitch_client_set_transport(
+	twitch_client *client,
+	twitch_transport *transport
+);
+
+/**
+ * Creates a transport that performs requests with cURL and appends every
+ * request and its response to an archive file, which can be replayed later
+ * with twitch_replay_transport_alloc().
+ *
+ * @param path Archive file path. New exchanges are appended to it.
+ *
+ * @return New transport, or NULL if the file can't be opened.
+ */
+twitch_transport *twitch_record_transport_alloc(const char *path);
+
+/**
+ * Creates a transport that answers requests with responses from an archive.
+ * Requests are matched by method, path and query, so an archive recorded
+ * against one server can be replayed with any API URL. If a request was
+ * recorded several times, its responses are returned in turn, starting over
+ * after the last one. Requests missing from the archive get 404 response.
+ *
+ * @param path Archive file path.
+ * @param latency Delay added to every response, in milliseconds.
+ * @param jitter Max random deviation from the latency, in milliseconds. The
+ * random sequence is the same on every run.
+ *
+ * @return New transport, or NULL if the archive can't be read.
+ */
+twitch_transport *twitch_replay_transport_alloc(
+	const char *path,
+	long latency,
+	long jitter
+);
+
+#endif
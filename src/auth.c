@@ -56,7 +56,7 @@ twitch_app_access_token *twitch_get_app_access_token(
 	string_append(grant_type, strlen(grant_type), url);
 
 	// Get JSON.
-	json_value *value = twitch_auth_post_json(url->ptr);
+	json_value *value = twitch_auth_post_json(NULL, url->ptr);
 	string_free(url);
 
 	if (value == NULL) {
@@ -92,7 +92,7 @@ twitch_user_access_token *twitch_get_user_access_token(
 	string_append_format(url, "&redirect_uri=%s", redirect_uri);
 
 	// Get JSON.
-	json_value *value = twitch_auth_post_json(url->ptr);
+	json_value *value = twitch_auth_post_json(NULL, url->ptr);
 	string_free(url);
 
 	if (value == NULL) {
@@ -126,7 +126,7 @@ twitch_user_access_token *twitch_refresh_access_token(
 	string_append(grant_type, strlen(grant_type), url);
 
 	// Get JSON.
-	json_value *value = twitch_auth_post_json(url->ptr);
+	json_value *value = twitch_auth_post_json(NULL, url->ptr);
 	string_free(url);
 
 	if (value == NULL) {
@@ -0,0 +1,283 @@
+#include <stdlib.h>
+#include <string.h>
+#include <curl/curl.h>
+
+#include "utils/datagen.h"
+#include "utils/strings/strings.h"
+#include "utils/network/client.h"
+
+#include <ctwitch/client.h>
+
+/** Client **/
+
+twitch_client *twitch_client_alloc() {
+	twitch_client *client = calloc(1, sizeof(twitch_client));
+	if (client == NULL) {
+		fprintf(stderr, "Failed to allocate memory for twitch_client");
+		exit(EXIT_FAILURE);
+	}
+
+	// Share DNS cache, TLS sessions and connections between all handles made
+	// by this client.
+	client->share = curl_share_init();
+	curl_share_setopt(client->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+	curl_share_setopt(client->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+	curl_share_setopt(client->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+
+	client->curl = curl_easy_init();
+	client->auth_curl = curl_easy_init();
+	client->rate_limiting = true;
+	client->compression = true;
+	client->retry = helix_retry_state_alloc();
+	client->arena = arena_init();
+	client->json = json_single_scratch_init();
+
+	return client;
+}
+
+void twitch_client_free(twitch_client *client) {
+	if (client == NULL) {
+		return;
+	}
+
+	// Handles must be cleaned up before the share they're attached to.
+	FREE_CUSTOM(client->curl, curl_easy_cleanup)
+	FREE_CUSTOM(client->auth_curl, curl_easy_cleanup)
+	FREE_CUSTOM(client->share, curl_share_cleanup)
+	FREE(client->api_url)
+	FREE(client->auth_url)
+	FREE(client->ca_info)
+	helix_rate_buckets_free(client->buckets);
+	helix_cache_free(client->cache);
+	helix_retry_state_free(client->retry);
+	if (client->transport != NULL) {
+		client->transport->free(client->transport);
+	}
+	twitch_stats_free(client->stats);
+	helix_tracer_free(client->tracer);
+	helix_credentials_free(client->credentials);
+	arena_free(client->arena);
+	json_single_scratch_free(client->json);
+	free(client);
+}
+
+void twitch_client_set_api_url(twitch_client *client, const char *url) {
+	FREE(client->api_url)
+	client->api_url = (url != NULL) ? immutable_string_copy(url) : NULL;
+}
+
+void twitch_client_set_auth_url(twitch_client *client, const char *url) {
+	FREE(client->auth_url)
+	client->auth_url = (url != NULL) ? immutable_string_copy(url) : NULL;
+}
+
+void twitch_client_set_ca_info(twitch_client *client, const char *path) {
+	FREE(client->ca_info)
+	client->ca_info = (path != NULL) ? immutable_string_copy(path) : NULL;
+}
+
+void twitch_client_set_pipelining(twitch_client *client, bool enabled) {
+	client->pipelining = enabled;
+}
+
+void twitch_client_set_rate_limiting(twitch_client *client, bool enabled) {
+	client->rate_limiting = enabled;
+}
+
+bool twitch_client_get_rate_limit(
+	twitch_client *client,
+	const char *client_id,
+	twitch_rate_limit *rate_limit
+) {
+	return helix_ratelimit_budget(client, client_id, rate_limit);
+}
+
+/** Retries **/
+
+void twitch_client_set_retry_policy(
+	twitch_client *client,
+	const twitch_retry_policy *policy
+) {
+	helix_retry_set_policy(client->retry, policy);
+}
+
+void twitch_client_set_hedging(twitch_client *client, bool enabled, long delay) {
+	client->retry->hedging = enabled;
+	client->retry->hedge_delay = (delay > 0) ? delay : 0;
+}
+
+/** Transfers **/
+
+void twitch_client_set_compression(twitch_client *client, bool enabled) {
+	client->compression = enabled;
+}
+
+void twitch_client_get_transfer_stats(
+	twitch_client *client,
+	twitch_transfer_stats *stats
+) {
+	*stats = client->transfer;
+}
+
+void twitch_client_count_transfer(
+	twitch_client *client,
+	size_t wire_bytes,
+	size_t decoded_bytes
+) {
+	if (client == NULL) {
+		return;
+	}
+
+	twitch_transfer_stats *stats = &client->transfer;
+	stats->requests++;
+	stats->wire_bytes += wire_bytes;
+	stats->decoded_bytes += decoded_bytes;
+	stats->last_wire_bytes = wire_bytes;
+	stats->last_decoded_bytes = decoded_bytes;
+}
+
+void twitch_client_record_transfer(
+	twitch_client *client,
+	CURL *curl,
+	size_t decoded_bytes
+) {
+	if (client == NULL) {
+		return;
+	}
+
+	// Download size is counted before content decoding.
+	curl_off_t wire_bytes = 0;
+	curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &wire_bytes);
+
+	twitch_client_count_transfer(client, wire_bytes, decoded_bytes);
+}
+
+/** Statistics **/
+
+twitch_stats *twitch_client_get_stats(twitch_client *client) {
+	return helix_stats_copy(client->stats);
+}
+
+void twitch_client_reset_stats(twitch_client *client) {
+	twitch_stats_free(client->stats);
+	client->stats = NULL;
+}
+
+/** Cache **/
+
+/**
+ * Returns client's cache, creating a disabled one if needed, so TTLs can be
+ * configured before the cache is enabled.
+ */
+helix_cache *twitch_client_cache(twitch_client *client) {
+	if (client->cache == NULL) {
+		client->cache = helix_cache_alloc(0, 0);
+	}
+	return client->cache;
+}
+
+void twitch_client_set_cache(twitch_client *client, size_t max_bytes, int ttl) {
+	helix_cache *cache = twitch_client_cache(client);
+
+	helix_cache_configure(cache, max_bytes, ttl);
+	if (max_bytes == 0) {
+		helix_cache_clear(cache);
+	}
+}
+
+void twitch_client_set_cache_ttl(
+	twitch_client *client,
+	const char *endpoint,
+	int ttl
+) {
+	// Rules match URLs as produced by URL builders, before API URL override.
+	string_t *prefix = string_init_with_value(TWITCH_API_URL);
+	string_append(endpoint, strlen(endpoint), prefix);
+
+	helix_cache_set_ttl(twitch_client_cache(client), prefix->ptr, ttl);
+
+	string_free(prefix);
+}
+
+void twitch_client_get_cache_stats(
+	twitch_client *client,
+	twitch_cache_stats *stats
+) {
+	if (client->cache == NULL) {
+		memset(stats, 0, sizeof(twitch_cache_stats));
+		return;
+	}
+
+	helix_cache_stats(client->cache, stats);
+}
+
+/** Handles **/
+
+void twitch_client_setup_handle(twitch_client *client, CURL *curl) {
+	if (client == NULL) {
+		return;
+	}
+
+	curl_easy_setopt(curl, CURLOPT_SHARE, client->share);
+
+	if (client->ca_info != NULL) {
+		curl_easy_setopt(curl, CURLOPT_CAINFO, client->ca_info);
+	}
+
+	// Empty string advertises every encoding cURL was built with.
+	if (client->compression) {
+		curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+	}
+}
+
+CURL *twitch_client_handle(twitch_client *client) {
+	if (client == NULL) {
+		return curl_easy_init();
+	}
+
+	// Reset keeps live connections and caches, but drops all options, so
+	// client-wide ones have to be applied again.
+	curl_easy_reset(client->curl);
+	twitch_client_setup_handle(client, client->curl);
+
+	return client->curl;
+}
+
+CURL *twitch_client_auth_handle(twitch_client *client) {
+	if (client == NULL) {
+		return curl_easy_init();
+	}
+
+	curl_easy_reset(client->auth_curl);
+	twitch_client_setup_handle(client, client->auth_curl);
+
+	return client->auth_curl;
+}
+
+void twitch_client_release_handle(twitch_client *client, CURL *curl) {
+	if (client == NULL) {
+		curl_easy_cleanup(curl);
+	}
+}
+
+string_t *twitch_client_resolve_url(twitch_client *client, const char *url) {
+	const char *prefix = NULL, *override = NULL;
+	if (client != NULL) {
+		if (strncmp(url, TWITCH_API_URL, strlen(TWITCH_API_URL)) == 0) {
+			prefix = TWITCH_API_URL;
+			override = client->api_url;
+		} else if (strncmp(url, TWITCH_AUTH_URL, strlen(TWITCH_AUTH_URL)) == 0) {
+			prefix = TWITCH_AUTH_URL;
+			override = client->auth_url;
+		}
+	}
+
+	if (override == NULL) {
+		return string_init_with_value(url);
+	}
+
+	size_t prefix_length = strlen(prefix);
+	string_t *resolved = string_init_with_value(override);
+	string_append(url + prefix_length, strlen(url + prefix_length), resolved);
+	return resolved;
+}
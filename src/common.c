@@ -1,8 +1,11 @@
 #include <stdlib.h>
+#include <string.h>
 
 #include <ctwitch/common.h>
 
 #include "utils/datagen.h"
+#include "utils/parser/parser.h"
+#include "json/json.h"
 
 /** Utils **/
 
@@ -25,3 +28,44 @@ void twitch_string_list_free(twitch_string_list *list) {
 	free(list);
 }
 
+
+/** Errors **/
+
+const twitch_error_details *twitch_error_get_details(twitch_error *error) {
+	if (error == NULL || error->details != NULL) {
+		return (error != NULL) ? error->details : NULL;
+	}
+
+	if (error->output == NULL || error->output_length == 0) {
+		return NULL;
+	}
+
+	// Error bodies are rarely looked at, so they're parsed only when asked.
+	json_value *value = json_parse(error->output, error->output_length);
+	if (value != NULL && value->type == json_object) {
+		error->details = (twitch_error_details *)parse_error_details(value);
+	}
+	FREE_CUSTOM(value, json_value_free)
+
+	return error->details;
+}
+
+void twitch_error_details_free(twitch_error_details *details) {
+	if (details == NULL) {
+		return;
+	}
+
+	FREE(details->error)
+	FREE(details->message)
+	free(details);
+}
+
+void twitch_error_clear(twitch_error *error) {
+	if (error == NULL) {
+		return;
+	}
+
+	FREE(error->output)
+	twitch_error_details_free(error->details);
+	memset(error, 0, sizeof(twitch_error));
+}
@@ -0,0 +1,439 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+
+#include "utils/datagen.h"
+#include "utils/strings/strings.h"
+#include "utils/network/helix.h"
+#include "utils/network/multi.h"
+
+#include <ctwitch/helix/batch.h>
+
+/** Data **/
+
+/**
+ * Single entity lookup.
+ */
+typedef struct helix_load {
+	char *key;
+	bool by_id;
+	twitch_helix_batch_load_callback callback;
+	void *user_data;
+	struct helix_load *next;
+} helix_load;
+
+/**
+ * Lookups of one entity type waiting to be sent.
+ */
+typedef struct helix_load_queue {
+	const helix_load_type *type;
+	helix_load *head;
+	helix_load *tail;
+	int keys;                       // Number of distinct keys.
+	struct helix_load_queue *next;
+} helix_load_queue;
+
+struct twitch_helix_batch {
+	helix_multi *multi;
+	char *client_id;
+	char *auth;
+	helix_load_queue *queues;
+	bool aborting;                  // Set while the batch is being destroyed.
+};
+
+typedef struct {
+	list_alloc_func list_alloc;
+	twitch_helix_batch_callback callback;
+	void *user_data;
+} helix_batch_request;
+
+/**
+ * Lookups sent together in one request.
+ */
+typedef struct {
+	const helix_load_type *type;
+	helix_load *loads;
+} helix_load_request;
+
+/** Lookups **/
+
+bool helix_load_key_equals(bool by_id, const char *a, const char *b) {
+	if (a == NULL || b == NULL) {
+		return false;
+	}
+
+	return by_id ? strcmp(a, b) == 0 : strcasecmp(a, b) == 0;
+}
+
+/**
+ * Checks whether there's a lookup with the same key in the list, before given
+ * one.
+ */
+bool helix_load_is_duplicate(helix_load *loads, helix_load *load) {
+	for (helix_load *other = loads; other != load; other = other->next) {
+		if (
+			other->by_id == load->by_id &&
+			helix_load_key_equals(load->by_id, other->key, load->key)
+		) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Builds the URL of a combined lookup with all distinct keys of the request.
+ */
+string_t *helix_load_url_builder(void *params, int limit, const char *after) {
+	(void)limit;
+	(void)after;
+
+	helix_load_request *request = (helix_load_request *)params;
+	bool is_first_param = true;
+
+	string_t *url = string_init_with_value(request->type->url);
+
+	for (helix_load *load = request->loads; load != NULL; load = load->next) {
+		if (helix_load_is_duplicate(request->loads, load)) {
+			continue;
+		}
+
+		char *key = url_encode(load->key);
+		string_append_format(
+			url,
+			"%s%s=%s",
+			is_first_param ? "?" : "&",
+			load->by_id ? request->type->id_param : request->type->name_param,
+			key
+		);
+		free(key);
+		is_first_param = false;
+	}
+
+	return url;
+}
+
+/**
+ * Hands the entities of a combined lookup to callbacks of lookups they
+ * match. Each lookup of a duplicate key gets its own copy, and lookups
+ * without a match get NULL.
+ */
+void helix_load_page_callback(
+	twitch_error *error,
+	void **items,
+	int count,
+	const char *next,
+	int total,
+	void *user_data
+) {
+	(void)next;
+	(void)total;
+
+	helix_load_request *request = (helix_load_request *)user_data;
+	const helix_load_type *type = request->type;
+
+	int loads_count = 0;
+	for (helix_load *load = request->loads; load != NULL; load = load->next) {
+		loads_count++;
+	}
+
+	// Match everything before the first callback, which may free its entity.
+	void **results = calloc(loads_count + 1, sizeof(void *));
+	bool *taken = calloc(count + 1, sizeof(bool));
+	if (results == NULL || taken == NULL) {
+		fprintf(stderr, "Failed to allocate memory for lookup results");
+		exit(EXIT_FAILURE);
+	}
+
+	int load_idx = 0;
+	for (helix_load *load = request->loads; load != NULL; load = load->next) {
+		for (int idx = 0; idx < count; idx++) {
+			const char *key = type->key(items[idx], load->by_id);
+			if (!helix_load_key_equals(load->by_id, key, load->key)) {
+				continue;
+			}
+
+			results[load_idx] = taken[idx]
+				? type->copy(items[idx])
+				: items[idx];
+			taken[idx] = true;
+			break;
+		}
+		load_idx++;
+	}
+
+	for (int idx = 0; idx < count; idx++) {
+		if (!taken[idx]) {
+			type->free(items[idx]);
+		}
+	}
+	FREE(items)
+	free(taken);
+
+	load_idx = 0;
+	helix_load *load = request->loads;
+	while (load != NULL) {
+		helix_load *next_load = load->next;
+		load->callback(error, results[load_idx++], load->user_data);
+		free(load->key);
+		free(load);
+		load = next_load;
+	}
+
+	free(results);
+	free(request);
+}
+
+/**
+ * Sends lookups waiting in the queue as one request.
+ */
+void helix_batch_flush_queue(
+	twitch_helix_batch *batch,
+	helix_load_queue *queue
+) {
+	helix_load_request *request = calloc(1, sizeof(helix_load_request));
+	if (request == NULL) {
+		fprintf(stderr, "Failed to allocate memory for lookup request");
+		exit(EXIT_FAILURE);
+	}
+
+	request->type = queue->type;
+	request->loads = queue->head;
+	queue->head = NULL;
+	queue->tail = NULL;
+	queue->keys = 0;
+
+	helix_multi_add_page(
+		batch->multi,
+		batch->client_id,
+		batch->auth,
+		&helix_load_url_builder,
+		(void *)request,
+		0,
+		NULL,
+		queue->type->parser,
+		&helix_load_page_callback,
+		(void *)request
+	);
+}
+
+/**
+ * Sends all lookups waiting in the batch.
+ *
+ * @return true if there were any.
+ */
+bool helix_batch_flush_loads(twitch_helix_batch *batch) {
+	bool flushed = false;
+
+	for (
+		helix_load_queue *queue = batch->queues;
+		queue != NULL;
+		queue = queue->next
+	) {
+		if (queue->head != NULL) {
+			helix_batch_flush_queue(batch, queue);
+			flushed = true;
+		}
+	}
+
+	return flushed;
+}
+
+/**
+ * Calls back lookups that were never sent with an abort error. Callbacks may
+ * add more lookups, which are aborted too.
+ */
+void helix_batch_abort_loads(twitch_helix_batch *batch) {
+	twitch_error error = { .curl_code = CURLE_ABORTED_BY_CALLBACK };
+	bool aborted = true;
+
+	while (aborted) {
+		aborted = false;
+
+		for (
+			helix_load_queue *queue = batch->queues;
+			queue != NULL;
+			queue = queue->next
+		) {
+			helix_load *load = queue->head;
+			queue->head = NULL;
+			queue->tail = NULL;
+			queue->keys = 0;
+
+			while (load != NULL) {
+				helix_load *next = load->next;
+				load->callback(&error, NULL, load->user_data);
+				free(load->key);
+				free(load);
+				load = next;
+				aborted = true;
+			}
+		}
+	}
+}
+
+/** Batch **/
+
+twitch_helix_batch *twitch_helix_batch_alloc(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth
+) {
+	twitch_helix_batch *batch = calloc(1, sizeof(twitch_helix_batch));
+	if (batch == NULL) {
+		fprintf(stderr, "Failed to allocate memory for twitch_helix_batch");
+		exit(EXIT_FAILURE);
+	}
+
+	batch->multi = helix_multi_alloc(client);
+	batch->client_id = (client_id != NULL)
+		? immutable_string_copy(client_id)
+		: NULL;
+	batch->auth = (auth != NULL) ? immutable_string_copy(auth) : NULL;
+
+	return batch;
+}
+
+void twitch_helix_batch_perform(twitch_helix_batch *batch) {
+	// Lookups are sent right before each round of transfers, so the ones
+	// added by callbacks in the meantime are combined too.
+	bool running = true;
+	while (helix_batch_flush_loads(batch) || running) {
+		running = helix_multi_step(batch->multi, 1000) > 0;
+	}
+}
+
+void twitch_helix_batch_free(twitch_helix_batch *batch) {
+	if (batch == NULL) {
+		return;
+	}
+
+	batch->aborting = true;
+	helix_multi_free(batch->multi);
+	helix_batch_abort_loads(batch);
+
+	while (batch->queues != NULL) {
+		helix_load_queue *next = batch->queues->next;
+		free(batch->queues);
+		batch->queues = next;
+	}
+
+	FREE(batch->client_id)
+	FREE(batch->auth)
+	free(batch);
+}
+
+/** Requests **/
+
+/**
+ * Wraps page results into a list struct and passes it to the user's callback.
+ */
+void helix_batch_page_callback(
+	twitch_error *error,
+	void **items,
+	int count,
+	const char *next,
+	int total,
+	void *user_data
+) {
+	(void)total;
+
+	helix_batch_request *request = (helix_batch_request *)user_data;
+
+	helix_list *list = (helix_list *)request->list_alloc();
+	list->count = count;
+	list->items = items;
+
+	request->callback(error, list, next, request->user_data);
+	free(request);
+}
+
+void helix_batch_add_page(
+	twitch_helix_batch *batch,
+	helix_page_url_builder builder,
+	void *params,
+	int limit,
+	const char *after,
+	parser_func parser,
+	list_alloc_func list_alloc,
+	twitch_helix_batch_callback callback,
+	void *user_data
+) {
+	helix_batch_request *request = calloc(1, sizeof(helix_batch_request));
+	if (request == NULL) {
+		fprintf(stderr, "Failed to allocate memory for batch request");
+		exit(EXIT_FAILURE);
+	}
+
+	request->list_alloc = list_alloc;
+	request->callback = callback;
+	request->user_data = user_data;
+
+	helix_multi_add_page(
+		batch->multi,
+		batch->client_id,
+		batch->auth,
+		builder,
+		params,
+		limit,
+		after,
+		parser,
+		&helix_batch_page_callback,
+		(void *)request
+	);
+}
+
+void helix_batch_load(
+	twitch_helix_batch *batch,
+	const helix_load_type *type,
+	bool by_id,
+	const char *key,
+	twitch_helix_batch_load_callback callback,
+	void *user_data
+) {
+	helix_load_queue *queue = batch->queues;
+	while (queue != NULL && queue->type != type) {
+		queue = queue->next;
+	}
+
+	if (queue == NULL) {
+		queue = calloc(1, sizeof(helix_load_queue));
+		if (queue == NULL) {
+			fprintf(stderr, "Failed to allocate memory for lookup queue");
+			exit(EXIT_FAILURE);
+		}
+		queue->type = type;
+		queue->next = batch->queues;
+		batch->queues = queue;
+	}
+
+	helix_load *load = calloc(1, sizeof(helix_load));
+	if (load == NULL) {
+		fprintf(stderr, "Failed to allocate memory for lookup");
+		exit(EXIT_FAILURE);
+	}
+
+	load->key = immutable_string_copy(key);
+	load->by_id = by_id;
+	load->callback = callback;
+	load->user_data = user_data;
+
+	if (queue->tail != NULL) {
+		queue->tail->next = load;
+	} else {
+		queue->head = load;
+	}
+	queue->tail = load;
+
+	if (!helix_load_is_duplicate(queue->head, load)) {
+		queue->keys++;
+	}
+
+	// Full request goes out right away, the rest waits for the next round.
+	if (queue->keys >= HELIX_LOAD_MAX_KEYS && !batch->aborting) {
+		helix_batch_flush_queue(batch, queue);
+	}
+}
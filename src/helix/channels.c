@@ -6,6 +6,7 @@
 
 #include "utils/strings/strings.h"
 #include "utils/network/helix.h"
+#include "utils/network/multi.h"
 #include "utils/parser/parser.h"
 #include "json/json.h"
 
@@ -44,6 +45,7 @@ string_t *helix_channel_followers_url_builder(
 }
 
 twitch_helix_follower_list *twitch_helix_get_channel_followers(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -62,6 +64,7 @@ twitch_helix_follower_list *twitch_helix_get_channel_followers(
 	twitch_helix_follower_list *list = twitch_helix_follower_list_alloc();
 
 	list->items = (twitch_helix_follower **)helix_get_page(
+		client,
 		client_id,
 		token,
 		error,
@@ -79,6 +82,7 @@ twitch_helix_follower_list *twitch_helix_get_channel_followers(
 }
 
 twitch_helix_follower_list *twitch_helix_get_all_channel_followers(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -94,6 +98,7 @@ twitch_helix_follower_list *twitch_helix_get_all_channel_followers(
 	twitch_helix_follower_list *list = twitch_helix_follower_list_alloc();
 
 	list->items = (twitch_helix_follower **)get_all_helix_pages(
+		client,
 		client_id,
 		token,
 		error,
@@ -126,6 +131,7 @@ string_t *helix_channel_teams_url_builder(
 }
 
 twitch_helix_team_list *twitch_helix_get_channel_teams(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -134,6 +140,7 @@ twitch_helix_team_list *twitch_helix_get_channel_teams(
 	twitch_helix_team_list *list = twitch_helix_team_list_alloc();
 
 	list->items = (twitch_helix_team **)helix_get_page(
+		client,
 		client_id,
 		token,
 		error,
@@ -150,3 +157,77 @@ twitch_helix_team_list *twitch_helix_get_channel_teams(
 	return list;
 }
 
+/** Batch requests **/
+
+void twitch_helix_batch_get_channel_followers(
+	twitch_helix_batch *batch,
+	const char *channel_id,
+	const char *user_id,
+	int first,
+	const char *after,
+	twitch_helix_batch_callback callback,
+	void *user_data
+) {
+	helix_channel_followers_params params = {
+		.broadcaster_id = channel_id,
+		.user_id = user_id,
+	};
+
+	helix_batch_add_page(
+		batch,
+		&helix_channel_followers_url_builder,
+		(void *)&params,
+		first,
+		after,
+		&parse_helix_follower,
+		(list_alloc_func)&twitch_helix_follower_list_alloc,
+		callback,
+		user_data
+	);
+}
+
+void twitch_helix_batch_get_channel_teams(
+	twitch_helix_batch *batch,
+	const char *channel_id,
+	twitch_helix_batch_callback callback,
+	void *user_data
+) {
+	helix_batch_add_page(
+		batch,
+		&helix_channel_teams_url_builder,
+		(void *)channel_id,
+		0,
+		NULL,
+		&parse_helix_team,
+		(list_alloc_func)&twitch_helix_team_list_alloc,
+		callback,
+		user_data
+	);
+}
+
+twitch_helix_page_iter *twitch_helix_iter_get_channel_followers(
+	twitch_client *client,
+	const char *client_id,
+	const char *token,
+	const char *channel_id,
+	const char *user_id,
+	int first,
+	int limit
+) {
+	helix_channel_followers_params params = {
+		.broadcaster_id = channel_id,
+		.user_id = user_id,
+	};
+
+	return helix_page_iter_alloc(
+		client,
+		client_id,
+		token,
+		&helix_channel_followers_url_builder,
+		(void *)&params,
+		&parse_helix_follower,
+		(list_alloc_func)&twitch_helix_follower_list_alloc,
+		first,
+		limit
+	);
+}
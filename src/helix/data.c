@@ -5,9 +5,16 @@
 #include "utils/datagen.h"
 #include "utils/arrays/arrays.h"
 #include "utils/data/data.h"
+#include "utils/strings/strings.h"
 
 #include <ctwitch/helix/data.h>
 
+/** Helpers **/
+
+char *helix_data_string_copy(const char *value) {
+	return (value != NULL) ? immutable_string_copy(value) : NULL;
+}
+
 /** User data */
 
 twitch_helix_user *twitch_helix_user_alloc() {
@@ -27,6 +34,21 @@ void twitch_helix_user_free(twitch_helix_user *user) {
 	free(user);
 }
 
+twitch_helix_user *twitch_helix_user_copy(const twitch_helix_user *user) {
+	twitch_helix_user *copy = twitch_helix_user_alloc();
+	copy->id = helix_data_string_copy(user->id);
+	copy->display_name = helix_data_string_copy(user->display_name);
+	copy->login = helix_data_string_copy(user->login);
+	copy->type = helix_data_string_copy(user->type);
+	copy->broadcaster_type = helix_data_string_copy(user->broadcaster_type);
+	copy->description = helix_data_string_copy(user->description);
+	copy->profile_image_url = helix_data_string_copy(user->profile_image_url);
+	copy->offline_image_url = helix_data_string_copy(user->offline_image_url);
+	copy->view_count = user->view_count;
+	copy->created_at = helix_data_string_copy(user->created_at);
+	return copy;
+}
+
 GENERIC_HELIX_LIST(user)
 
 /** Channel follows **/
@@ -81,6 +103,15 @@ void twitch_helix_game_free(twitch_helix_game *game) {
 	free(game);
 }
 
+twitch_helix_game *twitch_helix_game_copy(const twitch_helix_game *game) {
+	twitch_helix_game *copy = twitch_helix_game_alloc();
+	copy->id = helix_data_string_copy(game->id);
+	copy->igdb_id = helix_data_string_copy(game->igdb_id);
+	copy->name = helix_data_string_copy(game->name);
+	copy->box_art_url = helix_data_string_copy(game->box_art_url);
+	return copy;
+}
+
 GENERIC_HELIX_LIST(game)
 
 /** Teams **/
@@ -1,9 +1,11 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <stdbool.h>
 
 #include "utils/strings/strings.h"
 #include "utils/network/helix.h"
+#include "utils/network/multi.h"
 #include "utils/parser/parser.h"
 #include "json/json.h"
 
@@ -25,9 +27,27 @@ string_t *helix_top_games_url_builder(
 	return url;
 }
 
+/** Lookups **/
+
+const char *helix_game_load_key(void *item, bool by_id) {
+	twitch_helix_game *game = (twitch_helix_game *)item;
+	return by_id ? game->id : game->name;
+}
+
+const helix_load_type helix_game_load_type = {
+	.url = "https://api.twitch.tv/helix/games",
+	.id_param = "id",
+	.name_param = "name",
+	.parser = &parse_helix_game,
+	.key = &helix_game_load_key,
+	.copy = (void *(*)(void *))&twitch_helix_game_copy,
+	.free = (void (*)(void *))&twitch_helix_game_free
+};
+
 /** API **/
 
 twitch_helix_game_list *twitch_helix_get_top_games(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -38,6 +58,7 @@ twitch_helix_game_list *twitch_helix_get_top_games(
 	twitch_helix_game_list *list = twitch_helix_game_list_alloc();
 
 	list->items = (twitch_helix_game **)helix_get_page(
+		client,
 		client_id,
 		token,
 		error,
@@ -55,6 +76,7 @@ twitch_helix_game_list *twitch_helix_get_top_games(
 }
 
 twitch_helix_game_list *twitch_helix_get_all_top_games(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -63,6 +85,7 @@ twitch_helix_game_list *twitch_helix_get_all_top_games(
 	twitch_helix_game_list *list = twitch_helix_game_list_alloc();
 
 	list->items = (twitch_helix_game **)get_all_helix_pages(
+		client,
 		client_id,
 		token,
 		error,
@@ -76,3 +99,74 @@ twitch_helix_game_list *twitch_helix_get_all_top_games(
 	return list;
 }
 
+void twitch_helix_batch_get_top_games(
+	twitch_helix_batch *batch,
+	int first,
+	const char *after,
+	twitch_helix_batch_callback callback,
+	void *user_data
+) {
+	helix_batch_add_page(
+		batch,
+		&helix_top_games_url_builder,
+		NULL,
+		first,
+		after,
+		&parse_helix_game,
+		(list_alloc_func)&twitch_helix_game_list_alloc,
+		callback,
+		user_data
+	);
+}
+
+void twitch_helix_batch_load_game(
+	twitch_helix_batch *batch,
+	const char *id,
+	twitch_helix_batch_load_callback callback,
+	void *user_data
+) {
+	helix_batch_load(
+		batch,
+		&helix_game_load_type,
+		true,
+		id,
+		callback,
+		user_data
+	);
+}
+
+void twitch_helix_batch_load_game_by_name(
+	twitch_helix_batch *batch,
+	const char *name,
+	twitch_helix_batch_load_callback callback,
+	void *user_data
+) {
+	helix_batch_load(
+		batch,
+		&helix_game_load_type,
+		false,
+		name,
+		callback,
+		user_data
+	);
+}
+
+twitch_helix_page_iter *twitch_helix_iter_get_top_games(
+	twitch_client *client,
+	const char *client_id,
+	const char *token,
+	int first,
+	int limit
+) {
+	return helix_page_iter_alloc(
+		client,
+		client_id,
+		token,
+		&helix_top_games_url_builder,
+		NULL,
+		&parse_helix_game,
+		(list_alloc_func)&twitch_helix_game_list_alloc,
+		first,
+		limit
+	);
+}
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "utils/datagen.h"
+#include "utils/strings/strings.h"
+#include "utils/network/helix.h"
+#include "utils/network/stats.h"
+#include "json/json.h"
+
+#include <ctwitch/helix/iter.h>
+
+/** Data **/
+
+struct twitch_helix_page_iter {
+	twitch_client *client;
+	char *client_id;
+	char *auth;
+	char *url;                   // Request URL without cursor params.
+	parser_func parser;
+	list_alloc_func list_alloc;
+	int page_size;
+	int limit;
+	int count;                   // Items returned so far.
+	char *cursor;
+	bool done;
+};
+
+/** Iterator **/
+
+twitch_helix_page_iter *helix_page_iter_alloc(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	helix_page_url_builder builder,
+	void *params,
+	parser_func parser,
+	list_alloc_func list_alloc,
+	int page_size,
+	int limit
+) {
+	twitch_helix_page_iter *iter = calloc(1, sizeof(twitch_helix_page_iter));
+	if (iter == NULL) {
+		fprintf(stderr, "Failed to allocate memory for twitch_helix_page_iter");
+		exit(EXIT_FAILURE);
+	}
+
+	// Builders append cursor params at the very end of the URL, so the base URL
+	// can be built once and the params don't need to outlive this call.
+	string_t *url = builder(params, 0, NULL);
+
+	iter->client = client;
+	iter->client_id = (client_id != NULL)
+		? immutable_string_copy(client_id)
+		: NULL;
+	iter->auth = (auth != NULL) ? immutable_string_copy(auth) : NULL;
+	iter->url = immutable_string_copy(url->ptr);
+	iter->parser = parser;
+	iter->list_alloc = list_alloc;
+	iter->page_size = page_size;
+	iter->limit = limit;
+
+	string_free(url);
+
+	return iter;
+}
+
+void *twitch_helix_page_iter_next(
+	twitch_helix_page_iter *iter,
+	twitch_error *error
+) {
+	helix_reset_error(error);
+
+	if (iter->done) {
+		return NULL;
+	}
+
+	// Don't request more than needed to reach the limit.
+	int page_size = iter->page_size;
+	if (iter->limit > 0) {
+		int remaining = iter->limit - iter->count;
+		if (page_size == 0 || remaining < page_size) {
+			page_size = remaining;
+		}
+	}
+
+	string_t *url = string_init_with_value(iter->url);
+	helix_append_cursor_params(
+		url,
+		page_size,
+		iter->cursor,
+		strchr(iter->url, '?') == NULL
+	);
+
+	char *next = NULL;
+	helix_list *list = (helix_list *)iter->list_alloc();
+	list->items = helix_fetch_page(
+		iter->client,
+		iter->client_id,
+		iter->auth,
+		error,
+		url->ptr,
+		iter->parser,
+		&list->count,
+		&next,
+		NULL
+	);
+	string_free(url);
+
+	FREE(iter->cursor)
+	iter->cursor = next;
+	iter->count += list->count;
+
+	if (
+		next == NULL ||
+		list->count == 0 ||
+		(iter->limit > 0 && iter->count >= iter->limit)
+	) {
+		iter->done = true;
+	}
+
+	// Empty page means the end of the collection or an error.
+	if (list->count == 0) {
+		FREE(list->items)
+		free(list);
+		return NULL;
+	}
+
+	return list;
+}
+
+int twitch_helix_page_iter_count(twitch_helix_page_iter *iter) {
+	return iter->count;
+}
+
+void twitch_helix_page_iter_free(twitch_helix_page_iter *iter) {
+	if (iter == NULL) {
+		return;
+	}
+
+	FREE(iter->client_id)
+	FREE(iter->auth)
+	FREE(iter->url)
+	FREE(iter->cursor)
+	free(iter);
+}
@@ -37,6 +37,7 @@ string_t *helix_categories_url_builder(
 }
 
 twitch_helix_category_list *twitch_helix_get_categories(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -48,6 +49,7 @@ twitch_helix_category_list *twitch_helix_get_categories(
 	twitch_helix_category_list *list = twitch_helix_category_list_alloc();
 
 	list->items = (twitch_helix_category **)helix_get_page(
+		client,
 		client_id,
 		token,
 		error,
@@ -65,6 +67,7 @@ twitch_helix_category_list *twitch_helix_get_categories(
 }
 
 twitch_helix_category_list *twitch_helix_get_all_categories(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -74,6 +77,7 @@ twitch_helix_category_list *twitch_helix_get_all_categories(
 	twitch_helix_category_list *list = twitch_helix_category_list_alloc();
 
 	list->items = (twitch_helix_category **)get_all_helix_pages(
+		client,
 		client_id,
 		token,
 		error,
@@ -122,6 +126,7 @@ string_t *helix_channel_search_url_builder(
 }
 
 twitch_helix_channel_search_item_list *twitch_helix_search_channels(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -140,6 +145,7 @@ twitch_helix_channel_search_item_list *twitch_helix_search_channels(
 		twitch_helix_channel_search_item_list_alloc();
 
 	list->items = (twitch_helix_channel_search_item **)helix_get_page(
+		client,
 		client_id,
 		token,
 		error,
@@ -157,6 +163,7 @@ twitch_helix_channel_search_item_list *twitch_helix_search_channels(
 }
 
 twitch_helix_channel_search_item_list *twitch_helix_search_all_channels(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -173,6 +180,7 @@ twitch_helix_channel_search_item_list *twitch_helix_search_all_channels(
 		twitch_helix_channel_search_item_list_alloc();
 
 	list->items = (twitch_helix_channel_search_item **)get_all_helix_pages(
+		client,
 		client_id,
 		token,
 		error,
@@ -186,3 +194,50 @@ twitch_helix_channel_search_item_list *twitch_helix_search_all_channels(
 	return list;
 }
 
+twitch_helix_page_iter *twitch_helix_iter_get_categories(
+	twitch_client *client,
+	const char *client_id,
+	const char *token,
+	const char *query,
+	int first,
+	int limit
+) {
+	return helix_page_iter_alloc(
+		client,
+		client_id,
+		token,
+		&helix_categories_url_builder,
+		(void *)query,
+		&parse_helix_category,
+		(list_alloc_func)&twitch_helix_category_list_alloc,
+		first,
+		limit
+	);
+}
+
+twitch_helix_page_iter *twitch_helix_iter_search_channels(
+	twitch_client *client,
+	const char *client_id,
+	const char *token,
+	const char *query,
+	int live_only,
+	int first,
+	int limit
+) {
+	twitch_channel_search_params params = {
+		.query = query,
+		.live_only = live_only
+	};
+
+	return helix_page_iter_alloc(
+		client,
+		client_id,
+		token,
+		&helix_channel_search_url_builder,
+		(void *)&params,
+		&parse_helix_channel_search_item,
+		(list_alloc_func)&twitch_helix_channel_search_item_list_alloc,
+		first,
+		limit
+	);
+}
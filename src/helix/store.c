@@ -0,0 +1,835 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "utils/datagen.h"
+#include "utils/strings/strings.h"
+
+#include <ctwitch/helix/data.h>
+#include <ctwitch/helix/users.h>
+#include <ctwitch/helix/store.h>
+
+/**
+ * Store file layout. All numbers are 32-bit in host byte order, all offsets
+ * are relative to the start of the file.
+ *
+ *   header
+ *   user records       user_count * USER_FIELDS numbers
+ *   users by login     user_count record numbers sorted by login
+ *   users by ID        user_count record numbers sorted by ID
+ *   game records       game_count * GAME_FIELDS numbers
+ *   games by ID        game_count record numbers sorted by ID
+ *   games by name      game_count record numbers sorted by name
+ *   strings            null-terminated strings
+ *
+ * Record fields are offsets of strings in the strings pool, or NO_STRING for
+ * NULL values, except user's view count, which is stored as is.
+ */
+
+#define STORE_MAGIC "CTWS"
+#define STORE_VERSION 1
+#define NO_STRING UINT32_MAX
+
+#define USER_FIELDS 10
+#define USER_ID 0
+#define USER_LOGIN 2
+#define USER_VIEW_COUNT 9
+
+#define GAME_FIELDS 4
+#define GAME_ID 0
+#define GAME_NAME 2
+
+/** Data **/
+
+typedef struct {
+	char magic[4];
+	uint32_t version;
+	uint32_t user_count;
+	uint32_t game_count;
+	uint32_t users;
+	uint32_t users_by_login;
+	uint32_t users_by_id;
+	uint32_t games;
+	uint32_t games_by_id;
+	uint32_t games_by_name;
+	uint32_t strings;
+	uint32_t strings_size;
+} helix_store_header;
+
+struct twitch_helix_store {
+	char *path;
+	void *map;                        // Mapped file, or NULL.
+	size_t map_size;
+	const helix_store_header *header;
+	twitch_helix_user_list *users;    // Users added since the file was mapped.
+	twitch_helix_game_list *games;    // Games added since the file was mapped.
+};
+
+/** Helpers **/
+
+char *helix_store_copy(const char *value) {
+	return (value != NULL) ? immutable_string_copy(value) : NULL;
+}
+
+bool helix_store_equals(const char *a, const char *b) {
+	return a != NULL && b != NULL && strcmp(a, b) == 0;
+}
+
+/**
+ * Appends an item to a generic list, growing it by one.
+ */
+void helix_store_list_append(int *count, void ***items, void *item) {
+	*items = realloc(*items, sizeof(void *) * (*count + 1));
+	if (*items == NULL) {
+		fprintf(stderr, "Failed to allocate memory for store records.\n");
+		exit(EXIT_FAILURE);
+	}
+	(*items)[(*count)++] = item;
+}
+
+/** Mapped file **/
+
+const uint32_t *helix_store_table(twitch_helix_store *store, uint32_t offset) {
+	return (const uint32_t *)((const char *)store->map + offset);
+}
+
+const char *helix_store_string(twitch_helix_store *store, uint32_t offset) {
+	if (offset == NO_STRING) {
+		return NULL;
+	}
+	return (const char *)store->map + store->header->strings + offset;
+}
+
+bool helix_store_table_fits(
+	size_t size,
+	uint32_t offset,
+	uint32_t count,
+	uint32_t fields
+) {
+	return offset % sizeof(uint32_t) == 0 &&
+		(uint64_t)offset + (uint64_t)count * fields * sizeof(uint32_t) <= size;
+}
+
+/**
+ * Checks that the mapped file is a valid store file, so lookups don't have to.
+ */
+bool helix_store_validate(const void *map, size_t size) {
+	if (size < sizeof(helix_store_header)) {
+		return false;
+	}
+
+	const helix_store_header *header = (const helix_store_header *)map;
+	if (
+		memcmp(header->magic, STORE_MAGIC, 4) != 0 ||
+		header->version != STORE_VERSION
+	) {
+		return false;
+	}
+
+	uint32_t users = header->user_count, games = header->game_count;
+	if (
+		!helix_store_table_fits(size, header->users, users, USER_FIELDS) ||
+		!helix_store_table_fits(size, header->users_by_login, users, 1) ||
+		!helix_store_table_fits(size, header->users_by_id, users, 1) ||
+		!helix_store_table_fits(size, header->games, games, GAME_FIELDS) ||
+		!helix_store_table_fits(size, header->games_by_id, games, 1) ||
+		!helix_store_table_fits(size, header->games_by_name, games, 1) ||
+		(uint64_t)header->strings + header->strings_size > size
+	) {
+		return false;
+	}
+
+	// Every string must end within the pool.
+	const char *strings = (const char *)map + header->strings;
+	if (header->strings_size > 0 && strings[header->strings_size - 1] != '\0') {
+		return false;
+	}
+
+	const uint32_t *records[2] = {
+		(const uint32_t *)((const char *)map + header->users),
+		(const uint32_t *)((const char *)map + header->games)
+	};
+	uint32_t counts[2] = { users * USER_FIELDS, games * GAME_FIELDS };
+	for (int table = 0; table < 2; table++) {
+		for (uint32_t idx = 0; idx < counts[table]; idx++) {
+			if (table == 0 && idx % USER_FIELDS == USER_VIEW_COUNT) {
+				continue;
+			}
+
+			uint32_t offset = records[table][idx];
+			if (offset != NO_STRING && offset >= header->strings_size) {
+				return false;
+			}
+		}
+	}
+
+	const uint32_t *indices[4] = {
+		(const uint32_t *)((const char *)map + header->users_by_login),
+		(const uint32_t *)((const char *)map + header->users_by_id),
+		(const uint32_t *)((const char *)map + header->games_by_id),
+		(const uint32_t *)((const char *)map + header->games_by_name)
+	};
+	for (int index = 0; index < 4; index++) {
+		uint32_t count = (index < 2) ? users : games;
+		for (uint32_t idx = 0; idx < count; idx++) {
+			if (indices[index][idx] >= count) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void helix_store_map(twitch_helix_store *store) {
+	int fd = open(store->path, O_RDONLY);
+	if (fd < 0) {
+		return;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		return;
+	}
+
+	void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (map == MAP_FAILED) {
+		return;
+	}
+
+	if (!helix_store_validate(map, st.st_size)) {
+		munmap(map, st.st_size);
+		return;
+	}
+
+	store->map = map;
+	store->map_size = st.st_size;
+	store->header = (const helix_store_header *)map;
+}
+
+void helix_store_unmap(twitch_helix_store *store) {
+	if (store->map != NULL) {
+		munmap(store->map, store->map_size);
+	}
+
+	store->map = NULL;
+	store->map_size = 0;
+	store->header = NULL;
+}
+
+/**
+ * Binary searches a sorted index of the mapped file.
+ *
+ * @param store Store instance.
+ * @param records Offset of the records table.
+ * @param fields Number of fields in a record.
+ * @param index Offset of the index table.
+ * @param count Number of records.
+ * @param field Key field of the index.
+ * @param key Key to search for.
+ *
+ * @return Pointer to the found record, or NULL.
+ */
+const uint32_t *helix_store_find(
+	twitch_helix_store *store,
+	uint32_t records,
+	int fields,
+	uint32_t index,
+	uint32_t count,
+	int field,
+	const char *key
+) {
+	if (store->map == NULL || key == NULL) {
+		return NULL;
+	}
+
+	const uint32_t *table = helix_store_table(store, records);
+	const uint32_t *sorted = helix_store_table(store, index);
+
+	uint32_t low = 0, high = count;
+	while (low < high) {
+		uint32_t mid = low + (high - low) / 2;
+		const uint32_t *record = &table[sorted[mid] * fields];
+		const char *value = helix_store_string(store, record[field]);
+
+		int order = (value != NULL) ? strcmp(value, key) : -1;
+		if (order == 0) {
+			return record;
+		} else if (order < 0) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	return NULL;
+}
+
+twitch_helix_user *helix_store_read_user(
+	twitch_helix_store *store,
+	const uint32_t *record
+) {
+	twitch_helix_user *user = twitch_helix_user_alloc();
+	user->id = helix_store_copy(helix_store_string(store, record[0]));
+	user->display_name = helix_store_copy(helix_store_string(store, record[1]));
+	user->login = helix_store_copy(helix_store_string(store, record[2]));
+	user->type = helix_store_copy(helix_store_string(store, record[3]));
+	user->broadcaster_type =
+		helix_store_copy(helix_store_string(store, record[4]));
+	user->description = helix_store_copy(helix_store_string(store, record[5]));
+	user->profile_image_url =
+		helix_store_copy(helix_store_string(store, record[6]));
+	user->offline_image_url =
+		helix_store_copy(helix_store_string(store, record[7]));
+	user->created_at = helix_store_copy(helix_store_string(store, record[8]));
+	user->view_count = (int32_t)record[USER_VIEW_COUNT];
+	return user;
+}
+
+twitch_helix_game *helix_store_read_game(
+	twitch_helix_store *store,
+	const uint32_t *record
+) {
+	twitch_helix_game *game = twitch_helix_game_alloc();
+	game->id = helix_store_copy(helix_store_string(store, record[0]));
+	game->igdb_id = helix_store_copy(helix_store_string(store, record[1]));
+	game->name = helix_store_copy(helix_store_string(store, record[2]));
+	game->box_art_url = helix_store_copy(helix_store_string(store, record[3]));
+	return game;
+}
+
+/** Writing **/
+
+uint32_t helix_store_pool_add(string_t *pool, const char *value) {
+	if (value == NULL) {
+		return NO_STRING;
+	}
+
+	uint32_t offset = (uint32_t)pool->len;
+	string_append(value, strlen(value) + 1, pool);
+	return offset;
+}
+
+typedef struct {
+	const char *key;
+	uint32_t record;
+} helix_store_sort_item;
+
+int helix_store_sort_compare(const void *a, const void *b) {
+	const helix_store_sort_item *ia = (const helix_store_sort_item *)a;
+	const helix_store_sort_item *ib = (const helix_store_sort_item *)b;
+
+	if (ia->key == NULL || ib->key == NULL) {
+		return (ia->key != NULL) - (ib->key != NULL);
+	}
+	return strcmp(ia->key, ib->key);
+}
+
+/**
+ * Writes record numbers sorted by given key.
+ */
+void helix_store_write_index(
+	string_t *output,
+	int count,
+	const char **keys
+) {
+	helix_store_sort_item *items = malloc(
+		sizeof(helix_store_sort_item) * (count > 0 ? count : 1)
+	);
+	if (items == NULL) {
+		fprintf(stderr, "Failed to allocate memory for store index.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (int idx = 0; idx < count; idx++) {
+		items[idx].key = keys[idx];
+		items[idx].record = idx;
+	}
+
+	qsort(items, count, sizeof(helix_store_sort_item), helix_store_sort_compare);
+
+	for (int idx = 0; idx < count; idx++) {
+		string_append((const char *)&items[idx].record, sizeof(uint32_t), output);
+	}
+
+	free(items);
+}
+
+/** API **/
+
+twitch_helix_store *twitch_helix_store_open(const char *path) {
+	twitch_helix_store *store = calloc(1, sizeof(twitch_helix_store));
+	if (store == NULL) {
+		fprintf(stderr, "Failed to allocate memory for twitch_helix_store");
+		exit(EXIT_FAILURE);
+	}
+
+	store->path = immutable_string_copy(path);
+	store->users = twitch_helix_user_list_alloc();
+	store->games = twitch_helix_game_list_alloc();
+
+	helix_store_map(store);
+
+	return store;
+}
+
+void twitch_helix_store_close(twitch_helix_store *store) {
+	if (store == NULL) {
+		return;
+	}
+
+	helix_store_unmap(store);
+	twitch_helix_user_list_free(store->users);
+	twitch_helix_game_list_free(store->games);
+	FREE(store->path);
+	free(store);
+}
+
+twitch_helix_user *twitch_helix_store_get_user(
+	twitch_helix_store *store,
+	const char *login
+) {
+	// Records added since opening are newer than the file.
+	for (int idx = store->users->count - 1; idx >= 0; idx--) {
+		const char *value = store->users->items[idx]->login;
+		if (value != NULL && login != NULL && strcasecmp(value, login) == 0) {
+			return twitch_helix_user_copy(store->users->items[idx]);
+		}
+	}
+
+	if (store->map == NULL || login == NULL) {
+		return NULL;
+	}
+
+	// Logins are case-insensitive, and the API returns them in lower case.
+	char *key = immutable_string_copy(login);
+	for (char *chr = key; *chr != '\0'; chr++) {
+		*chr = tolower((unsigned char)*chr);
+	}
+
+	const uint32_t *record = helix_store_find(
+		store,
+		store->header->users,
+		USER_FIELDS,
+		store->header->users_by_login,
+		store->header->user_count,
+		USER_LOGIN,
+		key
+	);
+	free(key);
+
+	return (record != NULL) ? helix_store_read_user(store, record) : NULL;
+}
+
+twitch_helix_user *twitch_helix_store_get_user_by_id(
+	twitch_helix_store *store,
+	const char *id
+) {
+	for (int idx = store->users->count - 1; idx >= 0; idx--) {
+		if (helix_store_equals(store->users->items[idx]->id, id)) {
+			return twitch_helix_user_copy(store->users->items[idx]);
+		}
+	}
+
+	if (store->map == NULL) {
+		return NULL;
+	}
+
+	const uint32_t *record = helix_store_find(
+		store,
+		store->header->users,
+		USER_FIELDS,
+		store->header->users_by_id,
+		store->header->user_count,
+		USER_ID,
+		id
+	);
+
+	return (record != NULL) ? helix_store_read_user(store, record) : NULL;
+}
+
+twitch_helix_game *twitch_helix_store_get_game(
+	twitch_helix_store *store,
+	const char *id
+) {
+	for (int idx = store->games->count - 1; idx >= 0; idx--) {
+		if (helix_store_equals(store->games->items[idx]->id, id)) {
+			return twitch_helix_game_copy(store->games->items[idx]);
+		}
+	}
+
+	if (store->map == NULL) {
+		return NULL;
+	}
+
+	const uint32_t *record = helix_store_find(
+		store,
+		store->header->games,
+		GAME_FIELDS,
+		store->header->games_by_id,
+		store->header->game_count,
+		GAME_ID,
+		id
+	);
+
+	return (record != NULL) ? helix_store_read_game(store, record) : NULL;
+}
+
+twitch_helix_game *twitch_helix_store_get_game_by_name(
+	twitch_helix_store *store,
+	const char *name
+) {
+	for (int idx = store->games->count - 1; idx >= 0; idx--) {
+		if (helix_store_equals(store->games->items[idx]->name, name)) {
+			return twitch_helix_game_copy(store->games->items[idx]);
+		}
+	}
+
+	if (store->map == NULL) {
+		return NULL;
+	}
+
+	const uint32_t *record = helix_store_find(
+		store,
+		store->header->games,
+		GAME_FIELDS,
+		store->header->games_by_name,
+		store->header->game_count,
+		GAME_NAME,
+		name
+	);
+
+	return (record != NULL) ? helix_store_read_game(store, record) : NULL;
+}
+
+void twitch_helix_store_put_user(
+	twitch_helix_store *store,
+	twitch_helix_user *user
+) {
+	if (user == NULL || user->id == NULL) {
+		return;
+	}
+
+	twitch_helix_user *copy = twitch_helix_user_copy(user);
+
+	for (int idx = 0; idx < store->users->count; idx++) {
+		if (helix_store_equals(store->users->items[idx]->id, user->id)) {
+			twitch_helix_user_free(store->users->items[idx]);
+			store->users->items[idx] = copy;
+			return;
+		}
+	}
+
+	helix_store_list_append(
+		&store->users->count,
+		(void ***)&store->users->items,
+		copy
+	);
+}
+
+void twitch_helix_store_put_game(
+	twitch_helix_store *store,
+	twitch_helix_game *game
+) {
+	if (game == NULL || game->id == NULL) {
+		return;
+	}
+
+	twitch_helix_game *copy = twitch_helix_game_copy(game);
+
+	for (int idx = 0; idx < store->games->count; idx++) {
+		if (helix_store_equals(store->games->items[idx]->id, game->id)) {
+			twitch_helix_game_free(store->games->items[idx]);
+			store->games->items[idx] = copy;
+			return;
+		}
+	}
+
+	helix_store_list_append(
+		&store->games->count,
+		(void ***)&store->games->items,
+		copy
+	);
+}
+
+bool twitch_helix_store_save(twitch_helix_store *store) {
+	// Collect all records: the new ones, then the mapped ones they don't
+	// replace. Pointers into the map stay valid until it's unmapped.
+	twitch_helix_user_list *users = twitch_helix_user_list_alloc();
+	twitch_helix_game_list *games = twitch_helix_game_list_alloc();
+
+	for (int idx = 0; idx < store->users->count; idx++) {
+		helix_store_list_append(
+			&users->count,
+			(void ***)&users->items,
+			twitch_helix_user_copy(store->users->items[idx])
+		);
+	}
+	for (int idx = 0; idx < store->games->count; idx++) {
+		helix_store_list_append(
+			&games->count,
+			(void ***)&games->items,
+			twitch_helix_game_copy(store->games->items[idx])
+		);
+	}
+
+	if (store->map != NULL) {
+		const uint32_t *records = helix_store_table(store, store->header->users);
+		for (uint32_t idx = 0; idx < store->header->user_count; idx++) {
+			const uint32_t *record = &records[idx * USER_FIELDS];
+			const char *id = helix_store_string(store, record[USER_ID]);
+
+			bool replaced = false;
+			for (int new_idx = 0; new_idx < store->users->count; new_idx++) {
+				if (helix_store_equals(store->users->items[new_idx]->id, id)) {
+					replaced = true;
+					break;
+				}
+			}
+
+			if (!replaced) {
+				helix_store_list_append(
+					&users->count,
+					(void ***)&users->items,
+					helix_store_read_user(store, record)
+				);
+			}
+		}
+
+		records = helix_store_table(store, store->header->games);
+		for (uint32_t idx = 0; idx < store->header->game_count; idx++) {
+			const uint32_t *record = &records[idx * GAME_FIELDS];
+			const char *id = helix_store_string(store, record[GAME_ID]);
+
+			bool replaced = false;
+			for (int new_idx = 0; new_idx < store->games->count; new_idx++) {
+				if (helix_store_equals(store->games->items[new_idx]->id, id)) {
+					replaced = true;
+					break;
+				}
+			}
+
+			if (!replaced) {
+				helix_store_list_append(
+					&games->count,
+					(void ***)&games->items,
+					helix_store_read_game(store, record)
+				);
+			}
+		}
+	}
+
+	// Serialize records and strings.
+	string_t *pool = string_init();
+	string_t *user_records = string_init();
+	string_t *game_records = string_init();
+	const char **user_logins = malloc(sizeof(char *) * (users->count + 1));
+	const char **user_ids = malloc(sizeof(char *) * (users->count + 1));
+	const char **game_ids = malloc(sizeof(char *) * (games->count + 1));
+	const char **game_names = malloc(sizeof(char *) * (games->count + 1));
+	if (
+		user_logins == NULL || user_ids == NULL ||
+		game_ids == NULL || game_names == NULL
+	) {
+		fprintf(stderr, "Failed to allocate memory for store keys.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (int idx = 0; idx < users->count; idx++) {
+		twitch_helix_user *user = users->items[idx];
+		uint32_t record[USER_FIELDS] = {
+			helix_store_pool_add(pool, user->id),
+			helix_store_pool_add(pool, user->display_name),
+			helix_store_pool_add(pool, user->login),
+			helix_store_pool_add(pool, user->type),
+			helix_store_pool_add(pool, user->broadcaster_type),
+			helix_store_pool_add(pool, user->description),
+			helix_store_pool_add(pool, user->profile_image_url),
+			helix_store_pool_add(pool, user->offline_image_url),
+			helix_store_pool_add(pool, user->created_at),
+			(uint32_t)user->view_count
+		};
+		string_append((const char *)record, sizeof(record), user_records);
+		user_logins[idx] = user->login;
+		user_ids[idx] = user->id;
+	}
+
+	for (int idx = 0; idx < games->count; idx++) {
+		twitch_helix_game *game = games->items[idx];
+		uint32_t record[GAME_FIELDS] = {
+			helix_store_pool_add(pool, game->id),
+			helix_store_pool_add(pool, game->igdb_id),
+			helix_store_pool_add(pool, game->name),
+			helix_store_pool_add(pool, game->box_art_url)
+		};
+		string_append((const char *)record, sizeof(record), game_records);
+		game_ids[idx] = game->id;
+		game_names[idx] = game->name;
+	}
+
+	helix_store_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, STORE_MAGIC, 4);
+	header.version = STORE_VERSION;
+	header.user_count = users->count;
+	header.game_count = games->count;
+
+	string_t *output = string_init();
+	string_append((const char *)&header, sizeof(header), output);
+
+	header.users = output->len;
+	string_append(user_records->ptr, user_records->len, output);
+	header.users_by_login = output->len;
+	helix_store_write_index(output, users->count, user_logins);
+	header.users_by_id = output->len;
+	helix_store_write_index(output, users->count, user_ids);
+
+	header.games = output->len;
+	string_append(game_records->ptr, game_records->len, output);
+	header.games_by_id = output->len;
+	helix_store_write_index(output, games->count, game_ids);
+	header.games_by_name = output->len;
+	helix_store_write_index(output, games->count, game_names);
+
+	header.strings = output->len;
+	header.strings_size = pool->len;
+	string_append(pool->ptr, pool->len, output);
+
+	memcpy(output->ptr, &header, sizeof(header));
+
+	// Write next to the old file and swap them.
+	string_t *temp_path = string_init_with_value(store->path);
+	string_append(".tmp", 4, temp_path);
+
+	bool success = false;
+	FILE *file = fopen(temp_path->ptr, "wb");
+	if (file != NULL) {
+		success = fwrite(output->ptr, 1, output->len, file) == output->len;
+		success = (fclose(file) == 0) && success;
+	}
+
+	if (success) {
+		success = rename(temp_path->ptr, store->path) == 0;
+	} else {
+		remove(temp_path->ptr);
+	}
+
+	// Everything is in the file now, so start over from it.
+	if (success) {
+		helix_store_unmap(store);
+		helix_store_map(store);
+
+		twitch_helix_user_list_free(store->users);
+		twitch_helix_game_list_free(store->games);
+		store->users = twitch_helix_user_list_alloc();
+		store->games = twitch_helix_game_list_alloc();
+	}
+
+	string_free(temp_path);
+	string_free(output);
+	string_free(pool);
+	string_free(user_records);
+	string_free(game_records);
+	free(user_logins);
+	free(user_ids);
+	free(game_ids);
+	free(game_names);
+	twitch_helix_user_list_free(users);
+	twitch_helix_game_list_free(games);
+
+	return success;
+}
+
+twitch_helix_user_list *twitch_helix_store_get_users(
+	twitch_helix_store *store,
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	twitch_error *error,
+	int logins_count,
+	const char **logins
+) {
+	if (store == NULL) {
+		return twitch_helix_get_users(
+			client,
+			client_id,
+			auth,
+			error,
+			logins_count,
+			logins
+		);
+	}
+
+	twitch_helix_user **found = calloc(
+		logins_count > 0 ? logins_count : 1,
+		sizeof(twitch_helix_user *)
+	);
+	const char **missing = malloc(
+		sizeof(char *) * (logins_count > 0 ? logins_count : 1)
+	);
+	if (found == NULL || missing == NULL) {
+		fprintf(stderr, "Failed to allocate memory for users lookup.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	int missing_count = 0;
+	for (int idx = 0; idx < logins_count; idx++) {
+		found[idx] = twitch_helix_store_get_user(store, logins[idx]);
+		if (found[idx] == NULL) {
+			missing[missing_count++] = logins[idx];
+		}
+	}
+
+	// Request only the users that aren't in the store.
+	if (missing_count > 0) {
+		twitch_helix_user_list *fetched = twitch_helix_get_users(
+			client,
+			client_id,
+			auth,
+			error,
+			missing_count,
+			missing
+		);
+
+		for (int idx = 0; idx < fetched->count; idx++) {
+			twitch_helix_user *user = fetched->items[idx];
+			twitch_helix_store_put_user(store, user);
+
+			for (int login_idx = 0; login_idx < logins_count; login_idx++) {
+				if (
+					found[login_idx] == NULL &&
+					user->login != NULL &&
+					strcasecmp(logins[login_idx], user->login) == 0
+				) {
+					found[login_idx] = twitch_helix_user_copy(user);
+				}
+			}
+		}
+
+		twitch_helix_user_list_free(fetched);
+	}
+
+	// Pack the results in the order of given logins.
+	twitch_helix_user_list *list = twitch_helix_user_list_alloc();
+	for (int idx = 0; idx < logins_count; idx++) {
+		if (found[idx] != NULL) {
+			helix_store_list_append(&list->count, (void ***)&list->items, found[idx]);
+		}
+	}
+
+	free(found);
+	free(missing);
+
+	return list;
+}
@@ -6,6 +6,7 @@
 
 #include "utils/strings/strings.h"
 #include "utils/network/helix.h"
+#include "utils/network/multi.h"
 #include "utils/parser/parser.h"
 #include "json/json.h"
 
@@ -78,7 +79,96 @@ string_t *helix_streams_url_builder(
 	return url;
 }
 
+/** Sharding **/
+
+/**
+ * Splits the query into shards of up to MAX_USERS_COUNT user IDs or logins
+ * each, and downloads all of them in parallel.
+ *
+ * @param client Client context. Can be NULL.
+ * @param client_id Twitch API client ID.
+ * @param auth Authorization token.
+ * @param error Error holder struct.
+ * @param params Original query params.
+ * @param size Returns number of downloaded streams.
+ *
+ * @return Array of streams in the order of given IDs and logins shards.
+ */
+void **helix_get_sharded_streams(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	twitch_error *error,
+	helix_streams_params *params,
+	int *size
+) {
+	int users_shards =
+		(params->users_count + MAX_USERS_COUNT - 1) / MAX_USERS_COUNT;
+	int logins_shards =
+		(params->logins_count + MAX_USERS_COUNT - 1) / MAX_USERS_COUNT;
+	int shards_count = users_shards + logins_shards;
+
+	helix_streams_params *shards = calloc(
+		shards_count,
+		sizeof(helix_streams_params)
+	);
+	void **shard_params = malloc(sizeof(void *) * shards_count);
+	if (shards == NULL || shard_params == NULL) {
+		fprintf(stderr, "Failed to allocate memory for shards.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (int idx = 0; idx < shards_count; idx++) {
+		helix_streams_params *shard = &shards[idx];
+		shard->game_id = params->game_id;
+		shard->language = params->language;
+
+		if (idx < users_shards) {
+			int offset = idx * MAX_USERS_COUNT;
+			shard->users = &params->users[offset];
+			shard->users_count = params->users_count - offset;
+		} else {
+			int offset = (idx - users_shards) * MAX_USERS_COUNT;
+			shard->logins = &params->logins[offset];
+			shard->logins_count = params->logins_count - offset;
+		}
+
+		// The builder takes only first MAX_USERS_COUNT items anyway.
+		if (shard->users_count > MAX_USERS_COUNT) {
+			shard->users_count = MAX_USERS_COUNT;
+		}
+		if (shard->logins_count > MAX_USERS_COUNT) {
+			shard->logins_count = MAX_USERS_COUNT;
+		}
+
+		shard_params[idx] = (void *)shard;
+	}
+
+	// Each shard can't have more live streams than users, so it should fit into
+	// one page of MAX_USERS_COUNT items.
+	void **items = helix_get_all_pages_parallel(
+		client,
+		client_id,
+		auth,
+		error,
+		&helix_streams_url_builder,
+		shards_count,
+		shard_params,
+		MAX_USERS_COUNT,
+		&parse_helix_stream,
+		size
+	);
+
+	free(shard_params);
+	free(shards);
+
+	return items;
+}
+
+/** API **/
+
 twitch_helix_stream_list *twitch_helix_get_streams(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -104,6 +194,7 @@ twitch_helix_stream_list *twitch_helix_get_streams(
 
 	twitch_helix_stream_list *list = twitch_helix_stream_list_alloc();
 	list->items = (twitch_helix_stream **)helix_get_page(
+		client,
 		client_id,
 		auth,
 		error,
@@ -120,6 +211,7 @@ twitch_helix_stream_list *twitch_helix_get_streams(
 }
 
 twitch_helix_stream_list *twitch_helix_get_all_streams(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -140,7 +232,22 @@ twitch_helix_stream_list *twitch_helix_get_all_streams(
 	};
 
 	twitch_helix_stream_list *streams = twitch_helix_stream_list_alloc();
+
+	// Queries that don't fit into one request are split into parallel shards.
+	if (users_count > MAX_USERS_COUNT || logins_count > MAX_USERS_COUNT) {
+		streams->items = (twitch_helix_stream **)helix_get_sharded_streams(
+			client,
+			client_id,
+			auth,
+			error,
+			&params,
+			&streams->count
+		);
+		return streams;
+	}
+
 	streams->items = (twitch_helix_stream **)get_all_helix_pages(
+		client,
 		client_id,
 		auth,
 		error,
@@ -153,3 +260,73 @@ twitch_helix_stream_list *twitch_helix_get_all_streams(
 
 	return streams;
 }
+
+void twitch_helix_batch_get_streams(
+	twitch_helix_batch *batch,
+	const char *game_id,
+	const char *language,
+	int users_count,
+	const char **users,
+	int logins_count,
+	const char **logins,
+	int limit,
+	const char *after,
+	twitch_helix_batch_callback callback,
+	void *user_data
+) {
+	helix_streams_params params = {
+		.game_id = game_id,
+		.language = language,
+		.logins_count = logins_count,
+		.logins = logins,
+		.users_count = users_count,
+		.users = users
+	};
+
+	helix_batch_add_page(
+		batch,
+		&helix_streams_url_builder,
+		(void *)&params,
+		limit,
+		after,
+		&parse_helix_stream,
+		(list_alloc_func)&twitch_helix_stream_list_alloc,
+		callback,
+		user_data
+	);
+}
+
+twitch_helix_page_iter *twitch_helix_iter_get_streams(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	const char *game_id,
+	const char *language,
+	int users_count,
+	const char **users,
+	int logins_count,
+	const char **logins,
+	int first,
+	int limit
+) {
+	helix_streams_params params = {
+		.game_id = game_id,
+		.language = language,
+		.logins_count = logins_count,
+		.logins = logins,
+		.users_count = users_count,
+		.users = users
+	};
+
+	return helix_page_iter_alloc(
+		client,
+		client_id,
+		auth,
+		&helix_streams_url_builder,
+		(void *)&params,
+		&parse_helix_stream,
+		(list_alloc_func)&twitch_helix_stream_list_alloc,
+		first,
+		limit
+	);
+}
@@ -6,6 +6,7 @@
 
 #include "utils/strings/strings.h"
 #include "utils/network/helix.h"
+#include "utils/network/stats.h"
 #include "utils/parser/parser.h"
 #include "json/json.h"
 
@@ -36,6 +37,7 @@ string_t *helix_team_url_builder(void *params) {
 /** API **/
 
 twitch_helix_team *twitch_helix_get_team(
+	twitch_client *client,
 	const char *client_id,
 	const char *bearer,
 	twitch_error *error,
@@ -48,11 +50,21 @@ twitch_helix_team *twitch_helix_get_team(
 	};
 
 	string_t *url = helix_team_url_builder(&params);
-	json_value *value = twitch_helix_get_json(client_id, bearer, error, url->ptr);
-	string_free(url);
+	json_value *value = twitch_helix_get_json(
+		client,
+		client_id,
+		bearer,
+		error,
+		url->ptr
+	);
 
+	double start = helix_stats_clock();
 	void *team = parse_helix_team(value);
-	json_value_free(value);
+	if (value != NULL) {
+		helix_stats_record_time(client, url->ptr, TWITCH_METRIC_MATERIALIZE, start);
+	}
+	twitch_helix_release_json(client, value);
+	string_free(url);
 	return (twitch_helix_team *)team;
 }
 
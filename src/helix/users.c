@@ -6,6 +6,7 @@
 
 #include "utils/strings/strings.h"
 #include "utils/network/helix.h"
+#include "utils/network/multi.h"
 #include "utils/parser/parser.h"
 #include "json/json.h"
 
@@ -94,7 +95,90 @@ string_t *helix_channel_follows_url_builder(
 	return url;
 }
 
+/** Lookups **/
+
+const char *helix_user_load_key(void *item, bool by_id) {
+	twitch_helix_user *user = (twitch_helix_user *)item;
+	return by_id ? user->id : user->login;
+}
+
+const helix_load_type helix_user_load_type = {
+	.url = "https://api.twitch.tv/helix/users",
+	.id_param = "id",
+	.name_param = "login",
+	.parser = &parse_helix_user,
+	.key = &helix_user_load_key,
+	.copy = (void *(*)(void *))&twitch_helix_user_copy,
+	.free = (void (*)(void *))&twitch_helix_user_free
+};
+
+/** Sharding **/
+
+/**
+ * Splits the query into shards of up to MAX_USERS_COUNT logins each, and
+ * downloads all of them in parallel.
+ *
+ * @param client Client context. Can be NULL.
+ * @param client_id Twitch API client ID.
+ * @param auth Authorization token.
+ * @param error Error holder struct.
+ * @param params Original query params.
+ * @param size Returns number of downloaded users.
+ *
+ * @return Array of users in the order of given logins shards.
+ */
+void **helix_get_sharded_users(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	twitch_error *error,
+	helix_users_params *params,
+	int *size
+) {
+	int shards_count =
+		(params->logins_count + MAX_USERS_COUNT - 1) / MAX_USERS_COUNT;
+
+	helix_users_params *shards = calloc(shards_count, sizeof(helix_users_params));
+	void **shard_params = malloc(sizeof(void *) * shards_count);
+	if (shards == NULL || shard_params == NULL) {
+		fprintf(stderr, "Failed to allocate memory for shards.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (int idx = 0; idx < shards_count; idx++) {
+		int offset = idx * MAX_USERS_COUNT;
+		int remaining = params->logins_count - offset;
+
+		shards[idx].logins = &params->logins[offset];
+		shards[idx].logins_count = (remaining > MAX_USERS_COUNT)
+			? MAX_USERS_COUNT
+			: remaining;
+		shard_params[idx] = (void *)&shards[idx];
+	}
+
+	void **items = helix_get_all_pages_parallel(
+		client,
+		client_id,
+		auth,
+		error,
+		&helix_users_url_builder,
+		shards_count,
+		shard_params,
+		0,
+		&parse_helix_user,
+		size
+	);
+
+	free(shard_params);
+	free(shards);
+
+	return items;
+}
+
+/** API **/
+
 twitch_helix_user_list *twitch_helix_get_users(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -107,7 +191,22 @@ twitch_helix_user_list *twitch_helix_get_users(
 	};
 
 	twitch_helix_user_list *list = twitch_helix_user_list_alloc();
+
+	// Queries that don't fit into one request are split into parallel shards.
+	if (logins_count > MAX_USERS_COUNT) {
+		list->items = (twitch_helix_user **)helix_get_sharded_users(
+			client,
+			client_id,
+			auth,
+			error,
+			&params,
+			&list->count
+		);
+		return list;
+	}
+
 	list->items = (twitch_helix_user **)helix_get_page(
+		client,
 		client_id,
 		auth,
 		error,
@@ -124,6 +223,7 @@ twitch_helix_user_list *twitch_helix_get_users(
 }
 
 twitch_helix_user *twitch_helix_get_user(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -133,6 +233,7 @@ twitch_helix_user *twitch_helix_get_user(
 	twitch_helix_user *output = NULL, *user = NULL;
 
 	twitch_helix_user_list *users = twitch_helix_get_users(
+		client,
 		client_id,
 		auth,
 		error,
@@ -166,6 +267,7 @@ twitch_helix_user *twitch_helix_get_user(
 }
 
 twitch_helix_channel_follow_list *twitch_helix_get_channel_follows(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -183,6 +285,7 @@ twitch_helix_channel_follow_list *twitch_helix_get_channel_follows(
 
 	twitch_helix_channel_follow_list *list = twitch_helix_channel_follow_list_alloc();
 	list->items = (twitch_helix_channel_follow **)helix_get_page(
+		client,
 		client_id,
 		auth,
 		error,
@@ -199,6 +302,7 @@ twitch_helix_channel_follow_list *twitch_helix_get_channel_follows(
 }
 
 twitch_helix_channel_follow_list *twitch_helix_get_all_channel_follows(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -212,6 +316,7 @@ twitch_helix_channel_follow_list *twitch_helix_get_all_channel_follows(
 
 	twitch_helix_channel_follow_list *follows = twitch_helix_channel_follow_list_alloc();
 	follows->items = (twitch_helix_channel_follow **)get_all_helix_pages(
+		client,
 		client_id,
 		auth,
 		error,
@@ -225,3 +330,86 @@ twitch_helix_channel_follow_list *twitch_helix_get_all_channel_follows(
 	return follows;
 }
 
+void twitch_helix_batch_get_users(
+	twitch_helix_batch *batch,
+	int logins_count,
+	const char **logins,
+	twitch_helix_batch_callback callback,
+	void *user_data
+) {
+	helix_users_params params = {
+		.logins_count = logins_count,
+		.logins = logins
+	};
+
+	helix_batch_add_page(
+		batch,
+		&helix_users_url_builder,
+		(void *)&params,
+		0,
+		NULL,
+		&parse_helix_user,
+		(list_alloc_func)&twitch_helix_user_list_alloc,
+		callback,
+		user_data
+	);
+}
+
+void twitch_helix_batch_load_user(
+	twitch_helix_batch *batch,
+	const char *login,
+	twitch_helix_batch_load_callback callback,
+	void *user_data
+) {
+	helix_batch_load(
+		batch,
+		&helix_user_load_type,
+		false,
+		login,
+		callback,
+		user_data
+	);
+}
+
+void twitch_helix_batch_load_user_by_id(
+	twitch_helix_batch *batch,
+	const char *id,
+	twitch_helix_batch_load_callback callback,
+	void *user_data
+) {
+	helix_batch_load(
+		batch,
+		&helix_user_load_type,
+		true,
+		id,
+		callback,
+		user_data
+	);
+}
+
+twitch_helix_page_iter *twitch_helix_iter_get_channel_follows(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	const char *user_id,
+	const char *broadcaster_id,
+	int first,
+	int limit
+) {
+	helix_channel_follows_params params = {
+		.user_id = user_id,
+		.broadcaster_id = broadcaster_id
+	};
+
+	return helix_page_iter_alloc(
+		client,
+		client_id,
+		auth,
+		&helix_channel_follows_url_builder,
+		(void *)&params,
+		&parse_helix_channel_follow,
+		(list_alloc_func)&twitch_helix_channel_follow_list_alloc,
+		first,
+		limit
+	);
+}
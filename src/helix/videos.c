@@ -101,6 +101,7 @@ string_t *helix_videos_url_builder(
 }
 
 twitch_helix_video_list *twitch_helix_get_videos(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -130,6 +131,7 @@ twitch_helix_video_list *twitch_helix_get_videos(
 	twitch_helix_video_list *list = twitch_helix_video_list_alloc();
 
 	list->items = (twitch_helix_video **)helix_get_page(
+		client,
 		client_id,
 		token,
 		error,
@@ -147,6 +149,7 @@ twitch_helix_video_list *twitch_helix_get_videos(
 }
 
 twitch_helix_video_list *twitch_helix_get_all_videos(
+	twitch_client *client,
 	const char *client_id,
 	const char *token,
 	twitch_error *error,
@@ -174,6 +177,7 @@ twitch_helix_video_list *twitch_helix_get_all_videos(
 	twitch_helix_video_list *list = twitch_helix_video_list_alloc();
 
 	list->items = (twitch_helix_video **)get_all_helix_pages(
+		client,
 		client_id,
 		token,
 		error,
@@ -186,3 +190,42 @@ twitch_helix_video_list *twitch_helix_get_all_videos(
 
 	return list;
 }
+
+twitch_helix_page_iter *twitch_helix_iter_get_videos(
+	twitch_client *client,
+	const char *client_id,
+	const char *token,
+	const char *user_id,
+	const char *game_id,
+	int id_count,
+	const char **ids,
+	const char *language,
+	const char *period,
+	const char *sort,
+	const char *type,
+	int first,
+	int limit
+) {
+	helix_videos_params params = {
+		.user_id = user_id,
+		.game_id = game_id,
+		.id_count = id_count,
+		.ids = ids,
+		.language = language,
+		.period = period,
+		.sort = sort,
+		.type = type
+	};
+
+	return helix_page_iter_alloc(
+		client,
+		client_id,
+		token,
+		&helix_videos_url_builder,
+		(void *)&params,
+		&parse_helix_video,
+		(list_alloc_func)&twitch_helix_video_list_alloc,
+		first,
+		limit
+	);
+}
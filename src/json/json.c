@@ -607,7 +607,7 @@ json_value * json_parse_ex (json_settings * settings,
 
                      case 't':
 
-                        if ((end - state.ptr) < 3 || *(++ state.ptr) != 'r' ||
+                        if ((end - state.ptr) <= 3 || *(++ state.ptr) != 'r' ||
                             *(++ state.ptr) != 'u' || *(++ state.ptr) != 'e')
                         {
                            goto e_unknown_value;
@@ -623,7 +623,7 @@ json_value * json_parse_ex (json_settings * settings,
 
                      case 'f':
 
-                        if ((end - state.ptr) < 4 || *(++ state.ptr) != 'a' ||
+                        if ((end - state.ptr) <= 4 || *(++ state.ptr) != 'a' ||
                             *(++ state.ptr) != 'l' || *(++ state.ptr) != 's' ||
                             *(++ state.ptr) != 'e')
                         {
@@ -638,7 +638,7 @@ json_value * json_parse_ex (json_settings * settings,
 
                      case 'n':
 
-                        if ((end - state.ptr) < 3 || *(++ state.ptr) != 'u' ||
+                        if ((end - state.ptr) <= 3 || *(++ state.ptr) != 'u' ||
                             *(++ state.ptr) != 'l' || *(++ state.ptr) != 'l')
                         {
                            goto e_unknown_value;
@@ -677,7 +677,7 @@ json_value * json_parse_ex (json_settings * settings,
 
                            flags &= ~ (flag_num_negative | flag_num_e |
                                         flag_num_e_got_sign | flag_num_e_negative |
-                                           flag_num_zero);
+                                           flag_num_zero | flag_num_got_decimal);
 
                            num_digits = 0;
                            num_fraction = 0;
@@ -802,21 +802,30 @@ json_value * json_parse_ex (json_settings * settings,
                      continue;
                   }
                }
-               else if (b == '.' && top->type == json_integer)
+               else if (b == '.' && !(flags & (flag_num_got_decimal | flag_num_e)))
                {
                   if (!num_digits)
                   {  sprintf (error, "%d:%d: Expected digit before `.`", line_and_col);
                      goto e_failed;
                   }
 
-                  top->type = json_double;
-                  top->u.dbl = (double) top->u.integer;
+                  /* Integer part could have overflowed into a double already */
+                  if (top->type == json_integer)
+                  {
+                     top->type = json_double;
+                     top->u.dbl = (double) top->u.integer;
+                  }
 
                   flags |= flag_num_got_decimal;
                   num_digits = 0;
                   continue;
                }
 
+               if (top->type == json_integer && !num_digits)
+               {  sprintf (error, "%d:%d: Expected digit after `-`", line_and_col);
+                  goto e_failed;
+               }
+
                if (! (flags & flag_num_e))
                {
                   if (top->type == json_double)
@@ -0,0 +1,440 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "utils/datagen.h"
+#include "utils/strings/strings.h"
+#include "utils/network/client.h"
+#include "utils/network/cache.h"
+#include "utils/network/ratelimit.h"
+#include "utils/network/stats.h"
+
+#include <ctwitch/client.h>
+#include <ctwitch/stats.h>
+#include <ctwitch/metrics.h>
+
+/**
+ * Upper bounds of exported histogram buckets, in microseconds. Internal
+ * histograms are much finer, so these can be changed freely.
+ */
+static const unsigned long long TIME_BOUNDS[] = {
+	100, 250, 500,
+	1000, 2500, 5000,
+	10000, 25000, 50000,
+	100000, 250000, 500000,
+	1000000, 2500000, 5000000, 10000000
+};
+
+#define TIME_BOUNDS_COUNT (sizeof(TIME_BOUNDS) / sizeof(TIME_BOUNDS[0]))
+
+/**
+ * Request phases exported as histograms.
+ */
+static const twitch_metric PHASES[] = {
+	TWITCH_METRIC_DNS,
+	TWITCH_METRIC_CONNECT,
+	TWITCH_METRIC_TLS,
+	TWITCH_METRIC_TTFB,
+	TWITCH_METRIC_TOTAL,
+	TWITCH_METRIC_PARSE,
+	TWITCH_METRIC_MATERIALIZE
+};
+
+#define PHASES_COUNT (sizeof(PHASES) / sizeof(PHASES[0]))
+
+/** Snapshot **/
+
+twitch_metrics *twitch_client_get_metrics(twitch_client *client) {
+	twitch_metrics *metrics = calloc(1, sizeof(twitch_metrics));
+	if (metrics == NULL) {
+		fprintf(stderr, "Failed to allocate memory for twitch_metrics");
+		exit(EXIT_FAILURE);
+	}
+
+	metrics->stats = twitch_client_get_stats(client);
+	metrics->transfer = client->transfer;
+	twitch_client_get_cache_stats(client, &metrics->cache);
+
+	int count = 0;
+	for (
+		helix_rate_bucket *bucket = client->buckets;
+		bucket != NULL;
+		bucket = bucket->next
+	) {
+		count++;
+	}
+
+	if (count > 0) {
+		metrics->rate_limits = calloc(count, sizeof(twitch_rate_limit_entry));
+		if (metrics->rate_limits == NULL) {
+			fprintf(stderr, "Failed to allocate memory for rate limits.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	// Buckets that never got rate limit headers have nothing to report.
+	for (
+		helix_rate_bucket *bucket = client->buckets;
+		bucket != NULL;
+		bucket = bucket->next
+	) {
+		twitch_rate_limit_entry *entry =
+			&metrics->rate_limits[metrics->rate_limits_count];
+
+		if (helix_ratelimit_budget(client, bucket->client_id, &entry->rate_limit)) {
+			entry->client_id = immutable_string_copy(bucket->client_id);
+			metrics->rate_limits_count++;
+		}
+	}
+
+	return metrics;
+}
+
+void twitch_metrics_free(twitch_metrics *metrics) {
+	if (metrics == NULL) {
+		return;
+	}
+
+	twitch_stats_free(metrics->stats);
+	for (int idx = 0; idx < metrics->rate_limits_count; idx++) {
+		free(metrics->rate_limits[idx].client_id);
+	}
+	FREE(metrics->rate_limits)
+	free(metrics);
+}
+
+/** Rendering **/
+
+/**
+ * Appends a label value, escaped as exposition format requires.
+ */
+void metrics_append_label(string_t *output, const char *value) {
+	for (const char *ptr = value; *ptr != '\0'; ptr++) {
+		switch (*ptr) {
+			case '\\':
+				string_append("\\\\", 2, output);
+				break;
+			case '"':
+				string_append("\\\"", 2, output);
+				break;
+			case '\n':
+				string_append("\\n", 2, output);
+				break;
+			default:
+				string_append(ptr, 1, output);
+		}
+	}
+}
+
+void metrics_append_header(
+	string_t *output,
+	const char *name,
+	const char *type,
+	const char *help
+) {
+	string_append_format(
+		output,
+		"# HELP %s %s\n# TYPE %s %s\n",
+		name,
+		help,
+		name,
+		type
+	);
+}
+
+/**
+ * Appends a sample of a metric with endpoint label.
+ */
+void metrics_append_endpoint_value(
+	string_t *output,
+	const char *name,
+	const char *endpoint,
+	unsigned long long value
+) {
+	string_append_format(output, "%s{endpoint=\"", name);
+	metrics_append_label(output, endpoint);
+	string_append_format(output, "\"} %llu\n", value);
+}
+
+void metrics_append_requests(string_t *output, const twitch_stats *stats) {
+	metrics_append_header(
+		output,
+		"twitch_requests_total",
+		"counter",
+		"Request attempts by endpoint and HTTP status code."
+	);
+
+	for (int idx = 0; idx < stats->count; idx++) {
+		twitch_endpoint_stats *endpoint = stats->items[idx];
+		for (int code = 0; code < endpoint->statuses_count; code++) {
+			string_append_format(output, "twitch_requests_total{endpoint=\"");
+			metrics_append_label(output, endpoint->endpoint);
+			string_append_format(
+				output,
+				"\",code=\"%ld\"} %lu\n",
+				endpoint->statuses[code].code,
+				endpoint->statuses[code].count
+			);
+		}
+	}
+
+	metrics_append_header(
+		output,
+		"twitch_request_errors_total",
+		"counter",
+		"Failed request attempts, including HTTP errors."
+	);
+	for (int idx = 0; idx < stats->count; idx++) {
+		metrics_append_endpoint_value(
+			output,
+			"twitch_request_errors_total",
+			stats->items[idx]->endpoint,
+			stats->items[idx]->errors
+		);
+	}
+
+	metrics_append_header(
+		output,
+		"twitch_request_retries_total",
+		"counter",
+		"Request attempts that were retries after a failure or 429 response."
+	);
+	for (int idx = 0; idx < stats->count; idx++) {
+		metrics_append_endpoint_value(
+			output,
+			"twitch_request_retries_total",
+			stats->items[idx]->endpoint,
+			stats->items[idx]->retries
+		);
+	}
+
+	metrics_append_header(
+		output,
+		"twitch_response_bytes_total",
+		"counter",
+		"Response body bytes received, before decompression."
+	);
+	for (int idx = 0; idx < stats->count; idx++) {
+		metrics_append_endpoint_value(
+			output,
+			"twitch_response_bytes_total",
+			stats->items[idx]->endpoint,
+			stats->items[idx]->metrics[TWITCH_METRIC_BYTES].sum
+		);
+	}
+}
+
+void metrics_append_phases(string_t *output, const twitch_stats *stats) {
+	metrics_append_header(
+		output,
+		"twitch_request_phase_seconds",
+		"histogram",
+		"Duration of request phases by endpoint."
+	);
+
+	for (int idx = 0; idx < stats->count; idx++) {
+		twitch_endpoint_stats *endpoint = stats->items[idx];
+
+		for (size_t phase = 0; phase < PHASES_COUNT; phase++) {
+			const twitch_histogram *histogram = &endpoint->metrics[PHASES[phase]];
+			if (histogram->count == 0) {
+				continue;
+			}
+
+			const char *name = twitch_metric_name(PHASES[phase]);
+			for (size_t bound = 0; bound <= TIME_BOUNDS_COUNT; bound++) {
+				string_append_format(
+					output,
+					"twitch_request_phase_seconds_bucket{endpoint=\""
+				);
+				metrics_append_label(output, endpoint->endpoint);
+
+				if (bound < TIME_BOUNDS_COUNT) {
+					string_append_format(
+						output,
+						"\",phase=\"%s\",le=\"%g\"} %lu\n",
+						name,
+						TIME_BOUNDS[bound] / 1e6,
+						helix_histogram_count_below(histogram, TIME_BOUNDS[bound])
+					);
+				} else {
+					string_append_format(
+						output,
+						"\",phase=\"%s\",le=\"+Inf\"} %lu\n",
+						name,
+						histogram->count
+					);
+				}
+			}
+
+			string_append_format(
+				output,
+				"twitch_request_phase_seconds_sum{endpoint=\""
+			);
+			metrics_append_label(output, endpoint->endpoint);
+			string_append_format(
+				output,
+				"\",phase=\"%s\"} %.6f\n",
+				name,
+				histogram->sum / 1e6
+			);
+
+			string_append_format(
+				output,
+				"twitch_request_phase_seconds_count{endpoint=\""
+			);
+			metrics_append_label(output, endpoint->endpoint);
+			string_append_format(
+				output,
+				"\",phase=\"%s\"} %lu\n",
+				name,
+				histogram->count
+			);
+		}
+	}
+}
+
+/**
+ * Metric without labels.
+ */
+typedef struct {
+	const char *name;
+	const char *type;
+	const char *help;
+	unsigned long long value;
+} metrics_scalar;
+
+void metrics_append_client(string_t *output, const twitch_metrics *metrics) {
+	const twitch_cache_stats *cache = &metrics->cache;
+	const twitch_transfer_stats *transfer = &metrics->transfer;
+
+	metrics_scalar scalars[] = {
+		{
+			"twitch_cache_hits_total", "counter",
+			"Requests served from the response cache.",
+			cache->hits
+		},
+		{
+			"twitch_cache_misses_total", "counter",
+			"Cacheable requests that went to the network.",
+			cache->misses
+		},
+		{
+			"twitch_cache_evictions_total", "counter",
+			"Cache entries dropped to stay within the size cap.",
+			cache->evictions
+		},
+		{
+			"twitch_cache_expirations_total", "counter",
+			"Cache entries dropped because their TTL ran out.",
+			cache->expirations
+		},
+		{
+			"twitch_cache_entries", "gauge",
+			"Number of cached responses.",
+			cache->entries
+		},
+		{
+			"twitch_cache_bytes", "gauge",
+			"Estimated size of cached responses.",
+			cache->bytes
+		},
+		{
+			"twitch_transfer_wire_bytes_total", "counter",
+			"Response body bytes received over the network.",
+			transfer->wire_bytes
+		},
+		{
+			"twitch_transfer_decoded_bytes_total", "counter",
+			"Response body bytes after decompression.",
+			transfer->decoded_bytes
+		}
+	};
+
+	for (size_t idx = 0; idx < sizeof(scalars) / sizeof(scalars[0]); idx++) {
+		metrics_append_header(
+			output,
+			scalars[idx].name,
+			scalars[idx].type,
+			scalars[idx].help
+		);
+		string_append_format(
+			output,
+			"%s %llu\n",
+			scalars[idx].name,
+			scalars[idx].value
+		);
+	}
+
+	if (metrics->rate_limits_count == 0) {
+		return;
+	}
+
+	const char *names[] = {
+		"twitch_rate_limit_points",
+		"twitch_rate_limit_remaining_points",
+		"twitch_rate_limit_reset_timestamp_seconds"
+	};
+	const char *help[] = {
+		"Rate limit bucket size of the client ID.",
+		"Rate limit points left for the client ID.",
+		"Unix time when the rate limit bucket is full again."
+	};
+
+	for (int name = 0; name < 3; name++) {
+		metrics_append_header(output, names[name], "gauge", help[name]);
+
+		for (int idx = 0; idx < metrics->rate_limits_count; idx++) {
+			const twitch_rate_limit_entry *entry = &metrics->rate_limits[idx];
+			long values[] = {
+				entry->rate_limit.limit,
+				entry->rate_limit.remaining,
+				entry->rate_limit.reset
+			};
+
+			string_append_format(output, "%s{client_id=\"", names[name]);
+			metrics_append_label(output, entry->client_id);
+			string_append_format(output, "\"} %ld\n", values[name]);
+		}
+	}
+}
+
+int twitch_metrics_write(const twitch_metrics *metrics, int fd) {
+	string_t *output = string_init();
+
+	if (metrics->stats != NULL) {
+		metrics_append_requests(output, metrics->stats);
+		metrics_append_phases(output, metrics->stats);
+	}
+	metrics_append_client(output, metrics);
+
+	// Writes to sockets and pipes can be partial.
+	size_t written = 0;
+	while (written < output->len) {
+		ssize_t result = write(fd, output->ptr + written, output->len - written);
+		if (result < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			int saved_errno = errno;
+			string_free(output);
+			errno = saved_errno;
+			return -1;
+		}
+		written += result;
+	}
+
+	string_free(output);
+	return 0;
+}
+
+int twitch_client_metrics_write(twitch_client *client, int fd) {
+	twitch_metrics *metrics = twitch_client_get_metrics(client);
+	int result = twitch_metrics_write(metrics, fd);
+	twitch_metrics_free(metrics);
+
+	return result;
+}
@@ -0,0 +1,439 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <curl/curl.h>
+
+#include "utils/datagen.h"
+#include "utils/strings/strings.h"
+#include "utils/network/client.h"
+
+#include <ctwitch/client.h>
+#include <ctwitch/transport.h>
+
+/**
+ * Archive of recorded exchanges is a sequence of records like this one:
+ *
+ *   > GET /helix/users?login=twitch
+ *   < 200 <headers length> <body length>
+ *   <raw header block><body>
+ *
+ * with a line feed after the body. Request line has only the path and the
+ * query of the URL, so the archive doesn't depend on the server it was
+ * recorded from.
+ */
+
+extern size_t twitch_writefunc(
+	void *ptr,
+	size_t size,
+	size_t nmemb,
+	struct string *s
+);
+
+/** Client **/
+
+void twitch_client_set_transport(
+	twitch_client *client,
+	twitch_transport *transport
+) {
+	if (client->transport != NULL && client->transport != transport) {
+		client->transport->free(client->transport);
+	}
+	client->transport = transport;
+}
+
+/** Helpers **/
+
+/**
+ * Returns the part of URL starting with the path.
+ */
+const char *twitch_transport_url_path(const char *url) {
+	const char *host = strstr(url, "://");
+	if (host == NULL) {
+		return url;
+	}
+
+	const char *path = strchr(host + 3, '/');
+	return (path != NULL) ? path : "/";
+}
+
+/** Recording **/
+
+typedef struct {
+	twitch_transport transport;
+	CURL *curl;
+	FILE *archive;
+} twitch_record_transport;
+
+size_t twitch_record_header_callback(
+	char *buffer,
+	size_t size,
+	size_t nitems,
+	void *userdata
+) {
+	size_t length = size * nitems;
+	string_append(buffer, length, (string_t *)userdata);
+	return length;
+}
+
+long twitch_record_transport_perform(
+	twitch_transport *transport,
+	const twitch_transport_request *request,
+	twitch_transport_response *response
+) {
+	twitch_record_transport *recorder = (twitch_record_transport *)transport;
+	CURL *curl = recorder->curl;
+
+	struct curl_slist *headers = NULL;
+	for (int idx = 0; idx < request->headers_count; idx++) {
+		headers = curl_slist_append(headers, request->headers[idx]);
+	}
+
+	string_t *header_block = string_init();
+	string_t *body = string_init();
+
+	curl_easy_reset(curl);
+	curl_easy_setopt(curl, CURLOPT_URL, request->url);
+	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+	curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+	curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, twitch_record_header_callback);
+	curl_easy_setopt(curl, CURLOPT_HEADERDATA, header_block);
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, twitch_writefunc);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, body);
+	if (strcmp(request->method, "POST") == 0) {
+		curl_easy_setopt(curl, CURLOPT_POST, 1);
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, 0);
+		curl_easy_setopt(curl, CURLOPT_POSTFIELDS, "");
+	}
+
+	CURLcode code = curl_easy_perform(curl);
+	curl_slist_free_all(headers);
+
+	if (code != CURLE_OK) {
+		string_free(header_block);
+		string_free(body);
+		return code;
+	}
+
+	curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->status);
+
+	fprintf(
+		recorder->archive,
+		"> %s %s\n< %ld %zu %zu\n",
+		request->method,
+		twitch_transport_url_path(request->url),
+		response->status,
+		header_block->len,
+		body->len
+	);
+	fwrite(header_block->ptr, 1, header_block->len, recorder->archive);
+	fwrite(body->ptr, 1, body->len, recorder->archive);
+	fputc('\n', recorder->archive);
+	fflush(recorder->archive);
+
+	// Response takes over the buffers.
+	response->headers = header_block->ptr;
+	response->headers_length = header_block->len;
+	response->body = body->ptr;
+	response->body_length = body->len;
+	free(header_block);
+	free(body);
+
+	return CURLE_OK;
+}
+
+void twitch_record_transport_free(twitch_transport *transport) {
+	twitch_record_transport *recorder = (twitch_record_transport *)transport;
+	curl_easy_cleanup(recorder->curl);
+	fclose(recorder->archive);
+	free(recorder);
+}
+
+twitch_transport *twitch_record_transport_alloc(const char *path) {
+	FILE *archive = fopen(path, "ab");
+	if (archive == NULL) {
+		return NULL;
+	}
+
+	twitch_record_transport *recorder = calloc(1, sizeof(twitch_record_transport));
+	if (recorder == NULL) {
+		fprintf(stderr, "Failed to allocate memory for twitch_record_transport");
+		exit(EXIT_FAILURE);
+	}
+
+	recorder->transport.perform = &twitch_record_transport_perform;
+	recorder->transport.free = &twitch_record_transport_free;
+	recorder->curl = curl_easy_init();
+	recorder->archive = archive;
+
+	return (twitch_transport *)recorder;
+}
+
+/** Replaying **/
+
+typedef struct {
+	char *request;          // Method and path, like "GET /helix/users".
+	int order;              // Position in the archive.
+	int turn;               // Number of times the request was replayed.
+	long status;
+	const char *headers;
+	size_t headers_length;
+	const char *body;
+	size_t body_length;
+} twitch_replay_entry;
+
+typedef struct {
+	twitch_transport transport;
+	char *data;                    // Archive contents.
+	int count;                     // Number of recorded exchanges.
+	twitch_replay_entry *entries;  // Exchanges sorted by request and order.
+	long latency;                  // Response delay, in milliseconds.
+	long jitter;                   // Max deviation of the delay.
+	unsigned int seed;             // Jitter random generator state.
+} twitch_replay_transport;
+
+int twitch_replay_entry_compare(const void *a, const void *b) {
+	const twitch_replay_entry *ea = (const twitch_replay_entry *)a;
+	const twitch_replay_entry *eb = (const twitch_replay_entry *)b;
+
+	int order = strcmp(ea->request, eb->request);
+	return (order != 0) ? order : ea->order - eb->order;
+}
+
+/**
+ * Finds the first recorded exchange of given request.
+ *
+ * @return Index of the exchange, or -1.
+ */
+int twitch_replay_find(twitch_replay_transport *replay, const char *request) {
+	int low = 0, high = replay->count;
+	while (low < high) {
+		int mid = low + (high - low) / 2;
+		if (strcmp(replay->entries[mid].request, request) < 0) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	if (low < replay->count && strcmp(replay->entries[low].request, request) == 0) {
+		return low;
+	}
+	return -1;
+}
+
+char *twitch_replay_copy(const char *data, size_t length) {
+	char *copy = malloc(length + 1);
+	if (copy == NULL) {
+		fprintf(stderr, "Failed to allocate memory for replayed response.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	memcpy(copy, data, length);
+	copy[length] = '\0';
+	return copy;
+}
+
+void twitch_replay_sleep(twitch_replay_transport *replay) {
+	double delay = replay->latency;
+	if (replay->jitter > 0) {
+		double random = (double)rand_r(&replay->seed) / RAND_MAX;
+		delay += (2 * random - 1) * replay->jitter;
+	}
+
+	if (delay <= 0) {
+		return;
+	}
+
+	struct timespec ts;
+	ts.tv_sec = (time_t)(delay / 1000);
+	ts.tv_nsec = (long)((delay - ts.tv_sec * 1000.0) * 1e6);
+	nanosleep(&ts, NULL);
+}
+
+long twitch_replay_transport_perform(
+	twitch_transport *transport,
+	const twitch_transport_request *request,
+	twitch_transport_response *response
+) {
+	twitch_replay_transport *replay = (twitch_replay_transport *)transport;
+
+	string_t *key = string_init_with_value(request->method);
+	string_append(" ", 1, key);
+	const char *path = twitch_transport_url_path(request->url);
+	string_append(path, strlen(path), key);
+
+	int first = twitch_replay_find(replay, key->ptr);
+	string_free(key);
+
+	twitch_replay_sleep(replay);
+
+	if (first < 0) {
+		const char *body =
+			"{\"error\":\"Not Found\",\"status\":404,"
+			"\"message\":\"no recorded response\"}";
+		response->status = 404;
+		response->body = twitch_replay_copy(body, strlen(body));
+		response->body_length = strlen(body);
+		return CURLE_OK;
+	}
+
+	// Take recorded responses in turn.
+	int last = first;
+	while (
+		last + 1 < replay->count &&
+		strcmp(replay->entries[last + 1].request, replay->entries[first].request) == 0
+	) {
+		last++;
+	}
+
+	twitch_replay_entry *head = &replay->entries[first];
+	twitch_replay_entry *entry = &replay->entries[
+		first + head->turn % (last - first + 1)
+	];
+	head->turn++;
+
+	response->status = entry->status;
+	response->headers = twitch_replay_copy(entry->headers, entry->headers_length);
+	response->headers_length = entry->headers_length;
+	response->body = twitch_replay_copy(entry->body, entry->body_length);
+	response->body_length = entry->body_length;
+
+	return CURLE_OK;
+}
+
+void twitch_replay_transport_free(twitch_transport *transport) {
+	twitch_replay_transport *replay = (twitch_replay_transport *)transport;
+
+	for (int idx = 0; idx < replay->count; idx++) {
+		free(replay->entries[idx].request);
+	}
+
+	FREE(replay->entries)
+	FREE(replay->data)
+	free(replay);
+}
+
+/**
+ * Parses the archive into a list of exchanges. Bodies and headers point into
+ * the archive data.
+ *
+ * @return true if the whole archive is valid.
+ */
+bool twitch_replay_parse(twitch_replay_transport *replay, size_t size) {
+	const char *ptr = replay->data;
+	const char *end = replay->data + size;
+	int capacity = 0;
+
+	while (ptr < end) {
+		// Request line.
+		const char *line_end = memchr(ptr, '\n', end - ptr);
+		if (line_end == NULL || line_end - ptr < 3 || strncmp(ptr, "> ", 2) != 0) {
+			return false;
+		}
+
+		twitch_replay_entry entry;
+		memset(&entry, 0, sizeof(entry));
+		entry.request = twitch_replay_copy(ptr + 2, line_end - ptr - 2);
+		entry.order = replay->count;
+
+		if (replay->count == capacity) {
+			capacity = (capacity == 0) ? 16 : capacity * 2;
+			replay->entries = realloc(
+				replay->entries,
+				sizeof(twitch_replay_entry) * capacity
+			);
+			if (replay->entries == NULL) {
+				fprintf(stderr, "Failed to allocate memory for replay entries.\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		replay->entries[replay->count++] = entry;
+
+		// Status line.
+		ptr = line_end + 1;
+		line_end = (ptr < end) ? memchr(ptr, '\n', end - ptr) : NULL;
+		if (line_end == NULL || strncmp(ptr, "< ", 2) != 0) {
+			return false;
+		}
+
+		long status = 0;
+		size_t headers_length = 0, body_length = 0;
+		if (
+			sscanf(ptr, "< %ld %zu %zu", &status, &headers_length, &body_length) != 3
+		) {
+			return false;
+		}
+
+		// Contents.
+		ptr = line_end + 1;
+		if ((size_t)(end - ptr) < headers_length + body_length + 1) {
+			return false;
+		}
+
+		twitch_replay_entry *last = &replay->entries[replay->count - 1];
+		last->status = status;
+		last->headers = ptr;
+		last->headers_length = headers_length;
+		last->body = ptr + headers_length;
+		last->body_length = body_length;
+
+		ptr += headers_length + body_length + 1;
+	}
+
+	return true;
+}
+
+twitch_transport *twitch_replay_transport_alloc(
+	const char *path,
+	long latency,
+	long jitter
+) {
+	FILE *archive = fopen(path, "rb");
+	if (archive == NULL) {
+		return NULL;
+	}
+
+	twitch_replay_transport *replay = calloc(1, sizeof(twitch_replay_transport));
+	if (replay == NULL) {
+		fprintf(stderr, "Failed to allocate memory for twitch_replay_transport");
+		exit(EXIT_FAILURE);
+	}
+
+	replay->transport.perform = &twitch_replay_transport_perform;
+	replay->transport.free = &twitch_replay_transport_free;
+	replay->latency = latency;
+	replay->jitter = jitter;
+	replay->seed = 1;
+
+	// Read the whole archive.
+	fseek(archive, 0, SEEK_END);
+	long size = ftell(archive);
+	fseek(archive, 0, SEEK_SET);
+
+	replay->data = malloc(size > 0 ? size : 1);
+	if (replay->data == NULL) {
+		fprintf(stderr, "Failed to allocate memory for replay archive.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	bool valid = size >= 0 &&
+		fread(replay->data, 1, size, archive) == (size_t)size &&
+		twitch_replay_parse(replay, size);
+	fclose(archive);
+
+	if (!valid) {
+		twitch_replay_transport_free((twitch_transport *)replay);
+		return NULL;
+	}
+
+	qsort(
+		replay->entries,
+		replay->count,
+		sizeof(twitch_replay_entry),
+		twitch_replay_entry_compare
+	);
+
+	return (twitch_transport *)replay;
+}
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "utils/arena/arena.h"
+
+/** Data **/
+
+/**
+ * Alignment of every allocation, enough for any type.
+ */
+#define ARENA_ALIGN 16
+
+#define ARENA_ROUND(size) \
+	(((size) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+/**
+ * Block of memory. Allocations follow the header. Blocks after the arena's
+ * current one are empty and wait for reuse.
+ */
+struct arena_block {
+	struct arena_block *next;
+	size_t size;  // Capacity in bytes.
+	size_t used;  // Bytes allocated.
+};
+
+#define ARENA_HEADER_SIZE ARENA_ROUND(sizeof(arena_block))
+
+char *arena_block_data(arena_block *block) {
+	return (char *)block + ARENA_HEADER_SIZE;
+}
+
+/** Arena **/
+
+arena_t *arena_init() {
+	arena_t *arena = calloc(1, sizeof(arena_t));
+	if (arena == NULL) {
+		fprintf(stderr, "Failed to allocate memory for arena");
+		exit(EXIT_FAILURE);
+	}
+
+	return arena;
+}
+
+/**
+ * Makes a block with room for given size the current one, reusing the next
+ * empty block if it's big enough.
+ */
+arena_block *arena_next_block(arena_t *arena, size_t size) {
+	arena_block *next = (arena->current != NULL)
+		? arena->current->next
+		: arena->head;
+
+	if (next != NULL && next->size >= size) {
+		next->used = 0;
+		arena->current = next;
+		return next;
+	}
+
+	size_t capacity = (size > ARENA_BLOCK_SIZE) ? size : ARENA_BLOCK_SIZE;
+	arena_block *block = malloc(ARENA_HEADER_SIZE + capacity);
+	if (block == NULL) {
+		fprintf(stderr, "Failed to allocate memory for arena block");
+		exit(EXIT_FAILURE);
+	}
+	arena->blocks++;
+
+	// Smaller empty blocks stay after the new one for later use.
+	block->size = capacity;
+	block->used = 0;
+	block->next = next;
+	if (arena->current != NULL) {
+		arena->current->next = block;
+	} else {
+		arena->head = block;
+	}
+
+	arena->current = block;
+	return block;
+}
+
+void *arena_malloc(arena_t *arena, size_t size, bool zero) {
+	size = (size > 0) ? ARENA_ROUND(size) : ARENA_ALIGN;
+
+	arena_block *block = arena->current;
+	if (block == NULL || block->size - block->used < size) {
+		block = arena_next_block(arena, size);
+	}
+
+	void *ptr = arena_block_data(block) + block->used;
+	block->used += size;
+
+	if (zero) {
+		memset(ptr, 0, size);
+	}
+
+	return ptr;
+}
+
+arena_mark arena_get_mark(arena_t *arena) {
+	arena_mark mark = {
+		.block = arena->current,
+		.used = (arena->current != NULL) ? arena->current->used : 0
+	};
+
+	return mark;
+}
+
+void arena_reset(arena_t *arena, arena_mark mark) {
+	if (mark.block == NULL) {
+		// Mark of an arena without blocks, empty all of them.
+		arena->current = arena->head;
+		if (arena->current != NULL) {
+			arena->current->used = 0;
+		}
+		return;
+	}
+
+	arena->current = mark.block;
+	arena->current->used = mark.used;
+}
+
+bool arena_release(arena_t *arena, void *ptr) {
+	if (arena == NULL || arena->current == NULL) {
+		return false;
+	}
+
+	for (arena_block *block = arena->head; ; block = block->next) {
+		char *data = arena_block_data(block);
+		if ((char *)ptr >= data && (char *)ptr < data + block->used) {
+			arena->current = block;
+			block->used = (char *)ptr - data;
+			return true;
+		}
+
+		if (block == arena->current) {
+			return false;
+		}
+	}
+}
+
+void arena_free(arena_t *arena) {
+	if (arena == NULL) {
+		return;
+	}
+
+	while (arena->head != NULL) {
+		arena_block *next = arena->head->next;
+		free(arena->head);
+		arena->head = next;
+	}
+
+	free(arena);
+}
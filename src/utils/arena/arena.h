@@ -0,0 +1,98 @@
+/**
+ * Bump-pointer memory arena.
+ *
+ * Hands out memory from large blocks by moving a pointer forward, and frees
+ * everything allocated after a given point at once. Blocks are kept after
+ * being emptied, so a workload that repeatedly fills and empties the arena,
+ * like parsing one page after another, stops calling malloc() once the
+ * blocks are big enough for it.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#ifndef _H_ARENA_UTILS
+#define _H_ARENA_UTILS
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/**
+ * Default size of a block. Bigger allocations get a block of their own size.
+ */
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+typedef struct arena_block arena_block;
+
+/**
+ * Memory arena.
+ */
+typedef struct arena {
+	arena_block *head;     // First block.
+	arena_block *current;  // Block allocations are made from.
+	unsigned long blocks;  // Number of blocks allocated with malloc().
+} arena_t;
+
+/**
+ * Position in the arena to reset it to.
+ */
+typedef struct {
+	arena_block *block;
+	size_t used;
+} arena_mark;
+
+/**
+ * Returns new empty arena. No memory is reserved until the first allocation.
+ *
+ * @return New arena. Free it with arena_free().
+ */
+arena_t *arena_init();
+
+/**
+ * Allocates memory from the arena. The memory is aligned for any type.
+ *
+ * @param arena Arena to allocate from.
+ * @param size Number of bytes.
+ * @param zero Whether to fill the memory with zeros.
+ *
+ * @return Pointer to allocated memory.
+ */
+void *arena_malloc(arena_t *arena, size_t size, bool zero);
+
+/**
+ * Returns current position of the arena.
+ *
+ * @param arena Arena instance.
+ *
+ * @return Mark to pass to arena_reset().
+ */
+arena_mark arena_get_mark(arena_t *arena);
+
+/**
+ * Frees everything allocated after given mark was taken. Marks must be reset
+ * in reverse order of taking them.
+ *
+ * @param arena Arena instance.
+ * @param mark Mark returned by arena_get_mark().
+ */
+void arena_reset(arena_t *arena, arena_mark mark);
+
+/**
+ * Frees given allocation and everything allocated after it.
+ *
+ * @param arena Arena instance. Can be NULL.
+ * @param ptr Pointer returned by arena_malloc().
+ *
+ * @return true if the pointer was allocated from the arena and is in use,
+ * false otherwise, in which case nothing is freed.
+ */
+bool arena_release(arena_t *arena, void *ptr);
+
+/**
+ * Frees the arena with all its blocks.
+ *
+ * @param arena Arena to deallocate. Can be NULL.
+ */
+void arena_free(arena_t *arena);
+
+#endif
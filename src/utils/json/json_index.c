@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "utils/json/json_index.h"
+
+#if !defined(JSON_INDEX_PORTABLE) && defined(__x86_64__) && \
+	(defined(__GNUC__) || defined(__clang__))
+#define JSON_INDEX_X86
+#include <immintrin.h>
+#endif
+
+/** Data **/
+
+/**
+ * Bit masks of characters of one 64-byte block, bit N for Nth byte.
+ */
+typedef struct {
+	uint64_t quote;
+	uint64_t backslash;
+	uint64_t structural;
+} json_index_masks;
+
+typedef void (*json_index_classifier)(
+	const char *block,
+	json_index_masks *masks
+);
+
+/** Kernels **/
+
+void json_index_classify_scalar(const char *block, json_index_masks *masks) {
+	uint64_t quote = 0, backslash = 0, structural = 0;
+
+	for (int idx = 0; idx < 64; idx++) {
+		uint64_t bit = (uint64_t)1 << idx;
+		switch (block[idx]) {
+			case '"':
+				quote |= bit;
+				break;
+			case '\\':
+				backslash |= bit;
+				break;
+			case '{':
+			case '}':
+			case '[':
+			case ']':
+			case ':':
+			case ',':
+				structural |= bit;
+				break;
+			default:
+				break;
+		}
+	}
+
+	masks->quote = quote;
+	masks->backslash = backslash;
+	masks->structural = structural;
+}
+
+#ifdef JSON_INDEX_X86
+
+// Brackets are matched together with braces: setting bit 5 turns [ into {
+// and ] into }, and no other character into either.
+
+__attribute__((target("sse2")))
+void json_index_classify_sse2(const char *block, json_index_masks *masks) {
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i open = _mm_set1_epi8('{');
+	const __m128i close = _mm_set1_epi8('}');
+	const __m128i colon = _mm_set1_epi8(':');
+	const __m128i comma = _mm_set1_epi8(',');
+	const __m128i case_bit = _mm_set1_epi8(0x20);
+
+	masks->quote = 0;
+	masks->backslash = 0;
+	masks->structural = 0;
+
+	for (int part = 0; part < 4; part++) {
+		__m128i chunk = _mm_loadu_si128((const __m128i *)(block + part * 16));
+		__m128i folded = _mm_or_si128(chunk, case_bit);
+		__m128i structural = _mm_or_si128(
+			_mm_or_si128(
+				_mm_cmpeq_epi8(folded, open),
+				_mm_cmpeq_epi8(folded, close)
+			),
+			_mm_or_si128(
+				_mm_cmpeq_epi8(chunk, colon),
+				_mm_cmpeq_epi8(chunk, comma)
+			)
+		);
+
+		int shift = part * 16;
+		masks->quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+			_mm_cmpeq_epi8(chunk, quote)
+		) << shift;
+		masks->backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+			_mm_cmpeq_epi8(chunk, backslash)
+		) << shift;
+		masks->structural |=
+			(uint64_t)(uint16_t)_mm_movemask_epi8(structural) << shift;
+	}
+}
+
+__attribute__((target("avx2")))
+void json_index_classify_avx2(const char *block, json_index_masks *masks) {
+	const __m256i quote = _mm256_set1_epi8('"');
+	const __m256i backslash = _mm256_set1_epi8('\\');
+	const __m256i open = _mm256_set1_epi8('{');
+	const __m256i close = _mm256_set1_epi8('}');
+	const __m256i colon = _mm256_set1_epi8(':');
+	const __m256i comma = _mm256_set1_epi8(',');
+	const __m256i case_bit = _mm256_set1_epi8(0x20);
+
+	masks->quote = 0;
+	masks->backslash = 0;
+	masks->structural = 0;
+
+	for (int part = 0; part < 2; part++) {
+		__m256i chunk = _mm256_loadu_si256(
+			(const __m256i *)(block + part * 32)
+		);
+		__m256i folded = _mm256_or_si256(chunk, case_bit);
+		__m256i structural = _mm256_or_si256(
+			_mm256_or_si256(
+				_mm256_cmpeq_epi8(folded, open),
+				_mm256_cmpeq_epi8(folded, close)
+			),
+			_mm256_or_si256(
+				_mm256_cmpeq_epi8(chunk, colon),
+				_mm256_cmpeq_epi8(chunk, comma)
+			)
+		);
+
+		int shift = part * 32;
+		masks->quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+			_mm256_cmpeq_epi8(chunk, quote)
+		) << shift;
+		masks->backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+			_mm256_cmpeq_epi8(chunk, backslash)
+		) << shift;
+		masks->structural |=
+			(uint64_t)(uint32_t)_mm256_movemask_epi8(structural) << shift;
+	}
+}
+
+#endif
+
+/** Dispatch **/
+
+json_index_classifier json_index_classify = NULL;
+const char *json_index_classify_name = NULL;
+
+bool json_index_use(json_index_kernel kernel) {
+#ifdef JSON_INDEX_X86
+	__builtin_cpu_init();
+	bool has_avx2 = __builtin_cpu_supports("avx2");
+
+	if (kernel == JSON_INDEX_AUTO) {
+		kernel = has_avx2 ? JSON_INDEX_AVX2 : JSON_INDEX_SSE2;
+	}
+
+	if (kernel == JSON_INDEX_AVX2 && has_avx2) {
+		json_index_classify = &json_index_classify_avx2;
+		json_index_classify_name = "avx2";
+		return true;
+	}
+
+	// SSE2 is part of x86-64.
+	if (kernel == JSON_INDEX_SSE2) {
+		json_index_classify = &json_index_classify_sse2;
+		json_index_classify_name = "sse2";
+		return true;
+	}
+#else
+	if (kernel == JSON_INDEX_AUTO) {
+		kernel = JSON_INDEX_SCALAR;
+	}
+#endif
+
+	if (kernel == JSON_INDEX_SCALAR) {
+		json_index_classify = &json_index_classify_scalar;
+		json_index_classify_name = "scalar";
+		return true;
+	}
+
+	return false;
+}
+
+const char *json_index_kernel_name() {
+	if (json_index_classify == NULL) {
+		json_index_use(JSON_INDEX_AUTO);
+	}
+
+	return json_index_classify_name;
+}
+
+bool json_index_vectorized() {
+	if (json_index_classify == NULL) {
+		json_index_use(JSON_INDEX_AUTO);
+	}
+
+	return json_index_classify != &json_index_classify_scalar;
+}
+
+/** Index **/
+
+int json_index_ctz(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_ctzll(value);
+#else
+	int count = 0;
+	while ((value & 1) == 0) {
+		value >>= 1;
+		count++;
+	}
+	return count;
+#endif
+}
+
+/**
+ * Finds characters escaped by backslashes. Backslashes are rare, so they're
+ * walked one by one.
+ *
+ * @param backslash Backslashes of the block.
+ * @param carry Set to 1 if the first character of the next block is escaped.
+ * On input, whether the first character of this block is.
+ *
+ * @return Mask of escaped characters.
+ */
+uint64_t json_index_escaped(uint64_t backslash, uint64_t *carry) {
+	uint64_t escaped = *carry;
+	backslash &= ~*carry;
+	*carry = 0;
+
+	while (backslash != 0) {
+		int bit = json_index_ctz(backslash);
+		if (bit == 63) {
+			*carry = 1;
+			break;
+		}
+
+		escaped |= (uint64_t)2 << bit;
+		backslash &= ~((uint64_t)3 << bit);
+	}
+
+	return escaped;
+}
+
+/**
+ * Sets every bit from each set bit up to, not including, the next one, which
+ * turns quote positions into a mask of string contents with opening quotes.
+ */
+uint64_t json_index_prefix_xor(uint64_t bits) {
+	bits ^= bits << 1;
+	bits ^= bits << 2;
+	bits ^= bits << 4;
+	bits ^= bits << 8;
+	bits ^= bits << 16;
+	bits ^= bits << 32;
+	return bits;
+}
+
+void json_index_build(json_index *index, const char *json, size_t length) {
+	if (json_index_classify == NULL) {
+		json_index_use(JSON_INDEX_AUTO);
+	}
+
+	uint64_t in_string = 0;   // All ones if the previous block ended in one.
+	uint64_t escaped = 0;     // 1 if the block starts with escaped character.
+	char tail[64];
+
+	index->count = 0;
+
+	for (size_t offset = 0; offset < length; offset += 64) {
+		const char *block = json + offset;
+		if (length - offset < 64) {
+			memset(tail, ' ', sizeof(tail));
+			memcpy(tail, block, length - offset);
+			block = tail;
+		}
+
+		json_index_masks masks;
+		json_index_classify(block, &masks);
+
+		uint64_t quotes = masks.quote & ~json_index_escaped(
+			masks.backslash,
+			&escaped
+		);
+		uint64_t string = json_index_prefix_xor(quotes) ^ in_string;
+		in_string = (string >> 63) ? ~(uint64_t)0 : 0;
+
+		uint64_t bits = quotes
+			| (masks.structural & ~string)
+			| (masks.backslash & string);
+
+		if (index->count + 64 > index->capacity) {
+			size_t capacity = index->capacity > 0 ? index->capacity * 2 : 1024;
+			while (capacity < index->count + 64) {
+				capacity *= 2;
+			}
+
+			index->positions = realloc(
+				index->positions,
+				capacity * sizeof(uint32_t)
+			);
+			if (index->positions == NULL) {
+				fprintf(stderr, "Failed to allocate memory for JSON index");
+				exit(EXIT_FAILURE);
+			}
+			index->capacity = capacity;
+		}
+
+		while (bits != 0) {
+			index->positions[index->count++] = offset + json_index_ctz(bits);
+			bits &= bits - 1;
+		}
+	}
+}
+
+void json_index_clear(json_index *index) {
+	free(index->positions);
+	index->positions = NULL;
+	index->count = 0;
+	index->capacity = 0;
+}
@@ -0,0 +1,82 @@
+/**
+ * Structural index of JSON text.
+ *
+ * Finds positions of unescaped quotes, backslashes inside strings, and
+ * structural characters ({, }, [, ], : and ,) outside strings, 64 bytes at a
+ * time. Characters of each block are classified with AVX2 or SSE2 where the
+ * CPU supports it, or one by one otherwise, and everything after that is
+ * plain bit arithmetic shared by all kernels, so every kernel gives the same
+ * index. The single-pass parser uses the index to find where strings end, and
+ * whether they have escapes, without looking at their contents.
+ *
+ * Vector kernels are compiled only for x86-64 with GCC or Clang, and can be
+ * left out by defining JSON_INDEX_PORTABLE.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#ifndef _H_JSON_INDEX_UTILS
+#define _H_JSON_INDEX_UTILS
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * Character classification kernels.
+ */
+typedef enum {
+	JSON_INDEX_AUTO,    // Best kernel supported by the CPU.
+	JSON_INDEX_SCALAR,
+	JSON_INDEX_SSE2,
+	JSON_INDEX_AVX2
+} json_index_kernel;
+
+/**
+ * Structural index.
+ */
+typedef struct {
+	uint32_t *positions;  // Offsets of indexed characters, ascending.
+	size_t count;
+	size_t capacity;
+} json_index;
+
+/**
+ * Selects the kernel used by json_index_build().
+ *
+ * @param kernel Kernel to use.
+ *
+ * @return false if the kernel isn't available in this build or on this CPU,
+ * in which case the selection is unchanged.
+ */
+bool json_index_use(json_index_kernel kernel);
+
+/**
+ * Returns name of the kernel used by json_index_build().
+ */
+const char *json_index_kernel_name();
+
+/**
+ * Returns whether json_index_build() uses a vector kernel. Indexing one
+ * character at a time costs about as much as the parsing it saves.
+ */
+bool json_index_vectorized();
+
+/**
+ * Indexes JSON text, replacing previous contents of the index.
+ *
+ * @param index Index to fill. Its buffer is reused.
+ * @param json JSON text. Must be shorter than 4 GiB.
+ * @param length Length of the text.
+ */
+void json_index_build(json_index *index, const char *json, size_t length);
+
+/**
+ * Frees the buffer of the index.
+ *
+ * @param index Index to clear.
+ */
+void json_index_clear(json_index *index);
+
+#endif
@@ -0,0 +1,634 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "utils/json/json_sax.h"
+
+/** Data **/
+
+/**
+ * What the tokenizer expects next outside of tokens.
+ */
+typedef enum {
+	JSON_SAX_EXPECT_VALUE,   // Value, at the start or after `:`.
+	JSON_SAX_EXPECT_ITEM,    // Value or `]`, after `[` or `,` in arrays.
+	JSON_SAX_EXPECT_KEY,     // Key or `}`, after `{` or `,` in objects.
+	JSON_SAX_EXPECT_COLON,
+	JSON_SAX_EXPECT_NEXT,    // `,` or end of the container, after a value.
+	JSON_SAX_EXPECT_END      // Only whitespace, after the root value.
+} json_sax_state;
+
+/**
+ * Tokens that can be split between chunks.
+ */
+typedef enum {
+	JSON_SAX_TOKEN_NONE,
+	JSON_SAX_TOKEN_STRING,
+	JSON_SAX_TOKEN_ESCAPE,
+	JSON_SAX_TOKEN_NUMBER,
+	JSON_SAX_TOKEN_LITERAL
+} json_sax_token;
+
+/** Setup **/
+
+void json_sax_init(json_sax *sax, json_sax_handler handler, void *user_data) {
+	memset(sax, 0, sizeof(json_sax));
+	sax->handler = handler;
+	sax->user_data = user_data;
+	sax->state = JSON_SAX_EXPECT_VALUE;
+	sax->token = JSON_SAX_TOKEN_NONE;
+}
+
+void json_sax_clear(json_sax *sax) {
+	free(sax->stack);
+	free(sax->buffer);
+	sax->stack = NULL;
+	sax->buffer = NULL;
+	sax->depth = 0;
+	sax->stack_capacity = 0;
+	sax->length = 0;
+	sax->capacity = 0;
+}
+
+/** Helpers **/
+
+void json_sax_append(json_sax *sax, const char *data, size_t length) {
+	if (length == 0) {
+		return;
+	}
+
+	if (sax->length + length > sax->capacity) {
+		size_t capacity = (sax->capacity > 0) ? sax->capacity * 2 : 256;
+		while (capacity < sax->length + length) {
+			capacity *= 2;
+		}
+
+		sax->buffer = realloc(sax->buffer, capacity);
+		if (sax->buffer == NULL) {
+			fprintf(stderr, "Failed to allocate memory for JSON token");
+			exit(EXIT_FAILURE);
+		}
+		sax->capacity = capacity;
+	}
+
+	memcpy(sax->buffer + sax->length, data, length);
+	sax->length += length;
+}
+
+void json_sax_push(json_sax *sax, char container) {
+	if (sax->depth == sax->stack_capacity) {
+		sax->stack_capacity = (sax->stack_capacity > 0)
+			? sax->stack_capacity * 2
+			: 32;
+		sax->stack = realloc(sax->stack, sax->stack_capacity);
+		if (sax->stack == NULL) {
+			fprintf(stderr, "Failed to allocate memory for JSON containers");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	sax->stack[sax->depth++] = container;
+}
+
+bool json_sax_fail(json_sax *sax) {
+	sax->failed = true;
+	return false;
+}
+
+/**
+ * Reports a complete token to the handler.
+ */
+bool json_sax_emit(
+	json_sax *sax,
+	json_sax_event event,
+	const json_sax_value *value
+) {
+	if (!sax->handler(event, value, sax->user_data)) {
+		return json_sax_fail(sax);
+	}
+
+	return true;
+}
+
+/**
+ * Moves on after a complete value.
+ */
+void json_sax_value_done(json_sax *sax) {
+	sax->state = (sax->depth > 0) ? JSON_SAX_EXPECT_NEXT : JSON_SAX_EXPECT_END;
+}
+
+bool json_sax_is_number_char(char c) {
+	return (c >= '0' && c <= '9') ||
+		c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+/** Strings **/
+
+bool json_sax_end_string(json_sax *sax, const char *text, size_t length) {
+	json_sax_value value = { 0 };
+	value.string = text;
+	value.length = length;
+
+	bool key = sax->key;
+	sax->token = JSON_SAX_TOKEN_NONE;
+	sax->length = 0;
+
+	if (key) {
+		sax->state = JSON_SAX_EXPECT_COLON;
+	} else {
+		json_sax_value_done(sax);
+	}
+
+	return json_sax_emit(sax, key ? JSON_SAX_KEY : JSON_SAX_STRING, &value);
+}
+
+unsigned char json_sax_hex(char c) {
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	if (c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	}
+	return 0xFF;
+}
+
+unsigned int json_sax_hex4(const char *digits) {
+	unsigned int code = 0;
+	for (int idx = 0; idx < 4; idx++) {
+		code = (code << 4) | json_sax_hex(digits[idx]);
+	}
+	return code;
+}
+
+/**
+ * Decodes the escape sequence read so far into the token buffer, once it's
+ * complete.
+ *
+ * @return 1 if the sequence was decoded, 0 if it needs more characters, or -1
+ * if it's invalid.
+ */
+int json_sax_read_escape(json_sax *sax) {
+	const char *escape = sax->escape;
+	int last = sax->escape_length - 1;
+	char out[4];
+
+	switch (escape[0]) {
+		case 'b': out[0] = '\b'; break;
+		case 'f': out[0] = '\f'; break;
+		case 'n': out[0] = '\n'; break;
+		case 'r': out[0] = '\r'; break;
+		case 't': out[0] = '\t'; break;
+		case 'u': break;
+		default: out[0] = escape[0]; break;
+	}
+
+	if (escape[0] != 'u') {
+		json_sax_append(sax, out, 1);
+		return 1;
+	}
+
+	// Check characters as they come: \uXXXX, optionally followed by the low
+	// surrogate \uXXXX.
+	if (last == 5 && escape[last] != '\\') {
+		return -1;
+	}
+	if (last == 6 && escape[last] != 'u') {
+		return -1;
+	}
+	if (
+		last > 0 &&
+		last != 5 &&
+		last != 6 &&
+		json_sax_hex(escape[last]) == 0xFF
+	) {
+		return -1;
+	}
+
+	if (last < 4) {
+		return 0;
+	}
+
+	unsigned int code = json_sax_hex4(escape + 1);
+
+	// High surrogate must be followed by the low one.
+	if ((code & 0xF800) == 0xD800) {
+		if (last < 10) {
+			return 0;
+		}
+
+		unsigned int low = json_sax_hex4(escape + 7);
+		code = 0x010000 | ((code & 0x3FF) << 10) | (low & 0x3FF);
+	}
+
+	int length = 0;
+	if (code <= 0x7F) {
+		out[length++] = code;
+	} else if (code <= 0x7FF) {
+		out[length++] = 0xC0 | (code >> 6);
+		out[length++] = 0x80 | (code & 0x3F);
+	} else if (code <= 0xFFFF) {
+		out[length++] = 0xE0 | (code >> 12);
+		out[length++] = 0x80 | ((code >> 6) & 0x3F);
+		out[length++] = 0x80 | (code & 0x3F);
+	} else {
+		out[length++] = 0xF0 | (code >> 18);
+		out[length++] = 0x80 | ((code >> 12) & 0x3F);
+		out[length++] = 0x80 | ((code >> 6) & 0x3F);
+		out[length++] = 0x80 | (code & 0x3F);
+	}
+
+	json_sax_append(sax, out, length);
+	return 1;
+}
+
+/** Numbers and literals **/
+
+/**
+ * Converts the number in the token buffer the same way json_parse() does.
+ *
+ * @return false if it's not a valid number.
+ */
+bool json_sax_read_number(json_sax *sax, json_sax_value *value, bool *dbl) {
+	static const json_int_t int_max = INT64_MAX;
+
+	const char *ptr = sax->buffer;
+	const char *end = sax->buffer + sax->length;
+	bool negative = false;
+	json_int_t integer = 0;
+	double number = 0;
+
+	*dbl = false;
+
+	if (*ptr == '-') {
+		negative = true;
+		ptr++;
+	}
+
+	// Integer part.
+	int digits = 0;
+	bool zero = false;
+	while (ptr < end && *ptr >= '0' && *ptr <= '9') {
+		int digit = *ptr++ - '0';
+		digits++;
+
+		if (!*dbl) {
+			if (zero) {
+				return false;
+			}
+			if (digits == 1 && digit == 0) {
+				zero = true;
+			}
+
+			if ((int_max - digit) / 10 >= integer) {
+				integer = integer * 10 + digit;
+				continue;
+			}
+
+			*dbl = true;
+			number = (double)integer;
+		}
+
+		number = number * 10 + digit;
+	}
+
+	if (digits == 0) {
+		return false;
+	}
+
+	// Fraction.
+	if (ptr < end && *ptr == '.') {
+		if (!*dbl) {
+			*dbl = true;
+			number = (double)integer;
+		}
+		ptr++;
+
+		double fraction = 0;
+		digits = 0;
+		while (ptr < end && *ptr >= '0' && *ptr <= '9') {
+			fraction = fraction * 10 + (*ptr++ - '0');
+			digits++;
+		}
+
+		if (digits == 0) {
+			return false;
+		}
+
+		number += fraction / pow(10.0, digits);
+	}
+
+	// Exponent.
+	if (ptr < end && (*ptr == 'e' || *ptr == 'E')) {
+		if (!*dbl) {
+			*dbl = true;
+			number = (double)integer;
+		}
+		ptr++;
+
+		bool exp_negative = false;
+		if (ptr < end && (*ptr == '+' || *ptr == '-')) {
+			exp_negative = (*ptr == '-');
+			ptr++;
+		}
+
+		double exponent = 0;
+		digits = 0;
+		while (ptr < end && *ptr >= '0' && *ptr <= '9') {
+			exponent = exponent * 10 + (*ptr++ - '0');
+			digits++;
+		}
+
+		if (digits == 0) {
+			return false;
+		}
+
+		number *= pow(10.0, exp_negative ? -exponent : exponent);
+	}
+
+	if (ptr != end) {
+		return false;
+	}
+
+	value->integer = negative ? -integer : integer;
+	value->dbl = negative ? -number : number;
+	return true;
+}
+
+bool json_sax_end_number(json_sax *sax) {
+	json_sax_value value = { 0 };
+	bool dbl = false;
+
+	if (!json_sax_read_number(sax, &value, &dbl)) {
+		return json_sax_fail(sax);
+	}
+
+	sax->token = JSON_SAX_TOKEN_NONE;
+	sax->length = 0;
+	json_sax_value_done(sax);
+
+	return json_sax_emit(
+		sax,
+		dbl ? JSON_SAX_DOUBLE : JSON_SAX_INTEGER,
+		&value
+	);
+}
+
+bool json_sax_end_literal(json_sax *sax) {
+	json_sax_value value = { 0 };
+	json_sax_event event;
+
+	if (sax->length == 4 && memcmp(sax->buffer, "true", 4) == 0) {
+		event = JSON_SAX_BOOLEAN;
+		value.boolean = true;
+	} else if (sax->length == 5 && memcmp(sax->buffer, "false", 5) == 0) {
+		event = JSON_SAX_BOOLEAN;
+	} else if (sax->length == 4 && memcmp(sax->buffer, "null", 4) == 0) {
+		event = JSON_SAX_NULL;
+	} else {
+		return json_sax_fail(sax);
+	}
+
+	sax->token = JSON_SAX_TOKEN_NONE;
+	sax->length = 0;
+	json_sax_value_done(sax);
+
+	return json_sax_emit(sax, event, &value);
+}
+
+/** Tokenizer **/
+
+/**
+ * Continues reading a token split between chunks.
+ *
+ * @param ptr Position in the chunk, moved past what's consumed.
+ * @param end End of the chunk.
+ *
+ * @return false on error.
+ */
+bool json_sax_continue(json_sax *sax, const char **ptr, const char *end) {
+	const char *start = *ptr;
+	const char *cur = start;
+
+	switch (sax->token) {
+		case JSON_SAX_TOKEN_STRING:
+			while (cur < end && *cur != '"' && *cur != '\\') {
+				cur++;
+			}
+
+			if (cur == end) {
+				json_sax_append(sax, start, cur - start);
+				break;
+			}
+
+			if (*cur == '\\') {
+				json_sax_append(sax, start, cur - start);
+				sax->token = JSON_SAX_TOKEN_ESCAPE;
+				sax->escape_length = 0;
+				cur++;
+				break;
+			}
+
+			*ptr = cur + 1;
+
+			// Whole string is in this chunk, and has no escapes.
+			if (sax->length == 0) {
+				return json_sax_end_string(sax, start, cur - start);
+			}
+
+			json_sax_append(sax, start, cur - start);
+			return json_sax_end_string(sax, sax->buffer, sax->length);
+		case JSON_SAX_TOKEN_ESCAPE: {
+			sax->escape[sax->escape_length++] = *cur++;
+
+			int result = json_sax_read_escape(sax);
+			if (result < 0) {
+				return json_sax_fail(sax);
+			}
+			if (result > 0) {
+				sax->token = JSON_SAX_TOKEN_STRING;
+			}
+			break;
+		}
+		case JSON_SAX_TOKEN_NUMBER:
+			while (cur < end && json_sax_is_number_char(*cur)) {
+				cur++;
+			}
+
+			json_sax_append(sax, start, cur - start);
+			if (cur < end && !json_sax_end_number(sax)) {
+				return false;
+			}
+			break;
+		case JSON_SAX_TOKEN_LITERAL:
+			while (cur < end && *cur >= 'a' && *cur <= 'z') {
+				cur++;
+			}
+
+			json_sax_append(sax, start, cur - start);
+			if (sax->length > 5) {
+				return json_sax_fail(sax);
+			}
+			if (cur < end && !json_sax_end_literal(sax)) {
+				return false;
+			}
+			break;
+	}
+
+	*ptr = cur;
+	return true;
+}
+
+bool json_sax_feed(json_sax *sax, const char *chunk, size_t length) {
+	// The bundled parser takes a null character for the end of the text.
+	if (sax->ended) {
+		return !sax->failed;
+	}
+	const char *nul = memchr(chunk, '\0', length);
+	if (nul != NULL) {
+		length = nul - chunk;
+		sax->ended = true;
+	}
+
+	const char *ptr = chunk;
+	const char *end = chunk + length;
+
+	while (ptr < end && !sax->failed) {
+		if (sax->token != JSON_SAX_TOKEN_NONE) {
+			json_sax_continue(sax, &ptr, end);
+			continue;
+		}
+
+		char c = *ptr++;
+		switch (c) {
+			case ' ':
+			case '\t':
+			case '\n':
+			case '\r':
+				break;
+			case '"':
+				if (sax->state == JSON_SAX_EXPECT_KEY) {
+					sax->key = true;
+				} else if (
+					sax->state == JSON_SAX_EXPECT_VALUE ||
+					sax->state == JSON_SAX_EXPECT_ITEM
+				) {
+					sax->key = false;
+				} else {
+					return json_sax_fail(sax);
+				}
+
+				sax->token = JSON_SAX_TOKEN_STRING;
+				sax->length = 0;
+				break;
+			case '{':
+			case '[':
+				if (
+					sax->state != JSON_SAX_EXPECT_VALUE &&
+					sax->state != JSON_SAX_EXPECT_ITEM
+				) {
+					return json_sax_fail(sax);
+				}
+
+				json_sax_push(sax, c);
+				sax->state = (c == '{')
+					? JSON_SAX_EXPECT_KEY
+					: JSON_SAX_EXPECT_ITEM;
+				json_sax_emit(
+					sax,
+					(c == '{') ? JSON_SAX_OBJECT_START : JSON_SAX_ARRAY_START,
+					NULL
+				);
+				break;
+			case '}':
+			case ']': {
+				char open = (c == '}') ? '{' : '[';
+				int expected = (c == '}')
+					? JSON_SAX_EXPECT_KEY
+					: JSON_SAX_EXPECT_ITEM;
+
+				// Trailing comma is tolerated, as by the bundled parser.
+				if (
+					sax->depth == 0 ||
+					sax->stack[sax->depth - 1] != open ||
+					(
+						sax->state != expected &&
+						sax->state != JSON_SAX_EXPECT_NEXT
+					)
+				) {
+					return json_sax_fail(sax);
+				}
+
+				sax->depth--;
+				json_sax_value_done(sax);
+				json_sax_emit(
+					sax,
+					(c == '}') ? JSON_SAX_OBJECT_END : JSON_SAX_ARRAY_END,
+					NULL
+				);
+				break;
+			}
+			case ':':
+				if (sax->state != JSON_SAX_EXPECT_COLON) {
+					return json_sax_fail(sax);
+				}
+				sax->state = JSON_SAX_EXPECT_VALUE;
+				break;
+			case ',':
+				if (sax->state != JSON_SAX_EXPECT_NEXT) {
+					return json_sax_fail(sax);
+				}
+				sax->state = (sax->stack[sax->depth - 1] == '{')
+					? JSON_SAX_EXPECT_KEY
+					: JSON_SAX_EXPECT_ITEM;
+				break;
+			default:
+				if (
+					sax->state != JSON_SAX_EXPECT_VALUE &&
+					sax->state != JSON_SAX_EXPECT_ITEM
+				) {
+					return json_sax_fail(sax);
+				}
+
+				if (c == '-' || (c >= '0' && c <= '9')) {
+					sax->token = JSON_SAX_TOKEN_NUMBER;
+				} else if (c == 't' || c == 'f' || c == 'n') {
+					sax->token = JSON_SAX_TOKEN_LITERAL;
+				} else {
+					return json_sax_fail(sax);
+				}
+
+				sax->length = 0;
+				json_sax_append(sax, &c, 1);
+				break;
+		}
+	}
+
+	return !sax->failed;
+}
+
+bool json_sax_finish(json_sax *sax) {
+	if (sax->failed) {
+		return false;
+	}
+
+	// Only a root number or literal can end with the text.
+	if (sax->token == JSON_SAX_TOKEN_NUMBER) {
+		json_sax_end_number(sax);
+	} else if (sax->token == JSON_SAX_TOKEN_LITERAL) {
+		json_sax_end_literal(sax);
+	} else if (sax->token != JSON_SAX_TOKEN_NONE) {
+		json_sax_fail(sax);
+	}
+
+	if (!sax->failed && sax->state != JSON_SAX_EXPECT_END) {
+		json_sax_fail(sax);
+	}
+
+	return !sax->failed;
+}
@@ -0,0 +1,126 @@
+/**
+ * Resumable event-based JSON tokenizer.
+ *
+ * Reads JSON text in chunks of any size, e.g. as they arrive from the
+ * network, and reports every token to a handler as soon as it's complete,
+ * without building a tree. Tokens split between chunks are collected in an
+ * internal buffer. Strings that fit into one chunk and have no escapes are
+ * reported straight from it.
+ *
+ * Accepts the same text as json_parse() with default settings, including
+ * trailing commas in objects and arrays, and reads numbers the same way. A
+ * null character ends the text, as it does for json_parse().
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#ifndef _H_JSON_SAX_UTILS
+#define _H_JSON_SAX_UTILS
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "json/json.h"
+
+/**
+ * Tokenizer events.
+ */
+typedef enum {
+	JSON_SAX_OBJECT_START,
+	JSON_SAX_OBJECT_END,
+	JSON_SAX_ARRAY_START,
+	JSON_SAX_ARRAY_END,
+	JSON_SAX_KEY,
+	JSON_SAX_STRING,
+	JSON_SAX_INTEGER,
+	JSON_SAX_DOUBLE,
+	JSON_SAX_BOOLEAN,
+	JSON_SAX_NULL
+} json_sax_event;
+
+/**
+ * Value of a token. Only the member matching the event is set.
+ */
+typedef struct {
+	const char *string;  // Key or string text, not NUL-terminated.
+	size_t length;       // Length of the text.
+	json_int_t integer;
+	double dbl;
+	bool boolean;
+} json_sax_value;
+
+/**
+ * Token handler.
+ *
+ * @param event Kind of the token.
+ * @param value Value of the token. Only valid during the call.
+ * @param user_data User data given to json_sax_init().
+ *
+ * @return false to stop tokenizing.
+ */
+typedef bool (*json_sax_handler)(
+	json_sax_event event,
+	const json_sax_value *value,
+	void *user_data
+);
+
+/**
+ * Tokenizer state. Treat as opaque.
+ */
+typedef struct {
+	json_sax_handler handler;
+	void *user_data;
+	int state;               // What's expected next.
+	int token;               // Token being read, if it's split between chunks.
+	bool key;                // Whether the string being read is a key.
+	bool failed;             // Set on syntax error or stop by the handler.
+	bool ended;              // Set when a null character ends the text.
+	char *stack;             // Open containers, '{' or '['.
+	size_t depth;
+	size_t stack_capacity;
+	char *buffer;            // Text of the token being read.
+	size_t length;
+	size_t capacity;
+	char escape[12];         // Escape sequence being read, after backslash.
+	int escape_length;
+} json_sax;
+
+/**
+ * Prepares a tokenizer for a new text.
+ *
+ * @param sax Tokenizer to initialize.
+ * @param handler Token handler.
+ * @param user_data Value to pass to the handler.
+ */
+void json_sax_init(json_sax *sax, json_sax_handler handler, void *user_data);
+
+/**
+ * Reads next chunk of the text.
+ *
+ * @param sax Tokenizer.
+ * @param chunk Next part of the text.
+ * @param length Length of the chunk.
+ *
+ * @return false if the text is invalid or the handler stopped tokenizing, in
+ * which case the rest of the text is ignored.
+ */
+bool json_sax_feed(json_sax *sax, const char *chunk, size_t length);
+
+/**
+ * Finishes the text.
+ *
+ * @param sax Tokenizer.
+ *
+ * @return true if the whole text was a valid JSON value.
+ */
+bool json_sax_finish(json_sax *sax);
+
+/**
+ * Frees tokenizer's buffers.
+ *
+ * @param sax Tokenizer to clear.
+ */
+void json_sax_clear(json_sax *sax);
+
+#endif
@@ -0,0 +1,1071 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+
+#include "utils/json/json_single.h"
+#include "utils/json/json_index.h"
+
+/** Data **/
+
+/**
+ * Child of an open container. Names of object entries are kept in the names
+ * buffer until the object closes.
+ */
+typedef struct {
+	size_t name;               // Offset of the name in the names buffer.
+	unsigned int name_length;
+	json_value *value;         // NULL until the entry's value is parsed.
+} json_single_item;
+
+/**
+ * Open container.
+ */
+typedef struct {
+	json_value *value;
+	size_t items;              // Index of its first child.
+	size_t names;              // Offset of its first name.
+} json_single_frame;
+
+struct json_single_scratch {
+	json_single_frame *frames;
+	size_t frames_count;
+	size_t frames_capacity;
+	json_single_item *items;
+	size_t items_count;
+	size_t items_capacity;
+	char *names;
+	size_t names_length;
+	size_t names_capacity;
+	char *string;              // Unescaped string value.
+	size_t string_capacity;
+	json_index index;          // Structural index of the input.
+	bool indexing;             // Whether to index large inputs.
+};
+
+typedef struct {
+	json_settings settings;
+	json_single_scratch *scratch;
+	const json_char *start;
+	const json_char *ptr;
+	const json_char *end;
+	unsigned long used_memory;
+	char *error;
+	bool indexed;              // Whether the scratch has index of the input.
+	size_t cursor;             // Next entry of the index to look at.
+} json_single_state;
+
+/** Scratch **/
+
+json_single_scratch *json_single_scratch_init() {
+	json_single_scratch *scratch = calloc(1, sizeof(json_single_scratch));
+	if (scratch == NULL) {
+		fprintf(stderr, "Failed to allocate memory for JSON scratch space");
+		exit(EXIT_FAILURE);
+	}
+
+	scratch->indexing = json_index_vectorized();
+	return scratch;
+}
+
+void json_single_scratch_free(json_single_scratch *scratch) {
+	if (scratch == NULL) {
+		return;
+	}
+
+	free(scratch->frames);
+	free(scratch->items);
+	free(scratch->names);
+	free(scratch->string);
+	json_index_clear(&scratch->index);
+	free(scratch);
+}
+
+void json_single_scratch_set_indexing(
+	json_single_scratch *scratch,
+	bool enabled
+) {
+	scratch->indexing = enabled;
+}
+
+/**
+ * Makes sure the buffer has room for given number of elements.
+ */
+void *json_single_reserve(
+	void *buffer,
+	size_t *capacity,
+	size_t needed,
+	size_t size
+) {
+	if (needed <= *capacity) {
+		return buffer;
+	}
+
+	size_t new_capacity = (*capacity > 0) ? *capacity * 2 : 64;
+	while (new_capacity < needed) {
+		new_capacity *= 2;
+	}
+
+	buffer = realloc(buffer, new_capacity * size);
+	if (buffer == NULL) {
+		fprintf(stderr, "Failed to allocate memory for JSON scratch space");
+		exit(EXIT_FAILURE);
+	}
+
+	*capacity = new_capacity;
+	return buffer;
+}
+
+/** Helpers **/
+
+void *json_single_default_alloc(size_t size, int zero, void *user_data) {
+	(void)user_data;
+	return zero ? calloc(1, size) : malloc(size);
+}
+
+void json_single_default_free(void *ptr, void *user_data) {
+	(void)user_data;
+	free(ptr);
+}
+
+void *json_single_alloc(json_single_state *state, size_t size, int zero) {
+	if (state->settings.max_memory > 0) {
+		state->used_memory += size;
+		if (state->used_memory > state->settings.max_memory) {
+			return NULL;
+		}
+	}
+
+	return state->settings.mem_alloc(size, zero, state->settings.user_data);
+}
+
+/**
+ * Writes an error message prefixed with the current line and column.
+ */
+void json_single_fail(json_single_state *state, const char *message, int c) {
+	if (state->error == NULL) {
+		return;
+	}
+
+	unsigned int line = 1, col = 0;
+	for (const json_char *ptr = state->start; ptr < state->ptr; ptr++) {
+		if (*ptr == '\n') {
+			line++;
+			col = 0;
+		} else {
+			col++;
+		}
+	}
+
+	char text[json_error_max / 2];
+	snprintf(text, sizeof(text), message, c);
+	snprintf(state->error, json_error_max, "%u:%u: %s", line, col, text);
+}
+
+unsigned char json_single_hex(json_char c) {
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	if (c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	}
+	return 0xFF;
+}
+
+/**
+ * Skips whitespace, and comments if they're enabled.
+ *
+ * @return false if a block comment isn't closed.
+ */
+bool json_single_skip(json_single_state *state) {
+	const json_char *ptr = state->ptr;
+	const json_char *end = state->end;
+	bool comments = (state->settings.settings & json_enable_comments) != 0;
+
+	while (ptr < end) {
+		json_char c = *ptr;
+		if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+			ptr++;
+			continue;
+		}
+
+		if (!comments || c != '/' || ptr + 1 >= end) {
+			break;
+		}
+
+		if (ptr[1] == '/') {
+			ptr += 2;
+			while (ptr < end && *ptr != '\n' && *ptr != '\r') {
+				ptr++;
+			}
+		} else if (ptr[1] == '*') {
+			ptr += 2;
+			while (ptr + 1 < end && !(ptr[0] == '*' && ptr[1] == '/')) {
+				ptr++;
+			}
+			if (ptr + 1 >= end) {
+				state->ptr = end;
+				json_single_fail(state, "Unexpected EOF in block comment", 0);
+				return false;
+			}
+			ptr += 2;
+		} else {
+			break;
+		}
+	}
+
+	state->ptr = ptr;
+	return true;
+}
+
+/**
+ * Reads four hex digits of an \u escape.
+ *
+ * @return Code unit, or UINT_MAX if the digits are invalid.
+ */
+unsigned int json_single_read_hex4(json_single_state *state) {
+	if (state->end - state->ptr < 4) {
+		return UINT_MAX;
+	}
+
+	unsigned int code = 0;
+	for (int idx = 0; idx < 4; idx++) {
+		unsigned char digit = json_single_hex(state->ptr[idx]);
+		if (digit == 0xFF) {
+			return UINT_MAX;
+		}
+		code = (code << 4) | digit;
+	}
+
+	state->ptr += 4;
+	return code;
+}
+
+/**
+ * Decodes one escape sequence following a backslash.
+ *
+ * @param out Receives up to 4 bytes of decoded text.
+ *
+ * @return Number of bytes written, or -1 on invalid escape.
+ */
+int json_single_read_escape(json_single_state *state, char *out) {
+	json_char c = *state->ptr++;
+
+	switch (c) {
+		case 'b': out[0] = '\b'; return 1;
+		case 'f': out[0] = '\f'; return 1;
+		case 'n': out[0] = '\n'; return 1;
+		case 'r': out[0] = '\r'; return 1;
+		case 't': out[0] = '\t'; return 1;
+		case 'u': break;
+		default: out[0] = c; return 1;
+	}
+
+	unsigned int code = json_single_read_hex4(state);
+	if (code == UINT_MAX) {
+		return -1;
+	}
+
+	// High surrogate must be followed by the low one.
+	if ((code & 0xF800) == 0xD800) {
+		if (
+			state->end - state->ptr < 6 ||
+			state->ptr[0] != '\\' ||
+			state->ptr[1] != 'u'
+		) {
+			return -1;
+		}
+		state->ptr += 2;
+
+		unsigned int low = json_single_read_hex4(state);
+		if (low == UINT_MAX) {
+			return -1;
+		}
+		code = 0x010000 | ((code & 0x3FF) << 10) | (low & 0x3FF);
+	}
+
+	if (code <= 0x7F) {
+		out[0] = code;
+		return 1;
+	}
+
+	if (code <= 0x7FF) {
+		out[0] = 0xC0 | (code >> 6);
+		out[1] = 0x80 | (code & 0x3F);
+		return 2;
+	}
+
+	if (code <= 0xFFFF) {
+		out[0] = 0xE0 | (code >> 12);
+		out[1] = 0x80 | ((code >> 6) & 0x3F);
+		out[2] = 0x80 | (code & 0x3F);
+		return 3;
+	}
+
+	out[0] = 0xF0 | (code >> 18);
+	out[1] = 0x80 | ((code >> 12) & 0x3F);
+	out[2] = 0x80 | ((code >> 6) & 0x3F);
+	out[3] = 0x80 | (code & 0x3F);
+	return 4;
+}
+
+/**
+ * Reads a string after its opening quote into a scratch buffer.
+ *
+ * @param buffer Buffer to append the text to.
+ * @param length Current length of the buffer, updated with appended text.
+ * @param capacity Capacity of the buffer.
+ *
+ * @return false on error.
+ */
+bool json_single_read_string(
+	json_single_state *state,
+	char **buffer,
+	size_t *length,
+	size_t *capacity
+) {
+	const json_char *end = state->end;
+
+	while (true) {
+		// Copy the run of plain characters at once.
+		const json_char *run = state->ptr;
+		while (state->ptr < end && *state->ptr != '"' && *state->ptr != '\\') {
+			state->ptr++;
+		}
+
+		size_t run_length = state->ptr - run;
+		*buffer = json_single_reserve(
+			*buffer,
+			capacity,
+			*length + run_length + 4,
+			1
+		);
+		memcpy(*buffer + *length, run, run_length);
+		*length += run_length;
+
+		if (state->ptr >= end) {
+			json_single_fail(state, "Unexpected EOF in string", 0);
+			return false;
+		}
+
+		if (*state->ptr++ == '"') {
+			break;
+		}
+
+		if (state->ptr >= end) {
+			json_single_fail(state, "Unexpected EOF in string", 0);
+			return false;
+		}
+
+		int written = json_single_read_escape(state, *buffer + *length);
+		if (written < 0) {
+			json_single_fail(state, "Invalid character value in string", 0);
+			return false;
+		}
+		*length += written;
+	}
+
+	if (*length > UINT_MAX - 8) {
+		json_single_fail(state, "Too long (caught overflow)", 0);
+		return false;
+	}
+
+	return true;
+}
+
+json_value *json_single_new_value(
+	json_single_state *state,
+	json_type type,
+	json_value *parent
+) {
+	json_value *value = json_single_alloc(
+		state,
+		sizeof(json_value) + state->settings.value_extra,
+		1
+	);
+	if (value == NULL) {
+		json_single_fail(state, "Memory allocation failure", 0);
+		return NULL;
+	}
+
+	value->type = type;
+	value->parent = parent;
+	return value;
+}
+
+/**
+ * Looks up the end of a string in the structural index, when the parser is
+ * right after its opening quote.
+ *
+ * @return Closing quote, or NULL if the string has escapes or there's no
+ * index.
+ */
+const json_char *json_single_string_end(json_single_state *state) {
+	if (!state->indexed) {
+		return NULL;
+	}
+
+	json_index *index = &state->scratch->index;
+	uint32_t open = (state->ptr - state->start) - 1;
+	size_t cursor = state->cursor;
+	while (cursor < index->count && index->positions[cursor] < open) {
+		cursor++;
+	}
+	state->cursor = cursor;
+
+	if (cursor + 1 >= index->count || index->positions[cursor] != open) {
+		return NULL;
+	}
+
+	// Next entry is either the closing quote or a backslash inside.
+	const json_char *end = state->start + index->positions[cursor + 1];
+	if (*end != '"') {
+		return NULL;
+	}
+
+	state->cursor = cursor + 2;
+	return end;
+}
+
+/**
+ * Reads a string value after its opening quote.
+ */
+json_value *json_single_string_value(
+	json_single_state *state,
+	json_value *parent
+) {
+	const json_char *text = state->ptr;
+	size_t length = 0;
+
+	// Strings without escapes are copied straight from the input.
+	const json_char *ptr = json_single_string_end(state);
+	if (ptr == NULL) {
+		ptr = state->ptr;
+		while (ptr < state->end && *ptr != '"' && *ptr != '\\') {
+			ptr++;
+		}
+	}
+
+	if (ptr < state->end && *ptr == '"') {
+		length = ptr - state->ptr;
+		state->ptr = ptr + 1;
+		if (length > UINT_MAX - 8) {
+			json_single_fail(state, "Too long (caught overflow)", 0);
+			return NULL;
+		}
+	} else {
+		json_single_scratch *scratch = state->scratch;
+		if (!json_single_read_string(
+			state,
+			&scratch->string,
+			&length,
+			&scratch->string_capacity
+		)) {
+			return NULL;
+		}
+		text = scratch->string;
+	}
+
+	json_value *value = json_single_new_value(state, json_string, parent);
+	if (value == NULL) {
+		return NULL;
+	}
+
+	value->u.string.ptr = json_single_alloc(state, length + 1, 0);
+	if (value->u.string.ptr == NULL) {
+		state->settings.mem_free(value, state->settings.user_data);
+		json_single_fail(state, "Memory allocation failure", 0);
+		return NULL;
+	}
+
+	memcpy(value->u.string.ptr, text, length);
+	value->u.string.ptr[length] = '\0';
+	value->u.string.length = length;
+	return value;
+}
+
+/**
+ * Reads a number. Values are computed the same way the bundled parser does
+ * it, so both parsers give identical results.
+ */
+json_value *json_single_number_value(
+	json_single_state *state,
+	json_value *parent
+) {
+	static const json_int_t int_max = INT64_MAX;
+
+	const json_char *ptr = state->ptr;
+	const json_char *end = state->end;
+	bool negative = false;
+	json_type type = json_integer;
+	json_int_t integer = 0;
+	double dbl = 0;
+
+	if (*ptr == '-') {
+		negative = true;
+		ptr++;
+	}
+
+	// Integer part.
+	int digits = 0;
+	bool zero = false;
+	while (ptr < end && *ptr >= '0' && *ptr <= '9') {
+		int digit = *ptr - '0';
+		digits++;
+
+		if (type == json_integer) {
+			if (zero) {
+				state->ptr = ptr;
+				json_single_fail(state, "Unexpected `0` before `%c`", *ptr);
+				return NULL;
+			}
+			if (digits == 1 && digit == 0) {
+				zero = true;
+			}
+
+			if ((int_max - digit) / 10 < integer) {
+				type = json_double;
+				dbl = (double)integer;
+			} else {
+				integer = integer * 10 + digit;
+				ptr++;
+				continue;
+			}
+		}
+
+		dbl = dbl * 10 + digit;
+		ptr++;
+	}
+
+	if (digits == 0) {
+		state->ptr = ptr;
+		json_single_fail(
+			state,
+			"Unexpected %c when seeking value",
+			(ptr < end) ? *ptr : '-'
+		);
+		return NULL;
+	}
+
+	// Fraction.
+	if (ptr < end && *ptr == '.') {
+		if (type == json_integer) {
+			type = json_double;
+			dbl = (double)integer;
+		}
+		ptr++;
+
+		double fraction = 0;
+		digits = 0;
+		while (ptr < end && *ptr >= '0' && *ptr <= '9') {
+			fraction = fraction * 10 + (*ptr - '0');
+			digits++;
+			ptr++;
+		}
+
+		if (digits == 0) {
+			state->ptr = ptr;
+			json_single_fail(state, "Expected digit after `.`", 0);
+			return NULL;
+		}
+
+		dbl += fraction / pow(10.0, digits);
+	}
+
+	// Exponent.
+	if (ptr < end && (*ptr == 'e' || *ptr == 'E')) {
+		if (type == json_integer) {
+			type = json_double;
+			dbl = (double)integer;
+		}
+		ptr++;
+
+		bool exp_negative = false;
+		if (ptr < end && (*ptr == '+' || *ptr == '-')) {
+			exp_negative = (*ptr == '-');
+			ptr++;
+		}
+
+		double exponent = 0;
+		digits = 0;
+		while (ptr < end && *ptr >= '0' && *ptr <= '9') {
+			exponent = exponent * 10 + (*ptr - '0');
+			digits++;
+			ptr++;
+		}
+
+		if (digits == 0) {
+			state->ptr = ptr;
+			json_single_fail(state, "Expected digit after `e`", 0);
+			return NULL;
+		}
+
+		dbl *= pow(10.0, exp_negative ? -exponent : exponent);
+	}
+
+	state->ptr = ptr;
+
+	json_value *value = json_single_new_value(state, type, parent);
+	if (value == NULL) {
+		return NULL;
+	}
+
+	if (type == json_integer) {
+		value->u.integer = negative ? -integer : integer;
+	} else {
+		value->u.dbl = negative ? -dbl : dbl;
+	}
+
+	return value;
+}
+
+/**
+ * Reads true, false or null.
+ */
+json_value *json_single_literal_value(
+	json_single_state *state,
+	json_value *parent
+) {
+	const json_char *ptr = state->ptr;
+	size_t available = state->end - ptr;
+	json_value *value = NULL;
+
+	if (available >= 4 && memcmp(ptr, "true", 4) == 0) {
+		value = json_single_new_value(state, json_boolean, parent);
+		if (value != NULL) {
+			value->u.boolean = 1;
+		}
+		state->ptr += 4;
+	} else if (available >= 5 && memcmp(ptr, "false", 5) == 0) {
+		value = json_single_new_value(state, json_boolean, parent);
+		state->ptr += 5;
+	} else if (available >= 4 && memcmp(ptr, "null", 4) == 0) {
+		value = json_single_new_value(state, json_null, parent);
+		state->ptr += 4;
+	} else {
+		json_single_fail(state, "Unexpected %c when seeking value", *ptr);
+	}
+
+	return value;
+}
+
+/**
+ * Opens a container.
+ */
+void json_single_push_frame(json_single_state *state, json_value *value) {
+	json_single_scratch *scratch = state->scratch;
+	scratch->frames = json_single_reserve(
+		scratch->frames,
+		&scratch->frames_capacity,
+		scratch->frames_count + 1,
+		sizeof(json_single_frame)
+	);
+
+	json_single_frame *frame = &scratch->frames[scratch->frames_count++];
+	frame->value = value;
+	frame->items = scratch->items_count;
+	frame->names = scratch->names_length;
+}
+
+/**
+ * Returns the innermost open container, or NULL if there's none.
+ */
+json_single_frame *json_single_top(json_single_state *state) {
+	json_single_scratch *scratch = state->scratch;
+	return (scratch->frames_count > 0)
+		? &scratch->frames[scratch->frames_count - 1]
+		: NULL;
+}
+
+/**
+ * Adds a child to the innermost open container.
+ */
+json_single_item *json_single_push_item(json_single_state *state) {
+	json_single_scratch *scratch = state->scratch;
+	scratch->items = json_single_reserve(
+		scratch->items,
+		&scratch->items_capacity,
+		scratch->items_count + 1,
+		sizeof(json_single_item)
+	);
+
+	json_single_item *item = &scratch->items[scratch->items_count++];
+	item->name = 0;
+	item->name_length = 0;
+	item->value = NULL;
+	return item;
+}
+
+/**
+ * Gives the container on top of the stack its final array of children, and
+ * pops it.
+ *
+ * @return false if memory can't be allocated.
+ */
+bool json_single_close(json_single_state *state) {
+	json_single_scratch *scratch = state->scratch;
+	json_single_frame *frame = &scratch->frames[scratch->frames_count - 1];
+	json_value *value = frame->value;
+	size_t count = scratch->items_count - frame->items;
+	json_single_item *items = scratch->items + frame->items;
+
+	if (count > UINT_MAX - 8) {
+		json_single_fail(state, "Too long (caught overflow)", 0);
+		return false;
+	}
+
+	if (value->type == json_array && count > 0) {
+		json_value **values = json_single_alloc(
+			state,
+			count * sizeof(json_value *),
+			0
+		);
+		if (values == NULL) {
+			json_single_fail(state, "Memory allocation failure", 0);
+			return false;
+		}
+
+		for (size_t idx = 0; idx < count; idx++) {
+			values[idx] = items[idx].value;
+		}
+
+		value->u.array.values = values;
+		value->u.array.length = count;
+	} else if (value->type == json_object && count > 0) {
+		// Names go right after the entries, in the same allocation, the way
+		// json_value_free_ex() expects them.
+		size_t entries_size = count * sizeof(json_object_entry);
+		size_t names_size = scratch->names_length - frame->names;
+		json_object_entry *entries = json_single_alloc(
+			state,
+			entries_size + names_size,
+			0
+		);
+		if (entries == NULL) {
+			json_single_fail(state, "Memory allocation failure", 0);
+			return false;
+		}
+
+		char *names = (char *)entries + entries_size;
+		memcpy(names, scratch->names + frame->names, names_size);
+
+		for (size_t idx = 0; idx < count; idx++) {
+			entries[idx].name = names + (items[idx].name - frame->names);
+			entries[idx].name_length = items[idx].name_length;
+			entries[idx].value = items[idx].value;
+		}
+
+		value->u.object.values = entries;
+		value->u.object.length = count;
+	}
+
+	scratch->items_count = frame->items;
+	scratch->names_length = frame->names;
+	scratch->frames_count--;
+	return true;
+}
+
+/**
+ * Frees everything parsed so far after an error.
+ */
+void json_single_cleanup(json_single_state *state) {
+	json_single_scratch *scratch = state->scratch;
+
+	for (size_t idx = 0; idx < scratch->items_count; idx++) {
+		if (scratch->items[idx].value != NULL) {
+			json_value_free_ex(&state->settings, scratch->items[idx].value);
+		}
+	}
+
+	for (size_t idx = 0; idx < scratch->frames_count; idx++) {
+		state->settings.mem_free(
+			scratch->frames[idx].value,
+			state->settings.user_data
+		);
+	}
+
+	scratch->items_count = 0;
+	scratch->names_length = 0;
+	scratch->frames_count = 0;
+}
+
+/** Parser **/
+
+json_value *json_single_parse(
+	json_single_scratch *scratch,
+	json_settings *settings,
+	const json_char *json,
+	size_t length,
+	char *error
+) {
+	json_single_scratch local_scratch = { 0 };
+	json_single_state state = { 0 };
+	local_scratch.indexing = json_index_vectorized();
+
+	if (settings != NULL) {
+		state.settings = *settings;
+	}
+	if (state.settings.mem_alloc == NULL) {
+		state.settings.mem_alloc = &json_single_default_alloc;
+	}
+	if (state.settings.mem_free == NULL) {
+		state.settings.mem_free = &json_single_default_free;
+	}
+
+	// Skip UTF-8 BOM.
+	if (
+		length >= 3 &&
+		(unsigned char)json[0] == 0xEF &&
+		(unsigned char)json[1] == 0xBB &&
+		(unsigned char)json[2] == 0xBF
+	) {
+		json += 3;
+		length -= 3;
+	}
+
+	// The bundled parser takes a null character for the end of the text.
+	const json_char *nul = memchr(json, '\0', length);
+	if (nul != NULL) {
+		length = nul - json;
+	}
+
+	state.scratch = (scratch != NULL) ? scratch : &local_scratch;
+	state.start = json;
+	state.ptr = json;
+	state.end = json + length;
+	state.error = error;
+	if (error != NULL) {
+		error[0] = '\0';
+	}
+
+	scratch = state.scratch;
+	// Quotes in comments would throw the index off.
+	if (
+		scratch->indexing &&
+		!(state.settings.settings & json_enable_comments) &&
+		length >= JSON_SINGLE_INDEX_MIN &&
+		length <= UINT32_MAX
+	) {
+		json_index_build(&scratch->index, json, length);
+		state.indexed = true;
+	}
+
+	json_value *root = NULL;
+	json_value *value = NULL;
+
+	while (true) {
+		// Seek next value.
+		if (!json_single_skip(&state)) {
+			goto failed;
+		}
+
+		if (state.ptr >= state.end) {
+			json_single_fail(&state, "Unexpected EOF when seeking value", 0);
+			goto failed;
+		}
+
+		json_single_frame *frame = json_single_top(&state);
+		json_value *parent = (frame != NULL) ? frame->value : NULL;
+		json_char c = *state.ptr;
+
+		if (c == '{' || c == '[') {
+			value = json_single_new_value(
+				&state,
+				(c == '{') ? json_object : json_array,
+				parent
+			);
+			if (value == NULL) {
+				goto failed;
+			}
+
+			json_single_push_frame(&state, value);
+			state.ptr++;
+
+			if (!json_single_skip(&state)) {
+				goto failed;
+			}
+
+			if (
+				state.ptr < state.end &&
+				*state.ptr == ((c == '{') ? '}' : ']')
+			) {
+				state.ptr++;
+				if (!json_single_close(&state)) {
+					goto failed;
+				}
+			} else if (c == '{') {
+				goto next_key;
+			} else {
+				continue;
+			}
+		} else if (c == '"') {
+			state.ptr++;
+			value = json_single_string_value(&state, parent);
+		} else if (c == '-' || (c >= '0' && c <= '9')) {
+			value = json_single_number_value(&state, parent);
+		} else if (c == 't' || c == 'f' || c == 'n') {
+			value = json_single_literal_value(&state, parent);
+		} else {
+			json_single_fail(&state, "Unexpected %c when seeking value", c);
+			goto failed;
+		}
+
+		if (value == NULL) {
+			goto failed;
+		}
+
+		// Attach the value to its container, closing containers that end
+		// right after it.
+		while (true) {
+			frame = json_single_top(&state);
+			if (frame == NULL) {
+				root = value;
+				if (!json_single_skip(&state)) {
+					goto failed;
+				}
+				if (state.ptr < state.end) {
+					json_single_fail(
+						&state,
+						"Trailing garbage: `%c`",
+						*state.ptr
+					);
+					goto failed;
+				}
+				goto done;
+			}
+
+			bool is_object = (frame->value->type == json_object);
+			if (is_object) {
+				scratch->items[scratch->items_count - 1].value = value;
+			} else {
+				json_single_push_item(&state)->value = value;
+			}
+
+			if (!json_single_skip(&state)) {
+				goto failed;
+			}
+
+			if (state.ptr >= state.end) {
+				json_single_fail(&state, "Unexpected EOF in container", 0);
+				goto failed;
+			}
+
+			c = *state.ptr++;
+			if (c == ',') {
+				// Trailing comma is tolerated, as by the bundled parser.
+				if (!json_single_skip(&state)) {
+					goto failed;
+				}
+				if (
+					state.ptr >= state.end ||
+					*state.ptr != (is_object ? '}' : ']')
+				) {
+					break;
+				}
+				c = *state.ptr++;
+			}
+
+			if (c != (is_object ? '}' : ']')) {
+				state.ptr--;
+				json_single_fail(
+					&state,
+					is_object
+						? "Unexpected `%c` in object"
+						: "Unexpected `%c` in array",
+					c
+				);
+				goto failed;
+			}
+
+			value = frame->value;
+			if (!json_single_close(&state)) {
+				goto failed;
+			}
+		}
+
+		if (frame->value->type != json_object) {
+			continue;
+		}
+
+	next_key:
+		// Read the name of the next object entry.
+		if (!json_single_skip(&state)) {
+			goto failed;
+		}
+
+		if (state.ptr >= state.end || *state.ptr != '"') {
+			json_single_fail(
+				&state,
+				"Expected \" before entry name, got `%c`",
+				(state.ptr < state.end) ? *state.ptr : ' '
+			);
+			goto failed;
+		}
+		state.ptr++;
+
+		size_t name = scratch->names_length;
+		const json_char *name_end = json_single_string_end(&state);
+		if (name_end != NULL) {
+			size_t name_length = name_end - state.ptr;
+			scratch->names = json_single_reserve(
+				scratch->names,
+				&scratch->names_capacity,
+				scratch->names_length + name_length + 1,
+				1
+			);
+			memcpy(scratch->names + name, state.ptr, name_length);
+			scratch->names_length += name_length;
+			state.ptr = name_end + 1;
+		} else if (!json_single_read_string(
+			&state,
+			&scratch->names,
+			&scratch->names_length,
+			&scratch->names_capacity
+		)) {
+			goto failed;
+		}
+		scratch->names[scratch->names_length++] = '\0';
+
+		json_single_item *item = json_single_push_item(&state);
+		item->name = name;
+		item->name_length = scratch->names_length - name - 1;
+
+		if (!json_single_skip(&state)) {
+			goto failed;
+		}
+
+		if (state.ptr >= state.end || *state.ptr != ':') {
+			json_single_fail(&state, "Expected : after entry name", 0);
+			goto failed;
+		}
+		state.ptr++;
+	}
+
+failed:
+	if (error != NULL && error[0] == '\0') {
+		strcpy(error, "Unknown error");
+	}
+
+	json_single_cleanup(&state);
+	if (root != NULL) {
+		json_value_free_ex(&state.settings, root);
+		root = NULL;
+	}
+
+done:
+	if (scratch == &local_scratch) {
+		free(local_scratch.frames);
+		free(local_scratch.items);
+		free(local_scratch.names);
+		free(local_scratch.string);
+		json_index_clear(&local_scratch.index);
+	}
+
+	return root;
+}
@@ -0,0 +1,87 @@
+/**
+ * Single-pass JSON parser.
+ *
+ * Builds the same json_value trees as json_parse_ex() from the bundled json
+ * library, so they're read by the same code and freed with
+ * json_value_free_ex() with the same settings. The bundled parser walks the
+ * input twice, first to measure every container and string and then to fill
+ * them. This one walks it once: children of open containers are collected in
+ * growable scratch stacks, and each container gets its final, exactly sized
+ * array when it closes.
+ *
+ * Scratch stacks can be kept between parses, so a warmed up parser only
+ * allocates the tree itself, which can come from an arena through
+ * json_settings.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#ifndef _H_JSON_SINGLE_UTILS
+#define _H_JSON_SINGLE_UTILS
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "json/json.h"
+
+/**
+ * Inputs shorter than this are parsed without structural index, which
+ * wouldn't pay off.
+ */
+#define JSON_SINGLE_INDEX_MIN 1024
+
+typedef struct json_single_scratch json_single_scratch;
+
+/**
+ * Returns new empty scratch space for the parser.
+ *
+ * @return New scratch space. Free it with json_single_scratch_free().
+ */
+json_single_scratch *json_single_scratch_init();
+
+/**
+ * Frees scratch space of the parser.
+ *
+ * @param scratch Scratch space to deallocate. Can be NULL.
+ */
+void json_single_scratch_free(json_single_scratch *scratch);
+
+/**
+ * Sets whether inputs of at least JSON_SINGLE_INDEX_MIN bytes are indexed
+ * with a vectorized stage (see utils/json/json_index.h) before parsing.
+ * Enabled by default if the CPU has a vector kernel. Parsing gives the same
+ * result either way.
+ *
+ * @param scratch Scratch space of the parser.
+ * @param enabled Whether to index inputs.
+ */
+void json_single_scratch_set_indexing(
+	json_single_scratch *scratch,
+	bool enabled
+);
+
+/**
+ * Parses JSON text. Accepts the same input and settings as json_parse_ex(),
+ * including comments, custom allocators, memory limit and extra space for
+ * values.
+ *
+ * @param scratch Scratch space to reuse. If NULL, temporary one is used.
+ * @param settings Parser settings. If NULL, defaults are used.
+ * @param json JSON text.
+ * @param length Length of the text.
+ * @param error Buffer of json_error_max bytes to receive error message. Can be
+ * NULL.
+ *
+ * @return Parsed value, or NULL on error. Free it with json_value_free_ex()
+ * with the same settings.
+ */
+json_value *json_single_parse(
+	json_single_scratch *scratch,
+	json_settings *settings,
+	const json_char *json,
+	size_t length,
+	char *error
+);
+
+#endif
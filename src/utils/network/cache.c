@@ -0,0 +1,471 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "utils/datagen.h"
+#include "utils/strings/strings.h"
+#include "utils/network/cache.h"
+#include "json/json.h"
+
+#define CACHE_INITIAL_BUCKETS 64
+
+/** Data **/
+
+typedef struct helix_cache_entry {
+	char *key;
+	unsigned long hash;
+	json_value *value;
+	size_t size;                             // Estimated size of the value.
+	double expires;                          // Expiration time.
+	int leases;                              // Number of callers using value.
+	bool detached;                           // Removed while lent out.
+	struct helix_cache_entry *chain;         // Next entry in the hash bucket.
+	struct helix_cache_entry *newer;         // LRU list neighbours.
+	struct helix_cache_entry *older;
+	struct helix_cache_entry *leased_next;   // Next entry in the leased list.
+} helix_cache_entry;
+
+typedef struct helix_cache_rule {
+	char *endpoint;
+	size_t length;
+	int ttl;
+	struct helix_cache_rule *next;
+} helix_cache_rule;
+
+struct helix_cache {
+	size_t max_bytes;
+	int ttl;
+	int bucket_count;
+	helix_cache_entry **buckets;
+	unsigned long count;
+	size_t bytes;
+	helix_cache_entry *newest;
+	helix_cache_entry *oldest;
+	helix_cache_entry *leased;               // Entries lent out to callers.
+	helix_cache_rule *rules;
+	unsigned long hits;
+	unsigned long misses;
+	unsigned long evictions;
+	unsigned long expirations;
+};
+
+/** Helpers **/
+
+double helix_cache_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+unsigned long helix_cache_hash(const char *key) {
+	// FNV-1a.
+	unsigned long hash = 2166136261UL;
+	for (const unsigned char *ptr = (const unsigned char *)key; *ptr; ptr++) {
+		hash ^= *ptr;
+		hash *= 16777619UL;
+	}
+	return hash;
+}
+
+char *helix_cache_key(
+	const char *client_id,
+	const char *auth,
+	const char *url
+) {
+	string_t *key = string_init_with_value(client_id);
+	string_append("\n", 1, key);
+	string_append(auth, strlen(auth), key);
+	string_append("\n", 1, key);
+	string_append(url, strlen(url), key);
+
+	char *result = key->ptr;
+	free(key);
+	return result;
+}
+
+/**
+ * Estimates memory taken by given JSON value tree.
+ */
+size_t helix_cache_value_size(json_value *value) {
+	size_t size = sizeof(json_value);
+
+	switch (value->type) {
+		case json_string:
+			size += value->u.string.length + 1;
+			break;
+		case json_array:
+			size += value->u.array.length * sizeof(json_value *);
+			for (unsigned int idx = 0; idx < value->u.array.length; idx++) {
+				size += helix_cache_value_size(value->u.array.values[idx]);
+			}
+			break;
+		case json_object:
+			size += value->u.object.length * sizeof(json_object_entry);
+			for (unsigned int idx = 0; idx < value->u.object.length; idx++) {
+				size += value->u.object.values[idx].name_length + 1;
+				size += helix_cache_value_size(value->u.object.values[idx].value);
+			}
+			break;
+		default:
+			break;
+	}
+
+	return size;
+}
+
+int helix_cache_ttl(helix_cache *cache, const char *url) {
+	int ttl = cache->ttl;
+	size_t matched = 0;
+
+	// Longest matching endpoint wins.
+	for (helix_cache_rule *rule = cache->rules; rule != NULL; rule = rule->next) {
+		if (
+			rule->length <= matched ||
+			strncmp(url, rule->endpoint, rule->length) != 0
+		) {
+			continue;
+		}
+
+		// URL is at least as long as the prefix, and has to end there.
+		char next = url[rule->length];
+		if (next == '\0' || next == '?' || next == '/') {
+			ttl = rule->ttl;
+			matched = rule->length;
+		}
+	}
+
+	return ttl;
+}
+
+/** Entries **/
+
+void helix_cache_entry_free(helix_cache_entry *entry) {
+	FREE(entry->key)
+	FREE_CUSTOM(entry->value, json_value_free)
+	free(entry);
+}
+
+void helix_cache_lease(helix_cache *cache, helix_cache_entry *entry) {
+	if (entry->leases++ == 0) {
+		entry->leased_next = cache->leased;
+		cache->leased = entry;
+	}
+}
+
+void helix_cache_unlink_lru(helix_cache *cache, helix_cache_entry *entry) {
+	if (entry->newer != NULL) {
+		entry->newer->older = entry->older;
+	} else {
+		cache->newest = entry->older;
+	}
+
+	if (entry->older != NULL) {
+		entry->older->newer = entry->newer;
+	} else {
+		cache->oldest = entry->newer;
+	}
+
+	entry->newer = NULL;
+	entry->older = NULL;
+}
+
+void helix_cache_link_newest(helix_cache *cache, helix_cache_entry *entry) {
+	entry->older = cache->newest;
+	entry->newer = NULL;
+	if (cache->newest != NULL) {
+		cache->newest->newer = entry;
+	}
+	cache->newest = entry;
+	if (cache->oldest == NULL) {
+		cache->oldest = entry;
+	}
+}
+
+/**
+ * Removes entry from the cache. Entries that are lent out are freed when the
+ * last caller releases them.
+ */
+void helix_cache_remove(helix_cache *cache, helix_cache_entry *entry) {
+	int bucket = entry->hash % cache->bucket_count;
+	helix_cache_entry **slot = &cache->buckets[bucket];
+	while (*slot != entry) {
+		slot = &(*slot)->chain;
+	}
+	*slot = entry->chain;
+
+	helix_cache_unlink_lru(cache, entry);
+	cache->bytes -= entry->size;
+	cache->count--;
+
+	if (entry->leases > 0) {
+		entry->detached = true;
+	} else {
+		helix_cache_entry_free(entry);
+	}
+}
+
+void helix_cache_evict(helix_cache *cache) {
+	while (cache->bytes > cache->max_bytes && cache->oldest != NULL) {
+		helix_cache_remove(cache, cache->oldest);
+		cache->evictions++;
+	}
+}
+
+void helix_cache_grow(helix_cache *cache) {
+	int bucket_count = cache->bucket_count * 2;
+	helix_cache_entry **buckets = calloc(
+		bucket_count,
+		sizeof(helix_cache_entry *)
+	);
+	if (buckets == NULL) {
+		fprintf(stderr, "Failed to allocate memory for cache buckets.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (int idx = 0; idx < cache->bucket_count; idx++) {
+		helix_cache_entry *entry = cache->buckets[idx];
+		while (entry != NULL) {
+			helix_cache_entry *chain = entry->chain;
+			entry->chain = buckets[entry->hash % bucket_count];
+			buckets[entry->hash % bucket_count] = entry;
+			entry = chain;
+		}
+	}
+
+	free(cache->buckets);
+	cache->buckets = buckets;
+	cache->bucket_count = bucket_count;
+}
+
+helix_cache_entry *helix_cache_find(
+	helix_cache *cache,
+	const char *key,
+	unsigned long hash
+) {
+	helix_cache_entry *entry = cache->buckets[hash % cache->bucket_count];
+	while (entry != NULL) {
+		if (entry->hash == hash && strcmp(entry->key, key) == 0) {
+			return entry;
+		}
+		entry = entry->chain;
+	}
+	return NULL;
+}
+
+/** Cache **/
+
+helix_cache *helix_cache_alloc(size_t max_bytes, int ttl) {
+	helix_cache *cache = calloc(1, sizeof(helix_cache));
+	if (cache == NULL) {
+		fprintf(stderr, "Failed to allocate memory for helix_cache");
+		exit(EXIT_FAILURE);
+	}
+
+	cache->max_bytes = max_bytes;
+	cache->ttl = ttl;
+	cache->bucket_count = CACHE_INITIAL_BUCKETS;
+	cache->buckets = calloc(cache->bucket_count, sizeof(helix_cache_entry *));
+	if (cache->buckets == NULL) {
+		fprintf(stderr, "Failed to allocate memory for cache buckets.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	return cache;
+}
+
+void helix_cache_free(helix_cache *cache) {
+	if (cache == NULL) {
+		return;
+	}
+
+	helix_cache_clear(cache);
+
+	// Values still lent out can't be returned anymore, since the cache is gone,
+	// so they are freed right away.
+	while (cache->leased != NULL) {
+		helix_cache_entry *entry = cache->leased;
+		cache->leased = entry->leased_next;
+		helix_cache_entry_free(entry);
+	}
+
+	while (cache->rules != NULL) {
+		helix_cache_rule *rule = cache->rules;
+		cache->rules = rule->next;
+		free(rule->endpoint);
+		free(rule);
+	}
+
+	free(cache->buckets);
+	free(cache);
+}
+
+bool helix_cache_enabled(const helix_cache *cache) {
+	return cache != NULL && (cache->max_bytes > 0 || cache->leased != NULL);
+}
+
+void helix_cache_configure(helix_cache *cache, size_t max_bytes, int ttl) {
+	cache->max_bytes = max_bytes;
+	cache->ttl = ttl;
+	helix_cache_evict(cache);
+}
+
+void helix_cache_set_ttl(helix_cache *cache, const char *endpoint, int ttl) {
+	size_t length = strlen(endpoint);
+
+	for (helix_cache_rule *rule = cache->rules; rule != NULL; rule = rule->next) {
+		if (rule->length == length && strcmp(rule->endpoint, endpoint) == 0) {
+			rule->ttl = ttl;
+			return;
+		}
+	}
+
+	helix_cache_rule *rule = calloc(1, sizeof(helix_cache_rule));
+	if (rule == NULL) {
+		fprintf(stderr, "Failed to allocate memory for cache rule.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	rule->endpoint = immutable_string_copy(endpoint);
+	rule->length = length;
+	rule->ttl = ttl;
+	rule->next = cache->rules;
+	cache->rules = rule;
+}
+
+json_value *helix_cache_get(
+	helix_cache *cache,
+	const char *client_id,
+	const char *auth,
+	const char *url
+) {
+	if (cache->max_bytes == 0 || helix_cache_ttl(cache, url) <= 0) {
+		return NULL;
+	}
+
+	char *key = helix_cache_key(client_id, auth, url);
+	unsigned long hash = helix_cache_hash(key);
+	helix_cache_entry *entry = helix_cache_find(cache, key, hash);
+	free(key);
+
+	if (entry != NULL && entry->expires <= helix_cache_now()) {
+		helix_cache_remove(cache, entry);
+		cache->expirations++;
+		entry = NULL;
+	}
+
+	if (entry == NULL) {
+		cache->misses++;
+		return NULL;
+	}
+
+	cache->hits++;
+
+	// Move to the head of LRU list.
+	helix_cache_unlink_lru(cache, entry);
+	helix_cache_link_newest(cache, entry);
+
+	helix_cache_lease(cache, entry);
+	return entry->value;
+}
+
+void helix_cache_put(
+	helix_cache *cache,
+	const char *client_id,
+	const char *auth,
+	const char *url,
+	json_value *value
+) {
+	int ttl = helix_cache_ttl(cache, url);
+	if (value == NULL || ttl <= 0) {
+		return;
+	}
+
+	size_t size = helix_cache_value_size(value);
+	if (size > cache->max_bytes) {
+		return;
+	}
+
+	char *key = helix_cache_key(client_id, auth, url);
+	unsigned long hash = helix_cache_hash(key);
+
+	helix_cache_entry *existing = helix_cache_find(cache, key, hash);
+	if (existing != NULL) {
+		helix_cache_remove(cache, existing);
+	}
+
+	helix_cache_entry *entry = calloc(1, sizeof(helix_cache_entry));
+	if (entry == NULL) {
+		fprintf(stderr, "Failed to allocate memory for cache entry.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	entry->key = key;
+	entry->hash = hash;
+	entry->value = value;
+	entry->size = size;
+	entry->expires = helix_cache_now() + ttl;
+
+	if (cache->count >= (unsigned long)cache->bucket_count * 2) {
+		helix_cache_grow(cache);
+	}
+
+	helix_cache_entry **slot = &cache->buckets[hash % cache->bucket_count];
+	entry->chain = *slot;
+	*slot = entry;
+
+	helix_cache_link_newest(cache, entry);
+	cache->bytes += size;
+	cache->count++;
+
+	// The caller keeps using the value until it releases it.
+	helix_cache_lease(cache, entry);
+
+	helix_cache_evict(cache);
+}
+
+bool helix_cache_release(helix_cache *cache, json_value *value) {
+	helix_cache_entry **slot = &cache->leased;
+
+	while (*slot != NULL && (*slot)->value != value) {
+		slot = &(*slot)->leased_next;
+	}
+
+	helix_cache_entry *entry = *slot;
+	if (entry == NULL) {
+		return false;
+	}
+
+	if (--entry->leases == 0) {
+		*slot = entry->leased_next;
+		entry->leased_next = NULL;
+
+		if (entry->detached) {
+			helix_cache_entry_free(entry);
+		}
+	}
+
+	return true;
+}
+
+void helix_cache_clear(helix_cache *cache) {
+	while (cache->oldest != NULL) {
+		helix_cache_remove(cache, cache->oldest);
+	}
+
+	cache->hits = 0;
+	cache->misses = 0;
+	cache->evictions = 0;
+	cache->expirations = 0;
+}
+
+void helix_cache_stats(helix_cache *cache, twitch_cache_stats *stats) {
+	stats->hits = cache->hits;
+	stats->misses = cache->misses;
+	stats->evictions = cache->evictions;
+	stats->expirations = cache->expirations;
+	stats->entries = cache->count;
+	stats->bytes = cache->bytes;
+	stats->max_bytes = cache->max_bytes;
+}
@@ -0,0 +1,138 @@
+/**
+ * In-memory response cache.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * Cache keeps parsed JSON responses of Helix GET requests, keyed by request
+ * URL and the credentials it was made with. Entries expire after a TTL, which
+ * can be set per endpoint, and the least recently used ones are evicted when
+ * the total size of cached values exceeds the cap.
+ *
+ * Cached values are lent to callers and must be returned with
+ * helix_cache_release() instead of being freed.
+ */
+
+#ifndef _H_NETWORK_CACHE_UTILS
+#define _H_NETWORK_CACHE_UTILS
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "json/json.h"
+
+#include <ctwitch/client.h>
+
+typedef struct helix_cache helix_cache;
+
+/**
+ * Allocates a new empty cache.
+ *
+ * @param max_bytes Max total size of cached values.
+ * @param ttl Default time to live of entries, in seconds.
+ *
+ * @return New cache. Free it with helix_cache_free().
+ */
+helix_cache *helix_cache_alloc(size_t max_bytes, int ttl);
+
+/**
+ * Frees the cache and all values in it, except the ones lent out, which are
+ * freed when released.
+ *
+ * @param cache Cache to free.
+ */
+void helix_cache_free(helix_cache *cache);
+
+/**
+ * Checks whether the cache is in use. A cache allocated only to hold TTLs
+ * doesn't store anything, but one disabled with values still lent out has to
+ * get them back.
+ *
+ * @param cache Cache to check. Can be NULL.
+ *
+ * @return true if the cache has a size cap or values lent out.
+ */
+bool helix_cache_enabled(const helix_cache *cache);
+
+/**
+ * Updates the size cap of the cache, evicting entries if needed.
+ *
+ * @param cache Cache to configure.
+ * @param max_bytes Max total size of cached values.
+ * @param ttl Default time to live of entries, in seconds.
+ */
+void helix_cache_configure(helix_cache *cache, size_t max_bytes, int ttl);
+
+/**
+ * Sets time to live for responses of given endpoint.
+ *
+ * @param cache Cache to configure.
+ * @param endpoint Endpoint URL prefix, like "https://api.twitch.tv/helix/users".
+ * @param ttl Time to live in seconds. 0 disables caching of the endpoint.
+ */
+void helix_cache_set_ttl(helix_cache *cache, const char *endpoint, int ttl);
+
+/**
+ * Looks up a cached response.
+ *
+ * @param cache Cache to look in.
+ * @param client_id Client ID the request is made with.
+ * @param auth Token the request is made with.
+ * @param url Request URL.
+ *
+ * @return Cached value, or NULL if there is no live entry for the request. The
+ * value has to be returned with helix_cache_release().
+ */
+json_value *helix_cache_get(
+	helix_cache *cache,
+	const char *client_id,
+	const char *auth,
+	const char *url
+);
+
+/**
+ * Stores a response in the cache, if its endpoint is cacheable.
+ *
+ * @param cache Cache to store the value in.
+ * @param client_id Client ID the request was made with.
+ * @param auth Token the request was made with.
+ * @param url Request URL.
+ * @param value Parsed response. If stored, the cache takes ownership of it and
+ * lends it back to the caller, so it has to be returned with
+ * helix_cache_release().
+ */
+void helix_cache_put(
+	helix_cache *cache,
+	const char *client_id,
+	const char *auth,
+	const char *url,
+	json_value *value
+);
+
+/**
+ * Returns a value obtained from the cache.
+ *
+ * @param cache Cache the value came from.
+ * @param value Value to return.
+ *
+ * @return true if the value belongs to the cache, false if it's not a cached
+ * value and has to be freed by the caller.
+ */
+bool helix_cache_release(helix_cache *cache, json_value *value);
+
+/**
+ * Drops all entries, except the ones lent out, and resets counters.
+ *
+ * @param cache Cache to clear.
+ */
+void helix_cache_clear(helix_cache *cache);
+
+/**
+ * Returns cache counters.
+ *
+ * @param cache Cache to query.
+ * @param stats Returns the counters.
+ */
+void helix_cache_stats(helix_cache *cache, twitch_cache_stats *stats);
+
+#endif
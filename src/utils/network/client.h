@@ -0,0 +1,138 @@
+/**
+ * Internal client context data.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#ifndef _H_NETWORK_CLIENT_UTILS
+#define _H_NETWORK_CLIENT_UTILS
+
+#include <stdbool.h>
+#include <curl/curl.h>
+
+#include "utils/strings/strings.h"
+#include "utils/arena/arena.h"
+#include "utils/json/json_single.h"
+#include "utils/network/ratelimit.h"
+#include "utils/network/cache.h"
+#include "utils/network/retry.h"
+#include "utils/network/stats.h"
+#include "utils/network/trace.h"
+#include "utils/network/credentials.h"
+
+#include <ctwitch/client.h>
+#include <ctwitch/transport.h>
+#include <ctwitch/stats.h>
+
+/**
+ * Default base URL of Twitch API. All URL builders produce URLs starting with
+ * it, so it can be substituted with client's API URL.
+ */
+#define TWITCH_API_URL "https://api.twitch.tv"
+
+/**
+ * Default base URL of Twitch authentication server, substituted with client's
+ * auth URL the same way.
+ */
+#define TWITCH_AUTH_URL "https://id.twitch.tv"
+
+struct twitch_client {
+	CURL *curl;       // Reusable easy handle.
+	CURL *auth_curl;  // Easy handle for token requests.
+	CURLSH *share;    // DNS, TLS session and connection cache.
+	char *api_url;    // Base API URL override.
+	char *auth_url;   // Base auth URL override.
+	char *ca_info;    // CA bundle path override.
+	bool pipelining;  // Whether to prefetch next pages.
+	bool compression; // Whether to accept compressed responses.
+	bool rate_limiting;          // Whether to pace requests.
+	helix_rate_bucket *buckets;  // Rate limit buckets by client ID.
+	helix_cache *cache;          // Response cache, disabled if size cap is 0.
+	helix_retry_state *retry;    // Retry policy and response times.
+	twitch_transfer_stats transfer;  // Response size counters.
+	twitch_transport *transport;     // Custom transport, or NULL for cURL.
+	twitch_stats *stats;             // Per-endpoint request statistics.
+	helix_tracer *tracer;            // Span recorder, or NULL if not tracing.
+	helix_credentials *credentials;  // Managed credentials, or NULL.
+	arena_t *arena;                  // Memory for parsed JSON pages.
+	json_single_scratch *json;       // JSON parser's scratch space.
+};
+
+/**
+ * Returns an easy handle to perform a request with. If client is not NULL, the
+ * handle is reset and reused, otherwise a new one is created.
+ *
+ * @param client Client context. Can be NULL.
+ *
+ * @return cURL easy handle. Return it with twitch_client_release_handle().
+ */
+CURL *twitch_client_handle(twitch_client *client);
+
+/**
+ * Returns an easy handle to request a token with. Tokens are fetched in the
+ * middle of API requests, so they never share the handle returned by
+ * twitch_client_handle().
+ *
+ * @param client Client context. Can be NULL.
+ *
+ * @return cURL easy handle. Return it with twitch_client_release_handle().
+ */
+CURL *twitch_client_auth_handle(twitch_client *client);
+
+/**
+ * Returns the handle obtained with twitch_client_handle() back to the client,
+ * or destroys it if there is no client.
+ *
+ * @param client Client context. Can be NULL.
+ * @param curl Handle to release.
+ */
+void twitch_client_release_handle(twitch_client *client, CURL *curl);
+
+/**
+ * Applies client-wide options to given easy handle.
+ *
+ * @param client Client context. Can be NULL.
+ * @param curl Handle to configure.
+ */
+void twitch_client_setup_handle(twitch_client *client, CURL *curl);
+
+/**
+ * Adds a response to client's transfer counters.
+ *
+ * @param client Client context. Can be NULL.
+ * @param wire_bytes Size of the response body as received.
+ * @param decoded_bytes Size of the response body after decompression.
+ */
+void twitch_client_count_transfer(
+	twitch_client *client,
+	size_t wire_bytes,
+	size_t decoded_bytes
+);
+
+/**
+ * Adds the response of a request finished by cURL to client's transfer
+ * counters.
+ *
+ * @param client Client context. Can be NULL.
+ * @param curl Handle of the finished request.
+ * @param decoded_bytes Size of the response body after decompression.
+ */
+void twitch_client_record_transfer(
+	twitch_client *client,
+	CURL *curl,
+	size_t decoded_bytes
+);
+
+/**
+ * Substitutes default API or auth URL prefix with client's override, if there
+ * is one.
+ *
+ * @param client Client context. Can be NULL.
+ * @param url Original URL.
+ *
+ * @return New dynamic string with resolved URL.
+ */
+string_t *twitch_client_resolve_url(twitch_client *client, const char *url);
+
+#endif
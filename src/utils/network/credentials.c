@@ -0,0 +1,402 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "utils/datagen.h"
+#include "utils/strings/strings.h"
+#include "utils/network/client.h"
+#include "utils/network/credentials.h"
+#include "utils/network/network.h"
+#include "utils/network/ratelimit.h"
+#include "utils/parser/parser.h"
+#include "json/json.h"
+
+#include <ctwitch/auth.h>
+#include <ctwitch/credentials.h>
+
+#define TWITCH_TOKEN_URL "https://id.twitch.tv/oauth2/token"
+
+/** Helpers **/
+
+double helix_credentials_clock() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+helix_credentials *helix_credentials_alloc(
+	const char *client_id,
+	const char *client_secret
+) {
+	helix_credentials *credentials = calloc(1, sizeof(helix_credentials));
+	if (credentials == NULL) {
+		fprintf(stderr, "Failed to allocate memory for helix_credentials");
+		exit(EXIT_FAILURE);
+	}
+
+	credentials->client_id = immutable_string_copy(client_id);
+	credentials->client_secret = immutable_string_copy(client_secret);
+
+	return credentials;
+}
+
+/**
+ * Replaces current token with a new one.
+ *
+ * @param credentials Credentials to update.
+ * @param access_token New access token. Credentials take ownership of it.
+ * @param refresh_token New refresh token, or NULL to keep the current one.
+ * Credentials take ownership of it.
+ * @param expires_in Lifetime of the new token in seconds, or 0 if it doesn't
+ * expire.
+ */
+void helix_credentials_update(
+	helix_credentials *credentials,
+	char *access_token,
+	char *refresh_token,
+	int expires_in
+) {
+	FREE(credentials->access_token)
+	credentials->access_token = access_token;
+
+	if (refresh_token != NULL) {
+		FREE(credentials->refresh_token)
+		credentials->refresh_token = refresh_token;
+	}
+
+	double lifetime = expires_in * (1 - CREDENTIALS_REFRESH_SHARE);
+	credentials->refresh_at = (expires_in > 0)
+		? helix_credentials_clock() + lifetime
+		: 0;
+
+	credentials->retry_at = 0;
+	credentials->generation++;
+}
+
+/**
+ * Obtains a new token: an app access token, or a refreshed user access token
+ * for user credentials.
+ *
+ * @param client Client context.
+ * @param credentials Credentials to update.
+ *
+ * @return true if the token was replaced.
+ */
+bool helix_credentials_fetch(
+	twitch_client *client,
+	helix_credentials *credentials
+) {
+	// User tokens without refresh token can't be replaced.
+	if (credentials->user && credentials->refresh_token == NULL) {
+		credentials->retry_at = helix_credentials_clock() +
+			CREDENTIALS_RETRY_DELAY;
+		return false;
+	}
+
+	string_t *url = string_init_with_value(TWITCH_TOKEN_URL);
+	string_append_format(url, "?client_id=%s", credentials->client_id);
+	string_append_format(url, "&client_secret=%s", credentials->client_secret);
+	if (credentials->user) {
+		string_append_format(
+			url,
+			"&refresh_token=%s&grant_type=refresh_token",
+			credentials->refresh_token
+		);
+	} else {
+		string_append_format(url, "&grant_type=client_credentials");
+	}
+
+	json_value *value = twitch_auth_post_json(client, url->ptr);
+	string_free(url);
+
+	bool updated = false;
+	if (value != NULL && value->type == json_object) {
+		if (credentials->user) {
+			twitch_user_access_token *token = parse_user_auth_token(value);
+			if (token->access_token != NULL) {
+				helix_credentials_update(
+					credentials,
+					token->access_token,
+					token->refresh_token,
+					token->expires_in
+				);
+				token->access_token = NULL;
+				token->refresh_token = NULL;
+				updated = true;
+			}
+			twitch_user_access_token_free(token);
+		} else {
+			twitch_app_access_token *token = parse_auth_token(value);
+			if (token->token != NULL) {
+				helix_credentials_update(
+					credentials,
+					token->token,
+					NULL,
+					token->expires_in
+				);
+				token->token = NULL;
+				updated = true;
+			}
+			twitch_app_access_token_free(token);
+		}
+	}
+
+	if (value != NULL) {
+		json_value_free(value);
+	}
+
+	// Don't let every following request hit the token endpoint while it fails.
+	if (!updated) {
+		credentials->retry_at = helix_credentials_clock() +
+			CREDENTIALS_RETRY_DELAY;
+	}
+
+	return updated;
+}
+
+/**
+ * Returns current token of given credentials, obtaining or refreshing it
+ * first if it's due. If refresh fails, the current token is kept, as it may
+ * still be valid.
+ *
+ * @return Access token, or NULL if there is none.
+ */
+const char *helix_credentials_token(
+	twitch_client *client,
+	helix_credentials *credentials
+) {
+	double now = helix_credentials_clock();
+
+	bool due = credentials->access_token == NULL ||
+		(credentials->refresh_at > 0 && now >= credentials->refresh_at);
+	if (due && now >= credentials->retry_at) {
+		helix_credentials_fetch(client, credentials);
+	}
+
+	return credentials->access_token;
+}
+
+/**
+ * Picks client's credentials with the most rate limit budget left. Ties go
+ * to the least used ones, so parallel requests made before any budget is
+ * known are spread over the pool too.
+ *
+ * @return Chosen credentials, or NULL if the client has none.
+ */
+helix_credentials *helix_credentials_choose(twitch_client *client) {
+	helix_credentials *best = NULL;
+	double best_points = 0;
+
+	for (
+		helix_credentials *credentials = client->credentials;
+		credentials != NULL;
+		credentials = credentials->next
+	) {
+		double points = helix_ratelimit_available(
+			client,
+			credentials->client_id
+		);
+		if (
+			best == NULL ||
+			points > best_points ||
+			(points == best_points && credentials->uses < best->uses)
+		) {
+			best = credentials;
+			best_points = points;
+		}
+	}
+
+	return best;
+}
+
+/** Credentials **/
+
+void helix_credentials_free(helix_credentials *credentials) {
+	while (credentials != NULL) {
+		helix_credentials *next = credentials->next;
+		FREE(credentials->client_id)
+		FREE(credentials->client_secret)
+		FREE(credentials->access_token)
+		FREE(credentials->refresh_token)
+		free(credentials);
+		credentials = next;
+	}
+}
+
+void helix_credentials_resolve(
+	twitch_client *client,
+	const char **client_id,
+	const char **auth,
+	unsigned long *generation
+) {
+	*generation = 0;
+
+	if (*auth != NULL) {
+		if (*client_id == NULL) {
+			*client_id = "";
+		}
+		return;
+	}
+
+	helix_credentials *credentials = (client != NULL)
+		? helix_credentials_choose(client)
+		: NULL;
+	if (credentials == NULL) {
+		*client_id = "";
+		*auth = "";
+		return;
+	}
+
+	const char *token = helix_credentials_token(client, credentials);
+	credentials->uses++;
+
+	*client_id = credentials->client_id;
+	*auth = (token != NULL) ? token : "";
+	*generation = (token != NULL) ? credentials->generation : 0;
+}
+
+bool helix_credentials_rejected(
+	twitch_client *client,
+	const char *client_id,
+	unsigned long generation
+) {
+	if (client == NULL || generation == 0) {
+		return false;
+	}
+
+	for (
+		helix_credentials *credentials = client->credentials;
+		credentials != NULL;
+		credentials = credentials->next
+	) {
+		if (strcmp(credentials->client_id, client_id) != 0) {
+			continue;
+		}
+
+		// Another request has already replaced the token.
+		if (credentials->generation != generation) {
+			return credentials->access_token != NULL;
+		}
+
+		if (helix_credentials_clock() < credentials->retry_at) {
+			return false;
+		}
+
+		return helix_credentials_fetch(client, credentials);
+	}
+
+	return false;
+}
+
+/** API **/
+
+void twitch_client_set_app_credentials(
+	twitch_client *client,
+	const char *client_id,
+	const char *client_secret
+) {
+	helix_credentials_free(client->credentials);
+	client->credentials = NULL;
+
+	if (client_id != NULL) {
+		twitch_client_add_app_credentials(client, client_id, client_secret);
+	}
+}
+
+void twitch_client_add_app_credentials(
+	twitch_client *client,
+	const char *client_id,
+	const char *client_secret
+) {
+	// Keep the pool in the order credentials were added.
+	helix_credentials **link = &client->credentials;
+	while (*link != NULL) {
+		link = &(*link)->next;
+	}
+
+	*link = helix_credentials_alloc(client_id, client_secret);
+}
+
+void twitch_client_set_user_credentials(
+	twitch_client *client,
+	const char *client_id,
+	const char *client_secret,
+	const twitch_user_access_token *token
+) {
+	helix_credentials_free(client->credentials);
+
+	helix_credentials *credentials = helix_credentials_alloc(
+		client_id,
+		client_secret
+	);
+	credentials->user = true;
+	helix_credentials_update(
+		credentials,
+		immutable_string_copy(token->access_token),
+		(token->refresh_token != NULL)
+			? immutable_string_copy(token->refresh_token)
+			: NULL,
+		token->expires_in
+	);
+
+	client->credentials = credentials;
+}
+
+const char *twitch_client_get_access_token(twitch_client *client) {
+	if (client == NULL) {
+		return NULL;
+	}
+
+	helix_credentials *credentials = helix_credentials_choose(client);
+	if (credentials == NULL) {
+		return NULL;
+	}
+
+	return helix_credentials_token(client, credentials);
+}
+
+bool twitch_client_refresh_credentials(twitch_client *client) {
+	if (client->credentials == NULL) {
+		return false;
+	}
+
+	bool refreshed = true;
+	for (
+		helix_credentials *credentials = client->credentials;
+		credentials != NULL;
+		credentials = credentials->next
+	) {
+		if (!helix_credentials_fetch(client, credentials)) {
+			refreshed = false;
+		}
+	}
+
+	return refreshed;
+}
+
+long twitch_client_get_credentials_refresh_delay(twitch_client *client) {
+	double now = helix_credentials_clock();
+	long result = -1;
+
+	for (
+		helix_credentials *credentials = client->credentials;
+		credentials != NULL;
+		credentials = credentials->next
+	) {
+		long delay = -1;
+		if (credentials->access_token == NULL) {
+			delay = 0;
+		} else if (credentials->refresh_at > 0) {
+			double left = credentials->refresh_at - now;
+			delay = (left > 0) ? (long)left + 1 : 0;
+		}
+
+		if (delay >= 0 && (result < 0 || delay < result)) {
+			result = delay;
+		}
+	}
+
+	return result;
+}
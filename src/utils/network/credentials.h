@@ -0,0 +1,94 @@
+/**
+ * Managed credentials.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * Requests made with NULL token resolve client ID and token from client's
+ * credentials right before every attempt. With several credentials in the
+ * pool, each attempt goes with the ones that have the most rate limit budget
+ * left, so a request rejected with 429 is repeated with another client ID.
+ *
+ * Every new token gets the next generation number, so a request rejected
+ * with 401 can tell whether the token it was sent with has already been
+ * replaced, and only the first of such requests goes for a new one.
+ */
+
+#ifndef _H_NETWORK_CREDENTIALS_UTILS
+#define _H_NETWORK_CREDENTIALS_UTILS
+
+#include <stdbool.h>
+
+#include <ctwitch/client.h>
+
+/**
+ * Share of token's lifetime left when it gets refreshed.
+ */
+#define CREDENTIALS_REFRESH_SHARE 0.1
+
+/**
+ * Delay before trying again after failed refresh, in seconds.
+ */
+#define CREDENTIALS_RETRY_DELAY 10
+
+/**
+ * Credentials owned by a client. A client keeps a list of them.
+ */
+typedef struct helix_credentials {
+	char *client_id;
+	char *client_secret;
+	char *access_token;      // Current token, or NULL before the first one.
+	char *refresh_token;     // Refresh token, or NULL if there is none.
+	bool user;               // Whether the token is a user access token.
+	double refresh_at;       // Time to refresh the token at, or 0 if never.
+	double retry_at;         // Time the failed refresh can be retried at.
+	unsigned long generation;  // Number of tokens obtained so far.
+	unsigned long uses;        // Number of attempts made with these.
+	struct helix_credentials *next;
+} helix_credentials;
+
+/**
+ * Frees a list of credentials.
+ *
+ * @param credentials Head of the list. Can be NULL.
+ */
+void helix_credentials_free(helix_credentials *credentials);
+
+/**
+ * Resolves client ID and token to make a request attempt with. If the caller
+ * didn't pass a token, client's credentials with the most rate limit budget
+ * left are chosen, and their token is obtained or refreshed first if it's due.
+ *
+ * @param client Client context. Can be NULL.
+ * @param client_id Client ID given by the caller, or NULL. Returns client ID
+ * to send, or an empty string if there is none.
+ * @param auth Token given by the caller, or NULL. Returns token to send, or an
+ * empty string if there is none. Client's token stays valid until the next
+ * refresh.
+ * @param generation Returns generation of client's token, or 0 if the caller's
+ * token is used.
+ */
+void helix_credentials_resolve(
+	twitch_client *client,
+	const char **client_id,
+	const char **auth,
+	unsigned long *generation
+);
+
+/**
+ * Handles rejection of client's token with 401 response. Replaces the token,
+ * unless it has already been replaced since the request was made.
+ *
+ * @param client Client context. Can be NULL.
+ * @param client_id Client ID the request was made with.
+ * @param generation Generation of the token the request was made with.
+ *
+ * @return true if there is a new token to repeat the request with.
+ */
+bool helix_credentials_rejected(
+	twitch_client *client,
+	const char *client_id,
+	unsigned long generation
+);
+
+#endif
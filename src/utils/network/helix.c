@@ -2,11 +2,22 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdbool.h>
+#include <time.h>
 #include <curl/curl.h>
 
+#include "utils/datagen.h"
 #include "utils/network/helix.h"
+#include "utils/network/client.h"
+#include "utils/network/credentials.h"
+#include "utils/network/multi.h"
+#include "utils/network/ratelimit.h"
+#include "utils/network/retry.h"
+#include "utils/network/stats.h"
+#include "utils/network/trace.h"
+#include "utils/network/transport.h"
 #include "utils/strings/strings.h"
 #include "utils/parser/parser.h"
+#include "utils/parser/page_decoder.h"
 #include "json/json.h"
 
 #define MAX_PAGE_SIZE 100
@@ -20,34 +31,10 @@ int min_int(int a, int b) {
 
 /** cURL helpers **/
 
-extern size_t twitch_writefunc(
-	void *ptr,
-	size_t size,
-	size_t nmemb,
-	struct string *s
-);
-
-CURLcode twitch_helix_get(
+struct curl_slist *helix_request_headers(
 	const char *client_id,
-	const char *auth,
-	twitch_error *error,
-	const char *url,
-	string_t *output
+	const char *auth
 ) {
-	// Initialize curl.
-	CURL *curl;
-	curl = curl_easy_init();
-
-	// Clear error data.
-	if (error != NULL) {
-		error->curl_code = CURLE_OK;
-		error->http_code = 0;
-		if (error->output != NULL) {
-			free(error->output);
-			error->output = NULL;
-		}
-	}
-
 	// Headers list.
 	struct curl_slist *headers = NULL;
 
@@ -61,60 +48,695 @@ CURLcode twitch_helix_get(
 	string_append((void *)auth, strlen(auth), auth_header);
 	headers = curl_slist_append(headers, auth_header->ptr);
 
+	string_free(client_id_header);
+	string_free(auth_header);
+
+	return headers;
+}
+
+void helix_setup_request(
+	twitch_client *client,
+	CURL *curl,
+	struct curl_slist *headers,
+	const char *url,
+	helix_response *response
+) {
 	// Set headers.
 	curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
 
-	// Set URL.
-	curl_easy_setopt(curl, CURLOPT_URL, url);
+	// Set URL. cURL keeps its own copy of it.
+	string_t *resolved_url = twitch_client_resolve_url(client, url);
+	curl_easy_setopt(curl, CURLOPT_URL, resolved_url->ptr);
+	string_free(resolved_url);
 
-	// Setup output buffer.
-	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, twitch_writefunc);
-	curl_easy_setopt(curl, CURLOPT_WRITEDATA, output);
-	curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1);
+	// Setup response receiver. Error responses are written there too, so
+	// their body is available to the caller.
+	response->curl = curl;
+	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, helix_response_write);
+	curl_easy_setopt(curl, CURLOPT_WRITEDATA, response);
+}
+
+CURLcode helix_check_status(CURLcode code, long http_code) {
+	if (code == CURLE_OK && http_code >= 400) {
+		return CURLE_HTTP_RETURNED_ERROR;
+	}
 
-	// Perform curl operation.
-	CURLcode code = curl_easy_perform(curl);
+	return code;
+}
 
-	if (code == CURLE_HTTP_RETURNED_ERROR && error != NULL) {
-		error->curl_code = code;
-		long http = 0;
-		curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &(error->http_code));
-		if (output != NULL && output->ptr != NULL) {
-			error->output = output->ptr;
+/**
+ * Copies response body into error's buffer, growing it only if it's too
+ * small.
+ */
+void helix_error_set_output(
+	twitch_error *error,
+	const char *output,
+	size_t length
+) {
+	if (length + 1 > error->output_capacity) {
+		error->output = realloc(error->output, length + 1);
+		if (error->output == NULL) {
+			fprintf(stderr, "Failed to allocate memory for error output.\n");
+			exit(EXIT_FAILURE);
 		}
+		error->output_capacity = length + 1;
 	}
 
+	if (length > 0) {
+		memcpy(error->output, output, length);
+	}
+	error->output[length] = '\0';
+	error->output_length = length;
+}
+
+void helix_reset_error(twitch_error *error) {
+	if (error == NULL) {
+		return;
+	}
+
+	error->curl_code = CURLE_OK;
+	error->http_code = 0;
+	error->output_length = 0;
+	if (error->output != NULL) {
+		error->output[0] = '\0';
+	}
+	error->retry_after = 0;
+	error->ratelimit_limit = 0;
+	error->ratelimit_remaining = 0;
+	error->ratelimit_reset = 0;
+
+	twitch_error_details_free(error->details);
+	error->details = NULL;
+}
+
+void helix_fill_error(
+	twitch_error *error,
+	CURLcode code,
+	long http_code,
+	string_t *output,
+	const helix_ratelimit_headers *headers
+) {
+	if (error == NULL || code == CURLE_OK) {
+		return;
+	}
+
+	error->curl_code = code;
+
+	if (code != CURLE_HTTP_RETURNED_ERROR) {
+		return;
+	}
+
+	error->http_code = http_code;
+	if (output != NULL && output->ptr != NULL) {
+		helix_error_set_output(error, output->ptr, output->len);
+	}
+
+	// Headers are parsed into numbers as they arrive, so keeping them is free.
+	if (headers != NULL) {
+		error->retry_after = (headers->retry_after > 0)
+			? headers->retry_after
+			: 0;
+		if (headers->limit > 0) {
+			error->ratelimit_limit = headers->limit;
+			error->ratelimit_remaining = (headers->remaining > 0)
+				? headers->remaining
+				: 0;
+			error->ratelimit_reset = (headers->reset > 0) ? headers->reset : 0;
+		}
+	}
+}
+
+void helix_copy_error(twitch_error *error, const twitch_error *source) {
+	if (error == NULL) {
+		return;
+	}
+
+	helix_reset_error(error);
+	error->curl_code = source->curl_code;
+	error->http_code = source->http_code;
+	if (source->output_length > 0) {
+		helix_error_set_output(error, source->output, source->output_length);
+	}
+	error->retry_after = source->retry_after;
+	error->ratelimit_limit = source->ratelimit_limit;
+	error->ratelimit_remaining = source->ratelimit_remaining;
+	error->ratelimit_reset = source->ratelimit_reset;
+}
+
+/** Responses **/
+
+void helix_response_init(
+	helix_response *response,
+	string_t *output,
+	const entity_schema *schema
+) {
+	response->output = output;
+	response->schema = schema;
+	response->curl = NULL;
+	response->decoder = NULL;
+	response->started = false;
+	response->length = 0;
+	response->decode_time = 0;
+}
+
+void helix_response_reset(helix_response *response) {
+	if (response->output != NULL) {
+		string_clear(response->output);
+	}
+
+	page_decoder_free(response->decoder);
+	response->decoder = NULL;
+	response->started = false;
+	response->length = 0;
+	response->decode_time = 0;
+}
+
+void helix_response_clear(helix_response *response) {
+	page_decoder_free(response->decoder);
+	response->decoder = NULL;
+}
+
+void helix_response_start(helix_response *response, long http_code) {
+	response->started = true;
+
+	// Only successful pages are decoded on the fly, error bodies are kept for
+	// the caller.
+	if (response->schema != NULL && http_code >= 200 && http_code < 300) {
+		response->decoder = page_decoder_alloc(response->schema);
+	}
+}
+
+size_t helix_response_write(
+	char *ptr,
+	size_t size,
+	size_t nmemb,
+	void *userdata
+) {
+	helix_response *response = (helix_response *)userdata;
+	size_t length = size * nmemb;
+
+	// Status is known by the time the body arrives.
+	if (!response->started) {
+		long http_code = 0;
+		curl_easy_getinfo(response->curl, CURLINFO_RESPONSE_CODE, &http_code);
+		helix_response_start(response, http_code);
+	}
+	response->length += length;
+
+	if (response->decoder == NULL) {
+		string_append(ptr, length, response->output);
+		return length;
+	}
+
+	// Invalid text is reported when the page is finished.
+	double start = helix_stats_clock();
+	page_decoder_feed(response->decoder, ptr, length);
+	response->decode_time += helix_stats_clock() - start;
+
+	return length;
+}
+
+void **helix_response_page(
+	helix_response *response,
+	twitch_client *client,
+	const char *url,
+	parser_func parser,
+	int *size,
+	char **next,
+	int *total
+) {
+	*size = 0;
+
+	if (response->decoder == NULL) {
+		return helix_decode_page(
+			client,
+			url,
+			response->output->ptr,
+			response->output->len,
+			parser,
+			size,
+			next,
+			total
+		);
+	}
+
+	// Decoding is spread over the download, so only its total time is known.
+	double start = helix_stats_clock();
+	void **elements = page_decoder_finish(response->decoder, size, next, total);
+	double elapsed = response->decode_time + helix_stats_clock() - start;
+	helix_stats_record(
+		client,
+		url,
+		TWITCH_METRIC_MATERIALIZE,
+		(unsigned long long)(elapsed * 1e6)
+	);
+
+	page_decoder_free(response->decoder);
+	response->decoder = NULL;
+
+	return elements;
+}
+
+/** Hedging **/
+
+typedef struct {
+	int pending;         // Number of copies still in flight.
+	bool done;           // Whether a successful response has arrived.
+	twitch_error error;  // Error info of the chosen response.
+	string_t *body;      // Body of the chosen response.
+} helix_hedge;
+
+void helix_hedge_callback(twitch_error *error, string_t *body, void *user_data) {
+	helix_hedge *hedge = (helix_hedge *)user_data;
+	hedge->pending--;
+
+	// Aborted copy, or the race is already won.
+	if (body == NULL) {
+		return;
+	}
+	if (hedge->done) {
+		string_free(body);
+		return;
+	}
+
+	// Keep the first success, or the latest failure if nothing succeeds.
+	FREE_CUSTOM(hedge->body, string_free)
+	hedge->body = body;
+	helix_copy_error(&hedge->error, error);
+	hedge->done = (error->curl_code == CURLE_OK);
+}
+
+/**
+ * Performs a GET request, sending a duplicate if the first one is not
+ * answered within client's hedging delay. The first successful response
+ * wins, and the other copy is aborted. Each copy is retried on its own by the
+ * request engine.
+ *
+ * @param client Client context.
+ * @param client_id Twitch API client ID.
+ * @param auth Authorization token.
+ * @param url Target URL.
+ * @param output Buffer for the response body.
+ * @param error Error struct to fill. Can be NULL.
+ *
+ * @return Request result code.
+ */
+CURLcode helix_hedged_get(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	const char *url,
+	string_t *output,
+	twitch_error *error
+) {
+	helix_multi *multi = helix_multi_alloc(client);
+	helix_hedge hedge = { 1, false, { 0 }, NULL };
+
+	helix_multi_add_request(
+		multi,
+		client_id,
+		auth,
+		url,
+		&helix_hedge_callback,
+		(void *)&hedge
+	);
+
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	double deadline = ts.tv_sec + ts.tv_nsec / 1e9 +
+		helix_retry_hedge_delay(client);
+	bool hedged = false;
+
+	while (!hedge.done && hedge.pending > 0) {
+		int timeout_ms = 1000;
+
+		if (!hedged) {
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			double remaining = deadline - (ts.tv_sec + ts.tv_nsec / 1e9);
+
+			if (remaining <= 0) {
+				helix_multi_add_request(
+					multi,
+					client_id,
+					auth,
+					url,
+					&helix_hedge_callback,
+					(void *)&hedge
+				);
+				hedge.pending++;
+				hedged = true;
+			} else if (remaining * 1000 < timeout_ms) {
+				timeout_ms = (int)(remaining * 1000) + 1;
+			}
+		}
+
+		helix_multi_step(multi, timeout_ms);
+	}
+
+	// Aborts the losing copy, if it's still in flight.
+	helix_multi_free(multi);
+
+	string_clear(output);
+	if (hedge.body != NULL) {
+		string_append(hedge.body->ptr, hedge.body->len, output);
+		string_free(hedge.body);
+	}
+
+	CURLcode code = (CURLcode)hedge.error.curl_code;
+	helix_copy_error(error, &hedge.error);
+	twitch_error_clear(&hedge.error);
+
+	return code;
+}
+
+/** Requests **/
+
+CURLcode helix_get_response(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	twitch_error *error,
+	const char *url,
+	helix_response *response
+) {
+	// Clear error data.
+	helix_reset_error(error);
+
+	// Hedging needs parallel requests, which custom transports can't do.
+	if (
+		client != NULL &&
+		client->retry->hedging &&
+		!helix_transport_enabled(client)
+	) {
+		return helix_hedged_get(
+			client,
+			client_id,
+			auth,
+			url,
+			response->output,
+			error
+		);
+	}
+
+	// Get a handle, reusing client's one if possible. Custom transports get
+	// the URL instead.
+	bool custom_transport = helix_transport_enabled(client);
+	CURL *curl = NULL;
+	string_t *resolved_url = NULL;
+
+	// Setup the request. Requests made with client's own credentials get
+	// their headers before every attempt.
+	const char *request_id = client_id;
+	const char *token = auth;
+	unsigned long generation = 0;
+	helix_credentials_resolve(client, &request_id, &token, &generation);
+
+	struct curl_slist *headers = helix_request_headers(request_id, token);
+	if (custom_transport) {
+		resolved_url = twitch_client_resolve_url(client, url);
+	} else {
+		curl = twitch_client_handle(client);
+		helix_setup_request(client, curl, headers, url, response);
+	}
+
+	// Perform curl operation, waiting for rate limit budget if needed, and
+	// retrying transient failures.
+	CURLcode code = CURLE_OK;
+	long http_code = 0;
+	helix_ratelimit_headers ratelimit;
+	int attempt = 0;
+	bool reauthorized = false;
+	while (true) {
+		double latency = 0;
+
+		for (int retry = 0; retry <= MAX_RATE_LIMIT_RETRIES; retry++) {
+			// Repeated attempts go with the credentials that have the most budget
+			// left now, so a 429 moves the request to another client ID from the
+			// pool, and a replaced token is picked up.
+			if (auth == NULL && (retry > 0 || attempt > 0)) {
+				request_id = client_id;
+				token = NULL;
+				helix_credentials_resolve(
+					client,
+					&request_id,
+					&token,
+					&generation
+				);
+
+				curl_slist_free_all(headers);
+				headers = helix_request_headers(request_id, token);
+
+				// Resolving may have fetched a token, so the handle is set up
+				// from scratch rather than trusted to still hold this request.
+				if (curl != NULL) {
+					twitch_client_release_handle(client, curl);
+					curl = twitch_client_handle(client);
+					helix_setup_request(client, curl, headers, url, response);
+				}
+			}
+
+			helix_ratelimit_wait(client, request_id);
+
+			helix_response_reset(response);
+			if (custom_transport) {
+				code = helix_transport_perform(
+					client,
+					"GET",
+					resolved_url->ptr,
+					headers,
+					response->output,
+					&ratelimit,
+					&http_code,
+					&latency
+				);
+				response->length = response->output->len;
+			} else {
+				helix_ratelimit_setup(curl, &ratelimit);
+				code = curl_easy_perform(curl);
+
+				curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+				code = helix_check_status(code, http_code);
+				curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &latency);
+				twitch_client_record_transfer(client, curl, response->length);
+			}
+			helix_stats_record_attempt(
+				client,
+				url,
+				curl,
+				code,
+				http_code,
+				latency,
+				response->length
+			);
+
+			bool limited = helix_ratelimit_update(
+				client,
+				request_id,
+				&ratelimit,
+				http_code
+			);
+			if (!limited) {
+				break;
+			}
+			if (retry < MAX_RATE_LIMIT_RETRIES) {
+				helix_stats_record_retry(client, url);
+			}
+		}
+		attempt++;
+
+		if (code == CURLE_OK) {
+			helix_retry_record_latency(client, latency);
+			break;
+		}
+
+		// Client's token may have expired early or been revoked. The request is
+		// repeated once with a new one.
+		if (
+			code == CURLE_HTTP_RETURNED_ERROR &&
+			http_code == 401 &&
+			!reauthorized &&
+			helix_credentials_rejected(client, request_id, generation)
+		) {
+			reauthorized = true;
+			helix_stats_record_retry(client, url);
+			continue;
+		}
+
+		if (!helix_retry_should(client, attempt, code, http_code)) {
+			break;
+		}
+
+		helix_stats_record_retry(client, url);
+		helix_retry_sleep(helix_retry_delay(client, attempt));
+	}
+	helix_fill_error(error, code, http_code, response->output, &ratelimit);
+
 	// Cleanup.
 	curl_slist_free_all(headers);
-	string_free(client_id_header);
-	curl_easy_cleanup(curl);
+	FREE_CUSTOM(resolved_url, string_free)
+	if (curl != NULL) {
+		twitch_client_release_handle(client, curl);
+	}
 
 	return code;
 }
 
+CURLcode twitch_helix_get(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	twitch_error *error,
+	const char *url,
+	string_t *output
+) {
+	helix_response response;
+	helix_response_init(&response, output, NULL);
+
+	CURLcode code = helix_get_response(
+		client,
+		client_id,
+		auth,
+		error,
+		url,
+		&response
+	);
+
+	helix_response_clear(&response);
+	return code;
+}
+
+void *helix_json_arena_alloc(size_t size, int zero, void *user_data) {
+	return arena_malloc((arena_t *)user_data, size, zero);
+}
+
+void helix_json_arena_free(void *ptr, void *user_data) {
+	// Freed all at once with the root value.
+	(void)ptr;
+	(void)user_data;
+}
+
+json_value *helix_parse_json(
+	twitch_client *client,
+	const char *json,
+	size_t length
+) {
+	if (client == NULL) {
+		return json_single_parse(NULL, NULL, json, length, NULL);
+	}
+
+	// Cached values outlive the page, so they need their own memory.
+	if (helix_cache_enabled(client->cache)) {
+		return json_single_parse(client->json, NULL, json, length, NULL);
+	}
+
+	json_settings settings = { 0 };
+	settings.mem_alloc = &helix_json_arena_alloc;
+	settings.mem_free = &helix_json_arena_free;
+	settings.user_data = client->arena;
+
+	arena_mark mark = arena_get_mark(client->arena);
+	json_value *value = json_single_parse(
+		client->json,
+		&settings,
+		json,
+		length,
+		NULL
+	);
+	if (value == NULL) {
+		arena_reset(client->arena, mark);
+	}
+
+	return value;
+}
+
+void helix_free_json(twitch_client *client, json_value *value) {
+	if (value == NULL) {
+		return;
+	}
+
+	// Root value is the first allocation of a parse, so releasing it frees the
+	// whole tree.
+	if (client != NULL && arena_release(client->arena, value)) {
+		return;
+	}
+
+	json_value_free(value);
+}
+
 json_value *twitch_helix_get_json(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
 	const char *url
 ) {
+	// Responses for client's own credentials are cached under an empty key, so
+	// they outlive token refreshes and are shared by the whole pool.
+	const char *cache_id = "";
+	const char *cache_auth = "";
+	if (auth != NULL) {
+		cache_id = (client_id != NULL) ? client_id : "";
+		cache_auth = auth;
+	}
+
+	// Serve from the cache, if possible.
+	helix_cache *cache = (client != NULL && helix_cache_enabled(client->cache))
+		? client->cache
+		: NULL;
+	if (cache != NULL) {
+		json_value *cached = helix_cache_get(cache, cache_id, cache_auth, url);
+		if (cached != NULL) {
+			helix_reset_error(error);
+			return cached;
+		}
+	}
+
 	// Get the output.
 	string_t *output = string_init();
-	CURLcode code = twitch_helix_get(client_id, auth, error, url, output);
+	CURLcode code = twitch_helix_get(
+		client,
+		client_id,
+		auth,
+		error,
+		url,
+		output
+	);
 
 	// Check return code.
 	if (code == CURLE_HTTP_RETURNED_ERROR) {
-		free(output);
+		string_free(output);
 		return NULL;
 	}
 
 	// Parse.
-	json_value *value = json_parse(output->ptr, output->len);
+	double start = helix_stats_clock();
+	json_value *value = helix_parse_json(client, output->ptr, output->len);
+	helix_stats_record_time(client, url, TWITCH_METRIC_PARSE, start);
 	string_free(output);
 
+	if (cache != NULL && code == CURLE_OK) {
+		helix_cache_put(cache, cache_id, cache_auth, url, value);
+	}
+
 	return value;
 }
 
+void twitch_helix_release_json(twitch_client *client, json_value *value) {
+	if (value == NULL) {
+		return;
+	}
+
+	if (
+		client != NULL &&
+		helix_cache_enabled(client->cache) &&
+		helix_cache_release(client->cache, value)
+	) {
+		return;
+	}
+
+	helix_free_json(client, value);
+}
+
 /** Helpers **/
 
 void helix_append_cursor_params(
@@ -143,7 +765,332 @@ void helix_append_cursor_params(
 	}
 }
 
+/**
+ * Checks whether an object entry has given name.
+ */
+bool helix_entry_is(const json_object_entry *entry, const char *name) {
+	return entry->name_length == strlen(name) && strcmp(entry->name, name) == 0;
+}
+
+/**
+ * Parses items of a "data" array, skipping the ones that aren't objects.
+ */
+void **helix_parse_items(json_value *data, parser_func parser, int *size) {
+	int length = data->u.array.length;
+	*size = 0;
+	if (length == 0) {
+		return NULL;
+	}
+
+	void **elements = malloc(length * sizeof(void *));
+	if (elements == NULL) {
+		fprintf(stderr, "Failed to allocate memory for page items");
+		exit(EXIT_FAILURE);
+	}
+
+	for (int idx = 0; idx < length; idx++) {
+		json_value *item = data->u.array.values[idx];
+		if (item->type == json_object) {
+			elements[(*size)++] = parser(item);
+		}
+	}
+
+	if (*size == 0) {
+		free(elements);
+		return NULL;
+	}
+
+	return elements;
+}
+
+void **helix_parse_page(
+	json_value *value,
+	parser_func parser,
+	int *size,
+	char **next,
+	int *total
+) {
+	*size = 0;
+
+	if (value == NULL || value->type != json_object) {
+		return NULL;
+	}
+
+	// Extract the relevant fields. Values of other types are ignored, and
+	// repeated fields replace earlier ones, as in the streaming decoder.
+	void **elements = NULL;
+	char *cursor = NULL;
+	bool has_total = false;
+	int page_total = 0;
+
+	int length = value->u.object.length;
+	for (int x = 0; x < length; x++) {
+		json_object_entry *entry = &value->u.object.values[x];
+		json_value *field = entry->value;
+
+		if (helix_entry_is(entry, "data") && field->type == json_array) {
+			if (elements != NULL) {
+				const entity_schema *schema = parser_schema(parser);
+				for (int idx = 0; idx < *size && schema != NULL; idx++) {
+					schema->free(elements[idx]);
+				}
+				free(elements);
+			}
+
+			elements = helix_parse_items(field, parser, size);
+		} else if (
+			helix_entry_is(entry, "pagination") &&
+			field->type == json_object
+		) {
+			for (int y = 0; y < field->u.object.length; y++) {
+				json_object_entry *item = &field->u.object.values[y];
+				if (
+					helix_entry_is(item, "cursor") &&
+					item->value->type == json_string
+				) {
+					FREE(cursor)
+					cursor = immutable_string_copy(item->value->u.string.ptr);
+				}
+			}
+		} else if (helix_entry_is(entry, "total")) {
+			if (field->type == json_integer) {
+				has_total = true;
+				page_total = (int)field->u.integer;
+			} else if (field->type == json_double) {
+				has_total = true;
+				page_total = (int)field->u.dbl;
+			}
+		}
+	}
+
+	if (next != NULL && cursor != NULL) {
+		*next = cursor;
+	} else {
+		FREE(cursor)
+	}
+
+	if (total != NULL && has_total) {
+		*total = page_total;
+	}
+
+	return elements;
+}
+
+/** Peeking **/
+
+const char *helix_skip_whitespace(const char *ptr, const char *end) {
+	while (ptr < end && (*ptr == ' ' || *ptr == '\t' || *ptr == '\n' || *ptr == '\r')) {
+		ptr++;
+	}
+	return ptr;
+}
+
+/**
+ * Finds the last occurrence of given key in raw JSON text.
+ *
+ * @param body JSON text.
+ * @param length Length of the text.
+ * @param key Key to find, including quotes.
+ *
+ * @return Pointer to the first character after the key and colon, or NULL.
+ */
+const char *helix_peek_key(const char *body, size_t length, const char *key) {
+	size_t key_length = strlen(key);
+	if (body == NULL || length < key_length) {
+		return NULL;
+	}
+
+	// Pagination and total are usually at the end of the response, so look
+	// from there.
+	for (const char *ptr = body + length - key_length; ptr >= body; ptr--) {
+		if (*ptr != '"' || memcmp(ptr, key, key_length) != 0) {
+			continue;
+		}
+
+		// Escaped quote means this is a part of some string value.
+		if (ptr > body && *(ptr - 1) == '\\') {
+			continue;
+		}
+
+		const char *end = body + length;
+		const char *value = ptr + key_length;
+		value = helix_skip_whitespace(value, end);
+		if (value == end || *value != ':') {
+			continue;
+		}
+		value++;
+		value = helix_skip_whitespace(value, end);
+
+		return (value < end) ? value : NULL;
+	}
+
+	return NULL;
+}
+
+char *helix_peek_cursor(const char *body, size_t length) {
+	const char *pagination = helix_peek_key(body, length, "\"pagination\"");
+	if (pagination == NULL || *pagination != '{') {
+		return NULL;
+	}
+
+	const char *end = body + length;
+	const char *cursor = helix_peek_key(
+		pagination,
+		end - pagination,
+		"\"cursor\""
+	);
+	if (cursor == NULL || *cursor != '"') {
+		return NULL;
+	}
+
+	// Cursors are base64 strings, so anything with escapes is left to the
+	// real parser.
+	const char *start = cursor + 1;
+	const char *stop = start;
+	while (stop < end && *stop != '"') {
+		if (*stop == '\\') {
+			return NULL;
+		}
+		stop++;
+	}
+	if (stop == end || stop == start) {
+		return NULL;
+	}
+
+	char *result = malloc(stop - start + 1);
+	if (result == NULL) {
+		fprintf(stderr, "Failed to allocate memory for cursor.\n");
+		exit(EXIT_FAILURE);
+	}
+	memcpy(result, start, stop - start);
+	result[stop - start] = '\0';
+
+	return result;
+}
+
+bool helix_peek_total(const char *body, size_t length, int *total) {
+	const char *value = helix_peek_key(body, length, "\"total\"");
+	if (value == NULL) {
+		return false;
+	}
+
+	const char *end = body + length;
+	if (value == end || *value < '0' || *value > '9') {
+		return false;
+	}
+
+	long long result = 0;
+	while (value < end && *value >= '0' && *value <= '9') {
+		result = result * 10 + (*value - '0');
+		if (result > INT32_MAX) {
+			return false;
+		}
+		value++;
+	}
+
+	*total = (int)result;
+	return true;
+}
+
+void **helix_decode_page(
+	twitch_client *client,
+	const char *url,
+	const char *body,
+	size_t length,
+	parser_func parser,
+	int *size,
+	char **next,
+	int *total
+) {
+	const entity_schema *schema = parser_schema(parser);
+	double start = helix_stats_clock();
+
+	if (schema != NULL) {
+		void **elements = page_decode(schema, body, length, size, next, total);
+		helix_stats_record_time(client, url, TWITCH_METRIC_MATERIALIZE, start);
+		return elements;
+	}
+
+	json_value *value = helix_parse_json(client, body, length);
+	helix_stats_record_time(client, url, TWITCH_METRIC_PARSE, start);
+
+	start = helix_stats_clock();
+	void **elements = helix_parse_page(value, parser, size, next, total);
+	helix_stats_record_time(client, url, TWITCH_METRIC_MATERIALIZE, start);
+
+	helix_free_json(client, value);
+	return elements;
+}
+
+void **helix_fetch_page(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	twitch_error *error,
+	const char *url,
+	parser_func parser,
+	int *size,
+	char **next,
+	int *total
+) {
+	*size = 0;
+
+	// Cached responses are kept parsed, so they're materialized from the tree.
+	if (client != NULL && helix_cache_enabled(client->cache)) {
+		json_value *value = twitch_helix_get_json(
+			client,
+			client_id,
+			auth,
+			error,
+			url
+		);
+
+		if (value == NULL) {
+			return NULL;
+		}
+
+		double start = helix_stats_clock();
+		void **elements = helix_parse_page(value, parser, size, next, total);
+		helix_stats_record_time(client, url, TWITCH_METRIC_MATERIALIZE, start);
+
+		twitch_helix_release_json(client, value);
+		return elements;
+	}
+
+	// Page is decoded while it's being downloaded.
+	string_t *output = string_init();
+	helix_response response;
+	helix_response_init(&response, output, parser_schema(parser));
+
+	CURLcode code = helix_get_response(
+		client,
+		client_id,
+		auth,
+		error,
+		url,
+		&response
+	);
+
+	void **elements = NULL;
+	if (code != CURLE_HTTP_RETURNED_ERROR) {
+		elements = helix_response_page(
+			&response,
+			client,
+			url,
+			parser,
+			size,
+			next,
+			total
+		);
+	}
+
+	helix_response_clear(&response);
+	string_free(output);
+	return elements;
+}
+
 void **helix_get_page(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -156,55 +1103,264 @@ void **helix_get_page(
 	char **next,
 	int *total
 ) {
+	double start = helix_trace_clock(client);
 	string_t *url = builder(params, limit, after);
-	json_value *value = twitch_helix_get_json(client_id, auth, error, url->ptr);
+	helix_trace_end(client, TRACE_URL_BUILD, url->ptr, start);
+
+	void **elements = helix_fetch_page(
+		client,
+		client_id,
+		auth,
+		error,
+		url->ptr,
+		parser,
+		size,
+		next,
+		total
+	);
+
 	string_free(url);
+	return elements;
+}
 
-	if (value == NULL) {
-		*size = 0;
-		return NULL;
+/** Pipelining **/
+
+/**
+ * Single page download of a pipelined crawl.
+ */
+typedef struct helix_pipeline_fetch {
+	bool done;
+	twitch_error error;
+	string_t *body;
+	char *url;    // URL the page was requested with.
+	char *after;  // Cursor the page was requested with.
+	int limit;    // Page size the page was requested with.
+	struct helix_pipeline_fetch *next;
+} helix_pipeline_fetch;
+
+/**
+ * Shared state of a pipelined crawl.
+ */
+typedef struct {
+	helix_multi *multi;
+	twitch_client *client;
+	const char *client_id;
+	const char *auth;
+	helix_page_url_builder builder;
+	void *params;
+	helix_pipeline_fetch *fetches;  // All fetches, freed at the end.
+} helix_pipeline;
+
+void helix_pipeline_callback(
+	twitch_error *error,
+	string_t *body,
+	void *user_data
+) {
+	helix_pipeline_fetch *fetch = (helix_pipeline_fetch *)user_data;
+
+	fetch->done = true;
+	helix_copy_error(&fetch->error, error);
+	fetch->body = body;
+}
+
+/**
+ * Starts a download of a page with given cursor and page size.
+ *
+ * @param pipeline Crawl state.
+ * @param after Page cursor. Can be NULL.
+ * @param limit Page size.
+ *
+ * @return Fetch object. Owned by the pipeline.
+ */
+helix_pipeline_fetch *helix_pipeline_start(
+	helix_pipeline *pipeline,
+	const char *after,
+	int limit
+) {
+	helix_pipeline_fetch *fetch = calloc(1, sizeof(helix_pipeline_fetch));
+	if (fetch == NULL) {
+		fprintf(stderr, "Failed to allocate memory for page fetch.\n");
+		exit(EXIT_FAILURE);
 	}
 
-	// Extract the relevant fields.
+	fetch->after = (after != NULL) ? immutable_string_copy(after) : NULL;
+	fetch->limit = limit;
+	fetch->next = pipeline->fetches;
+	pipeline->fetches = fetch;
+
+	double start = helix_trace_clock(pipeline->client);
+	string_t *url = pipeline->builder(pipeline->params, limit, after);
+	helix_trace_end(pipeline->client, TRACE_URL_BUILD, url->ptr, start);
+
+	helix_multi_add_request(
+		pipeline->multi,
+		pipeline->client_id,
+		pipeline->auth,
+		url->ptr,
+		helix_pipeline_callback,
+		fetch
+	);
+	fetch->url = url->ptr;
+	free(url);
+
+	// Push the request out right away.
+	helix_multi_step(pipeline->multi, 0);
+
+	return fetch;
+}
+
+/**
+ * Same as get_all_helix_pages(), but starts downloading the next page while
+ * the current one is being parsed. The cursor and total of the next page are
+ * pulled from the raw response text. The prefetched page is only used if it
+ * matches the request the serial loop would have made, so the result is
+ * always the same as with get_all_helix_pages().
+ */
+void **get_all_helix_pages_pipelined(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	twitch_error *error,
+	helix_page_url_builder builder,
+	void *params,
+	parser_func parser,
+	int limit,
+	int *size
+) {
+	const int PAGE_SIZE = DEFAULT_PAGE_SIZE;
+
+	helix_pipeline pipeline = {
+		helix_multi_alloc(client),
+		client,
+		client_id,
+		auth,
+		builder,
+		params,
+		NULL
+	};
+
+	int count = 0;
+	int total = 0;
+	int reported_total = 0;
 	void **elements = NULL;
 
-	int length = value->u.object.length;
-	for (int x = 0; x < length; x++) {
-		if (strcmp(value->u.object.values[x].name, "data") == 0) {
-			json_value *elements_value = value->u.object.values[x].value;
-			int elements_length = elements_value->u.array.length;
-			if (elements_length == 0) {
-				*size = 0;
-				break;
+	helix_reset_error(error);
+
+	helix_pipeline_fetch *current = helix_pipeline_start(
+		&pipeline,
+		NULL,
+		min_int(PAGE_SIZE, (limit > 0) ? limit : 0)
+	);
+
+	while (current != NULL) {
+		while (!current->done) {
+			helix_multi_step(pipeline.multi, 1000);
+		}
+
+		if (current->error.curl_code != CURLE_OK) {
+			helix_copy_error(error, &current->error);
+			break;
+		}
+
+		string_t *body = current->body;
+
+		// Speculatively request the next page, assuming the current one is full.
+		helix_pipeline_fetch *prefetch = NULL;
+		int expected = total + ((current->limit > 0) ? current->limit : PAGE_SIZE);
+		int peeked_total = 0;
+		if (
+			helix_peek_total(body->ptr, body->len, &peeked_total) &&
+			expected < peeked_total &&
+			(limit == 0 || expected < limit)
+		) {
+			char *peeked_cursor = helix_peek_cursor(body->ptr, body->len);
+			if (peeked_cursor != NULL) {
+				prefetch = helix_pipeline_start(
+					&pipeline,
+					peeked_cursor,
+					min_int(PAGE_SIZE, (limit > 0) ? (limit - expected) : 0)
+				);
+				free(peeked_cursor);
 			}
+		}
 
-			elements = parse_json_array(elements_value, size, parser);
-		} else if (strcmp(value->u.object.values[x].name, "pagination") == 0) {
-			json_value *pagination = value->u.object.values[x].value;
-			int pagination_length = pagination->u.object.length;
-			for (int y = 0; y < pagination_length; y++) {
-				if (
-					strcmp(pagination->u.object.values[y].name, "cursor") == 0 &&
-					next != NULL
-				) {
-					(*next) = immutable_string_copy(
-						pagination->u.object.values[y].value->u.string.ptr
-					);
-				}
+		// Parse current page while the next one is in flight.
+		char *next_cursor = NULL;
+		void **page = helix_decode_page(
+			client,
+			current->url,
+			body->ptr,
+			body->len,
+			parser,
+			&count,
+			&next_cursor,
+			&reported_total
+		);
+
+		string_free(current->body);
+		current->body = NULL;
+
+		if (count == 0 && next_cursor == NULL) {
+			break;
+		}
+
+		// Append the page to the overall storage.
+		double start = helix_trace_clock(client);
+		if (count > 0) {
+			elements = realloc(elements, sizeof(void *) * (total + count));
+			if (elements == NULL) {
+				fprintf(stderr, "Failed to allocate memory for next page.\n");
+				exit(EXIT_FAILURE);
 			}
-		} else if (
-			strcmp(value->u.object.values[x].name, "total") == 0 &&
-			total != NULL
+
+			memcpy(&elements[total], page, sizeof(void *) * count);
+			total += count;
+		}
+		FREE(page)
+		helix_trace_end(client, TRACE_PAGE_MERGE, current->url, start);
+
+		if (
+			!(count > 0 && total < reported_total && (limit == 0 || total < limit)) ||
+			next_cursor == NULL
+		) {
+			FREE(next_cursor)
+			break;
+		}
+
+		// Use the prefetched page only if it's exactly what we need next.
+		int next_limit = min_int(PAGE_SIZE, (limit > 0) ? (limit - total) : 0);
+		if (
+			prefetch != NULL &&
+			prefetch->limit == next_limit &&
+			strcmp(prefetch->after, next_cursor) == 0
 		) {
-			*total = value->u.object.values[x].value->u.integer;
+			current = prefetch;
+		} else {
+			current = helix_pipeline_start(&pipeline, next_cursor, next_limit);
 		}
+
+		free(next_cursor);
 	}
 
-	json_value_free(value);
+	// Aborts the outstanding prefetch, if any.
+	helix_multi_free(pipeline.multi);
+
+	while (pipeline.fetches != NULL) {
+		helix_pipeline_fetch *fetch = pipeline.fetches;
+		pipeline.fetches = fetch->next;
+		FREE_CUSTOM(fetch->body, string_free)
+		twitch_error_clear(&fetch->error);
+		FREE(fetch->url)
+		FREE(fetch->after)
+		free(fetch);
+	}
+
+	*size = total;
 	return elements;
 }
 
 void **get_all_helix_pages(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -214,6 +1370,24 @@ void **get_all_helix_pages(
 	int limit,
 	int *size
 ) {
+	double crawl_start = helix_trace_clock(client);
+
+	if (client != NULL && client->pipelining) {
+		void **elements = get_all_helix_pages_pipelined(
+			client,
+			client_id,
+			auth,
+			error,
+			builder,
+			params,
+			parser,
+			limit,
+			size
+		);
+		helix_trace_end(client, TRACE_CRAWL, NULL, crawl_start);
+		return elements;
+	}
+
 	const int PAGE_SIZE = DEFAULT_PAGE_SIZE;
 
 	int count = 0;
@@ -225,6 +1399,7 @@ void **get_all_helix_pages(
 
 	do {
 		void **page = helix_get_page(
+			client,
 			client_id,
 			auth,
 			error,
@@ -245,6 +1420,7 @@ void **get_all_helix_pages(
 		}
 
 		// (Re)allocate memory to store next page.
+		double merge_start = helix_trace_clock(client);
 		if (total == 0) {
 			elements = malloc(sizeof(void *) * count);
 		} else {
@@ -264,6 +1440,7 @@ void **get_all_helix_pages(
 
 		// Free current page data.
 		free(page);
+		helix_trace_end(client, TRACE_PAGE_MERGE, NULL, merge_start);
 
 		// Update cursor, if needed.
 		if (next_cursor != NULL) {
@@ -281,6 +1458,8 @@ void **get_all_helix_pages(
 		free(cursor);
 	}
 
+	helix_trace_end(client, TRACE_CRAWL, NULL, crawl_start);
+
 	// Return the whole list.
 	*size = total;
 	return elements;
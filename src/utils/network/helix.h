@@ -15,9 +15,13 @@
 #include <curl/curl.h>
 
 #include "utils/strings/strings.h"
+#include "utils/network/ratelimit.h"
+#include "utils/parser/page_decoder.h"
 #include "json/json.h"
 
 #include <ctwitch/common.h>
+#include <ctwitch/client.h>
+#include <ctwitch/helix/iter.h>
 
 /**
  * Convenience function type for URL builder functions.
@@ -33,6 +37,21 @@ typedef string_t *(*helix_page_url_builder)(
  */
 typedef void *(*parser_func)(json_value *);
 
+/**
+ * Generic layout of all twitch_helix_*_list structs. Lets the code that
+ * doesn't know the concrete entity type to fill any of them.
+ */
+typedef struct {
+	int count;
+	void **items;
+} helix_list;
+
+/**
+ * Convenience function type for list allocators, like
+ * twitch_helix_user_list_alloc().
+ */
+typedef void *(*list_alloc_func)();
+
 /**
  * Helper function to append paging params to the end of the URL query
  *
@@ -50,10 +69,177 @@ void helix_append_cursor_params(
 );
 
 
+/**
+ * Builds the list of authorization headers for Helix API request.
+ *
+ * @param client_id Twitch API client ID string.
+ * @param auth Authorization token.
+ *
+ * @return Headers list. Free it with curl_slist_free_all() after the request
+ * is finished.
+ */
+struct curl_slist *helix_request_headers(
+	const char *client_id,
+	const char *auth
+);
+
+/**
+ * Receiver of a response body. Successful responses to page requests are
+ * decoded into entities while they are being downloaded, so they are never
+ * kept as text. Other responses, like errors, are written to the output
+ * string.
+ */
+typedef struct {
+	string_t *output;              // Body text, unless it's being decoded.
+	const entity_schema *schema;   // Schema of page items, or NULL.
+	CURL *curl;                    // Handle to read response status from.
+	page_decoder *decoder;         // Decoder of the body, once it's started.
+	bool started;                  // Whether any body has arrived.
+	size_t length;                 // Size of the body received so far.
+	double decode_time;            // Time spent decoding, in seconds.
+} helix_response;
+
+/**
+ * Prepares a response receiver.
+ *
+ * @param response Receiver to initialize.
+ * @param output String to write response text to. Stays owned by the caller.
+ * @param schema Schema of page items to decode successful responses with, or
+ * NULL to keep all responses as text.
+ */
+void helix_response_init(
+	helix_response *response,
+	string_t *output,
+	const entity_schema *schema
+);
+
+/**
+ * Drops anything received, before the request is attempted again.
+ *
+ * @param response Receiver to reset.
+ */
+void helix_response_reset(helix_response *response);
+
+/**
+ * Frees receiver's decoder. Output string is left to the caller.
+ *
+ * @param response Receiver to clear.
+ */
+void helix_response_clear(helix_response *response);
+
+/**
+ * Prepares the receiver for the body of a response with given status. Called
+ * by helix_response_write() with the status of the transfer when the body
+ * starts arriving.
+ *
+ * @param response Receiver of the body.
+ * @param http_code HTTP status of the response.
+ */
+void helix_response_start(helix_response *response, long http_code);
+
+/**
+ * cURL write callback, passing received data on to a helix_response.
+ */
+size_t helix_response_write(
+	char *ptr,
+	size_t size,
+	size_t nmemb,
+	void *userdata
+);
+
+/**
+ * Hands over the page received by a successful request. Page decoded while
+ * it was downloading is finished, and page kept as text, like one delivered
+ * by a custom transport, is decoded with helix_decode_page().
+ *
+ * @param response Receiver of the page.
+ * @param client Client context. Can be NULL.
+ * @param url URL of the page, to file statistics under.
+ * @param parser Parser function of page items.
+ * @param size Returns number of parsed items.
+ * @param next (Optional) Returns cursor string to fetch the next page.
+ * @param total (Optional) Returns total number of items in the collection.
+ *
+ * @return Array of pointers to parsed items.
+ */
+void **helix_response_page(
+	helix_response *response,
+	twitch_client *client,
+	const char *url,
+	parser_func parser,
+	int *size,
+	char **next,
+	int *total
+);
+
+/**
+ * Sets up given easy handle to perform a GET request to Helix API.
+ *
+ * @param client Client context. Can be NULL.
+ * @param curl Handle to set up.
+ * @param headers Request headers. Must stay alive until the request is done.
+ * @param url Target URL string.
+ * @param response Receiver to write the response to.
+ */
+void helix_setup_request(
+	twitch_client *client,
+	CURL *curl,
+	struct curl_slist *headers,
+	const char *url,
+	helix_response *response
+);
+
+/**
+ * Turns HTTP error status of a finished transfer into
+ * CURLE_HTTP_RETURNED_ERROR, like CURLOPT_FAILONERROR would, but without
+ * cutting the response body off.
+ *
+ * @param code Transfer result code.
+ * @param http_code HTTP status code of the response.
+ *
+ * @return Request result code.
+ */
+CURLcode helix_check_status(CURLcode code, long http_code);
+
+/**
+ * Clears error data before a new request. Error's body buffer is kept for
+ * reuse.
+ *
+ * @param error Error struct to clear. Can be NULL.
+ */
+void helix_reset_error(twitch_error *error);
+
+/**
+ * Fills error struct with the result of finished request. Response body and
+ * headers are kept only for HTTP errors.
+ *
+ * @param error Error struct to fill. Can be NULL.
+ * @param code Request result code.
+ * @param http_code HTTP status code of the response.
+ * @param output Response body. Can be NULL.
+ * @param headers Rate limit headers of the response. Can be NULL.
+ */
+void helix_fill_error(
+	twitch_error *error,
+	CURLcode code,
+	long http_code,
+	string_t *output,
+	const helix_ratelimit_headers *headers
+);
+
+/**
+ * Copies error info into another error struct, reusing its body buffer.
+ *
+ * @param error Error struct to fill. Can be NULL.
+ * @param source Error to copy.
+ */
+void helix_copy_error(twitch_error *error, const twitch_error *source);
+
 /**
  * Performs GET request to Twitch Helix API and writes the output to dynamic
  * string.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch API client ID string.
  * @param auth Authorization token.
  * @param error Error struct to hold any error info.
@@ -64,6 +250,7 @@ void helix_append_cursor_params(
  * @return cURL request result code.
  */
 CURLcode twitch_helix_get(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -71,33 +258,178 @@ CURLcode twitch_helix_get(
 	string_t *output
 );
 
+/**
+ * Same as twitch_helix_get(), but writes the output to a response receiver,
+ * which can decode a page while it's being downloaded.
+ *
+ * @param client Client context to reuse connections from. Can be NULL.
+ * @param client_id Twitch API client ID string.
+ * @param auth Authorization token.
+ * @param error Error struct to hold any error info.
+ * @param url Target URL string.
+ * @param response Receiver to write the response to.
+ *
+ * @return cURL request result code.
+ */
+CURLcode helix_get_response(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	twitch_error *error,
+	const char *url,
+	helix_response *response
+);
+
+/**
+ * Parses a response body in a single pass (see utils/json/json_single.h),
+ * reusing the client's scratch space. Values of a client without response
+ * cache are allocated from the client's arena, so parsing a page doesn't call
+ * malloc() for every node. Such values must be freed with helix_free_json()
+ * in reverse order of parsing, which is how pages are processed anyway.
+ *
+ * @param client Client context. Can be NULL.
+ * @param json Response body.
+ * @param length Length of the body.
+ *
+ * @return Parsed JSON value, or NULL if the body is not valid JSON.
+ */
+json_value *helix_parse_json(
+	twitch_client *client,
+	const char *json,
+	size_t length
+);
+
+/**
+ * Frees a value returned by helix_parse_json(), along with anything parsed
+ * after it.
+ *
+ * @param client Client context the value was parsed with. Can be NULL.
+ * @param value Value to free. Can be NULL.
+ */
+void helix_free_json(twitch_client *client, json_value *value);
+
 /**
  * Performs a GET request to given Twitch API endpoint URL, and returns parsed
  * JSON value.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch API client ID.
  * @param auth Authorization token.
  * @param error Error struct to hold any error info.
  * @param url Target API endpoint URL.
  *
+ * The value may come from the client's response cache or arena (see
+ * helix_parse_json()), so it must be returned with twitch_helix_release_json()
+ * instead of being freed directly.
+ *
  * @return Parsed JSON value. (see utils/json library).
  */
 json_value *twitch_helix_get_json(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
 	const char *url
 );
 
+/**
+ * Releases a value returned by twitch_helix_get_json(). Cached values are
+ * returned to the cache, others are freed with helix_free_json().
+ *
+ * @param client Client context the value was obtained with. Can be NULL.
+ * @param value Value to release. Can be NULL.
+ */
+void twitch_helix_release_json(twitch_client *client, json_value *value);
+
 /**
  * Performs a POST request to given Twitch API endpoint URL, and returns parsed
  * JSON value.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param url Target API endpoint URL.
  *
  * @return Parsed JSON value. (see utils/json library).
  */
-json_value *twitch_auth_post_json(const char *url);
+json_value *twitch_auth_post_json(twitch_client *client, const char *url);
+
+/**
+ * Extracts the items, next page cursor and total count from a parsed page of
+ * Helix API data. Items of "data" that aren't objects are skipped, and fields
+ * of unexpected types are ignored.
+ *
+ * @param value Parsed response.
+ * @param parser Parser function to parse each value object inside the values
+ * JSON array.
+ * @param size Returns number of parsed items.
+ * @param next (Optional) Returns cursor string to fetch the next page.
+ * @param total (Optional) Returns total number of items in the collection.
+ *
+ * @return Array of pointers to parsed items.
+ */
+void **helix_parse_page(
+	json_value *value,
+	parser_func parser,
+	int *size,
+	char **next,
+	int *total
+);
+
+/**
+ * Converts a page of Helix API data from response text into items. Pages of
+ * entities with a schema (see utils/parser/parser.h) are decoded straight
+ * from the text, without building a JSON tree. Others are parsed with
+ * helix_parse_json() and helix_parse_page().
+ *
+ * @param client Client context. Can be NULL.
+ * @param url URL of the page, to file statistics under.
+ * @param body Response text.
+ * @param length Length of the text.
+ * @param parser Parser function of page items.
+ * @param size Returns number of parsed items.
+ * @param next (Optional) Returns cursor string to fetch the next page.
+ * @param total (Optional) Returns total number of items in the collection.
+ *
+ * @return Array of pointers to parsed items.
+ */
+void **helix_decode_page(
+	twitch_client *client,
+	const char *url,
+	const char *body,
+	size_t length,
+	parser_func parser,
+	int *size,
+	char **next,
+	int *total
+);
+
+/**
+ * Downloads a page from given URL and converts it into items. Pages are
+ * served from the client's response cache if it has one, and decoded while
+ * they are being downloaded otherwise (see helix_response).
+ *
+ * @param client Client context to reuse connections from. Can be NULL.
+ * @param client_id Twitch API client ID.
+ * @param auth Authorization token.
+ * @param error Error struct to hold any error info.
+ * @param url Page URL.
+ * @param parser Parser function of page items.
+ * @param size Returns number of parsed items.
+ * @param next (Optional) Returns cursor string to fetch the next page.
+ * @param total (Optional) Returns total number of items in the collection.
+ *
+ * @return Array of pointers to parsed items.
+ */
+void **helix_fetch_page(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	twitch_error *error,
+	const char *url,
+	parser_func parser,
+	int *size,
+	char **next,
+	int *total
+);
 
 /**
  * Downloads one page of paged data from Twitch Helix API and parses it with
@@ -117,6 +449,7 @@ json_value *twitch_auth_post_json(const char *url);
  * the next page of data from the same response indicate the overall number of
  * items matching given request or que
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch API client ID.
  * @param auth Authorization token.
  * @param builder Twitch API URL builder function.
@@ -132,6 +465,7 @@ json_value *twitch_auth_post_json(const char *url);
  * @return Array of pointers to downloaded and parsed items.
  */
 void **helix_get_page(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -145,6 +479,32 @@ void **helix_get_page(
 	int *total
 );
 
+/**
+ * Extracts pagination cursor from raw paged response text without parsing the
+ * whole response. Used to start fetching the next page early.
+ *
+ * The result is a best guess: it's NULL whenever the cursor can't be found
+ * cheaply, e.g. if it contains escape sequences.
+ *
+ * @param body Response text.
+ * @param length Length of the response text.
+ *
+ * @return New string with the cursor, or NULL.
+ */
+char *helix_peek_cursor(const char *body, size_t length);
+
+/**
+ * Extracts "total" field from raw paged response text without parsing the
+ * whole response.
+ *
+ * @param body Response text.
+ * @param length Length of the response text.
+ * @param total Returns total number of items, if found.
+ *
+ * @return true if total value was found.
+ */
+bool helix_peek_total(const char *body, size_t length, int *total);
+
 /**
  * Downloads all pages of paged data from Twitch Helix API and parses them with
  * given parsing params.
@@ -164,6 +524,10 @@ void **helix_get_page(
  * the next page of data from the same response indicate the overall number of
  * items matching given request or que
  *
+ * If pipelining is enabled for the client, the next page is requested while
+ * the current one is being parsed. See twitch_client_set_pipelining().
+ *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param client_id Twitch API client ID.
  * @param auth Authorization token.
  * @param builder Twitch API URL builder function.
@@ -175,6 +539,7 @@ void **helix_get_page(
  * @return Array of pointers to downloaded and parsed items.
  */
 void **get_all_helix_pages(
+	twitch_client *client,
 	const char *client_id,
 	const char *auth,
 	twitch_error *error,
@@ -185,5 +550,35 @@ void **get_all_helix_pages(
 	int *size
 );
 
+/** Iterator helpers **/
+
+/**
+ * Creates a page iterator over a paged endpoint.
+ *
+ * @param client Client context to reuse connections from. Can be NULL.
+ * @param client_id Twitch API client ID.
+ * @param auth Authorization token.
+ * @param builder Twitch API URL builder function. It's called once, so params
+ * don't have to outlive the iterator.
+ * @param params URL/request params to provide to the builder function.
+ * @param parser Parser function to parse each item.
+ * @param list_alloc Allocator of the list struct to return pages in.
+ * @param page_size Page size. 0 means server's default.
+ * @param limit Max number of items to return. 0 means no limit.
+ *
+ * @return New iterator. Free it with twitch_helix_page_iter_free().
+ */
+twitch_helix_page_iter *helix_page_iter_alloc(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	helix_page_url_builder builder,
+	void *params,
+	parser_func parser,
+	list_alloc_func list_alloc,
+	int page_size,
+	int limit
+);
+
 #endif
 
@@ -0,0 +1,1021 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <curl/curl.h>
+
+#include "utils/network/multi.h"
+#include "utils/network/helix.h"
+#include "utils/network/client.h"
+#include "utils/network/credentials.h"
+#include "utils/network/ratelimit.h"
+#include "utils/network/retry.h"
+#include "utils/network/stats.h"
+#include "utils/network/trace.h"
+#include "utils/network/transport.h"
+#include "utils/strings/strings.h"
+#include "utils/parser/parser.h"
+#include "utils/datagen.h"
+#include "json/json.h"
+
+/**
+ * Max number of parallel connections to one host. Over HTTP/2 requests get
+ * multiplexed over existing connections as well.
+ */
+#define MAX_HOST_CONNECTIONS 8
+
+/** Data **/
+
+/**
+ * Caller of a page request identical to one already in flight, waiting for
+ * its result.
+ */
+typedef struct helix_waiter {
+	helix_page_callback callback;
+	void *user_data;
+	void **items;                  // Waiter's copy of the page.
+	struct helix_waiter *next;
+} helix_waiter;
+
+typedef struct helix_job {
+	CURL *curl;                    // Handle, or NULL with custom transport.
+	char *url;                     // Resolved URL for custom transport.
+	char *stats_url;               // Original URL to file statistics under.
+	char *client_id;
+	char *auth;                    // Caller's token, or NULL if managed.
+	struct curl_slist *headers;
+	bool managed;                  // Whether client's credentials are used.
+	unsigned long generation;      // Client's token generation, or 0.
+	bool reauthorized;             // Whether the job got a new token after 401.
+	helix_response response;       // Receiver of the response.
+	helix_ratelimit_headers ratelimit;
+	int attempts;                  // Number of retries after 429 response.
+	int failures;                  // Number of attempts failed transiently.
+	double retry_at;               // Time to retry the failed job at.
+	long http_code;                // HTTP status code of the last attempt.
+	parser_func parser;
+	helix_page_callback callback;
+	helix_body_callback body_callback;
+	void *user_data;
+	helix_waiter *waiters;         // Callers attached to this job's result.
+	struct helix_job *prev;
+	struct helix_job *next;
+	struct helix_job *queue_next;  // Next job waiting for rate limit budget.
+	struct helix_job *delay_next;  // Next job waiting to be retried.
+	struct helix_job *ready_next;  // Next job for custom transport to perform.
+} helix_job;
+
+struct helix_multi {
+	CURLM *handle;
+	twitch_client *client;
+	bool aborting;         // Set while the engine is being destroyed.
+	helix_job *jobs;       // Added and not yet finished jobs.
+	int active;            // Number of jobs in the list.
+	helix_job *queue;      // Jobs waiting for rate limit budget, oldest first.
+	helix_job *queue_tail; // Last job in the queue.
+	helix_job *delayed;    // Failed jobs waiting to be retried.
+	helix_job *ready;      // Jobs for custom transport, oldest first.
+	helix_job *ready_tail; // Last job for custom transport.
+	int idle_count;        // Number of handles in the idle pool.
+	int idle_capacity;     // Capacity of the idle pool.
+	CURL **idle;           // Finished handles ready to be reused.
+	twitch_error error;    // Error info of finished jobs, reusing its buffer.
+};
+
+/** Handles **/
+
+CURL *helix_multi_handle(helix_multi *multi) {
+	CURL *curl = NULL;
+
+	if (multi->idle_count > 0) {
+		curl = multi->idle[--multi->idle_count];
+		curl_easy_reset(curl);
+	} else {
+		curl = curl_easy_init();
+	}
+
+	twitch_client_setup_handle(multi->client, curl);
+
+	return curl;
+}
+
+void helix_multi_release_handle(helix_multi *multi, CURL *curl) {
+	if (multi->idle_count == multi->idle_capacity) {
+		multi->idle_capacity = (multi->idle_capacity == 0)
+			? 4
+			: multi->idle_capacity * 2;
+		multi->idle = realloc(multi->idle, sizeof(CURL *) * multi->idle_capacity);
+		if (multi->idle == NULL) {
+			fprintf(stderr, "Failed to allocate memory for handle pool.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	multi->idle[multi->idle_count++] = curl;
+}
+
+/** Engine **/
+
+helix_multi *helix_multi_alloc(twitch_client *client) {
+	helix_multi *multi = calloc(1, sizeof(helix_multi));
+	if (multi == NULL) {
+		fprintf(stderr, "Failed to allocate memory for helix_multi");
+		exit(EXIT_FAILURE);
+	}
+
+	multi->client = client;
+	multi->handle = curl_multi_init();
+	curl_multi_setopt(
+		multi->handle,
+		CURLMOPT_MAX_HOST_CONNECTIONS,
+		(long)MAX_HOST_CONNECTIONS
+	);
+
+	return multi;
+}
+
+void helix_job_free(helix_job *job) {
+	FREE(job->url)
+	FREE(job->stats_url)
+	FREE(job->client_id)
+	FREE(job->auth)
+	curl_slist_free_all(job->headers);
+
+	while (job->waiters != NULL) {
+		helix_waiter *waiter = job->waiters;
+		job->waiters = waiter->next;
+		free(waiter);
+	}
+
+	helix_response_clear(&job->response);
+	FREE_CUSTOM(job->response.output, string_free)
+	free(job);
+}
+
+/**
+ * Makes a waiter's own copy of the page. Decoded pages are copied, and pages
+ * kept as text are decoded again.
+ *
+ * @param multi Engine instance.
+ * @param job Finished job.
+ * @param items Items of the page.
+ * @param count Number of items.
+ *
+ * @return New array of new items.
+ */
+void **helix_job_copy_page(
+	helix_multi *multi,
+	helix_job *job,
+	void **items,
+	int count
+) {
+	if (job->response.schema != NULL) {
+		return copy_schema_entities(job->response.schema, items, count);
+	}
+
+	int size = 0;
+	return helix_decode_page(
+		multi->client,
+		job->stats_url,
+		job->response.output->ptr,
+		job->response.output->len,
+		job->parser,
+		&size,
+		NULL,
+		NULL
+	);
+}
+
+/**
+ * Invokes job's callback of either kind with given result.
+ *
+ * @param multi Engine instance.
+ * @param job Finished job.
+ * @param error Request error info.
+ */
+void helix_job_complete(
+	helix_multi *multi,
+	helix_job *job,
+	twitch_error *error
+) {
+	if (job->body_callback != NULL) {
+		// Body callback takes over the response buffer.
+		string_t *body = job->response.output;
+		job->response.output = NULL;
+		job->body_callback(error, body, job->user_data);
+		return;
+	}
+
+	void **items = NULL;
+	char *next = NULL;
+	int count = 0, total = 0;
+
+	if (error->curl_code == CURLE_OK && job->response.output != NULL) {
+		items = helix_response_page(
+			&job->response,
+			multi->client,
+			job->stats_url,
+			job->parser,
+			&count,
+			&next,
+			&total
+		);
+	}
+
+	// Callers of identical requests get their own copies of the entities,
+	// made before job's callback takes over the originals.
+	for (
+		helix_waiter *waiter = job->waiters;
+		waiter != NULL;
+		waiter = waiter->next
+	) {
+		if (items != NULL) {
+			waiter->items = helix_job_copy_page(multi, job, items, count);
+		}
+	}
+
+	job->callback(error, items, count, next, total, job->user_data);
+
+	for (
+		helix_waiter *waiter = job->waiters;
+		waiter != NULL;
+		waiter = waiter->next
+	) {
+		void **copy = waiter->items;
+		waiter->items = NULL;
+		waiter->callback(error, copy, count, next, total, waiter->user_data);
+	}
+
+	FREE(next)
+}
+
+void helix_multi_free(helix_multi *multi) {
+	if (multi == NULL) {
+		return;
+	}
+
+	// Abort unfinished jobs, letting their callbacks release user data.
+	multi->aborting = true;
+	while (multi->jobs != NULL) {
+		helix_job *job = multi->jobs;
+		multi->jobs = job->next;
+		twitch_error error = { .curl_code = CURLE_ABORTED_BY_CALLBACK };
+		FREE_CUSTOM(job->response.output, string_free)
+		job->response.output = NULL;
+		helix_job_complete(multi, job, &error);
+
+		if (job->curl != NULL) {
+			curl_multi_remove_handle(multi->handle, job->curl);
+			curl_easy_cleanup(job->curl);
+		}
+		helix_job_free(job);
+	}
+
+	for (int idx = 0; idx < multi->idle_count; idx++) {
+		curl_easy_cleanup(multi->idle[idx]);
+	}
+
+	FREE(multi->idle)
+	twitch_error_clear(&multi->error);
+	curl_multi_cleanup(multi->handle);
+	free(multi);
+}
+
+/** Scheduling **/
+
+/**
+ * Picks credentials for a job made with client's own ones, right before it
+ * asks for rate limit budget. Headers are rebuilt if the job moves to another
+ * client ID of the pool, or its token has been replaced.
+ *
+ * @param multi Engine instance.
+ * @param job Job about to be scheduled.
+ */
+void helix_multi_update_credentials(helix_multi *multi, helix_job *job) {
+	if (!job->managed) {
+		return;
+	}
+
+	const char *client_id = NULL;
+	const char *token = NULL;
+	unsigned long generation = 0;
+	helix_credentials_resolve(multi->client, &client_id, &token, &generation);
+
+	if (
+		job->headers != NULL &&
+		job->generation == generation &&
+		strcmp(job->client_id, client_id) == 0
+	) {
+		return;
+	}
+
+	FREE(job->client_id)
+	job->client_id = immutable_string_copy(client_id);
+	curl_slist_free_all(job->headers);
+	job->headers = helix_request_headers(client_id, token);
+	job->generation = generation;
+
+	if (job->curl != NULL) {
+		curl_easy_setopt(job->curl, CURLOPT_HTTPHEADER, job->headers);
+	}
+}
+
+/**
+ * Starts given job: adds its handle to the multi handle, or puts it in line
+ * for client's custom transport.
+ *
+ * @param multi Engine instance.
+ * @param job Job to start.
+ */
+void helix_multi_start_job(helix_multi *multi, helix_job *job) {
+	if (job->curl != NULL) {
+		curl_multi_add_handle(multi->handle, job->curl);
+		return;
+	}
+
+	job->ready_next = NULL;
+	if (multi->ready_tail != NULL) {
+		multi->ready_tail->ready_next = job;
+	} else {
+		multi->ready = job;
+	}
+	multi->ready_tail = job;
+}
+
+/**
+ * Starts given job right away if there is rate limit budget for it, or puts it
+ * to the end of the queue otherwise.
+ *
+ * @param multi Engine instance.
+ * @param job Job to start.
+ */
+void helix_multi_schedule_job(helix_multi *multi, helix_job *job) {
+	if (job->curl != NULL) {
+		helix_ratelimit_setup(job->curl, &job->ratelimit);
+	}
+
+	// Jobs don't overtake the ones already waiting.
+	if (multi->queue == NULL) {
+		helix_multi_update_credentials(multi, job);
+	}
+	if (
+		multi->queue == NULL &&
+		helix_ratelimit_acquire(multi->client, job->client_id) == 0
+	) {
+		helix_multi_start_job(multi, job);
+		return;
+	}
+
+	job->queue_next = NULL;
+	if (multi->queue_tail != NULL) {
+		multi->queue_tail->queue_next = job;
+	} else {
+		multi->queue = job;
+	}
+	multi->queue_tail = job;
+}
+
+/**
+ * Starts queued jobs while there is rate limit budget for them.
+ *
+ * @param multi Engine instance.
+ *
+ * @return Number of seconds until the next queued job can start, or 0 if the
+ * queue is empty.
+ */
+double helix_multi_dispatch_queue(helix_multi *multi) {
+	while (multi->queue != NULL) {
+		helix_job *job = multi->queue;
+
+		helix_multi_update_credentials(multi, job);
+		double delay = helix_ratelimit_acquire(multi->client, job->client_id);
+		if (delay > 0) {
+			return delay;
+		}
+
+		multi->queue = job->queue_next;
+		if (multi->queue == NULL) {
+			multi->queue_tail = NULL;
+		}
+		job->queue_next = NULL;
+
+		helix_multi_start_job(multi, job);
+	}
+
+	return 0;
+}
+
+/**
+ * Puts a transiently failed job aside until its retry delay passes.
+ *
+ * @param multi Engine instance.
+ * @param job Failed job.
+ */
+void helix_multi_delay_job(helix_multi *multi, helix_job *job) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	job->retry_at = ts.tv_sec + ts.tv_nsec / 1e9 +
+		helix_retry_delay(multi->client, job->failures);
+	job->delay_next = multi->delayed;
+	multi->delayed = job;
+}
+
+/**
+ * Schedules failed jobs whose retry delay has passed.
+ *
+ * @param multi Engine instance.
+ *
+ * @return Number of seconds until the next delayed job is due, or 0 if there
+ * are none.
+ */
+double helix_multi_dispatch_delayed(helix_multi *multi) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	double now = ts.tv_sec + ts.tv_nsec / 1e9;
+	double next = 0;
+
+	helix_job **link = &multi->delayed;
+	while (*link != NULL) {
+		helix_job *job = *link;
+
+		if (job->retry_at > now) {
+			if (next == 0 || job->retry_at - now < next) {
+				next = job->retry_at - now;
+			}
+			link = &job->delay_next;
+			continue;
+		}
+
+		*link = job->delay_next;
+		job->delay_next = NULL;
+
+		helix_response_reset(&job->response);
+		helix_multi_schedule_job(multi, job);
+	}
+
+	return next;
+}
+
+/** Jobs **/
+
+/**
+ * Creates a job for given URL and starts it.
+ *
+ * @return New job. Caller has to set its callback.
+ */
+helix_job *helix_multi_add_job(
+	helix_multi *multi,
+	const char *client_id,
+	const char *auth,
+	const char *url
+) {
+	helix_job *job = calloc(1, sizeof(helix_job));
+	if (job == NULL) {
+		fprintf(stderr, "Failed to allocate memory for helix_job");
+		exit(EXIT_FAILURE);
+	}
+
+	// Jobs made with client's own credentials get them when scheduled.
+	job->managed = (auth == NULL);
+	if (!job->managed) {
+		job->client_id = immutable_string_copy(
+			(client_id != NULL) ? client_id : ""
+		);
+		job->auth = immutable_string_copy(auth);
+		job->headers = helix_request_headers(job->client_id, auth);
+	}
+	job->stats_url = immutable_string_copy(url);
+	helix_response_init(&job->response, string_init(), NULL);
+
+	if (helix_transport_enabled(multi->client)) {
+		string_t *resolved_url = twitch_client_resolve_url(multi->client, url);
+		job->url = resolved_url->ptr;
+		free(resolved_url);
+	} else {
+		job->curl = helix_multi_handle(multi);
+		helix_setup_request(
+			multi->client,
+			job->curl,
+			job->headers,
+			url,
+			&job->response
+		);
+		curl_easy_setopt(job->curl, CURLOPT_PRIVATE, job);
+	}
+
+	// Link the job into the active list.
+	job->next = multi->jobs;
+	if (multi->jobs != NULL) {
+		multi->jobs->prev = job;
+	}
+	multi->jobs = job;
+	multi->active++;
+
+	helix_multi_schedule_job(multi, job);
+
+	return job;
+}
+
+/**
+ * Finds an unfinished page request for given URL made with the same
+ * credentials and parser.
+ *
+ * @return Found job, or NULL.
+ */
+helix_job *helix_multi_find_page(
+	helix_multi *multi,
+	const char *client_id,
+	const char *auth,
+	const char *url,
+	parser_func parser
+) {
+	for (helix_job *job = multi->jobs; job != NULL; job = job->next) {
+		if (
+			job->callback == NULL ||
+			job->parser != parser ||
+			strcmp(job->stats_url, url) != 0
+		) {
+			continue;
+		}
+
+		if (auth == NULL) {
+			if (job->managed) {
+				return job;
+			}
+			continue;
+		}
+
+		if (
+			!job->managed &&
+			strcmp(job->auth, auth) == 0 &&
+			strcmp(job->client_id, (client_id != NULL) ? client_id : "") == 0
+		) {
+			return job;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Attaches a caller to the result of given job. Callers are invoked in the
+ * order they were added.
+ */
+void helix_multi_add_waiter(
+	helix_job *job,
+	helix_page_callback callback,
+	void *user_data
+) {
+	helix_waiter *waiter = calloc(1, sizeof(helix_waiter));
+	if (waiter == NULL) {
+		fprintf(stderr, "Failed to allocate memory for helix_waiter");
+		exit(EXIT_FAILURE);
+	}
+
+	waiter->callback = callback;
+	waiter->user_data = user_data;
+
+	helix_waiter **link = &job->waiters;
+	while (*link != NULL) {
+		link = &(*link)->next;
+	}
+	*link = waiter;
+}
+
+void helix_multi_add_page(
+	helix_multi *multi,
+	const char *client_id,
+	const char *auth,
+	helix_page_url_builder builder,
+	void *params,
+	int limit,
+	const char *after,
+	parser_func parser,
+	helix_page_callback callback,
+	void *user_data
+) {
+	if (multi->aborting) {
+		return;
+	}
+
+	double start = helix_trace_clock(multi->client);
+	string_t *url = builder(params, limit, after);
+	helix_trace_end(multi->client, TRACE_URL_BUILD, url->ptr, start);
+
+	// Identical request already in flight shares its result instead.
+	helix_job *leader = helix_multi_find_page(
+		multi,
+		client_id,
+		auth,
+		url->ptr,
+		parser
+	);
+	if (leader != NULL) {
+		string_free(url);
+		helix_multi_add_waiter(leader, callback, user_data);
+		return;
+	}
+
+	helix_job *job = helix_multi_add_job(multi, client_id, auth, url->ptr);
+	string_free(url);
+
+	// Response starts arriving on the next step, and is decoded on the fly.
+	job->parser = parser;
+	job->response.schema = parser_schema(parser);
+	job->callback = callback;
+	job->user_data = user_data;
+}
+
+void helix_multi_add_request(
+	helix_multi *multi,
+	const char *client_id,
+	const char *auth,
+	const char *url,
+	helix_body_callback callback,
+	void *user_data
+) {
+	if (multi->aborting) {
+		return;
+	}
+
+	helix_job *job = helix_multi_add_job(multi, client_id, auth, url);
+	job->body_callback = callback;
+	job->user_data = user_data;
+}
+
+/**
+ * Hands the result of finished job over to its callback.
+ *
+ * @param multi Engine instance.
+ * @param job Finished job.
+ * @param code Transfer result code.
+ */
+void helix_multi_finish_job(helix_multi *multi, helix_job *job, CURLcode code) {
+	// Callbacks get the error only for the duration of the call, so all jobs
+	// share one struct, and failures don't allocate a buffer each.
+	twitch_error *error = &multi->error;
+	helix_reset_error(error);
+	helix_fill_error(
+		error,
+		code,
+		job->http_code,
+		job->response.output,
+		&job->ratelimit
+	);
+
+	// Unlink the job first, so callback can safely add new ones.
+	if (job->prev != NULL) {
+		job->prev->next = job->next;
+	} else {
+		multi->jobs = job->next;
+	}
+	if (job->next != NULL) {
+		job->next->prev = job->prev;
+	}
+
+	helix_job_complete(multi, job, error);
+
+	if (job->curl != NULL) {
+		helix_multi_release_handle(multi, job->curl);
+	}
+	helix_job_free(job);
+	multi->active--;
+}
+
+/**
+ * Handles the result of job's attempt: sends it back to the queue if it was
+ * rejected by rate limiter, delays it if it failed transiently, or finishes
+ * it.
+ *
+ * @param multi Engine instance.
+ * @param job Job that made an attempt.
+ * @param code Transfer result code.
+ * @param latency Duration of the attempt, in seconds.
+ */
+void helix_multi_job_done(
+	helix_multi *multi,
+	helix_job *job,
+	CURLcode code,
+	double latency
+) {
+	// Requests rejected by rate limiter go back to the queue.
+	bool retry = helix_ratelimit_update(
+		multi->client,
+		job->client_id,
+		&job->ratelimit,
+		job->http_code
+	);
+	if (retry && job->attempts < MAX_RATE_LIMIT_RETRIES) {
+		job->attempts++;
+		helix_stats_record_retry(multi->client, job->stats_url);
+		helix_response_reset(&job->response);
+		helix_multi_schedule_job(multi, job);
+		return;
+	}
+
+	// Client's token may have expired early or been revoked. The job is
+	// repeated once with a new one.
+	if (
+		code == CURLE_HTTP_RETURNED_ERROR &&
+		job->http_code == 401 &&
+		!job->reauthorized &&
+		helix_credentials_rejected(
+			multi->client,
+			job->client_id,
+			job->generation
+		)
+	) {
+		job->reauthorized = true;
+		helix_stats_record_retry(multi->client, job->stats_url);
+		helix_response_reset(&job->response);
+		helix_multi_schedule_job(multi, job);
+		return;
+	}
+
+	// Transient failures are retried after a delay.
+	if (code != CURLE_OK) {
+		job->failures++;
+		if (
+			helix_retry_should(multi->client, job->failures, code, job->http_code)
+		) {
+			helix_stats_record_retry(multi->client, job->stats_url);
+			helix_multi_delay_job(multi, job);
+			return;
+		}
+	} else {
+		helix_retry_record_latency(multi->client, latency);
+	}
+
+	helix_multi_finish_job(multi, job, code);
+}
+
+/**
+ * Performs jobs waiting for client's custom transport, one by one.
+ *
+ * @param multi Engine instance.
+ */
+void helix_multi_perform_ready(helix_multi *multi) {
+	while (multi->ready != NULL) {
+		helix_job *job = multi->ready;
+		multi->ready = job->ready_next;
+		if (multi->ready == NULL) {
+			multi->ready_tail = NULL;
+		}
+		job->ready_next = NULL;
+
+		double latency = 0;
+		helix_response_reset(&job->response);
+		CURLcode code = helix_transport_perform(
+			multi->client,
+			"GET",
+			job->url,
+			job->headers,
+			job->response.output,
+			&job->ratelimit,
+			&job->http_code,
+			&latency
+		);
+		job->response.length = job->response.output->len;
+		helix_stats_record_attempt(
+			multi->client,
+			job->stats_url,
+			NULL,
+			code,
+			job->http_code,
+			latency,
+			job->response.length
+		);
+
+		helix_multi_job_done(multi, job, code, latency);
+	}
+}
+
+int helix_multi_step(helix_multi *multi, int timeout_ms) {
+	int running = 0;
+
+	// Don't wait past the moment the next queued or delayed job can start.
+	double retry_delay = helix_multi_dispatch_delayed(multi);
+	if (multi->delayed != NULL && retry_delay * 1000 < timeout_ms) {
+		timeout_ms = (int)(retry_delay * 1000) + 1;
+	}
+
+	double delay = helix_multi_dispatch_queue(multi);
+	if (multi->queue != NULL && delay * 1000 < timeout_ms) {
+		timeout_ms = (int)(delay * 1000) + 1;
+	}
+
+	helix_multi_perform_ready(multi);
+
+	curl_multi_perform(multi->handle, &running);
+	if (
+		(running > 0 || multi->queue != NULL || multi->delayed != NULL) &&
+		timeout_ms > 0
+	) {
+		curl_multi_poll(multi->handle, NULL, 0, timeout_ms, NULL);
+		curl_multi_perform(multi->handle, &running);
+	}
+
+	// Dispatch finished jobs. Callbacks may add new ones.
+	CURLMsg *msg = NULL;
+	int left = 0;
+	while ((msg = curl_multi_info_read(multi->handle, &left)) != NULL) {
+		if (msg->msg != CURLMSG_DONE) {
+			continue;
+		}
+
+		CURL *curl = msg->easy_handle;
+		CURLcode code = msg->data.result;
+		helix_job *job = NULL;
+		double latency = 0;
+
+		curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char **)&job);
+		curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &job->http_code);
+		curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &latency);
+		code = helix_check_status(code, job->http_code);
+		curl_multi_remove_handle(multi->handle, curl);
+		twitch_client_record_transfer(
+			multi->client,
+			curl,
+			job->response.length
+		);
+		helix_stats_record_attempt(
+			multi->client,
+			job->stats_url,
+			curl,
+			code,
+			job->http_code,
+			latency,
+			job->response.length
+		);
+
+		helix_multi_job_done(multi, job, code, latency);
+	}
+
+	return multi->active;
+}
+
+void helix_multi_perform(helix_multi *multi) {
+	while (helix_multi_step(multi, 1000) > 0);
+}
+
+/** Parallel pagination **/
+
+typedef struct helix_crawl helix_crawl;
+
+typedef struct {
+	helix_crawl *crawl;
+	void *params;
+	int count;
+	void **items;
+} helix_crawl_shard;
+
+struct helix_crawl {
+	helix_multi *multi;
+	const char *client_id;
+	const char *auth;
+	twitch_error *error;
+	helix_page_url_builder builder;
+	parser_func parser;
+	int limit;
+	bool failed;
+};
+
+void helix_crawl_page_callback(
+	twitch_error *error,
+	void **items,
+	int count,
+	const char *next,
+	int total,
+	void *user_data
+) {
+	(void)total;
+
+	helix_crawl_shard *shard = (helix_crawl_shard *)user_data;
+	helix_crawl *crawl = shard->crawl;
+
+	// Remember the first error only.
+	if (error->curl_code != CURLE_OK) {
+		if (!crawl->failed) {
+			helix_copy_error(crawl->error, error);
+		}
+		crawl->failed = true;
+		return;
+	}
+
+	if (count > 0) {
+		shard->items = realloc(
+			shard->items,
+			sizeof(void *) * (shard->count + count)
+		);
+		if (shard->items == NULL) {
+			fprintf(stderr, "Failed to allocate memory for next page.\n");
+			exit(EXIT_FAILURE);
+		}
+
+		memcpy(&shard->items[shard->count], items, sizeof(void *) * count);
+		shard->count += count;
+	}
+	FREE(items)
+
+	// Continue with the next page of the same shard.
+	if (count > 0 && next != NULL && !crawl->failed) {
+		helix_multi_add_page(
+			crawl->multi,
+			crawl->client_id,
+			crawl->auth,
+			crawl->builder,
+			shard->params,
+			crawl->limit,
+			next,
+			crawl->parser,
+			&helix_crawl_page_callback,
+			(void *)shard
+		);
+	}
+}
+
+void **helix_get_all_pages_parallel(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	twitch_error *error,
+	helix_page_url_builder builder,
+	int params_count,
+	void **params,
+	int limit,
+	parser_func parser,
+	int *size
+) {
+	helix_reset_error(error);
+
+	helix_crawl crawl = {
+		.multi = helix_multi_alloc(client),
+		.client_id = client_id,
+		.auth = auth,
+		.error = error,
+		.builder = builder,
+		.parser = parser,
+		.limit = limit,
+		.failed = false
+	};
+
+	helix_crawl_shard *shards = calloc(params_count, sizeof(helix_crawl_shard));
+	if (shards == NULL && params_count > 0) {
+		fprintf(stderr, "Failed to allocate memory for shards.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// Start the first page of every shard at once.
+	for (int idx = 0; idx < params_count; idx++) {
+		shards[idx].crawl = &crawl;
+		shards[idx].params = params[idx];
+
+		helix_multi_add_page(
+			crawl.multi,
+			client_id,
+			auth,
+			builder,
+			params[idx],
+			limit,
+			NULL,
+			parser,
+			&helix_crawl_page_callback,
+			(void *)&shards[idx]
+		);
+	}
+
+	helix_multi_perform(crawl.multi);
+	helix_multi_free(crawl.multi);
+
+	// Merge the shards in order.
+	int total = 0;
+	for (int idx = 0; idx < params_count; idx++) {
+		total += shards[idx].count;
+	}
+
+	void **elements = (total > 0) ? malloc(sizeof(void *) * total) : NULL;
+	if (elements == NULL && total > 0) {
+		fprintf(stderr, "Failed to allocate memory for items.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	int offset = 0;
+	for (int idx = 0; idx < params_count; idx++) {
+		if (shards[idx].count > 0) {
+			memcpy(
+				&elements[offset],
+				shards[idx].items,
+				sizeof(void *) * shards[idx].count
+			);
+			offset += shards[idx].count;
+		}
+		FREE(shards[idx].items)
+	}
+
+	free(shards);
+
+	*size = total;
+	return elements;
+}
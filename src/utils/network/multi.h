@@ -0,0 +1,266 @@
+/**
+ * Concurrent request engine for Helix API.
+ *
+ * Runs any number of page requests in parallel on a single thread using cURL
+ * multi interface, and delivers parsed results through completion callbacks.
+ * Pages are decoded while they are being downloaded (see helix_response).
+ * Callbacks are invoked from helix_multi_perform() or helix_multi_step(), and
+ * they can add new jobs to the same engine, e.g. to fetch the next page.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#ifndef _H_NETWORK_MULTI_UTILS
+#define _H_NETWORK_MULTI_UTILS
+
+#include <stdbool.h>
+#include <curl/curl.h>
+
+#include "utils/network/helix.h"
+
+#include <ctwitch/common.h>
+#include <ctwitch/client.h>
+#include <ctwitch/helix/batch.h>
+
+/**
+ * Page completion callback.
+ *
+ * @param error Error info of the request. Only valid during the call.
+ * @param items Parsed items. Callee takes ownership of the array and items.
+ * @param count Number of parsed items.
+ * @param next Cursor of the next page or NULL. Only valid during the call.
+ * @param total Total number of items reported by the API, or 0.
+ * @param user_data User data provided with the job.
+ */
+typedef void (*helix_page_callback)(
+	twitch_error *error,
+	void **items,
+	int count,
+	const char *next,
+	int total,
+	void *user_data
+);
+
+/**
+ * Raw request completion callback.
+ *
+ * @param error Error info of the request. Only valid during the call.
+ * @param body Response body. Callee takes ownership of it. NULL if the request
+ * was aborted.
+ * @param user_data User data provided with the job.
+ */
+typedef void (*helix_body_callback)(
+	twitch_error *error,
+	string_t *body,
+	void *user_data
+);
+
+typedef struct helix_multi helix_multi;
+
+/**
+ * Creates new request engine.
+ *
+ * @param client Client context to share connections and caches with. Can be
+ * NULL.
+ *
+ * @return New engine instance. Free it with helix_multi_free().
+ */
+helix_multi *helix_multi_alloc(twitch_client *client);
+
+/**
+ * Aborts all unfinished jobs and frees the engine. Callbacks of aborted jobs
+ * are called with CURLE_ABORTED_BY_CALLBACK error code, and any jobs they try
+ * to add are ignored.
+ *
+ * @param multi Engine to deallocate.
+ */
+void helix_multi_free(helix_multi *multi);
+
+/**
+ * Adds a page request to the engine. The request starts on the next call to
+ * helix_multi_step() or helix_multi_perform().
+ *
+ * If an identical request, for the same URL with the same credentials and
+ * parser, is already in flight, no new one is sent. The callback is invoked
+ * with the result of that request instead, right after its own callback, with
+ * its own copy of the parsed items.
+ *
+ * @param multi Engine instance.
+ * @param client_id Twitch API client ID.
+ * @param auth Authorization token.
+ * @param builder Twitch API URL builder function.
+ * @param params URL/request params to provide to the builder function. Used
+ * only during this call.
+ * @param limit Page size.
+ * @param after Page offset.
+ * @param parser Parser function to parse each value object inside the values
+ * JSON array.
+ * @param callback Completion callback.
+ * @param user_data Value to pass to the callback.
+ */
+void helix_multi_add_page(
+	helix_multi *multi,
+	const char *client_id,
+	const char *auth,
+	helix_page_url_builder builder,
+	void *params,
+	int limit,
+	const char *after,
+	parser_func parser,
+	helix_page_callback callback,
+	void *user_data
+);
+
+/**
+ * Adds a GET request to the engine, which delivers raw response body instead
+ * of parsed page. The request starts on the next call to helix_multi_step() or
+ * helix_multi_perform().
+ *
+ * @param multi Engine instance.
+ * @param client_id Twitch API client ID.
+ * @param auth Authorization token.
+ * @param url Target URL.
+ * @param callback Completion callback.
+ * @param user_data Value to pass to the callback.
+ */
+void helix_multi_add_request(
+	helix_multi *multi,
+	const char *client_id,
+	const char *auth,
+	const char *url,
+	helix_body_callback callback,
+	void *user_data
+);
+
+/**
+ * Drives all running transfers once, waiting up to given timeout for network
+ * activity, and invokes callbacks of finished jobs.
+ *
+ * @param multi Engine instance.
+ * @param timeout_ms Max time to wait for network activity.
+ *
+ * @return Number of jobs still unfinished.
+ */
+int helix_multi_step(helix_multi *multi, int timeout_ms);
+
+/**
+ * Runs the engine until all jobs, including ones added by callbacks, are
+ * finished.
+ *
+ * @param multi Engine instance.
+ */
+void helix_multi_perform(helix_multi *multi);
+
+/**
+ * Downloads all pages for each of given request params in parallel, and
+ * returns their items merged in the order of params. Each params set gets its
+ * own pagination, which continues until an empty page or a page without
+ * cursor is returned.
+ *
+ * Used to split queries that can't fit into one request, like more than 100
+ * user IDs, into shards.
+ *
+ * @param client Client context. Can be NULL.
+ * @param client_id Twitch API client ID.
+ * @param auth Authorization token.
+ * @param error Error struct to hold info about the first failed request.
+ * @param builder Twitch API URL builder function.
+ * @param params_count Number of request params sets.
+ * @param params Array of request params sets. Must be valid until the function
+ * returns.
+ * @param limit Page size.
+ * @param parser Parser function to parse each item.
+ * @param size Returns total number of parsed items.
+ *
+ * @return Array of pointers to downloaded and parsed items.
+ */
+void **helix_get_all_pages_parallel(
+	twitch_client *client,
+	const char *client_id,
+	const char *auth,
+	twitch_error *error,
+	helix_page_url_builder builder,
+	int params_count,
+	void **params,
+	int limit,
+	parser_func parser,
+	int *size
+);
+
+/** Batch helpers **/
+
+/**
+ * Max number of keys in one combined lookup request.
+ */
+#define HELIX_LOAD_MAX_KEYS 100
+
+/**
+ * Returns entity's ID, or its name if by_id is false, to match it against
+ * lookup keys.
+ */
+typedef const char *(*helix_load_key_func)(void *item, bool by_id);
+
+/**
+ * Describes an entity that can be looked up by key with batched lookups,
+ * like users by login or ID.
+ */
+typedef struct {
+	const char *url;            // Endpoint URL.
+	const char *id_param;       // Query param for lookups by ID.
+	const char *name_param;     // Query param for lookups by name.
+	parser_func parser;         // Entity parser.
+	helix_load_key_func key;    // Entity key getter.
+	void *(*copy)(void *);      // Entity copy function.
+	void (*free)(void *);       // Entity free function.
+} helix_load_type;
+
+/**
+ * Adds a page request to the batch, wrapping its result into a list struct
+ * allocated with given allocator before passing it to the user's callback.
+ *
+ * @param batch Batch to add request to.
+ * @param builder Twitch API URL builder function.
+ * @param params URL/request params to provide to the builder function.
+ * @param limit Page size.
+ * @param after Page offset.
+ * @param parser Parser function to parse each item.
+ * @param list_alloc Allocator of the list struct to pass to the callback.
+ * @param callback User's callback.
+ * @param user_data User data for the callback.
+ */
+void helix_batch_add_page(
+	twitch_helix_batch *batch,
+	helix_page_url_builder builder,
+	void *params,
+	int limit,
+	const char *after,
+	parser_func parser,
+	list_alloc_func list_alloc,
+	twitch_helix_batch_callback callback,
+	void *user_data
+);
+
+/**
+ * Adds a lookup of a single entity by key to the batch. Lookups of the same
+ * type are collected until the batch is performed, or until there are
+ * HELIX_LOAD_MAX_KEYS distinct keys, and then sent as one request. Names are
+ * matched case-insensitively, IDs exactly.
+ *
+ * @param batch Batch to add lookup to.
+ * @param type Type of the entity.
+ * @param by_id Whether the key is an ID or a name.
+ * @param key Entity's ID or name.
+ * @param callback User's callback.
+ * @param user_data User data for the callback.
+ */
+void helix_batch_load(
+	twitch_helix_batch *batch,
+	const helix_load_type *type,
+	bool by_id,
+	const char *key,
+	twitch_helix_batch_load_callback callback,
+	void *user_data
+);
+
+#endif
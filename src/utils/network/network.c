@@ -5,6 +5,9 @@
 #include <curl/curl.h>
 
 #include "utils/network/network.h"
+#include "utils/network/client.h"
+#include "utils/network/transport.h"
+#include "utils/network/stats.h"
 #include "utils/strings/strings.h"
 #include "utils/parser/parser.h"
 #include "json/json.h"
@@ -17,22 +20,54 @@ size_t twitch_writefunc(void *ptr, size_t size, size_t nmemb, struct string *s)
   return append_size;
 }
 
-CURLcode twitch_post(const char *url, string_t *output) {
-  // Initialize curl.
-  CURL *curl;
-  curl = curl_easy_init();
-
+CURLcode twitch_post(twitch_client *client, const char *url, string_t *output) {
   // Headers list.
   struct curl_slist *headers = NULL;
 
   // Basic headers.
   headers = curl_slist_append(headers, "Accept: application/json");
 
+  // Auth server may be substituted too.
+  string_t *resolved_url = twitch_client_resolve_url(client, url);
+
+  // Hand the request over to custom transport, if there is one.
+  if (helix_transport_enabled(client)) {
+    long http_code = 0;
+    double latency = 0;
+    CURLcode code = helix_transport_perform(
+      client,
+      "POST",
+      resolved_url->ptr,
+      headers,
+      output,
+      NULL,
+      &http_code,
+      &latency
+    );
+    helix_stats_record_attempt(
+      client,
+      url,
+      NULL,
+      code,
+      http_code,
+      latency,
+      output->len
+    );
+    curl_slist_free_all(headers);
+    string_free(resolved_url);
+    return code;
+  }
+
+  // Get a handle. Tokens may be requested while client's main handle is set
+  // up for an API request, so they have a handle of their own.
+  CURL *curl = twitch_client_auth_handle(client);
+
   // Set headers.
   curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
 
-  // Set URL.
-  curl_easy_setopt(curl, CURLOPT_URL, url);
+  // Set URL. cURL keeps its own copy of it.
+  curl_easy_setopt(curl, CURLOPT_URL, resolved_url->ptr);
+  string_free(resolved_url);
 
   // Setup output buffer.
   curl_easy_setopt(curl, CURLOPT_POST, 1);
@@ -45,17 +80,19 @@ CURLcode twitch_post(const char *url, string_t *output) {
 
   // Perform curl operation.
   CURLcode code = curl_easy_perform(curl);
+  helix_stats_record_attempt(client, url, curl, code, 0, 0, output->len);
 
   // Cleanup.
-  curl_easy_cleanup(curl);
+  curl_slist_free_all(headers);
+  twitch_client_release_handle(client, curl);
 
   return code;
 }
 
-json_value *twitch_auth_post_json(const char *url) {
+json_value *twitch_auth_post_json(twitch_client *client, const char *url) {
   // Get the output.
   string_t *output = string_init();
-  CURLcode code = twitch_post(url, output);
+  CURLcode code = twitch_post(client, url, output);
 
   // Check return code.
   if (code == CURLE_HTTP_RETURNED_ERROR) {
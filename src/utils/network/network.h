@@ -17,6 +17,8 @@
 #include "utils/strings/strings.h"
 #include "json/json.h"
 
+#include <ctwitch/client.h>
+
 /**
  * Convenience JSON parser function type.
  */
@@ -26,11 +28,12 @@ typedef void *(*parser_func)(json_value *);
  * Performs a POST request to given Twitch API endpoint URL, and returns parsed
  * JSON value.
  *
+ * @param client Client context to reuse connections from. Can be NULL.
  * @param url Target API endpoint URL.
  *
  * @return Parsed JSON value. (see utils/json library).
  */
-json_value *twitch_auth_post_json(const char *url);
+json_value *twitch_auth_post_json(twitch_client *client, const char *url);
 
 #endif
 
@@ -0,0 +1,398 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <time.h>
+#include <curl/curl.h>
+
+#include "utils/datagen.h"
+#include "utils/strings/strings.h"
+#include "utils/network/client.h"
+#include "utils/network/ratelimit.h"
+
+/**
+ * Time it takes for an empty bucket to refill completely, in seconds.
+ */
+#define RATE_LIMIT_WINDOW 60.0
+
+/**
+ * Bucket size Helix gives to client IDs by default, assumed for buckets not
+ * known yet.
+ */
+#define RATE_LIMIT_DEFAULT_POINTS 800
+
+/**
+ * Delay before retrying 429 response which didn't say when to retry.
+ */
+#define RATE_LIMIT_DEFAULT_DELAY 1.0
+
+/** Helpers **/
+
+double helix_ratelimit_now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Parses a header line if it's given header.
+ *
+ * @param line Header line, not null-terminated.
+ * @param length Length of the line.
+ * @param name Header name with colon.
+ * @param value Returns header value.
+ *
+ * @return true if the line contains given header with a numeric value.
+ */
+bool helix_ratelimit_parse_header(
+	const char *line,
+	size_t length,
+	const char *name,
+	long *value
+) {
+	size_t name_length = strlen(name);
+	if (length <= name_length || strncasecmp(line, name, name_length) != 0) {
+		return false;
+	}
+
+	char buffer[32];
+	size_t value_length = length - name_length;
+	if (value_length >= sizeof(buffer)) {
+		return false;
+	}
+
+	memcpy(buffer, line + name_length, value_length);
+	buffer[value_length] = '\0';
+
+	char *end = NULL;
+	long result = strtol(buffer, &end, 10);
+	if (end == buffer) {
+		return false;
+	}
+
+	*value = result;
+	return true;
+}
+
+/**
+ * Parses Retry-After header line, which holds either a number of seconds or
+ * an HTTP date.
+ *
+ * @return true if the line contains Retry-After header with a valid value.
+ */
+bool helix_ratelimit_parse_retry_after(
+	const char *line,
+	size_t length,
+	long *value
+) {
+	const char *name = "Retry-After:";
+	size_t name_length = strlen(name);
+	if (length <= name_length || strncasecmp(line, name, name_length) != 0) {
+		return false;
+	}
+
+	if (helix_ratelimit_parse_header(line, length, name, value)) {
+		return true;
+	}
+
+	char buffer[64];
+	size_t value_length = length - name_length;
+	if (value_length >= sizeof(buffer)) {
+		return false;
+	}
+
+	memcpy(buffer, line + name_length, value_length);
+	buffer[value_length] = '\0';
+
+	time_t date = curl_getdate(buffer, NULL);
+	if (date < 0) {
+		return false;
+	}
+
+	long delay = (long)(date - (time_t)helix_ratelimit_now());
+	*value = (delay > 0) ? delay : 0;
+	return true;
+}
+
+void helix_ratelimit_reset_headers(helix_ratelimit_headers *headers) {
+	headers->limit = -1;
+	headers->remaining = -1;
+	headers->reset = -1;
+	headers->retry_after = -1;
+}
+
+void helix_ratelimit_read_header(
+	helix_ratelimit_headers *headers,
+	const char *line,
+	size_t length
+) {
+	long *retry_after = &headers->retry_after;
+	if (helix_ratelimit_parse_retry_after(line, length, retry_after)) {
+		return;
+	}
+
+	const char *names[3] = {
+		"Ratelimit-Limit:",
+		"Ratelimit-Remaining:",
+		"Ratelimit-Reset:"
+	};
+	long *values[3] = {
+		&headers->limit,
+		&headers->remaining,
+		&headers->reset
+	};
+
+	for (int idx = 0; idx < 3; idx++) {
+		if (helix_ratelimit_parse_header(line, length, names[idx], values[idx])) {
+			break;
+		}
+	}
+}
+
+size_t helix_ratelimit_header_callback(
+	char *buffer,
+	size_t size,
+	size_t nitems,
+	void *userdata
+) {
+	size_t length = size * nitems;
+	helix_ratelimit_read_header(
+		(helix_ratelimit_headers *)userdata,
+		buffer,
+		length
+	);
+	return length;
+}
+
+/**
+ * Finds the bucket of given client ID, creating it if needed.
+ */
+helix_rate_bucket *helix_ratelimit_bucket(
+	twitch_client *client,
+	const char *client_id
+) {
+	for (
+		helix_rate_bucket *bucket = client->buckets;
+		bucket != NULL;
+		bucket = bucket->next
+	) {
+		if (strcmp(bucket->client_id, client_id) == 0) {
+			return bucket;
+		}
+	}
+
+	helix_rate_bucket *bucket = calloc(1, sizeof(helix_rate_bucket));
+	if (bucket == NULL) {
+		fprintf(stderr, "Failed to allocate memory for rate limit bucket.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// The bucket is unknown until the first response arrives.
+	bucket->client_id = immutable_string_copy(client_id);
+	bucket->limit = -1;
+	bucket->next = client->buckets;
+	client->buckets = bucket;
+
+	return bucket;
+}
+
+/**
+ * Adds points accumulated since the last refill.
+ */
+void helix_ratelimit_refill(helix_rate_bucket *bucket, double now) {
+	if (bucket->limit <= 0) {
+		return;
+	}
+
+	if (bucket->reset > 0 && now >= bucket->reset) {
+		// The window is over, the next response tells when the new one ends.
+		bucket->tokens = bucket->limit;
+		bucket->reset = 0;
+	} else if (now > bucket->updated) {
+		double elapsed = now - bucket->updated;
+		bucket->tokens += elapsed * bucket->limit / RATE_LIMIT_WINDOW;
+		if (bucket->tokens > bucket->limit) {
+			bucket->tokens = bucket->limit;
+		}
+	}
+
+	bucket->updated = now;
+}
+
+/** Scheduler **/
+
+void helix_ratelimit_setup(CURL *curl, helix_ratelimit_headers *headers) {
+	helix_ratelimit_reset_headers(headers);
+
+	curl_easy_setopt(
+		curl,
+		CURLOPT_HEADERFUNCTION,
+		helix_ratelimit_header_callback
+	);
+	curl_easy_setopt(curl, CURLOPT_HEADERDATA, headers);
+}
+
+double helix_ratelimit_acquire(twitch_client *client, const char *client_id) {
+	if (client == NULL || !client->rate_limiting) {
+		return 0;
+	}
+
+	helix_rate_bucket *bucket = helix_ratelimit_bucket(client, client_id);
+	if (bucket->limit <= 0) {
+		bucket->in_flight++;
+		return 0;
+	}
+
+	double now = helix_ratelimit_now();
+	helix_ratelimit_refill(bucket, now);
+
+	// Server asked to wait, even if points drip in sooner.
+	if (bucket->retry_at > now) {
+		return bucket->retry_at - now;
+	}
+
+	if (bucket->tokens >= 1) {
+		bucket->tokens -= 1;
+		bucket->in_flight++;
+		return 0;
+	}
+
+	// Wait for one point to drip in, or for the reset, whichever comes first.
+	double delay = (1 - bucket->tokens) * RATE_LIMIT_WINDOW / bucket->limit;
+	if (bucket->reset > now && bucket->reset - now < delay) {
+		delay = bucket->reset - now;
+	}
+
+	return delay;
+}
+
+void helix_ratelimit_wait(twitch_client *client, const char *client_id) {
+	double delay = 0;
+
+	while ((delay = helix_ratelimit_acquire(client, client_id)) > 0) {
+		struct timespec ts;
+		ts.tv_sec = (time_t)delay;
+		ts.tv_nsec = (long)((delay - ts.tv_sec) * 1e9);
+		nanosleep(&ts, NULL);
+	}
+}
+
+bool helix_ratelimit_update(
+	twitch_client *client,
+	const char *client_id,
+	helix_ratelimit_headers *headers,
+	long http_code
+) {
+	if (client == NULL) {
+		return false;
+	}
+
+	helix_rate_bucket *bucket = helix_ratelimit_bucket(client, client_id);
+	double now = helix_ratelimit_now();
+
+	if (bucket->in_flight > 0) {
+		bucket->in_flight--;
+	}
+
+	if (headers->limit > 0) {
+		bucket->limit = headers->limit;
+	}
+
+	// Within the same window the server's count can only be lower than the
+	// local one, unless it doesn't know about requests still in flight yet.
+	// A new window resets the local count, minus points already spent on
+	// requests the server hasn't answered.
+	if (headers->remaining >= 0) {
+		helix_ratelimit_refill(bucket, now);
+
+		if (headers->reset > bucket->reset) {
+			bucket->tokens = headers->remaining - bucket->in_flight;
+		} else if (headers->remaining < bucket->tokens) {
+			bucket->tokens = headers->remaining;
+		}
+
+		if (bucket->tokens < 0) {
+			bucket->tokens = 0;
+		}
+		bucket->updated = now;
+	}
+
+	if (headers->reset > bucket->reset) {
+		bucket->reset = headers->reset;
+	}
+
+	if (http_code != 429) {
+		return false;
+	}
+
+	// Drain the bucket, so the following requests wait for the reset.
+	bucket->tokens = 0;
+	bucket->updated = now;
+	if (bucket->limit <= 0) {
+		bucket->limit = (long)RATE_LIMIT_WINDOW;
+	}
+	if (headers->retry_after > 0) {
+		bucket->retry_at = now + headers->retry_after;
+		if (bucket->reset < (long)bucket->retry_at) {
+			bucket->reset = (long)bucket->retry_at;
+		}
+	}
+	if (bucket->reset <= now) {
+		bucket->reset = (long)(now + RATE_LIMIT_DEFAULT_DELAY);
+	}
+
+	return client->rate_limiting;
+}
+
+double helix_ratelimit_available(twitch_client *client, const char *client_id) {
+	helix_rate_bucket *bucket = helix_ratelimit_bucket(client, client_id);
+	if (bucket->limit <= 0) {
+		return RATE_LIMIT_DEFAULT_POINTS - bucket->in_flight;
+	}
+
+	helix_ratelimit_refill(bucket, helix_ratelimit_now());
+	return bucket->tokens;
+}
+
+bool helix_ratelimit_budget(
+	twitch_client *client,
+	const char *client_id,
+	twitch_rate_limit *rate_limit
+) {
+	if (client == NULL) {
+		return false;
+	}
+
+	for (
+		helix_rate_bucket *bucket = client->buckets;
+		bucket != NULL;
+		bucket = bucket->next
+	) {
+		if (strcmp(bucket->client_id, client_id) != 0) {
+			continue;
+		}
+
+		if (bucket->limit <= 0) {
+			return false;
+		}
+
+		helix_ratelimit_refill(bucket, helix_ratelimit_now());
+
+		rate_limit->limit = bucket->limit;
+		rate_limit->remaining = (long)bucket->tokens;
+		rate_limit->reset = bucket->reset;
+		return true;
+	}
+
+	return false;
+}
+
+void helix_rate_buckets_free(helix_rate_bucket *bucket) {
+	while (bucket != NULL) {
+		helix_rate_bucket *next = bucket->next;
+		FREE(bucket->client_id)
+		free(bucket);
+		bucket = next;
+	}
+}
@@ -0,0 +1,153 @@
+/**
+ * Rate limit scheduler.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * Helix API limits the number of requests per client ID with a token bucket.
+ * Every response carries the state of the bucket in Ratelimit-Limit,
+ * Ratelimit-Remaining and Ratelimit-Reset headers. The scheduler keeps a local
+ * copy of each client ID's bucket inside the client, refills it at the rate
+ * the server does, and delays requests when it's empty instead of letting them
+ * fail with 429 Too Many Requests.
+ */
+
+#ifndef _H_NETWORK_RATELIMIT_UTILS
+#define _H_NETWORK_RATELIMIT_UTILS
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <curl/curl.h>
+
+#include <ctwitch/client.h>
+
+/**
+ * Number of times a request is retried after 429 response.
+ */
+#define MAX_RATE_LIMIT_RETRIES 3
+
+/**
+ * Rate limit headers of one response.
+ */
+typedef struct {
+	long limit;      // Ratelimit-Limit value, or -1 if not present.
+	long remaining;  // Ratelimit-Remaining value, or -1 if not present.
+	long reset;      // Ratelimit-Reset value, or -1 if not present.
+	long retry_after;  // Retry-After value in seconds, or -1 if not present.
+} helix_ratelimit_headers;
+
+/**
+ * Local copy of a client ID's bucket.
+ */
+typedef struct helix_rate_bucket {
+	char *client_id;
+	long limit;       // Bucket size.
+	double tokens;    // Estimated number of points left.
+	long reset;       // Unix time when the bucket is full again, or 0.
+	double updated;   // Time of the last refill.
+	double retry_at;  // Time to hold requests until after 429, or 0.
+	int in_flight;    // Requests sent but not answered yet.
+	struct helix_rate_bucket *next;
+} helix_rate_bucket;
+
+/**
+ * Installs a header callback on given handle, which collects rate limit
+ * headers of the response.
+ *
+ * @param curl Handle to configure.
+ * @param headers Headers struct to fill. Must outlive the transfer.
+ */
+void helix_ratelimit_setup(CURL *curl, helix_ratelimit_headers *headers);
+
+/**
+ * Resets all header values to -1 before a new response.
+ *
+ * @param headers Headers struct to reset.
+ */
+void helix_ratelimit_reset_headers(helix_ratelimit_headers *headers);
+
+/**
+ * Collects given header line if it's one of rate limit headers, or
+ * Retry-After.
+ *
+ * @param headers Headers struct to fill.
+ * @param line Header line, not null-terminated.
+ * @param length Length of the line.
+ */
+void helix_ratelimit_read_header(
+	helix_ratelimit_headers *headers,
+	const char *line,
+	size_t length
+);
+
+/**
+ * Tries to take one point from the bucket of given client ID.
+ *
+ * @param client Client context. Can be NULL.
+ * @param client_id Twitch API client ID.
+ *
+ * @return 0 if the request can be made right away, in which case the point is
+ * taken. Otherwise number of seconds until a point becomes available.
+ */
+double helix_ratelimit_acquire(twitch_client *client, const char *client_id);
+
+/**
+ * Blocks until a point is available in the bucket of given client ID, and
+ * takes it.
+ *
+ * @param client Client context. Can be NULL.
+ * @param client_id Twitch API client ID.
+ */
+void helix_ratelimit_wait(twitch_client *client, const char *client_id);
+
+/**
+ * Updates the bucket of given client ID with response data.
+ *
+ * @param client Client context. Can be NULL.
+ * @param client_id Twitch API client ID.
+ * @param headers Rate limit headers of the response.
+ * @param http_code HTTP status code of the response.
+ *
+ * @return true if the response was 429 and the request should be retried.
+ */
+bool helix_ratelimit_update(
+	twitch_client *client,
+	const char *client_id,
+	helix_ratelimit_headers *headers,
+	long http_code
+);
+
+/**
+ * Estimates the number of points left in the bucket of given client ID.
+ *
+ * @param client Client context.
+ * @param client_id Twitch API client ID.
+ *
+ * @return Number of points. For buckets not known yet, default bucket size
+ * minus requests in flight.
+ */
+double helix_ratelimit_available(twitch_client *client, const char *client_id);
+
+/**
+ * Returns the current state of the bucket of given client ID.
+ *
+ * @param client Client context. Can be NULL.
+ * @param client_id Twitch API client ID.
+ * @param rate_limit Returns the state of the bucket.
+ *
+ * @return true if the bucket is known.
+ */
+bool helix_ratelimit_budget(
+	twitch_client *client,
+	const char *client_id,
+	twitch_rate_limit *rate_limit
+);
+
+/**
+ * Frees the list of buckets.
+ *
+ * @param bucket Head of the list.
+ */
+void helix_rate_buckets_free(helix_rate_bucket *bucket);
+
+#endif
@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <curl/curl.h>
+
+#include "utils/datagen.h"
+#include "utils/network/client.h"
+#include "utils/network/retry.h"
+
+/**
+ * Default retry policy.
+ */
+#define DEFAULT_MAX_ATTEMPTS 3
+#define DEFAULT_BASE_DELAY 100
+#define DEFAULT_MAX_DELAY 5000
+#define DEFAULT_JITTER 1.0
+
+/**
+ * Hedging delay used until enough response times are recorded, in seconds.
+ */
+#define DEFAULT_HEDGE_DELAY 0.5
+
+/**
+ * Number of response times needed to estimate the hedging delay.
+ */
+#define MIN_LATENCY_SAMPLES 16
+
+static const long DEFAULT_RETRY_STATUSES[] = { 500, 502, 503, 504 };
+
+/** State **/
+
+helix_retry_state *helix_retry_state_alloc() {
+	helix_retry_state *state = calloc(1, sizeof(helix_retry_state));
+	if (state == NULL) {
+		fprintf(stderr, "Failed to allocate memory for helix_retry_state");
+		exit(EXIT_FAILURE);
+	}
+
+	state->seed = (unsigned int)time(NULL) ^ (unsigned int)(size_t)state;
+	helix_retry_set_policy(state, NULL);
+
+	return state;
+}
+
+void helix_retry_state_free(helix_retry_state *state) {
+	if (state == NULL) {
+		return;
+	}
+
+	free((long *)state->policy.statuses);
+	free(state);
+}
+
+void helix_retry_set_policy(
+	helix_retry_state *state,
+	const twitch_retry_policy *policy
+) {
+	twitch_retry_policy defaults = {
+		.max_attempts = DEFAULT_MAX_ATTEMPTS,
+		.base_delay = DEFAULT_BASE_DELAY,
+		.max_delay = DEFAULT_MAX_DELAY,
+		.jitter = DEFAULT_JITTER,
+		.statuses_count =
+			sizeof(DEFAULT_RETRY_STATUSES) / sizeof(DEFAULT_RETRY_STATUSES[0]),
+		.statuses = DEFAULT_RETRY_STATUSES
+	};
+
+	if (policy == NULL) {
+		policy = &defaults;
+	}
+
+	long *statuses = NULL;
+	if (policy->statuses_count > 0) {
+		statuses = malloc(sizeof(long) * policy->statuses_count);
+		if (statuses == NULL) {
+			fprintf(stderr, "Failed to allocate memory for retry statuses.\n");
+			exit(EXIT_FAILURE);
+		}
+		memcpy(statuses, policy->statuses, sizeof(long) * policy->statuses_count);
+	}
+
+	free((long *)state->policy.statuses);
+	state->policy = *policy;
+	state->policy.statuses = statuses;
+
+	if (state->policy.max_attempts < 1) {
+		state->policy.max_attempts = 1;
+	}
+	if (state->policy.jitter < 0) {
+		state->policy.jitter = 0;
+	} else if (state->policy.jitter > 1) {
+		state->policy.jitter = 1;
+	}
+}
+
+/** Retries **/
+
+/**
+ * Tells whether the transfer failed for a reason that may go away by itself.
+ */
+bool helix_retry_transient_code(CURLcode code) {
+	switch (code) {
+		case CURLE_COULDNT_CONNECT:
+		case CURLE_OPERATION_TIMEDOUT:
+		case CURLE_SEND_ERROR:
+		case CURLE_RECV_ERROR:
+		case CURLE_GOT_NOTHING:
+		case CURLE_PARTIAL_FILE:
+		case CURLE_SSL_CONNECT_ERROR:
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool helix_retry_should(
+	twitch_client *client,
+	int attempt,
+	CURLcode code,
+	long http_code
+) {
+	if (client == NULL || code == CURLE_OK) {
+		return false;
+	}
+
+	twitch_retry_policy *policy = &client->retry->policy;
+	if (attempt >= policy->max_attempts) {
+		return false;
+	}
+
+	if (code != CURLE_HTTP_RETURNED_ERROR) {
+		return helix_retry_transient_code(code);
+	}
+
+	for (int idx = 0; idx < policy->statuses_count; idx++) {
+		if (policy->statuses[idx] == http_code) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+double helix_retry_delay(twitch_client *client, int attempt) {
+	helix_retry_state *state = client->retry;
+	twitch_retry_policy *policy = &state->policy;
+
+	double delay = policy->base_delay / 1000.0;
+	for (int idx = 1; idx < attempt && delay < policy->max_delay / 1000.0; idx++) {
+		delay *= 2;
+	}
+	if (delay > policy->max_delay / 1000.0) {
+		delay = policy->max_delay / 1000.0;
+	}
+
+	double random = (double)rand_r(&state->seed) / RAND_MAX;
+	return delay * (1 - policy->jitter * random);
+}
+
+void helix_retry_sleep(double seconds) {
+	if (seconds <= 0) {
+		return;
+	}
+
+	struct timespec ts;
+	ts.tv_sec = (time_t)seconds;
+	ts.tv_nsec = (long)((seconds - ts.tv_sec) * 1e9);
+	nanosleep(&ts, NULL);
+}
+
+/** Hedging **/
+
+void helix_retry_record_latency(twitch_client *client, double seconds) {
+	if (client == NULL) {
+		return;
+	}
+
+	helix_retry_state *state = client->retry;
+	state->latencies[state->latencies_next] = seconds;
+	state->latencies_next = (state->latencies_next + 1) % LATENCY_WINDOW;
+	if (state->latencies_count < LATENCY_WINDOW) {
+		state->latencies_count++;
+	}
+}
+
+int helix_retry_compare_latency(const void *a, const void *b) {
+	double da = *(const double *)a, db = *(const double *)b;
+	return (da > db) - (da < db);
+}
+
+double helix_retry_hedge_delay(twitch_client *client) {
+	helix_retry_state *state = client->retry;
+
+	if (state->hedge_delay > 0) {
+		return state->hedge_delay / 1000.0;
+	}
+
+	if (state->latencies_count < MIN_LATENCY_SAMPLES) {
+		return DEFAULT_HEDGE_DELAY;
+	}
+
+	double sorted[LATENCY_WINDOW];
+	memcpy(sorted, state->latencies, sizeof(double) * state->latencies_count);
+	qsort(
+		sorted,
+		state->latencies_count,
+		sizeof(double),
+		helix_retry_compare_latency
+	);
+
+	return sorted[(state->latencies_count * 95) / 100];
+}
@@ -0,0 +1,119 @@
+/**
+ * Retries and hedged requests.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * Transient failures, like dropped connections, timeouts and 5xx responses,
+ * are retried according to client's retry policy, with exponentially growing
+ * and randomly shortened delays between attempts.
+ *
+ * The client also keeps a window of recent response times, which tells how
+ * long to wait before hedging a slow request with a duplicate.
+ */
+
+#ifndef _H_NETWORK_RETRY_UTILS
+#define _H_NETWORK_RETRY_UTILS
+
+#include <stdbool.h>
+#include <curl/curl.h>
+
+#include <ctwitch/client.h>
+
+/**
+ * Number of recent response times kept for hedging delay estimation.
+ */
+#define LATENCY_WINDOW 64
+
+/**
+ * Client's retry and hedging state.
+ */
+typedef struct {
+	twitch_retry_policy policy;     // Policy with statuses owned by the client.
+	unsigned int seed;              // Jitter random generator state.
+	bool hedging;                   // Whether to hedge requests.
+	long hedge_delay;               // Fixed hedging delay in ms, or 0.
+	double latencies[LATENCY_WINDOW];  // Recent response times, in seconds.
+	int latencies_count;            // Number of recorded response times.
+	int latencies_next;             // Next slot to overwrite.
+} helix_retry_state;
+
+/**
+ * Allocates retry state with the default policy.
+ *
+ * @return New retry state. Free it with helix_retry_state_free().
+ */
+helix_retry_state *helix_retry_state_alloc();
+
+/**
+ * Frees retry state.
+ *
+ * @param state State to deallocate.
+ */
+void helix_retry_state_free(helix_retry_state *state);
+
+/**
+ * Replaces the retry policy, copying the list of statuses.
+ *
+ * @param state State to update.
+ * @param policy New policy, or NULL to restore the default one.
+ */
+void helix_retry_set_policy(
+	helix_retry_state *state,
+	const twitch_retry_policy *policy
+);
+
+/**
+ * Tells whether a failed request should be attempted again.
+ *
+ * @param client Client context. Can be NULL, in which case requests are never
+ * retried.
+ * @param attempt Number of attempts made so far.
+ * @param code Transfer result code.
+ * @param http_code HTTP status code of the response.
+ *
+ * @return true if the failure is transient and the policy allows one more
+ * attempt.
+ */
+bool helix_retry_should(
+	twitch_client *client,
+	int attempt,
+	CURLcode code,
+	long http_code
+);
+
+/**
+ * Returns the delay before the next attempt.
+ *
+ * @param client Client context.
+ * @param attempt Number of attempts made so far.
+ *
+ * @return Delay in seconds.
+ */
+double helix_retry_delay(twitch_client *client, int attempt);
+
+/**
+ * Blocks the calling thread for given time.
+ *
+ * @param seconds Time to sleep.
+ */
+void helix_retry_sleep(double seconds);
+
+/**
+ * Records response time of a successful request.
+ *
+ * @param client Client context. Can be NULL.
+ * @param seconds Duration of the request.
+ */
+void helix_retry_record_latency(twitch_client *client, double seconds);
+
+/**
+ * Returns the delay before a slow request is hedged.
+ *
+ * @param client Client context.
+ *
+ * @return Delay in seconds.
+ */
+double helix_retry_hedge_delay(twitch_client *client);
+
+#endif
@@ -0,0 +1,508 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <curl/curl.h>
+
+#include "utils/datagen.h"
+#include "utils/strings/strings.h"
+#include "utils/network/client.h"
+#include "utils/network/stats.h"
+#include "utils/network/trace.h"
+
+#include <ctwitch/stats.h>
+
+/**
+ * Number of linear buckets per power of two, as a power of two.
+ */
+#define SUB_BUCKET_BITS 5
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+
+/**
+ * Largest tracked value.
+ */
+#define MAX_TRACKED_VALUE 0xFFFFFFFFULL
+
+static const char *METRIC_NAMES[TWITCH_METRIC_COUNT] = {
+	"dns",
+	"connect",
+	"tls",
+	"ttfb",
+	"total",
+	"parse",
+	"materialize",
+	"bytes"
+};
+
+/**
+ * Names of trace spans recorded along with timed metrics, or NULL.
+ * Transfers are traced separately, with timings from cURL.
+ */
+static const char *METRIC_SPANS[TWITCH_METRIC_COUNT] = {
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	TRACE_JSON_PARSE,
+	TRACE_MATERIALIZE,
+	NULL
+};
+
+/** Histograms **/
+
+/**
+ * Returns the bucket of given value. Values below SUB_BUCKETS get a bucket of
+ * their own, larger ones share a bucket with values that have the same top
+ * SUB_BUCKET_BITS + 1 bits.
+ */
+int helix_histogram_index(unsigned long long value) {
+	if (value > MAX_TRACKED_VALUE) {
+		value = MAX_TRACKED_VALUE;
+	}
+
+	if (value < SUB_BUCKETS) {
+		return (int)value;
+	}
+
+	int magnitude = SUB_BUCKET_BITS;
+	while ((value >> (magnitude + 1)) != 0) {
+		magnitude++;
+	}
+
+	int shift = magnitude - SUB_BUCKET_BITS;
+	int sub_bucket = (int)((value >> shift) & (SUB_BUCKETS - 1));
+
+	return (shift + 1) * SUB_BUCKETS + sub_bucket;
+}
+
+/**
+ * Returns the largest value that falls into given bucket.
+ */
+unsigned long long helix_histogram_bucket_top(int index) {
+	if (index < SUB_BUCKETS) {
+		return index;
+	}
+
+	int shift = index / SUB_BUCKETS - 1;
+	unsigned long long low =
+		(unsigned long long)(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+
+	return low + (1ULL << shift) - 1;
+}
+
+void helix_histogram_add(
+	twitch_histogram *histogram,
+	unsigned long long value
+) {
+	if (histogram->count == 0 || value < histogram->min) {
+		histogram->min = value;
+	}
+	if (value > histogram->max) {
+		histogram->max = value;
+	}
+
+	histogram->count++;
+	histogram->sum += value;
+	histogram->buckets[helix_histogram_index(value)]++;
+}
+
+unsigned long long twitch_histogram_percentile(
+	const twitch_histogram *histogram,
+	double percentile
+) {
+	if (histogram->count == 0) {
+		return 0;
+	}
+
+	if (percentile <= 0) {
+		return histogram->min;
+	}
+	if (percentile >= 100) {
+		return histogram->max;
+	}
+
+	// Rank of the sample at the percentile, counting from 1.
+	unsigned long rank = (unsigned long)(percentile / 100 * histogram->count);
+	if ((double)rank < percentile / 100 * histogram->count) {
+		rank++;
+	}
+	if (rank == 0) {
+		rank = 1;
+	}
+
+	unsigned long seen = 0;
+	for (int idx = 0; idx < TWITCH_HISTOGRAM_BUCKETS; idx++) {
+		seen += histogram->buckets[idx];
+		if (seen < rank) {
+			continue;
+		}
+
+		// Bucket bounds are coarser than the exact extremes.
+		unsigned long long value = helix_histogram_bucket_top(idx);
+		if (value > histogram->max) {
+			value = histogram->max;
+		}
+		if (value < histogram->min) {
+			value = histogram->min;
+		}
+		return value;
+	}
+
+	return histogram->max;
+}
+
+unsigned long helix_histogram_count_below(
+	const twitch_histogram *histogram,
+	unsigned long long value
+) {
+	if (histogram->count == 0 || value < histogram->min) {
+		return 0;
+	}
+	if (value >= histogram->max) {
+		return histogram->count;
+	}
+
+	// Buckets are counted if they end at or below the value.
+	unsigned long count = 0;
+	for (int idx = 0; idx < TWITCH_HISTOGRAM_BUCKETS; idx++) {
+		if (helix_histogram_bucket_top(idx) > value) {
+			break;
+		}
+		count += histogram->buckets[idx];
+	}
+
+	return count;
+}
+
+double twitch_histogram_mean(const twitch_histogram *histogram) {
+	if (histogram->count == 0) {
+		return 0;
+	}
+
+	return (double)histogram->sum / histogram->count;
+}
+
+const char *twitch_metric_name(twitch_metric metric) {
+	if (metric < 0 || metric >= TWITCH_METRIC_COUNT) {
+		return "unknown";
+	}
+
+	return METRIC_NAMES[metric];
+}
+
+/** Table **/
+
+twitch_stats *helix_stats_alloc() {
+	GENERIC_ALLOC(twitch_stats)
+}
+
+void twitch_stats_free(twitch_stats *stats) {
+	if (stats == NULL) {
+		return;
+	}
+
+	for (int idx = 0; idx < stats->count; idx++) {
+		free(stats->items[idx]->endpoint);
+		FREE(stats->items[idx]->statuses)
+		free(stats->items[idx]);
+	}
+
+	FREE(stats->items)
+	free(stats);
+}
+
+int helix_stats_compare(const void *a, const void *b) {
+	const twitch_endpoint_stats *left = *(const twitch_endpoint_stats **)a;
+	const twitch_endpoint_stats *right = *(const twitch_endpoint_stats **)b;
+
+	return strcmp(left->endpoint, right->endpoint);
+}
+
+twitch_stats *helix_stats_copy(const twitch_stats *stats) {
+	twitch_stats *copy = helix_stats_alloc();
+	if (stats == NULL || stats->count == 0) {
+		return copy;
+	}
+
+	copy->items = malloc(sizeof(twitch_endpoint_stats *) * stats->count);
+	if (copy->items == NULL) {
+		fprintf(stderr, "Failed to allocate memory for stats.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (int idx = 0; idx < stats->count; idx++) {
+		twitch_endpoint_stats *item = malloc(sizeof(twitch_endpoint_stats));
+		if (item == NULL) {
+			fprintf(stderr, "Failed to allocate memory for endpoint stats.\n");
+			exit(EXIT_FAILURE);
+		}
+
+		twitch_endpoint_stats *source = stats->items[idx];
+		memcpy(item, source, sizeof(twitch_endpoint_stats));
+		item->endpoint = immutable_string_copy(source->endpoint);
+
+		if (source->statuses_count > 0) {
+			size_t size = sizeof(twitch_status_count) * source->statuses_count;
+			item->statuses = malloc(size);
+			if (item->statuses == NULL) {
+				fprintf(stderr, "Failed to allocate memory for status counts.\n");
+				exit(EXIT_FAILURE);
+			}
+			memcpy(item->statuses, source->statuses, size);
+		}
+
+		copy->items[idx] = item;
+	}
+	copy->count = stats->count;
+
+	qsort(
+		copy->items,
+		copy->count,
+		sizeof(twitch_endpoint_stats *),
+		helix_stats_compare
+	);
+
+	return copy;
+}
+
+const char *helix_stats_path(const char *url, size_t *length) {
+	const char *path = url;
+
+	const char *scheme = strstr(url, "://");
+	if (scheme != NULL) {
+		path = strchr(scheme + 3, '/');
+		if (path == NULL) {
+			path = "/";
+		}
+	}
+
+	const char *query = strchr(path, '?');
+	*length = (query != NULL) ? (size_t)(query - path) : strlen(path);
+
+	return path;
+}
+
+/**
+ * Finds statistics of the endpoint of given URL, adding them if needed.
+ *
+ * @param client Client context.
+ * @param url Request URL or path.
+ *
+ * @return Endpoint statistics.
+ */
+twitch_endpoint_stats *helix_stats_endpoint(
+	twitch_client *client,
+	const char *url
+) {
+	if (client->stats == NULL) {
+		client->stats = helix_stats_alloc();
+	}
+	twitch_stats *stats = client->stats;
+
+	size_t length = 0;
+	const char *path = helix_stats_path(url, &length);
+
+	for (int idx = 0; idx < stats->count; idx++) {
+		const char *endpoint = stats->items[idx]->endpoint;
+		if (strncmp(endpoint, path, length) == 0 && endpoint[length] == '\0') {
+			return stats->items[idx];
+		}
+	}
+
+	stats->items = realloc(
+		stats->items,
+		sizeof(twitch_endpoint_stats *) * (stats->count + 1)
+	);
+	twitch_endpoint_stats *item = calloc(1, sizeof(twitch_endpoint_stats));
+	char *endpoint = malloc(length + 1);
+	if (stats->items == NULL || item == NULL || endpoint == NULL) {
+		fprintf(stderr, "Failed to allocate memory for endpoint stats.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	memcpy(endpoint, path, length);
+	endpoint[length] = '\0';
+	item->endpoint = endpoint;
+	stats->items[stats->count++] = item;
+
+	return item;
+}
+
+/** Recording **/
+
+double helix_stats_clock() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void helix_stats_record(
+	twitch_client *client,
+	const char *url,
+	twitch_metric metric,
+	unsigned long long value
+) {
+	if (client == NULL || url == NULL) {
+		return;
+	}
+
+	twitch_endpoint_stats *endpoint = helix_stats_endpoint(client, url);
+	helix_histogram_add(&endpoint->metrics[metric], value);
+}
+
+void helix_stats_record_time(
+	twitch_client *client,
+	const char *url,
+	twitch_metric metric,
+	double start
+) {
+	if (client == NULL) {
+		return;
+	}
+
+	double end = helix_stats_clock();
+	double elapsed = end - start;
+	helix_stats_record(
+		client,
+		url,
+		metric,
+		(elapsed > 0) ? (unsigned long long)(elapsed * 1e6) : 0
+	);
+
+	if (METRIC_SPANS[metric] != NULL) {
+		helix_trace_span_record(client, METRIC_SPANS[metric], url, start, end);
+	}
+}
+
+/**
+ * Counts a response with given status code, keeping the list sorted.
+ */
+void helix_stats_count_status(twitch_endpoint_stats *endpoint, long code) {
+	int idx = 0;
+	while (idx < endpoint->statuses_count && endpoint->statuses[idx].code < code) {
+		idx++;
+	}
+
+	if (idx < endpoint->statuses_count && endpoint->statuses[idx].code == code) {
+		endpoint->statuses[idx].count++;
+		return;
+	}
+
+	endpoint->statuses = realloc(
+		endpoint->statuses,
+		sizeof(twitch_status_count) * (endpoint->statuses_count + 1)
+	);
+	if (endpoint->statuses == NULL) {
+		fprintf(stderr, "Failed to allocate memory for status counts.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	memmove(
+		&endpoint->statuses[idx + 1],
+		&endpoint->statuses[idx],
+		sizeof(twitch_status_count) * (endpoint->statuses_count - idx)
+	);
+	endpoint->statuses[idx].code = code;
+	endpoint->statuses[idx].count = 1;
+	endpoint->statuses_count++;
+}
+
+void helix_stats_record_retry(twitch_client *client, const char *url) {
+	if (client == NULL || url == NULL) {
+		return;
+	}
+
+	helix_stats_endpoint(client, url)->retries++;
+}
+
+/**
+ * Records a transfer span that ended now.
+ */
+void helix_stats_trace_transfer(
+	twitch_client *client,
+	const char *url,
+	double duration
+) {
+	if (client->tracer == NULL) {
+		return;
+	}
+
+	double end = helix_stats_clock();
+	helix_trace_span_record(client, TRACE_TRANSFER, url, end - duration, end);
+}
+
+void helix_stats_record_attempt(
+	twitch_client *client,
+	const char *url,
+	CURL *curl,
+	CURLcode code,
+	long http_code,
+	double latency,
+	size_t bytes
+) {
+	if (client == NULL || url == NULL) {
+		return;
+	}
+
+	twitch_endpoint_stats *endpoint = helix_stats_endpoint(client, url);
+	twitch_histogram *metrics = endpoint->metrics;
+
+	endpoint->requests++;
+	if (code != CURLE_OK) {
+		endpoint->errors++;
+	}
+
+	if (curl != NULL) {
+		curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+	}
+	helix_stats_count_status(endpoint, http_code);
+
+	if (curl == NULL) {
+		helix_stats_trace_transfer(client, url, latency);
+		helix_histogram_add(
+			&metrics[TWITCH_METRIC_TOTAL],
+			(unsigned long long)(latency * 1e6)
+		);
+		helix_histogram_add(&metrics[TWITCH_METRIC_BYTES], bytes);
+		return;
+	}
+
+	// All cURL times are counted from the start of the transfer, in
+	// microseconds.
+	curl_off_t name_lookup = 0, connect = 0, app_connect = 0;
+	curl_off_t start_transfer = 0, total = 0, downloaded = 0;
+	long connects = 0;
+
+	curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &name_lookup);
+	curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+	curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &app_connect);
+	curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &start_transfer);
+	curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+	curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+	curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+
+	helix_stats_trace_transfer(client, url, total / 1e6);
+
+	// Reused connections skip the handshake phases, so they are only sampled
+	// when a new connection was made.
+	if (connects > 0) {
+		helix_histogram_add(&metrics[TWITCH_METRIC_DNS], name_lookup);
+		helix_histogram_add(
+			&metrics[TWITCH_METRIC_CONNECT],
+			(connect > name_lookup) ? connect - name_lookup : 0
+		);
+		if (app_connect > 0) {
+			helix_histogram_add(
+				&metrics[TWITCH_METRIC_TLS],
+				(app_connect > connect) ? app_connect - connect : 0
+			);
+		}
+	}
+
+	if (code == CURLE_OK || start_transfer > 0) {
+		helix_histogram_add(&metrics[TWITCH_METRIC_TTFB], start_transfer);
+	}
+	helix_histogram_add(&metrics[TWITCH_METRIC_TOTAL], total);
+	helix_histogram_add(&metrics[TWITCH_METRIC_BYTES], downloaded);
+}
@@ -0,0 +1,141 @@
+/**
+ * Request statistics recording.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * Measurements are filed under the path of the request URL, without query,
+ * so all pages and all filters of one endpoint share histograms. Requests
+ * made without a client are not recorded.
+ */
+
+#ifndef _H_NETWORK_STATS_UTILS
+#define _H_NETWORK_STATS_UTILS
+
+#include <stddef.h>
+#include <curl/curl.h>
+
+#include <ctwitch/client.h>
+#include <ctwitch/stats.h>
+
+/**
+ * Returns current monotonic time, to be passed to helix_stats_record_time()
+ * later.
+ *
+ * @return Time in seconds.
+ */
+double helix_stats_clock();
+
+/**
+ * Adds a sample to a histogram.
+ *
+ * @param histogram Histogram to update.
+ * @param value Sample value.
+ */
+void helix_histogram_add(
+	twitch_histogram *histogram,
+	unsigned long long value
+);
+
+/**
+ * Adds a sample to given metric of the endpoint.
+ *
+ * @param client Client context. Can be NULL.
+ * @param url Request URL or path.
+ * @param metric Metric to update.
+ * @param value Sample value.
+ */
+void helix_stats_record(
+	twitch_client *client,
+	const char *url,
+	twitch_metric metric,
+	unsigned long long value
+);
+
+/**
+ * Adds the time passed since `start` to given metric of the endpoint.
+ *
+ * @param client Client context. Can be NULL.
+ * @param url Request URL or path.
+ * @param metric Metric to update.
+ * @param start Start time, returned by helix_stats_clock().
+ */
+void helix_stats_record_time(
+	twitch_client *client,
+	const char *url,
+	twitch_metric metric,
+	double start
+);
+
+/**
+ * Records network timings of one request attempt.
+ *
+ * @param client Client context. Can be NULL.
+ * @param url Request URL or path.
+ * @param curl Handle of the finished transfer, to read detailed timings from,
+ * or NULL if the request was made by a custom transport.
+ * @param code Transfer result code.
+ * @param http_code HTTP status code, used without a handle.
+ * @param latency Duration of the attempt in seconds, used without a handle.
+ * @param bytes Response body size, used without a handle.
+ */
+void helix_stats_record_attempt(
+	twitch_client *client,
+	const char *url,
+	CURL *curl,
+	CURLcode code,
+	long http_code,
+	double latency,
+	size_t bytes
+);
+
+/**
+ * Counts a retry of a request.
+ *
+ * @param client Client context. Can be NULL.
+ * @param url Request URL or path.
+ */
+void helix_stats_record_retry(twitch_client *client, const char *url);
+
+/**
+ * Returns the number of samples in a histogram that are not larger than
+ * given value, up to histogram's precision.
+ *
+ * @param histogram Histogram to query.
+ * @param value Upper bound.
+ *
+ * @return Number of samples.
+ */
+unsigned long helix_histogram_count_below(
+	const twitch_histogram *histogram,
+	unsigned long long value
+);
+
+/**
+ * Finds the path part of given URL: everything after the host and before the
+ * query.
+ *
+ * @param url Full URL or path.
+ * @param length Returns path length.
+ *
+ * @return Start of the path.
+ */
+const char *helix_stats_path(const char *url, size_t *length);
+
+/**
+ * Allocates an empty statistics table.
+ *
+ * @return New table. Free it with twitch_stats_free().
+ */
+twitch_stats *helix_stats_alloc();
+
+/**
+ * Makes a deep copy of a statistics table, with endpoints sorted by path.
+ *
+ * @param stats Table to copy. Can be NULL.
+ *
+ * @return New table. Free it with twitch_stats_free().
+ */
+twitch_stats *helix_stats_copy(const twitch_stats *stats);
+
+#endif
@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "utils/datagen.h"
+#include "utils/strings/strings.h"
+#include "utils/network/client.h"
+#include "utils/network/stats.h"
+#include "utils/network/trace.h"
+
+#include <ctwitch/trace.h>
+
+/** Tracer **/
+
+helix_tracer *helix_tracer_alloc(size_t capacity) {
+	helix_tracer *tracer = calloc(1, sizeof(helix_tracer));
+	if (tracer == NULL) {
+		fprintf(stderr, "Failed to allocate memory for helix_tracer");
+		exit(EXIT_FAILURE);
+	}
+
+	tracer->spans = calloc(capacity, sizeof(helix_trace_span));
+	if (tracer->spans == NULL) {
+		fprintf(stderr, "Failed to allocate memory for trace buffer.\n");
+		exit(EXIT_FAILURE);
+	}
+	tracer->capacity = capacity;
+
+	return tracer;
+}
+
+void helix_tracer_free(helix_tracer *tracer) {
+	if (tracer == NULL) {
+		return;
+	}
+
+	free(tracer->spans);
+	free(tracer);
+}
+
+void twitch_client_set_tracing(twitch_client *client, size_t capacity) {
+	helix_tracer_free(client->tracer);
+	client->tracer = (capacity > 0) ? helix_tracer_alloc(capacity) : NULL;
+}
+
+/** Recording **/
+
+double helix_trace_clock(twitch_client *client) {
+	if (client == NULL || client->tracer == NULL) {
+		return 0;
+	}
+
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void helix_trace_span_record(
+	twitch_client *client,
+	const char *name,
+	const char *url,
+	double start,
+	double end
+) {
+	if (client == NULL || client->tracer == NULL) {
+		return;
+	}
+
+	helix_tracer *tracer = client->tracer;
+	helix_trace_span *span = &tracer->spans[tracer->count % tracer->capacity];
+	tracer->count++;
+
+	span->name = name;
+	span->start = start;
+	span->duration = (end > start) ? end - start : 0;
+
+	size_t length = 0;
+	const char *path = (url != NULL) ? helix_stats_path(url, &length) : "";
+	if (length >= TRACE_ENDPOINT_SIZE) {
+		length = TRACE_ENDPOINT_SIZE - 1;
+	}
+	memcpy(span->endpoint, path, length);
+	span->endpoint[length] = '\0';
+}
+
+void helix_trace_end(
+	twitch_client *client,
+	const char *name,
+	const char *url,
+	double start
+) {
+	if (client == NULL || client->tracer == NULL) {
+		return;
+	}
+
+	helix_trace_span_record(client, name, url, start, helix_trace_clock(client));
+}
+
+/** Export **/
+
+/**
+ * Appends a JSON string value, escaping characters that need it.
+ */
+void helix_trace_append_string(string_t *output, const char *value) {
+	string_append("\"", 1, output);
+	for (const char *ptr = value; *ptr != '\0'; ptr++) {
+		if (*ptr == '"' || *ptr == '\\') {
+			string_append("\\", 1, output);
+		} else if ((unsigned char)*ptr < 0x20) {
+			continue;
+		}
+		string_append(ptr, 1, output);
+	}
+	string_append("\"", 1, output);
+}
+
+int twitch_client_trace_write(twitch_client *client, int fd) {
+	string_t *output = string_init_with_value("{\"traceEvents\":[");
+	helix_tracer *tracer = client->tracer;
+
+	if (tracer != NULL) {
+		// Oldest span first. Once the ring has wrapped, it's the next one to be
+		// overwritten.
+		unsigned long long first = (tracer->count > tracer->capacity)
+			? tracer->count - tracer->capacity
+			: 0;
+
+		for (unsigned long long idx = first; idx < tracer->count; idx++) {
+			helix_trace_span *span = &tracer->spans[idx % tracer->capacity];
+
+			string_append_format(
+				output,
+				"%s{\"name\":\"%s\",\"cat\":\"ctwitch\",\"ph\":\"X\","
+				"\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1,"
+				"\"args\":{\"endpoint\":",
+				(idx > first) ? ",\n" : "\n",
+				span->name,
+				span->start * 1e6,
+				span->duration * 1e6
+			);
+			helix_trace_append_string(output, span->endpoint);
+			string_append("}}", 2, output);
+		}
+
+		string_append_format(
+			output,
+			"\n],\"otherData\":{\"dropped\":\"%llu\"}}\n",
+			first
+		);
+	} else {
+		string_append("]}\n", 3, output);
+	}
+
+	// Writes to sockets and pipes can be partial.
+	size_t written = 0;
+	while (written < output->len) {
+		ssize_t result = write(fd, output->ptr + written, output->len - written);
+		if (result < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			int saved_errno = errno;
+			string_free(output);
+			errno = saved_errno;
+			return -1;
+		}
+		written += result;
+	}
+
+	string_free(output);
+	return 0;
+}
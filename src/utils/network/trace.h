@@ -0,0 +1,112 @@
+/**
+ * Span recorder.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * Spans are written into a preallocated ring buffer. Recording one is two
+ * clock reads and a copy of a fixed-size struct. Span names are static
+ * strings, and the endpoint is copied into the span, truncated if needed, so
+ * nothing has to outlive the request.
+ */
+
+#ifndef _H_NETWORK_TRACE_UTILS
+#define _H_NETWORK_TRACE_UTILS
+
+#include <stddef.h>
+
+#include <ctwitch/client.h>
+
+/**
+ * Size of endpoint path stored in a span, including terminating zero.
+ */
+#define TRACE_ENDPOINT_SIZE 48
+
+/**
+ * Span names.
+ */
+#define TRACE_URL_BUILD "url_build"
+#define TRACE_TRANSFER "transfer"
+#define TRACE_JSON_PARSE "json_parse"
+#define TRACE_MATERIALIZE "parse_json_array"
+#define TRACE_PAGE_MERGE "page_merge"
+#define TRACE_CRAWL "get_all_helix_pages"
+
+/**
+ * Recorded span.
+ */
+typedef struct {
+	const char *name;                    // Static span name.
+	double start;                        // Start time, in seconds.
+	double duration;                     // Duration, in seconds.
+	char endpoint[TRACE_ENDPOINT_SIZE];  // URL path, possibly truncated.
+} helix_trace_span;
+
+/**
+ * Ring buffer of spans.
+ */
+typedef struct {
+	size_t capacity;           // Number of slots.
+	unsigned long long count;  // Number of spans ever recorded.
+	helix_trace_span *spans;   // Slots.
+} helix_tracer;
+
+/**
+ * Allocates a tracer.
+ *
+ * @param capacity Number of slots.
+ *
+ * @return New tracer. Free it with helix_tracer_free().
+ */
+helix_tracer *helix_tracer_alloc(size_t capacity);
+
+/**
+ * Frees a tracer.
+ *
+ * @param tracer Tracer to deallocate.
+ */
+void helix_tracer_free(helix_tracer *tracer);
+
+/**
+ * Returns current time for span start, or 0 if the client doesn't trace, so
+ * callers don't pay for the clock when tracing is off.
+ *
+ * @param client Client context. Can be NULL.
+ *
+ * @return Time in seconds.
+ */
+double helix_trace_clock(twitch_client *client);
+
+/**
+ * Records a span that ends now.
+ *
+ * @param client Client context. Can be NULL.
+ * @param name Static span name.
+ * @param url Request URL or path, or NULL.
+ * @param start Start time, returned by helix_trace_clock().
+ */
+void helix_trace_end(
+	twitch_client *client,
+	const char *name,
+	const char *url,
+	double start
+);
+
+/**
+ * Records a span with known bounds.
+ *
+ * @param client Client context. Can be NULL.
+ * @param name Static span name.
+ * @param url Request URL or path, or NULL.
+ * @param start Start time, in seconds.
+ * @param end End time, in seconds.
+ */
+void helix_trace_span_record(
+	twitch_client *client,
+	const char *name,
+	const char *url,
+	double start,
+	double end
+);
+
+#endif
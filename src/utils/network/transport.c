@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <curl/curl.h>
+
+#include "utils/strings/strings.h"
+#include "utils/network/client.h"
+#include "utils/network/ratelimit.h"
+#include "utils/network/transport.h"
+
+#include <ctwitch/transport.h>
+
+bool helix_transport_enabled(twitch_client *client) {
+	return client != NULL && client->transport != NULL;
+}
+
+CURLcode helix_transport_perform(
+	twitch_client *client,
+	const char *method,
+	const char *url,
+	struct curl_slist *headers,
+	string_t *output,
+	helix_ratelimit_headers *ratelimit,
+	long *http_code,
+	double *latency
+) {
+	// Flatten the header list.
+	int headers_count = 0;
+	for (struct curl_slist *item = headers; item != NULL; item = item->next) {
+		headers_count++;
+	}
+
+	const char **lines = malloc(sizeof(char *) * (headers_count + 1));
+	if (lines == NULL) {
+		fprintf(stderr, "Failed to allocate memory for request headers.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	int idx = 0;
+	for (struct curl_slist *item = headers; item != NULL; item = item->next) {
+		lines[idx++] = item->data;
+	}
+
+	twitch_transport_request request = {
+		.method = method,
+		.url = url,
+		.headers_count = headers_count,
+		.headers = lines
+	};
+	twitch_transport_response response;
+	memset(&response, 0, sizeof(response));
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	twitch_transport *transport = client->transport;
+	CURLcode code = (CURLcode)transport->perform(transport, &request, &response);
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	if (latency != NULL) {
+		*latency = (end.tv_sec - start.tv_sec) +
+			(end.tv_nsec - start.tv_nsec) / 1e9;
+	}
+
+	free(lines);
+
+	// Deliver the response the way cURL would.
+	string_clear(output);
+	if (response.body != NULL) {
+		string_append(response.body, response.body_length, output);
+	}
+
+	if (ratelimit != NULL) {
+		helix_ratelimit_reset_headers(ratelimit);
+	}
+
+	if (ratelimit != NULL && response.headers != NULL) {
+		const char *line = response.headers;
+		const char *end_of_headers = response.headers + response.headers_length;
+		while (line < end_of_headers) {
+			const char *next = memchr(line, '\n', end_of_headers - line);
+			next = (next != NULL) ? next + 1 : end_of_headers;
+			helix_ratelimit_read_header(ratelimit, line, next - line);
+			line = next;
+		}
+	}
+
+	*http_code = (code == CURLE_OK) ? response.status : 0;
+	if (code == CURLE_OK && response.status >= 400) {
+		code = CURLE_HTTP_RETURNED_ERROR;
+	}
+
+	if (code == CURLE_OK || code == CURLE_HTTP_RETURNED_ERROR) {
+		twitch_client_count_transfer(client, output->len, output->len);
+	}
+
+	free(response.headers);
+	free(response.body);
+
+	return code;
+}
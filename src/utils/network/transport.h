@@ -0,0 +1,57 @@
+/**
+ * Requests through client's custom transport.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#ifndef _H_NETWORK_TRANSPORT_UTILS
+#define _H_NETWORK_TRANSPORT_UTILS
+
+#include <stdbool.h>
+#include <curl/curl.h>
+
+#include "utils/strings/strings.h"
+#include "utils/network/ratelimit.h"
+
+#include <ctwitch/client.h>
+#include <ctwitch/transport.h>
+
+/**
+ * Tells whether the client has a custom transport.
+ *
+ * @param client Client context. Can be NULL.
+ *
+ * @return true if requests should go through helix_transport_perform().
+ */
+bool helix_transport_enabled(twitch_client *client);
+
+/**
+ * Performs a request with client's custom transport, the same way it would be
+ * performed with cURL: HTTP error statuses turn into
+ * CURLE_HTTP_RETURNED_ERROR, rate limit headers are collected, and the
+ * transfer is added to client's counters.
+ *
+ * @param client Client context with a custom transport.
+ * @param method Request method.
+ * @param url Full request URL.
+ * @param headers Request headers.
+ * @param output Buffer for the response body. Cleared before the request.
+ * @param ratelimit Rate limit headers to fill. Can be NULL.
+ * @param http_code Returns HTTP status code of the response.
+ * @param latency Returns duration of the request, in seconds. Can be NULL.
+ *
+ * @return Request result code.
+ */
+CURLcode helix_transport_perform(
+	twitch_client *client,
+	const char *method,
+	const char *url,
+	struct curl_slist *headers,
+	string_t *output,
+	helix_ratelimit_headers *ratelimit,
+	long *http_code,
+	double *latency
+);
+
+#endif
@@ -0,0 +1,532 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <ctwitch/common.h>
+
+#include "utils/parser/page_decoder.h"
+#include "utils/json/json_sax.h"
+#include "utils/datagen.h"
+
+/**
+ * Max nesting of decoded containers: root object, "data" array, item object,
+ * list field of the item and objects in it.
+ */
+#define PAGE_DECODER_DEPTH 8
+
+/** Data **/
+
+typedef enum {
+	PAGE_FRAME_ROOT,        // Response object.
+	PAGE_FRAME_DATA,        // "data" array.
+	PAGE_FRAME_PAGINATION,  // "pagination" object.
+	PAGE_FRAME_ENTITY,      // Object of an item.
+	PAGE_FRAME_STRINGS,     // Array of strings of a field.
+	PAGE_FRAME_ENTITIES     // Array of objects of a field.
+} page_frame_type;
+
+typedef enum {
+	PAGE_KEY_OTHER,
+	PAGE_KEY_DATA,
+	PAGE_KEY_PAGINATION,
+	PAGE_KEY_TOTAL,
+	PAGE_KEY_CURSOR
+} page_key;
+
+/**
+ * Layout shared by all lists, and "data" items.
+ */
+typedef struct {
+	int count;
+	void **items;
+} page_list;
+
+/**
+ * Container being decoded.
+ */
+typedef struct {
+	page_frame_type type;
+	const entity_schema *schema;  // Schema of the entity or of list items.
+	void *target;                 // Entity or list being filled.
+	int capacity;                 // Capacity of list items.
+	int hint;                     // Field of the entity to look up first.
+} page_frame;
+
+struct page_decoder {
+	json_sax sax;
+	const entity_schema *schema;
+	page_frame frames[PAGE_DECODER_DEPTH];
+	int depth;                    // Number of open frames.
+	int skip;                     // Nesting inside an ignored value.
+	page_key key;                 // Last key of the root or pagination.
+	const field_spec *field;      // Field of the last key of an entity.
+	page_list items;
+	char *cursor;
+	bool has_total;
+	int total;
+};
+
+/** Helpers **/
+
+char *page_decoder_string(const json_sax_value *value) {
+	char *string = malloc(value->length + 1);
+	if (string == NULL) {
+		fprintf(stderr, "Failed to allocate memory for string");
+		exit(EXIT_FAILURE);
+	}
+
+	memcpy(string, value->string, value->length);
+	string[value->length] = '\0';
+	return string;
+}
+
+bool page_decoder_is(const json_sax_value *value, const char *name) {
+	size_t length = strlen(name);
+	return value->length == length && memcmp(value->string, name, length) == 0;
+}
+
+void page_decoder_push(
+	page_decoder *decoder,
+	page_frame_type type,
+	const entity_schema *schema,
+	void *target
+) {
+	// Deeper containers aren't described by any schema.
+	if (decoder->depth == PAGE_DECODER_DEPTH) {
+		decoder->skip = 1;
+		return;
+	}
+
+	page_frame *frame = &decoder->frames[decoder->depth++];
+	frame->type = type;
+	frame->schema = schema;
+	frame->target = target;
+	frame->capacity = 0;
+	frame->hint = 0;
+}
+
+void page_decoder_append(page_frame *frame, void *item) {
+	page_list *list = (page_list *)frame->target;
+
+	if (list->count == frame->capacity) {
+		frame->capacity = (frame->capacity > 0) ? frame->capacity * 2 : 16;
+		list->items = realloc(list->items, sizeof(void *) * frame->capacity);
+		if (list->items == NULL) {
+			fprintf(stderr, "Failed to allocate memory for page items");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	list->items[list->count++] = item;
+}
+
+/**
+ * Closes the innermost container, trimming its list to the exact size.
+ */
+void page_decoder_pop(page_decoder *decoder) {
+	page_frame *frame = &decoder->frames[--decoder->depth];
+	if (
+		frame->type != PAGE_FRAME_DATA &&
+		frame->type != PAGE_FRAME_STRINGS &&
+		frame->type != PAGE_FRAME_ENTITIES
+	) {
+		return;
+	}
+
+	page_list *list = (page_list *)frame->target;
+	if (list->count > 0 && list->count < frame->capacity) {
+		list->items = realloc(list->items, sizeof(void *) * list->count);
+		if (list->items == NULL) {
+			fprintf(stderr, "Failed to allocate memory for page items");
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+void page_decoder_drop_items(page_decoder *decoder) {
+	for (int idx = 0; idx < decoder->items.count; idx++) {
+		decoder->schema->free(decoder->items.items[idx]);
+	}
+
+	FREE(decoder->items.items)
+	decoder->items.items = NULL;
+	decoder->items.count = 0;
+}
+
+/**
+ * Finds a field of the entity by name. Properties of an object usually come
+ * in the same order as in the schema, so the search starts after the last
+ * found field.
+ */
+const field_spec *page_decoder_field(
+	page_frame *frame,
+	const json_sax_value *key
+) {
+	const entity_schema *schema = frame->schema;
+
+	for (int idx = 0; idx < schema->count; idx++) {
+		int field = (frame->hint + idx) % schema->count;
+		if (page_decoder_is(key, schema->fields[field].name)) {
+			frame->hint = field + 1;
+			return &schema->fields[field];
+		}
+	}
+
+	return NULL;
+}
+
+/** Containers **/
+
+void page_decoder_root(
+	page_decoder *decoder,
+	json_sax_event event,
+	const json_sax_value *value
+) {
+	switch (event) {
+		case JSON_SAX_KEY:
+			if (page_decoder_is(value, "data")) {
+				decoder->key = PAGE_KEY_DATA;
+			} else if (page_decoder_is(value, "pagination")) {
+				decoder->key = PAGE_KEY_PAGINATION;
+			} else if (page_decoder_is(value, "total")) {
+				decoder->key = PAGE_KEY_TOTAL;
+			} else {
+				decoder->key = PAGE_KEY_OTHER;
+			}
+			break;
+		case JSON_SAX_ARRAY_START:
+			if (decoder->key != PAGE_KEY_DATA) {
+				decoder->skip = 1;
+				break;
+			}
+
+			// Only the last "data" counts.
+			page_decoder_drop_items(decoder);
+			page_decoder_push(
+				decoder,
+				PAGE_FRAME_DATA,
+				decoder->schema,
+				&decoder->items
+			);
+			break;
+		case JSON_SAX_OBJECT_START:
+			if (decoder->key != PAGE_KEY_PAGINATION) {
+				decoder->skip = 1;
+				break;
+			}
+
+			page_decoder_push(decoder, PAGE_FRAME_PAGINATION, NULL, NULL);
+			break;
+		case JSON_SAX_INTEGER:
+		case JSON_SAX_DOUBLE:
+			if (decoder->key == PAGE_KEY_TOTAL) {
+				decoder->has_total = true;
+				decoder->total = (event == JSON_SAX_INTEGER)
+					? (int)value->integer
+					: (int)value->dbl;
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+void page_decoder_pagination(
+	page_decoder *decoder,
+	json_sax_event event,
+	const json_sax_value *value
+) {
+	switch (event) {
+		case JSON_SAX_KEY:
+			decoder->key = page_decoder_is(value, "cursor")
+				? PAGE_KEY_CURSOR
+				: PAGE_KEY_OTHER;
+			break;
+		case JSON_SAX_STRING:
+			if (decoder->key == PAGE_KEY_CURSOR) {
+				FREE(decoder->cursor)
+				decoder->cursor = page_decoder_string(value);
+			}
+			break;
+		case JSON_SAX_OBJECT_START:
+		case JSON_SAX_ARRAY_START:
+			decoder->skip = 1;
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * Stores a number, or a literal, in an integer field.
+ */
+void page_decoder_integer(
+	void *dest,
+	field_type type,
+	json_sax_event event,
+	const json_sax_value *value
+) {
+	json_int_t number = 0;
+
+	switch (event) {
+		case JSON_SAX_INTEGER:
+			number = value->integer;
+			break;
+		case JSON_SAX_DOUBLE:
+			number = (json_int_t)value->dbl;
+			break;
+		case JSON_SAX_BOOLEAN:
+			number = value->boolean;
+			break;
+		case JSON_SAX_NULL:
+			break;
+		default:
+			return;
+	}
+
+	if (type == FIELD_INT) {
+		*((int *)dest) = number;
+	} else {
+		*((long *)dest) = number;
+	}
+}
+
+void page_decoder_entity(
+	page_decoder *decoder,
+	page_frame *frame,
+	json_sax_event event,
+	const json_sax_value *value
+) {
+	if (event == JSON_SAX_KEY) {
+		decoder->field = page_decoder_field(frame, value);
+		return;
+	}
+
+	const field_spec *field = decoder->field;
+	bool is_array = (event == JSON_SAX_ARRAY_START);
+	if (field == NULL) {
+		if (is_array || event == JSON_SAX_OBJECT_START) {
+			decoder->skip = 1;
+		}
+		return;
+	}
+
+	void *dest = (char *)frame->target + field->offset;
+	switch (field->type) {
+		case FIELD_STRING:
+			if (event == JSON_SAX_STRING) {
+				FREE(*((char **)dest))
+				*((char **)dest) = page_decoder_string(value);
+			}
+			break;
+		case FIELD_INT:
+		case FIELD_LONG:
+			page_decoder_integer(dest, field->type, event, value);
+			break;
+		case FIELD_BOOL:
+			if (event == JSON_SAX_BOOLEAN) {
+				*((bool *)dest) = value->boolean;
+			}
+			break;
+		case FIELD_STRINGS:
+			if (is_array) {
+				twitch_string_list *list = (twitch_string_list *)dest;
+				for (int idx = 0; idx < list->count; idx++) {
+					free(list->items[idx]);
+				}
+				FREE(list->items)
+				list->items = NULL;
+				list->count = 0;
+
+				page_decoder_push(decoder, PAGE_FRAME_STRINGS, NULL, list);
+				return;
+			}
+			break;
+		case FIELD_STRING_LIST:
+			if (is_array) {
+				twitch_string_list **strings = (twitch_string_list **)dest;
+				FREE_CUSTOM(*strings, twitch_string_list_free)
+				twitch_string_list *list = twitch_string_list_alloc();
+				*strings = list;
+
+				page_decoder_push(decoder, PAGE_FRAME_STRINGS, NULL, list);
+				return;
+			}
+			break;
+		case FIELD_ENTITY_LIST:
+			if (is_array) {
+				FREE_CUSTOM(*((void **)dest), field->items->list_free)
+				void *list = field->items->list_alloc();
+				*((void **)dest) = list;
+
+				page_decoder_push(
+					decoder,
+					PAGE_FRAME_ENTITIES,
+					field->items,
+					list
+				);
+				return;
+			}
+			break;
+	}
+
+	if (is_array || event == JSON_SAX_OBJECT_START) {
+		decoder->skip = 1;
+	}
+}
+
+/**
+ * Handles a token. Every container either opens a frame, or is skipped
+ * whole.
+ */
+bool page_decoder_event(
+	json_sax_event event,
+	const json_sax_value *value,
+	void *user_data
+) {
+	page_decoder *decoder = (page_decoder *)user_data;
+	bool is_start =
+		(event == JSON_SAX_OBJECT_START || event == JSON_SAX_ARRAY_START);
+	bool is_end =
+		(event == JSON_SAX_OBJECT_END || event == JSON_SAX_ARRAY_END);
+
+	if (decoder->skip > 0) {
+		if (is_start) {
+			decoder->skip++;
+		} else if (is_end) {
+			decoder->skip--;
+		}
+		return true;
+	}
+
+	if (is_end) {
+		page_decoder_pop(decoder);
+		return true;
+	}
+
+	if (decoder->depth == 0) {
+		if (event == JSON_SAX_OBJECT_START) {
+			page_decoder_push(decoder, PAGE_FRAME_ROOT, NULL, NULL);
+		} else if (is_start) {
+			decoder->skip = 1;
+		}
+		return true;
+	}
+
+	page_frame *frame = &decoder->frames[decoder->depth - 1];
+	switch (frame->type) {
+		case PAGE_FRAME_ROOT:
+			page_decoder_root(decoder, event, value);
+			break;
+		case PAGE_FRAME_PAGINATION:
+			page_decoder_pagination(decoder, event, value);
+			break;
+		case PAGE_FRAME_ENTITY:
+			page_decoder_entity(decoder, frame, event, value);
+			break;
+		case PAGE_FRAME_STRINGS:
+			if (event == JSON_SAX_STRING) {
+				page_decoder_append(frame, page_decoder_string(value));
+			} else if (is_start) {
+				decoder->skip = 1;
+			}
+			break;
+		case PAGE_FRAME_DATA:
+		case PAGE_FRAME_ENTITIES:
+			if (event == JSON_SAX_OBJECT_START) {
+				void *entity = frame->schema->alloc();
+				page_decoder_append(frame, entity);
+				page_decoder_push(
+					decoder,
+					PAGE_FRAME_ENTITY,
+					frame->schema,
+					entity
+				);
+			} else if (is_start) {
+				decoder->skip = 1;
+			}
+			break;
+	}
+
+	return true;
+}
+
+/** API **/
+
+page_decoder *page_decoder_alloc(const entity_schema *schema) {
+	page_decoder *decoder = calloc(1, sizeof(page_decoder));
+	if (decoder == NULL) {
+		fprintf(stderr, "Failed to allocate memory for page_decoder");
+		exit(EXIT_FAILURE);
+	}
+
+	decoder->schema = schema;
+	json_sax_init(&decoder->sax, &page_decoder_event, decoder);
+
+	return decoder;
+}
+
+bool page_decoder_feed(
+	page_decoder *decoder,
+	const char *chunk,
+	size_t length
+) {
+	return json_sax_feed(&decoder->sax, chunk, length);
+}
+
+void **page_decoder_finish(
+	page_decoder *decoder,
+	int *size,
+	char **next,
+	int *total
+) {
+	*size = 0;
+
+	if (!json_sax_finish(&decoder->sax)) {
+		page_decoder_drop_items(decoder);
+		return NULL;
+	}
+
+	void **items = decoder->items.items;
+	*size = decoder->items.count;
+	decoder->items.items = NULL;
+	decoder->items.count = 0;
+
+	if (next != NULL && decoder->cursor != NULL) {
+		*next = decoder->cursor;
+		decoder->cursor = NULL;
+	}
+
+	if (total != NULL && decoder->has_total) {
+		*total = decoder->total;
+	}
+
+	return items;
+}
+
+void page_decoder_free(page_decoder *decoder) {
+	if (decoder == NULL) {
+		return;
+	}
+
+	page_decoder_drop_items(decoder);
+	FREE(decoder->cursor)
+	json_sax_clear(&decoder->sax);
+	free(decoder);
+}
+
+void **page_decode(
+	const entity_schema *schema,
+	const char *body,
+	size_t length,
+	int *size,
+	char **next,
+	int *total
+) {
+	page_decoder *decoder = page_decoder_alloc(schema);
+	page_decoder_feed(decoder, body, length);
+	void **items = page_decoder_finish(decoder, size, next, total);
+	page_decoder_free(decoder);
+	return items;
+}
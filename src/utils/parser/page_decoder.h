@@ -0,0 +1,97 @@
+/**
+ * Streaming decoder of Helix API pages.
+ *
+ * Fills entity structs straight from JSON tokens (see utils/json/json_sax.h)
+ * using entity schemas (see parser.h), and picks out "pagination.cursor" and
+ * "total" on the way, without building a JSON tree. Gives the same result as
+ * parsing the page with json_parse() and helix_parse_page().
+ *
+ * The page can be fed in chunks of any size as it's being downloaded.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#ifndef _H_PAGE_DECODER_PARSER
+#define _H_PAGE_DECODER_PARSER
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "utils/parser/parser.h"
+
+typedef struct page_decoder page_decoder;
+
+/**
+ * Creates a decoder for a page of entities.
+ *
+ * @param schema Schema of page items.
+ *
+ * @return New decoder. Free it with page_decoder_free().
+ */
+page_decoder *page_decoder_alloc(const entity_schema *schema);
+
+/**
+ * Decodes next chunk of the page.
+ *
+ * @param decoder Page decoder.
+ * @param chunk Next part of the response text.
+ * @param length Length of the chunk.
+ *
+ * @return false if the text isn't valid JSON. The rest of it is ignored.
+ */
+bool page_decoder_feed(
+	page_decoder *decoder,
+	const char *chunk,
+	size_t length
+);
+
+/**
+ * Finishes the page and hands over decoded items.
+ *
+ * @param decoder Page decoder.
+ * @param size Returns number of items.
+ * @param next (Optional) Returns cursor string to fetch the next page, if the
+ * page has one.
+ * @param total (Optional) Returns total number of items in the collection, if
+ * the page has one.
+ *
+ * @return Array of items, or NULL if there are none or the text isn't valid
+ * JSON, in which case next and total aren't touched.
+ */
+void **page_decoder_finish(
+	page_decoder *decoder,
+	int *size,
+	char **next,
+	int *total
+);
+
+/**
+ * Frees the decoder along with any items it hasn't handed over.
+ *
+ * @param decoder Decoder to deallocate. Can be NULL.
+ */
+void page_decoder_free(page_decoder *decoder);
+
+/**
+ * Decodes a whole page at once.
+ *
+ * @param schema Schema of page items.
+ * @param body Response text.
+ * @param length Length of the text.
+ * @param size Returns number of items.
+ * @param next (Optional) Returns cursor string to fetch the next page.
+ * @param total (Optional) Returns total number of items in the collection.
+ *
+ * @return Array of items, see page_decoder_finish().
+ */
+void **page_decode(
+	const entity_schema *schema,
+	const char *body,
+	size_t length,
+	int *size,
+	char **next,
+	int *total
+);
+
+#endif
@@ -2,12 +2,15 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
+#include <stddef.h>
 
 #include <ctwitch/common.h>
+#include <ctwitch/auth.h>
 #include <ctwitch/helix/data.h>
 
 #include "parser.h"
 #include "utils/strings/strings.h"
+#include "utils/datagen.h"
 
 /** JSON array parser **/
 
@@ -40,65 +43,225 @@ void **parse_json_array(
 
 /** Generic entity parsing **/
 
+/*
+ * Values of unexpected types are ignored the same way the streaming page
+ * decoder ignores them (see page_decoder.h), and repeated properties replace
+ * earlier ones.
+ */
+
 void parse_string(void *dest, json_value *source) {
 	if (source->type == json_string) {
+		FREE(*((char **)dest))
 		*((char **)dest) = immutable_string_copy(source->u.string.ptr);
 	}
 }
 
-void *_parse_string(json_value *source) {
-	char *string = immutable_string_copy(source->u.string.ptr);
-	return string;
+/**
+ * Fills a string list from strings of JSON array, skipping other items.
+ */
+void parse_strings(twitch_string_list *list, json_value *source) {
+	int length = source->u.array.length;
+	list->count = 0;
+	list->items = NULL;
+	if (length == 0) {
+		return;
+	}
+
+	list->items = malloc(length * sizeof(char *));
+	if (list->items == NULL) {
+		fprintf(stderr, "Failed to allocate memory for string list");
+		exit(EXIT_FAILURE);
+	}
+
+	for (int index = 0; index < length; index++) {
+		json_value *item = source->u.array.values[index];
+		if (item->type == json_string) {
+			list->items[list->count++] = immutable_string_copy(item->u.string.ptr);
+		}
+	}
+
+	if (list->count == 0) {
+		free(list->items);
+		list->items = NULL;
+	}
 }
 
 void parse_string_list(void *dest, json_value *source) {
 	if (source->type == json_array) {
-		int size = 0;
 		twitch_string_list *list = dest;
+		for (int index = 0; index < list->count; index++) {
+			FREE(list->items[index])
+		}
+		FREE(list->items)
 
-		char **items = (char **)parse_json_array(source, &size, &_parse_string);
-		list->count = size;
-		list->items = items;
+		parse_strings(list, source);
 	}
 }
 
 void make_string_list(void *dest, json_value *value) {
 	if (value->type == json_array) {
-		int size = 0;
+		FREE_CUSTOM(*((twitch_string_list **)dest), twitch_string_list_free)
 		twitch_string_list *list = twitch_string_list_alloc();
-
-		char **items = (char **)parse_json_array(value, &size, &_parse_string);
-		list->count = size;
-		list->items = items;
+		parse_strings(list, value);
 
 		*((void **)dest) = list;
 	}
 }
 
 void parse_bool(void *dest, json_value *source) {
-	*((bool *)dest) = source->u.boolean;
+	if (source->type == json_boolean) {
+		*((bool *)dest) = source->u.boolean;
+	}
 }
 
-void parse_double(void *dest, json_value *source) {
-	*((float *)dest) = source->u.dbl;
+/**
+ * Reads a number, or a literal, as an integer.
+ *
+ * @return false if the value can't be read as an integer.
+ */
+bool parse_number(json_value *source, json_int_t *number) {
+	switch (source->type) {
+		case json_integer:
+			*number = source->u.integer;
+			return true;
+		case json_double:
+			*number = (json_int_t)source->u.dbl;
+			return true;
+		case json_boolean:
+			*number = source->u.boolean;
+			return true;
+		case json_null:
+			*number = 0;
+			return true;
+		default:
+			return false;
+	}
 }
 
 void parse_int(void *dest, json_value *source) {
-	*((int *)dest) = source->u.integer;
+	json_int_t number = 0;
+	if (parse_number(source, &number)) {
+		*((int *)dest) = number;
+	}
 }
 
-typedef struct {
-	char *name;
-	void *dest;
-	void(*parser)(void*, json_value*);
-} field_spec;
+void parse_long(void *dest, json_value *source) {
+	json_int_t number = 0;
+	if (parse_number(source, &number)) {
+		*((long *)dest) = number;
+	}
+}
+
+void parse_entity(
+	json_value *src,
+	void *entity,
+	int count,
+	const field_spec *specs
+);
+
+/**
+ * Creates a new entity of given schema and fills it from JSON object.
+ */
+void *parse_schema_entity(json_value *src, const entity_schema *schema) {
+	if (src->type != json_object) {
+		return NULL;
+	}
+
+	void *entity = schema->alloc();
+	parse_entity(src, entity, schema->count, schema->fields);
+	return entity;
+}
+
+void parse_entity_list(
+	void *dest,
+	const entity_schema *schema,
+	json_value *value
+) {
+	if (value->type != json_array) {
+		return;
+	}
+
+	int length = value->u.array.length;
+	int count = 0;
+	void **items = NULL;
+	if (length > 0) {
+		items = malloc(length * sizeof(void *));
+		if (items == NULL) {
+			fprintf(stderr, "Failed to allocate memory for entity list");
+			exit(EXIT_FAILURE);
+		}
+
+		// Items that aren't objects are skipped.
+		for (int index = 0; index < length; index++) {
+			void *item = parse_schema_entity(value->u.array.values[index], schema);
+			if (item != NULL) {
+				items[count++] = item;
+			}
+		}
+
+		if (count == 0) {
+			free(items);
+			items = NULL;
+		}
+	}
+
+	// All lists share the same layout.
+	FREE_CUSTOM(*((void **)dest), schema->list_free)
+	twitch_string_list *list = schema->list_alloc();
+	list->count = count;
+	list->items = (char **)items;
+
+	*((void **)dest) = list;
+}
+
+void parse_field(void *entity, const field_spec *spec, json_value *value) {
+	void *dest = (char *)entity + spec->offset;
+
+	switch (spec->type) {
+		case FIELD_STRING:
+			parse_string(dest, value);
+			break;
+		case FIELD_INT:
+			parse_int(dest, value);
+			break;
+		case FIELD_LONG:
+			parse_long(dest, value);
+			break;
+		case FIELD_BOOL:
+			parse_bool(dest, value);
+			break;
+		case FIELD_STRINGS:
+			parse_string_list(dest, value);
+			break;
+		case FIELD_STRING_LIST:
+			make_string_list(dest, value);
+			break;
+		case FIELD_ENTITY_LIST:
+			parse_entity_list(dest, spec->items, value);
+			break;
+	}
+}
+
+void parse_entity(
+	json_value *src,
+	void *entity,
+	int count,
+	const field_spec *specs
+) {
+	if (src->type != json_object) {
+		return;
+	}
 
-void parse_entity(json_value *src, int count, field_spec *specs) {
 	for (int prop_ind = 0; prop_ind < src->u.object.length; prop_ind++) {
+		json_object_entry *entry = &src->u.object.values[prop_ind];
 		for (int spec_ind = 0; spec_ind < count; spec_ind++) {
-			if (strcmp(src->u.object.values[prop_ind].name, specs[spec_ind].name) == 0) {
-				(*(specs[spec_ind].parser))(
-					specs[spec_ind].dest,
+			if (
+				entry->name_length == strlen(specs[spec_ind].name) &&
+				strcmp(entry->name, specs[spec_ind].name) == 0
+			) {
+				parse_field(
+					entity,
+					&specs[spec_ind],
 					src->u.object.values[prop_ind].value
 				);
 			}
@@ -108,303 +271,419 @@ void parse_entity(json_value *src, int count, field_spec *specs) {
 
 /** User **/
 
-void *parse_helix_user(json_value *user_object) {
-	twitch_helix_user *user = twitch_helix_user_alloc();
-
-	field_spec schema[] = {
-		{
-			.name = "id",
-			.dest = &user->id,
-			.parser = &parse_string
-		},
-		{
-			.name = "display_name",
-			.dest = &user->display_name,
-			.parser = &parse_string
-		},
-		{
-			.name = "login",
-			.dest = &user->login,
-			.parser = &parse_string
-		},
-		{
-			.name = "type",
-			.dest = &user->type,
-			.parser = &parse_string
-		},
-		{
-			.name = "broadcaster_type",
-			.dest = &user->broadcaster_type,
-			.parser = &parse_string
-		},
-		{
-			.name = "description",
-			.dest = &user->description,
-			.parser = &parse_string
-		},
-		{
-			.name = "profile_image_url",
-			.dest = &user->profile_image_url,
-			.parser = &parse_string
-		},
-		{
-			.name = "created_at",
-			.dest = &user->created_at,
-			.parser = &parse_string
-		},
-		{
-			.name = "offline_image_url",
-			.dest = &user->offline_image_url,
-			.parser = &parse_string
-		},
-		{
-			.name = "view_count",
-			.dest = &user->view_count,
-			.parser = &parse_int
-		}
-	};
-	parse_entity(user_object, sizeof(schema)/sizeof(field_spec), schema);
+const field_spec helix_user_fields[] = {
+	{
+		.name = "id",
+		.offset = offsetof(twitch_helix_user, id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "display_name",
+		.offset = offsetof(twitch_helix_user, display_name),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "login",
+		.offset = offsetof(twitch_helix_user, login),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "type",
+		.offset = offsetof(twitch_helix_user, type),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "broadcaster_type",
+		.offset = offsetof(twitch_helix_user, broadcaster_type),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "description",
+		.offset = offsetof(twitch_helix_user, description),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "profile_image_url",
+		.offset = offsetof(twitch_helix_user, profile_image_url),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "created_at",
+		.offset = offsetof(twitch_helix_user, created_at),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "offline_image_url",
+		.offset = offsetof(twitch_helix_user, offline_image_url),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "view_count",
+		.offset = offsetof(twitch_helix_user, view_count),
+		.type = FIELD_INT
+	}
+};
 
-	return (void *)user;
+const entity_schema helix_user_schema = {
+	.alloc = (void *(*)())&twitch_helix_user_alloc,
+	.free = (void (*)(void *))&twitch_helix_user_free,
+	.list_alloc = (void *(*)())&twitch_helix_user_list_alloc,
+	.list_free = (void (*)(void *))&twitch_helix_user_list_free,
+	.count = sizeof(helix_user_fields) / sizeof(field_spec),
+	.fields = helix_user_fields
+};
+
+void *parse_helix_user(json_value *user_object) {
+	return parse_schema_entity(user_object, &helix_user_schema);
 }
 
 /** Streams **/
 
-void *parse_helix_stream(json_value *stream_object) {
-	twitch_helix_stream *stream = twitch_helix_stream_alloc();
-
-	field_spec schema[] = {
-		{
-			.name = "id",
-			.dest = &stream->id,
-			.parser = &parse_string
-		},
-		{
-			.name = "user_id",
-			.dest = &stream->user_id,
-			.parser = &parse_string
-		},
-		{
-			.name = "user_name",
-			.dest = &stream->user_name,
-			.parser = &parse_string
-		},
-		{
-			.name = "game_id",
-			.dest = &stream->game_id,
-			.parser = &parse_string
-		},
-		{
-			.name = "game_name",
-			.dest = &stream->game_name,
-			.parser = &parse_string
-		},
-		{
-			.name = "type",
-			.dest = &stream->type,
-			.parser = &parse_string
-		},
-		{
-			.name = "title",
-			.dest = &stream->title,
-			.parser = &parse_string
-		},
-		{
-			.name = "viewer_count",
-			.dest = &stream->viewer_count,
-			.parser = &parse_int
-		},
-		{
-			.name = "started_at",
-			.dest = &stream->started_at,
-			.parser = &parse_string
-		},
-		{
-			.name = "language",
-			.dest = &stream->language,
-			.parser = &parse_string
-		},
-		{
-			.name = "thumbnail_url",
-			.dest = &stream->thumbnail_url,
-			.parser = &parse_string
-		}
-	};
-	parse_entity(stream_object, sizeof(schema)/sizeof(field_spec), schema);
+const field_spec helix_stream_fields[] = {
+	{
+		.name = "id",
+		.offset = offsetof(twitch_helix_stream, id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "user_id",
+		.offset = offsetof(twitch_helix_stream, user_id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "user_name",
+		.offset = offsetof(twitch_helix_stream, user_name),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "game_id",
+		.offset = offsetof(twitch_helix_stream, game_id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "game_name",
+		.offset = offsetof(twitch_helix_stream, game_name),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "type",
+		.offset = offsetof(twitch_helix_stream, type),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "title",
+		.offset = offsetof(twitch_helix_stream, title),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "viewer_count",
+		.offset = offsetof(twitch_helix_stream, viewer_count),
+		.type = FIELD_INT
+	},
+	{
+		.name = "started_at",
+		.offset = offsetof(twitch_helix_stream, started_at),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "language",
+		.offset = offsetof(twitch_helix_stream, language),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "thumbnail_url",
+		.offset = offsetof(twitch_helix_stream, thumbnail_url),
+		.type = FIELD_STRING
+	}
+};
 
-	return (void *)stream;
+const entity_schema helix_stream_schema = {
+	.alloc = (void *(*)())&twitch_helix_stream_alloc,
+	.free = (void (*)(void *))&twitch_helix_stream_free,
+	.list_alloc = (void *(*)())&twitch_helix_stream_list_alloc,
+	.list_free = (void (*)(void *))&twitch_helix_stream_list_free,
+	.count = sizeof(helix_stream_fields) / sizeof(field_spec),
+	.fields = helix_stream_fields
+};
+
+void *parse_helix_stream(json_value *stream_object) {
+	return parse_schema_entity(stream_object, &helix_stream_schema);
 }
 
 /** Follow **/
 
-void *parse_helix_channel_follow(json_value *follow_object) {
-	twitch_helix_channel_follow *follow = twitch_helix_channel_follow_alloc();
-
-	field_spec schema[] = {
-		{
-			.name = "broadcaster_id",
-			.dest = &follow->broadcaster_id,
-			.parser = &parse_string
-		},
-		{
-			.name = "broadcaster_name",
-			.dest = &follow->broadcaster_name,
-			.parser = &parse_string
-		},
-		{
-			.name = "broadcaster_login",
-			.dest = &follow->broadcaster_login,
-			.parser = &parse_string
-		},
-		{
-			.name = "followed_at",
-			.dest = &follow->followed_at,
-			.parser = &parse_string
-		}
-	};
-	parse_entity(follow_object, sizeof(schema)/sizeof(field_spec), schema);
+const field_spec helix_channel_follow_fields[] = {
+	{
+		.name = "broadcaster_id",
+		.offset = offsetof(twitch_helix_channel_follow, broadcaster_id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "broadcaster_name",
+		.offset = offsetof(twitch_helix_channel_follow, broadcaster_name),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "broadcaster_login",
+		.offset = offsetof(twitch_helix_channel_follow, broadcaster_login),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "followed_at",
+		.offset = offsetof(twitch_helix_channel_follow, followed_at),
+		.type = FIELD_STRING
+	}
+};
+
+const entity_schema helix_channel_follow_schema = {
+	.alloc = (void *(*)())&twitch_helix_channel_follow_alloc,
+	.free = (void (*)(void *))&twitch_helix_channel_follow_free,
+	.list_alloc = (void *(*)())&twitch_helix_channel_follow_list_alloc,
+	.list_free = (void (*)(void *))&twitch_helix_channel_follow_list_free,
+	.count = sizeof(helix_channel_follow_fields) / sizeof(field_spec),
+	.fields = helix_channel_follow_fields
+};
 
-	return (void *)follow;
+void *parse_helix_channel_follow(json_value *follow_object) {
+	return parse_schema_entity(follow_object, &helix_channel_follow_schema);
 }
 
 /** Games **/
 
-void *parse_helix_game(json_value *game_object) {
-	twitch_helix_game *game = twitch_helix_game_alloc();
-
-	field_spec schema[] = {
-		{
-			.name = "id",
-			.dest = &game->id,
-			.parser = &parse_string
-		},
-		{
-			.name = "igdb_id",
-			.dest = &game->igdb_id,
-			.parser = &parse_string
-		},
-		{
-			.name = "name",
-			.dest = &game->name,
-			.parser = &parse_string
-		},
-		{
-			.name = "box_art_url",
-			.dest = &game->box_art_url,
-			.parser = &parse_string
-		}
-	};
-	parse_entity(game_object, sizeof(schema)/sizeof(field_spec), schema);
+const field_spec helix_game_fields[] = {
+	{
+		.name = "id",
+		.offset = offsetof(twitch_helix_game, id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "igdb_id",
+		.offset = offsetof(twitch_helix_game, igdb_id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "name",
+		.offset = offsetof(twitch_helix_game, name),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "box_art_url",
+		.offset = offsetof(twitch_helix_game, box_art_url),
+		.type = FIELD_STRING
+	}
+};
 
-	return (void *)game;
+const entity_schema helix_game_schema = {
+	.alloc = (void *(*)())&twitch_helix_game_alloc,
+	.free = (void (*)(void *))&twitch_helix_game_free,
+	.list_alloc = (void *(*)())&twitch_helix_game_list_alloc,
+	.list_free = (void (*)(void *))&twitch_helix_game_list_free,
+	.count = sizeof(helix_game_fields) / sizeof(field_spec),
+	.fields = helix_game_fields
+};
+
+void *parse_helix_game(json_value *game_object) {
+	return parse_schema_entity(game_object, &helix_game_schema);
 }
 
 /** Auth **/
 
+const field_spec auth_token_fields[] = {
+	{
+		.name = "access_token",
+		.offset = offsetof(twitch_app_access_token, token),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "expires_in",
+		.offset = offsetof(twitch_app_access_token, expires_in),
+		.type = FIELD_INT
+	},
+	{
+		.name = "token_type",
+		.offset = offsetof(twitch_app_access_token, token_type),
+		.type = FIELD_STRING
+	},
+};
+
 void *parse_auth_token(json_value *value) {
 	twitch_app_access_token *token = twitch_app_access_token_alloc();
-
-	field_spec schema[] = {
-		{
-			.name = "access_token",
-			.dest = &token->token,
-			.parser = &parse_string
-		},
-		{
-			.name = "expires_in",
-			.dest = &token->expires_in,
-			.parser = &parse_int
-		},
-		{
-			.name = "token_type",
-			.dest = &token->token_type,
-			.parser = &parse_string
-		},
-	};
-	parse_entity(value, sizeof(schema)/sizeof(field_spec), schema);
+	parse_entity(
+		value,
+		token,
+		sizeof(auth_token_fields) / sizeof(field_spec),
+		auth_token_fields
+	);
 
 	return (void *)token;
 }
 
-void *parse_user_auth_token(json_value *value) {
-	twitch_user_access_token *token = twitch_user_access_token_alloc();
+const field_spec error_details_fields[] = {
+	{
+		.name = "error",
+		.offset = offsetof(twitch_error_details, error),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "status",
+		.offset = offsetof(twitch_error_details, status),
+		.type = FIELD_LONG
+	},
+	{
+		.name = "message",
+		.offset = offsetof(twitch_error_details, message),
+		.type = FIELD_STRING
+	},
+};
+
+void *parse_error_details(json_value *value) {
+	twitch_error_details *details = calloc(1, sizeof(twitch_error_details));
+	if (details == NULL) {
+		fprintf(stderr, "Failed to allocate memory for twitch_error_details");
+		exit(EXIT_FAILURE);
+	}
 
-	field_spec schema[] = {
-		{
-			.name = "access_token",
-			.dest = &token->access_token,
-			.parser = &parse_string
-		},
-		{
-			.name = "refresh_token",
-			.dest = &token->refresh_token,
-			.parser = &parse_string
-		},
-		{
-			.name = "expires_in",
-			.dest = &token->expires_in,
-			.parser = &parse_int
-		},
-		{
-			.name = "token_type",
-			.dest = &token->token_type,
-			.parser = &parse_string
-		},
-		{
-			.name = "scope",
-			.dest = &token->scopes,
-			.parser = &parse_string_list
-		},
-	};
-	parse_entity(value, sizeof(schema)/sizeof(field_spec), schema);
+	parse_entity(
+		value,
+		details,
+		sizeof(error_details_fields) / sizeof(field_spec),
+		error_details_fields
+	);
 
-	return (void *)token;
+	return (void *)details;
 }
 
-/** Teams **/
+const field_spec user_auth_token_fields[] = {
+	{
+		.name = "access_token",
+		.offset = offsetof(twitch_user_access_token, access_token),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "refresh_token",
+		.offset = offsetof(twitch_user_access_token, refresh_token),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "expires_in",
+		.offset = offsetof(twitch_user_access_token, expires_in),
+		.type = FIELD_INT
+	},
+	{
+		.name = "token_type",
+		.offset = offsetof(twitch_user_access_token, token_type),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "scope",
+		.offset = offsetof(twitch_user_access_token, scopes),
+		.type = FIELD_STRINGS
+	},
+};
 
-void *parse_team_member(json_value *value) {
-	twitch_helix_team_member *member = twitch_helix_team_member_alloc();
-
-	field_spec schema[] = {
-		{
-			.name = "user_id",
-			.dest = &member->id,
-			.parser = &parse_string
-		},
-		{
-			.name = "user_name",
-			.dest = &member->name,
-			.parser = &parse_string
-		},
-		{
-			.name = "user_login",
-			.dest = &member->login,
-			.parser = &parse_string
-		},
-	};
-	parse_entity(value, sizeof(schema)/sizeof(field_spec), schema);
-
-	return (void *)member;
+void *parse_user_auth_token(json_value *value) {
+	twitch_user_access_token *token = twitch_user_access_token_alloc();
+	parse_entity(
+		value,
+		token,
+		sizeof(user_auth_token_fields) / sizeof(field_spec),
+		user_auth_token_fields
+	);
+
+	return (void *)token;
 }
 
-void _parse_team_member_list(void *dest, json_value *value) {
-	if (value->type == json_array) {
-		int size = 0;
-		twitch_helix_team_member_list *list = twitch_helix_team_member_list_alloc();
-
-		twitch_helix_team_member **items =
-			(twitch_helix_team_member **)parse_json_array(
-				value,
-				&size,
-				&parse_team_member
-			);
-		list->count = size;
-		list->items = items;
+/** Teams **/
 
-		*((void **)dest) = list;
-	}
-}
+const field_spec helix_team_member_fields[] = {
+	{
+		.name = "user_id",
+		.offset = offsetof(twitch_helix_team_member, id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "user_name",
+		.offset = offsetof(twitch_helix_team_member, name),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "user_login",
+		.offset = offsetof(twitch_helix_team_member, login),
+		.type = FIELD_STRING
+	},
+};
+
+const entity_schema helix_team_member_schema = {
+	.alloc = (void *(*)())&twitch_helix_team_member_alloc,
+	.free = (void (*)(void *))&twitch_helix_team_member_free,
+	.list_alloc = (void *(*)())&twitch_helix_team_member_list_alloc,
+	.list_free = (void (*)(void *))&twitch_helix_team_member_list_free,
+	.count = sizeof(helix_team_member_fields) / sizeof(field_spec),
+	.fields = helix_team_member_fields
+};
+
+const field_spec helix_team_fields[] = {
+	{
+		.name = "id",
+		.offset = offsetof(twitch_helix_team, id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "created_at",
+		.offset = offsetof(twitch_helix_team, created_at),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "updated_at",
+		.offset = offsetof(twitch_helix_team, updated_at),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "background_image_url",
+		.offset = offsetof(twitch_helix_team, background),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "thumbnail_url",
+		.offset = offsetof(twitch_helix_team, thumbnail),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "banner",
+		.offset = offsetof(twitch_helix_team, banner),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "info",
+		.offset = offsetof(twitch_helix_team, info),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "team_display_name",
+		.offset = offsetof(twitch_helix_team, display_name),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "team_name",
+		.offset = offsetof(twitch_helix_team, name),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "users",
+		.offset = offsetof(twitch_helix_team, users),
+		.type = FIELD_ENTITY_LIST,
+		.items = &helix_team_member_schema
+	},
+};
+
+const entity_schema helix_team_schema = {
+	.alloc = (void *(*)())&twitch_helix_team_alloc,
+	.free = (void (*)(void *))&twitch_helix_team_free,
+	.list_alloc = (void *(*)())&twitch_helix_team_list_alloc,
+	.list_free = (void (*)(void *))&twitch_helix_team_list_free,
+	.count = sizeof(helix_team_fields) / sizeof(field_spec),
+	.fields = helix_team_fields
+};
 
 void *parse_helix_team(json_value *value) {
 	json_value *team_object = NULL;
@@ -432,323 +711,413 @@ void *parse_helix_team(json_value *value) {
 		return NULL;
 	}
 
-	twitch_helix_team *team = twitch_helix_team_alloc();
-
-	field_spec schema[] = {
-		{
-			.name = "id",
-			.dest = &team->id,
-			.parser = &parse_string
-		},
-		{
-			.name = "created_at",
-			.dest = &team->created_at,
-			.parser = &parse_string
-		},
-		{
-			.name = "updated_at",
-			.dest = &team->updated_at,
-			.parser = &parse_string
-		},
-		{
-			.name = "background_image_url",
-			.dest = &team->background,
-			.parser = &parse_string
-		},
-		{
-			.name = "thumbnail_url",
-			.dest = &team->thumbnail,
-			.parser = &parse_string
-		},
-		{
-			.name = "banner",
-			.dest = &team->banner,
-			.parser = &parse_string
-		},
-		{
-			.name = "info",
-			.dest = &team->info,
-			.parser = &parse_string
-		},
-		{
-			.name = "team_display_name",
-			.dest = &team->display_name,
-			.parser = &parse_string
-		},
-		{
-			.name = "team_name",
-			.dest = &team->name,
-			.parser = &parse_string
-		},
-		{
-			.name = "users",
-			.dest = &team->users,
-			.parser = &_parse_team_member_list
-		},
-	};
-	parse_entity(team_object, sizeof(schema)/sizeof(field_spec), schema);
-
-	return (void *)team;
+	return parse_schema_entity(team_object, &helix_team_schema);
 }
 
 /** Followers **/
 
-void *parse_helix_follower(json_value *object) {
-	twitch_helix_follower *follower = twitch_helix_follower_alloc();
-
-	field_spec schema[] = {
-		{
-			.name = "user_id",
-			.dest = &follower->user_id,
-			.parser = &parse_string
-		},
-		{
-			.name = "user_name",
-			.dest = &follower->user_name,
-			.parser = &parse_string
-		},
-		{
-			.name = "user_login",
-			.dest = &follower->user_login,
-			.parser = &parse_string
-		},
-		{
-			.name = "followed_at",
-			.dest = &follower->followed_at,
-			.parser = &parse_string
-		}
-	};
-	parse_entity(object, sizeof(schema)/sizeof(field_spec), schema);
+const field_spec helix_follower_fields[] = {
+	{
+		.name = "user_id",
+		.offset = offsetof(twitch_helix_follower, user_id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "user_name",
+		.offset = offsetof(twitch_helix_follower, user_name),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "user_login",
+		.offset = offsetof(twitch_helix_follower, user_login),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "followed_at",
+		.offset = offsetof(twitch_helix_follower, followed_at),
+		.type = FIELD_STRING
+	}
+};
 
-	return (void *)follower;
+const entity_schema helix_follower_schema = {
+	.alloc = (void *(*)())&twitch_helix_follower_alloc,
+	.free = (void (*)(void *))&twitch_helix_follower_free,
+	.list_alloc = (void *(*)())&twitch_helix_follower_list_alloc,
+	.list_free = (void (*)(void *))&twitch_helix_follower_list_free,
+	.count = sizeof(helix_follower_fields) / sizeof(field_spec),
+	.fields = helix_follower_fields
+};
+
+void *parse_helix_follower(json_value *object) {
+	return parse_schema_entity(object, &helix_follower_schema);
 }
 
 /** Videos **/
 
+const field_spec helix_segment_fields[] = {
+	{
+		.name = "duration",
+		.offset = offsetof(twitch_helix_segment, duration),
+		.type = FIELD_INT
+	},
+	{
+		.name = "offset",
+		.offset = offsetof(twitch_helix_segment, offset),
+		.type = FIELD_INT
+	}
+};
+
+const entity_schema helix_segment_schema = {
+	.alloc = (void *(*)())&twitch_helix_segment_alloc,
+	.free = (void (*)(void *))&twitch_helix_segment_free,
+	.list_alloc = (void *(*)())&twitch_helix_segment_list_alloc,
+	.list_free = (void (*)(void *))&twitch_helix_segment_list_free,
+	.count = sizeof(helix_segment_fields) / sizeof(field_spec),
+	.fields = helix_segment_fields
+};
+
 void *parse_helix_segment(json_value *object) {
-	twitch_helix_segment *segment = twitch_helix_segment_alloc();
-
-	field_spec schema[] = {
-		{
-			.name = "duration",
-			.dest = &segment->duration,
-			.parser = &parse_int
-		},
-		{
-			.name = "offset",
-			.dest = &segment->offset,
-			.parser = &parse_int
-		}
-	};
-	parse_entity(object, sizeof(schema)/sizeof(field_spec), schema);
+	return parse_schema_entity(object, &helix_segment_schema);
+}
 
-	return (void *)segment;
+const field_spec helix_video_fields[] = {
+	{
+		.name = "id",
+		.offset = offsetof(twitch_helix_video, id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "stream_id",
+		.offset = offsetof(twitch_helix_video, stream_id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "user_id",
+		.offset = offsetof(twitch_helix_video, user_id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "user_login",
+		.offset = offsetof(twitch_helix_video, user_login),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "user_name",
+		.offset = offsetof(twitch_helix_video, user_name),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "title",
+		.offset = offsetof(twitch_helix_video, title),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "description",
+		.offset = offsetof(twitch_helix_video, description),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "created_at",
+		.offset = offsetof(twitch_helix_video, created_at),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "published_at",
+		.offset = offsetof(twitch_helix_video, published_at),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "url",
+		.offset = offsetof(twitch_helix_video, url),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "thumbnail_url",
+		.offset = offsetof(twitch_helix_video, thumbnail_url),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "viewable",
+		.offset = offsetof(twitch_helix_video, viewable),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "view_count",
+		.offset = offsetof(twitch_helix_video, view_count),
+		.type = FIELD_INT
+	},
+	{
+		.name = "language",
+		.offset = offsetof(twitch_helix_video, language),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "type",
+		.offset = offsetof(twitch_helix_video, type),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "duration",
+		.offset = offsetof(twitch_helix_video, duration),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "muted_segments",
+		.offset = offsetof(twitch_helix_video, muted_segments),
+		.type = FIELD_ENTITY_LIST,
+		.items = &helix_segment_schema
+	},
+};
+
+const entity_schema helix_video_schema = {
+	.alloc = (void *(*)())&twitch_helix_video_alloc,
+	.free = (void (*)(void *))&twitch_helix_video_free,
+	.list_alloc = (void *(*)())&twitch_helix_video_list_alloc,
+	.list_free = (void (*)(void *))&twitch_helix_video_list_free,
+	.count = sizeof(helix_video_fields) / sizeof(field_spec),
+	.fields = helix_video_fields
+};
+
+void *parse_helix_video(json_value *object) {
+	return parse_schema_entity(object, &helix_video_schema);
 }
 
-void parse_helix_segment_list(void *dest, json_value *value) {
-	if (value->type == json_array) {
-		int size = 0;
-		twitch_helix_segment_list *list = twitch_helix_segment_list_alloc();
-
-		twitch_helix_segment **items =
-			(twitch_helix_segment **)parse_json_array(
-				value,
-				&size,
-				&parse_helix_segment
-			);
-		list->count = size;
-		list->items = items;
+/** Categories/games search **/
 
-		*((void **)dest) = list;
+const field_spec helix_category_fields[] = {
+	{
+		.name = "id",
+		.offset = offsetof(twitch_helix_category, id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "name",
+		.offset = offsetof(twitch_helix_category, name),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "box_art_url",
+		.offset = offsetof(twitch_helix_category, box_art_url),
+		.type = FIELD_STRING
 	}
+};
+
+const entity_schema helix_category_schema = {
+	.alloc = (void *(*)())&twitch_helix_category_alloc,
+	.free = (void (*)(void *))&twitch_helix_category_free,
+	.list_alloc = (void *(*)())&twitch_helix_category_list_alloc,
+	.list_free = (void (*)(void *))&twitch_helix_category_list_free,
+	.count = sizeof(helix_category_fields) / sizeof(field_spec),
+	.fields = helix_category_fields
+};
+
+void *parse_helix_category(json_value *object) {
+	return parse_schema_entity(object, &helix_category_schema);
 }
 
-void *parse_helix_video(json_value *object) {
-	twitch_helix_video *video = twitch_helix_video_alloc();
-
-	field_spec schema[] = {
-		{
-			.name = "id",
-			.dest = &video->id,
-			.parser = &parse_string
-		},
-		{
-			.name = "stream_id",
-			.dest = &video->stream_id,
-			.parser = &parse_string
-		},
-		{
-			.name = "user_id",
-			.dest = &video->user_id,
-			.parser = &parse_string
-		},
-		{
-			.name = "user_login",
-			.dest = &video->user_login,
-			.parser = &parse_string
-		},
-		{
-			.name = "user_name",
-			.dest = &video->user_name,
-			.parser = &parse_string
-		},
-		{
-			.name = "title",
-			.dest = &video->title,
-			.parser = &parse_string
-		},
-		{
-			.name = "description",
-			.dest = &video->description,
-			.parser = &parse_string
-		},
-		{
-			.name = "created_at",
-			.dest = &video->created_at,
-			.parser = &parse_string
-		},
-		{
-			.name = "published_at",
-			.dest = &video->published_at,
-			.parser = &parse_string
-		},
-		{
-			.name = "url",
-			.dest = &video->url,
-			.parser = &parse_string
-		},
-		{
-			.name = "thumbnail_url",
-			.dest = &video->thumbnail_url,
-			.parser = &parse_string
-		},
-		{
-			.name = "viewable",
-			.dest = &video->viewable,
-			.parser = &parse_string
-		},
-		{
-			.name = "view_count",
-			.dest = &video->view_count,
-			.parser = &parse_int
-		},
-		{
-			.name = "language",
-			.dest = &video->language,
-			.parser = &parse_string
-		},
-		{
-			.name = "type",
-			.dest = &video->type,
-			.parser = &parse_string
-		},
-		{
-			.name = "duration",
-			.dest = &video->duration,
-			.parser = &parse_string
-		},
-		{
-			.name = "muted_segments",
-			.dest = &video->muted_segments,
-			.parser = &parse_helix_segment_list
-		},
-	};
-	parse_entity(object, sizeof(schema)/sizeof(field_spec), schema);
-
-	return (void *)video;
+/** Channels search **/
+
+const field_spec helix_channel_search_item_fields[] = {
+	{
+		.name = "id",
+		.offset = offsetof(twitch_helix_channel_search_item, id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "game_id",
+		.offset = offsetof(twitch_helix_channel_search_item, game_id),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "game_name",
+		.offset = offsetof(twitch_helix_channel_search_item, game_name),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "display_name",
+		.offset = offsetof(twitch_helix_channel_search_item, display_name),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "broadcaster_language",
+		.offset = offsetof(
+			twitch_helix_channel_search_item,
+			broadcaster_language
+		),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "broadcaster_login",
+		.offset = offsetof(
+			twitch_helix_channel_search_item,
+			broadcaster_login
+		),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "is_live",
+		.offset = offsetof(twitch_helix_channel_search_item, is_live),
+		.type = FIELD_BOOL
+	},
+	{
+		.name = "thumbnail_url",
+		.offset = offsetof(twitch_helix_channel_search_item, thumbnail_url),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "title",
+		.offset = offsetof(twitch_helix_channel_search_item, title),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "started_at",
+		.offset = offsetof(twitch_helix_channel_search_item, started_at),
+		.type = FIELD_STRING
+	},
+	{
+		.name = "tags",
+		.offset = offsetof(twitch_helix_channel_search_item, tags),
+		.type = FIELD_STRING_LIST
+	},
+};
+
+const entity_schema helix_channel_search_item_schema = {
+	.alloc = (void *(*)())&twitch_helix_channel_search_item_alloc,
+	.free = (void (*)(void *))&twitch_helix_channel_search_item_free,
+	.list_alloc = (void *(*)())&twitch_helix_channel_search_item_list_alloc,
+	.list_free = (void (*)(void *))&twitch_helix_channel_search_item_list_free,
+	.count = sizeof(helix_channel_search_item_fields) / sizeof(field_spec),
+	.fields = helix_channel_search_item_fields
+};
+
+void *parse_helix_channel_search_item(json_value *object) {
+	return parse_schema_entity(object, &helix_channel_search_item_schema);
 }
 
-/** Categories/games search **/
+/** Schemas **/
 
-void *parse_helix_category(json_value *object) {
-	twitch_helix_category *category = twitch_helix_category_alloc();
-
-	field_spec schema[] = {
-		{
-			.name = "id",
-			.dest = &category->id,
-			.parser = &parse_string
-		},
-		{
-			.name = "name",
-			.dest = &category->name,
-			.parser = &parse_string
-		},
-		{
-			.name = "box_art_url",
-			.dest = &category->box_art_url,
-			.parser = &parse_string
+typedef struct {
+	void *(*parser)(json_value *);
+	const entity_schema *schema;
+} parser_schema_entry;
+
+const parser_schema_entry parser_schemas[] = {
+	{ &parse_helix_user, &helix_user_schema },
+	{ &parse_helix_stream, &helix_stream_schema },
+	{ &parse_helix_channel_follow, &helix_channel_follow_schema },
+	{ &parse_helix_game, &helix_game_schema },
+	{ &parse_helix_team, &helix_team_schema },
+	{ &parse_helix_follower, &helix_follower_schema },
+	{ &parse_helix_segment, &helix_segment_schema },
+	{ &parse_helix_video, &helix_video_schema },
+	{ &parse_helix_category, &helix_category_schema },
+	{ &parse_helix_channel_search_item, &helix_channel_search_item_schema }
+};
+
+const entity_schema *parser_schema(void *(*parser)(json_value *)) {
+	int count = sizeof(parser_schemas) / sizeof(parser_schema_entry);
+	for (int idx = 0; idx < count; idx++) {
+		if (parser_schemas[idx].parser == parser) {
+			return parser_schemas[idx].schema;
 		}
-	};
-	parse_entity(object, sizeof(schema)/sizeof(field_spec), schema);
+	}
 
-	return (void *)category;
+	return NULL;
 }
 
-/** Channels search **/
+/** Copying **/
 
-void *parse_helix_channel_search_item(json_value *object) {
-	twitch_helix_channel_search_item *item =
-		twitch_helix_channel_search_item_alloc();
-
-	field_spec schema[] = {
-		{
-			.name = "id",
-			.dest = &item->id,
-			.parser = &parse_string
-		},
-		{
-			.name = "game_id",
-			.dest = &item->game_id,
-			.parser = &parse_string
-		},
-		{
-			.name = "game_name",
-			.dest = &item->game_name,
-			.parser = &parse_string
-		},
-		{
-			.name = "display_name",
-			.dest = &item->display_name,
-			.parser = &parse_string
-		},
-		{
-			.name = "broadcaster_language",
-			.dest = &item->broadcaster_language,
-			.parser = &parse_string
-		},
-		{
-			.name = "broadcaster_login",
-			.dest = &item->broadcaster_login,
-			.parser = &parse_string
-		},
-		{
-			.name = "is_live",
-			.dest = &item->is_live,
-			.parser = &parse_bool
-		},
-		{
-			.name = "thumbnail_url",
-			.dest = &item->thumbnail_url,
-			.parser = &parse_string
-		},
-		{
-			.name = "title",
-			.dest = &item->title,
-			.parser = &parse_string
-		},
-		{
-			.name = "started_at",
-			.dest = &item->started_at,
-			.parser = &parse_string
-		},
-		{
-			.name = "tags",
-			.dest = &item->tags,
-			.parser = &make_string_list
-		},
-	};
-	parse_entity(object, sizeof(schema)/sizeof(field_spec), schema);
-
-	return (void *)item;
+void copy_string_list(twitch_string_list *dest, const twitch_string_list *src) {
+	dest->count = src->count;
+	dest->items = NULL;
+	if (src->items == NULL) {
+		return;
+	}
+
+	dest->items = malloc(src->count * sizeof(char *));
+	if (dest->items == NULL && src->count > 0) {
+		fprintf(stderr, "Failed to allocate memory for string list");
+		exit(EXIT_FAILURE);
+	}
+
+	for (int index = 0; index < src->count; index++) {
+		dest->items[index] = (src->items[index] != NULL)
+			? immutable_string_copy(src->items[index])
+			: NULL;
+	}
+}
+
+void *copy_schema_entity(const entity_schema *schema, const void *entity) {
+	void *copy = schema->alloc();
+
+	for (int idx = 0; idx < schema->count; idx++) {
+		const field_spec *spec = &schema->fields[idx];
+		const void *src = (const char *)entity + spec->offset;
+		void *dest = (char *)copy + spec->offset;
+
+		switch (spec->type) {
+			case FIELD_STRING:
+				if (*((char **)src) != NULL) {
+					*((char **)dest) = immutable_string_copy(*((char **)src));
+				}
+				break;
+			case FIELD_INT:
+				*((int *)dest) = *((int *)src);
+				break;
+			case FIELD_LONG:
+				*((long *)dest) = *((long *)src);
+				break;
+			case FIELD_BOOL:
+				*((bool *)dest) = *((bool *)src);
+				break;
+			case FIELD_STRINGS:
+				copy_string_list(dest, src);
+				break;
+			case FIELD_STRING_LIST:
+				if (*((twitch_string_list **)src) != NULL) {
+					twitch_string_list *list = twitch_string_list_alloc();
+					copy_string_list(list, *((twitch_string_list **)src));
+					*((twitch_string_list **)dest) = list;
+				}
+				break;
+			case FIELD_ENTITY_LIST:
+				if (*((void **)src) != NULL) {
+					// All lists share the same layout.
+					const twitch_string_list *source = *((void **)src);
+					twitch_string_list *list = spec->items->list_alloc();
+					list->count = source->count;
+					list->items = (char **)copy_schema_entities(
+						spec->items,
+						(void **)source->items,
+						source->count
+					);
+					*((void **)dest) = list;
+				}
+				break;
+		}
+	}
+
+	return copy;
+}
+
+void **copy_schema_entities(
+	const entity_schema *schema,
+	void **items,
+	int count
+) {
+	if (items == NULL) {
+		return NULL;
+	}
+
+	void **copies = malloc(count * sizeof(void *));
+	if (copies == NULL && count > 0) {
+		fprintf(stderr, "Failed to allocate memory for entity list");
+		exit(EXIT_FAILURE);
+	}
+
+	for (int index = 0; index < count; index++) {
+		copies[index] = copy_schema_entity(schema, items[index]);
+	}
+
+	return copies;
 }
@@ -8,8 +8,82 @@
 #ifndef _PARSER_H
 #define _PARSER_H
 
+#include <stddef.h>
+
 #include "json/json.h"
 
+/**
+ * How JSON values of entity fields are stored in entity structs.
+ */
+typedef enum {
+	FIELD_STRING,       // char *, from a string.
+	FIELD_INT,          // int, from a number.
+	FIELD_LONG,         // long, from a number.
+	FIELD_BOOL,         // bool, from true or false.
+	FIELD_STRINGS,      // twitch_string_list, from an array of strings.
+	FIELD_STRING_LIST,  // twitch_string_list *, from an array of strings.
+	FIELD_ENTITY_LIST   // List struct pointer, from an array of objects.
+} field_type;
+
+typedef struct entity_schema entity_schema;
+
+/**
+ * Description of one entity field.
+ */
+typedef struct {
+	const char *name;             // JSON property name.
+	size_t offset;                // Offset of the field in entity struct.
+	field_type type;
+	const entity_schema *items;   // Schema of FIELD_ENTITY_LIST items.
+} field_spec;
+
+/**
+ * Description of an entity struct and its JSON representation, shared by the
+ * tree parsers below and the streaming page decoder (see page_decoder.h).
+ */
+struct entity_schema {
+	void *(*alloc)();             // Entity allocator.
+	void (*free)(void *);         // Entity deallocator.
+	void *(*list_alloc)();        // Allocator of the list of entities.
+	void (*list_free)(void *);    // Deallocator of the list of entities.
+	int count;                    // Number of fields.
+	const field_spec *fields;
+};
+
+/**
+ * Returns the schema of entities produced by given parser function.
+ *
+ * @param parser One of parse_helix_* functions.
+ *
+ * @return Entity schema, or NULL if the parser doesn't have one.
+ */
+const entity_schema *parser_schema(void *(*parser)(json_value *));
+
+/**
+ * Makes a deep copy of an entity described by a schema.
+ *
+ * @param schema Entity schema.
+ * @param entity Entity to copy.
+ *
+ * @return New entity. Free it with the schema's free function.
+ */
+void *copy_schema_entity(const entity_schema *schema, const void *entity);
+
+/**
+ * Makes deep copies of an array of entities described by a schema.
+ *
+ * @param schema Entity schema.
+ * @param items Entities to copy. Can be NULL.
+ * @param count Number of entities.
+ *
+ * @return New array of new entities, or NULL if items is NULL.
+ */
+void **copy_schema_entities(
+	const entity_schema *schema,
+	void **items,
+	int count
+);
+
 /**
  * Parses given json_value object of type 'json_array' using provided parser
  * function.
@@ -37,6 +111,16 @@ void **parse_json_array(
  */
 void *parse_auth_token(json_value *value);
 
+/**
+ * Creates a new twitch_error_details struct and fills it with properties from
+ * JSON body of a failed response.
+ *
+ * @param value: JSON object to parse.
+ *
+ * @return Pointer to twitch_error_details struct with data from JSON.
+ */
+void *parse_error_details(json_value *value);
+
 /**
  * Creates a new twitch_user_access_token struct and fills it with properties
  * from JSON value.
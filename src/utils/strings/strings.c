@@ -42,6 +42,11 @@ void string_append_format(string_t *s, const char *fmt, ...) {
   string_append(buffer, strlen(buffer), s);
 }
 
+void string_clear(string_t *s) {
+  s->len = 0;
+  s->ptr[0] = '\0';
+}
+
 void string_free(string_t *s) {
   free(s->ptr);
   free(s);
@@ -51,6 +51,13 @@ void string_append(const char* ptr, size_t size, string_t *s);
  */
 void string_append_format(string_t *s, const char *fmt, ...);
 
+/**
+ * Removes all content from dynamic string, keeping it allocated.
+ *
+ * @param s String to clear.
+ */
+void string_clear(string_t *s);
+
 /**
  * Frees dynamic string.
  *
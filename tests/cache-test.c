@@ -0,0 +1,396 @@
+/**
+ * Checks the response cache.
+ *
+ * Parsed values are put into a cache directly, to see which of them it keeps:
+ * the least recently used ones go first when the cache is full, entries expire
+ * after the TTL of the longest matching endpoint, and values still lent out
+ * stay valid until they are released, even after being evicted.
+ *
+ * Then the same requests are made twice against mock-helix. With the cache
+ * enabled, the second one is served without going to the server or parsing.
+ * A cache holding only TTLs is not enabled, so every request goes to the
+ * server and pages are decoded without parsing.
+ *
+ * Usage: cache-test path/to/mock-helix
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include <ctwitch/ctwitch.h>
+#include <ctwitch/client.h>
+#include <ctwitch/stats.h>
+#include <ctwitch/helix.h>
+
+#include "json/json.h"
+#include "utils/network/cache.h"
+#include "mock-server.h"
+
+#define PAGE "{\"data\":[{\"id\":\"1\",\"name\":\"Game\"}],\"pagination\":{}}"
+#define URL "https://api.twitch.tv/helix/games/top?first=1"
+
+/** Helpers **/
+
+/**
+ * Prints the failure and returns false, if the condition doesn't hold.
+ */
+bool expect(bool condition, const char *name, const char *message) {
+	if (!condition) {
+		fprintf(stderr, " ! %s: %s\n", name, message);
+	}
+	return condition;
+}
+
+json_value *parse_page() {
+	return json_parse(PAGE, strlen(PAGE));
+}
+
+/**
+ * Puts a new value into the cache and returns it right away.
+ *
+ * @return Whether the cache took the value.
+ */
+bool put(helix_cache *cache, const char *url) {
+	json_value *value = parse_page();
+	helix_cache_put(cache, "id", "token", url, value);
+
+	if (helix_cache_release(cache, value)) {
+		return true;
+	}
+
+	json_value_free(value);
+	return false;
+}
+
+/**
+ * Looks a value up and returns it right away.
+ *
+ * @return Whether the value was found.
+ */
+bool has(helix_cache *cache, const char *url) {
+	json_value *value = helix_cache_get(cache, "id", "token", url);
+	if (value == NULL) {
+		return false;
+	}
+
+	helix_cache_release(cache, value);
+	return true;
+}
+
+/**
+ * Returns the size the cache accounts for one page.
+ */
+size_t page_size() {
+	helix_cache *cache = helix_cache_alloc(1 << 20, 60);
+	put(cache, URL);
+
+	twitch_cache_stats stats;
+	helix_cache_stats(cache, &stats);
+	helix_cache_free(cache);
+
+	return stats.bytes;
+}
+
+/** Cases **/
+
+/**
+ * Full cache evicts the entry used longest ago.
+ */
+bool check_lru() {
+	const char *name = "lru";
+	helix_cache *cache = helix_cache_alloc(page_size() * 5 / 2, 60);
+
+	put(cache, URL "&after=a");
+	put(cache, URL "&after=b");
+	has(cache, URL "&after=a");
+	put(cache, URL "&after=c");
+
+	twitch_cache_stats stats;
+	helix_cache_stats(cache, &stats);
+	bool passed = expect(
+		stats.entries == 2 && stats.evictions == 1,
+		name,
+		"wrong number of entries"
+	);
+	passed = expect(
+		has(cache, URL "&after=a") &&
+			!has(cache, URL "&after=b") &&
+			has(cache, URL "&after=c"),
+		name,
+		"wrong entry evicted"
+	) && passed;
+
+	// Credentials are a part of the key.
+	json_value *value = helix_cache_get(cache, "id", "other", URL "&after=a");
+	passed = expect(value == NULL, name, "hit with other token") && passed;
+
+	helix_cache_free(cache);
+	return passed;
+}
+
+/**
+ * Entries live as long as the longest matching endpoint rule says.
+ */
+bool check_ttl() {
+	const char *name = "ttl";
+	helix_cache *cache = helix_cache_alloc(1 << 20, 60);
+	helix_cache_set_ttl(cache, "https://api.twitch.tv/helix/games", 0);
+	helix_cache_set_ttl(cache, "https://api.twitch.tv/helix/games/top", 1);
+
+	bool passed = expect(
+		!put(cache, "https://api.twitch.tv/helix/games?id=1"),
+		name,
+		"endpoint with TTL 0 cached"
+	);
+	passed = expect(
+		put(cache, URL) &&
+			put(cache, "https://api.twitch.tv/helix/gamesx") &&
+			has(cache, URL),
+		name,
+		"cacheable responses not cached"
+	) && passed;
+
+	struct timespec ts = { 1, 100000000 };
+	nanosleep(&ts, NULL);
+
+	twitch_cache_stats stats;
+	bool expired = !has(cache, URL);
+	helix_cache_stats(cache, &stats);
+	passed = expect(
+		expired && stats.expirations == 1,
+		name,
+		"entry outlived its TTL"
+	) && passed;
+	passed = expect(
+		has(cache, "https://api.twitch.tv/helix/gamesx"),
+		name,
+		"entry with default TTL expired"
+	) && passed;
+
+	helix_cache_free(cache);
+	return passed;
+}
+
+/**
+ * Values lent out survive eviction and clearing until they are released.
+ */
+bool check_leases() {
+	const char *name = "leases";
+	helix_cache *cache = helix_cache_alloc(page_size(), 60);
+
+	json_value *first = parse_page();
+	helix_cache_put(cache, "id", "token", URL "&after=a", first);
+	json_value *second = parse_page();
+	helix_cache_put(cache, "id", "token", URL "&after=b", second);
+
+	// The first value is evicted, but it's still in use.
+	bool passed = expect(
+		!has(cache, URL "&after=a"),
+		name,
+		"full cache kept evicted entry"
+	);
+	passed = expect(
+		first->type == json_object && first->u.object.length == 2,
+		name,
+		"evicted value freed while in use"
+	) && passed;
+	passed = expect(
+		helix_cache_release(cache, first),
+		name,
+		"evicted value not taken back"
+	) && passed;
+
+	helix_cache_clear(cache);
+	passed = expect(
+		second->type == json_object && helix_cache_release(cache, second),
+		name,
+		"cleared value not taken back"
+	) && passed;
+
+	// Values that didn't come from the cache are the caller's.
+	json_value *other = parse_page();
+	passed = expect(
+		!helix_cache_release(cache, other),
+		name,
+		"foreign value taken"
+	) && passed;
+	json_value_free(other);
+
+	// Values still lent out when the cache is freed are freed with it.
+	put(cache, URL);
+	helix_cache_get(cache, "id", "token", URL);
+	helix_cache_free(cache);
+
+	return passed;
+}
+
+/**
+ * Returns statistics of one endpoint from a snapshot, or NULL if it was never
+ * requested.
+ */
+twitch_endpoint_stats *find_endpoint(twitch_stats *stats, const char *path) {
+	for (int idx = 0; idx < stats->count; idx++) {
+		if (strcmp(stats->items[idx]->endpoint, path) == 0) {
+			return stats->items[idx];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Requests the same user and the same page twice.
+ *
+ * @return Whether both requests of each pair succeeded with the same result.
+ */
+bool request_twice(twitch_client *client) {
+	bool same = true;
+	twitch_helix_user *users[2];
+	twitch_helix_game_list *games[2];
+
+	for (int idx = 0; idx < 2; idx++) {
+		twitch_error error = { 0 };
+		users[idx] = twitch_helix_get_user(
+			client,
+			"id",
+			"token",
+			&error,
+			"cache"
+		);
+		games[idx] = twitch_helix_get_top_games(
+			client,
+			"id",
+			"token",
+			&error,
+			5,
+			NULL,
+			NULL
+		);
+		same = same && error.curl_code == 0;
+		twitch_error_clear(&error);
+	}
+
+	same = same &&
+		users[0] != NULL &&
+		users[1] != NULL &&
+		users[0] != users[1] &&
+		strcmp(users[0]->login, users[1]->login) == 0 &&
+		games[0] != NULL &&
+		games[1] != NULL &&
+		games[0]->count == 5 &&
+		games[1]->count == 5 &&
+		strcmp(games[0]->items[4]->id, games[1]->items[4]->id) == 0;
+
+	for (int idx = 0; idx < 2; idx++) {
+		twitch_helix_user_free(users[idx]);
+		twitch_helix_game_list_free(games[idx]);
+	}
+
+	return same;
+}
+
+bool check_server(const mock_server *server) {
+	const char *name = "server";
+	twitch_client *client = twitch_client_alloc();
+	twitch_client_set_api_url(client, server->url);
+	twitch_client_set_cache(client, 1 << 20, 60);
+
+	bool passed = expect(request_twice(client), name, "wrong responses");
+
+	twitch_stats *stats = twitch_client_get_stats(client);
+	twitch_endpoint_stats *users = find_endpoint(stats, "/helix/users");
+	twitch_endpoint_stats *games = find_endpoint(stats, "/helix/games/top");
+	passed = expect(
+		users != NULL && users->requests == 1 &&
+			games != NULL && games->requests == 1,
+		name,
+		"cached request sent again"
+	) && passed;
+	passed = expect(
+		games != NULL && games->metrics[TWITCH_METRIC_PARSE].count == 1,
+		name,
+		"cached page parsed again"
+	) && passed;
+	twitch_stats_free(stats);
+
+	twitch_cache_stats cache;
+	twitch_client_get_cache_stats(client, &cache);
+	passed = expect(
+		cache.hits == 2 && cache.misses == 2 && cache.entries == 2,
+		name,
+		"wrong cache counters"
+	) && passed;
+
+	twitch_client_free(client);
+	return passed;
+}
+
+bool check_ttl_only(const mock_server *server) {
+	const char *name = "ttl only";
+	twitch_client *client = twitch_client_alloc();
+	twitch_client_set_api_url(client, server->url);
+	twitch_client_set_cache_ttl(client, "/helix/games/top", 60);
+
+	bool passed = expect(request_twice(client), name, "wrong responses");
+
+	twitch_stats *stats = twitch_client_get_stats(client);
+	twitch_endpoint_stats *games = find_endpoint(stats, "/helix/games/top");
+	passed = expect(
+		games != NULL && games->requests == 2,
+		name,
+		"request served without a cache"
+	) && passed;
+
+	// Pages are decoded straight from the text while downloading.
+	passed = expect(
+		games != NULL &&
+			games->metrics[TWITCH_METRIC_PARSE].count == 0 &&
+			games->metrics[TWITCH_METRIC_MATERIALIZE].count == 2,
+		name,
+		"pages parsed"
+	) && passed;
+	twitch_stats_free(stats);
+
+	twitch_cache_stats cache;
+	twitch_client_get_cache_stats(client, &cache);
+	passed = expect(
+		cache.misses == 0 && cache.entries == 0,
+		name,
+		"cache used"
+	) && passed;
+
+	twitch_client_free(client);
+	return passed;
+}
+
+/** Test **/
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s path/to/mock-helix\n", argv[0]);
+		return 1;
+	}
+
+	twitch_helix_init();
+
+	bool passed = check_lru();
+	passed = check_ttl() && passed;
+	passed = check_leases() && passed;
+
+	mock_server server;
+	if (mock_server_start(&server, argv[1], NULL)) {
+		passed = check_server(&server) && passed;
+		passed = check_ttl_only(&server) && passed;
+		mock_server_stop(&server);
+	} else {
+		passed = false;
+	}
+
+	printf("%s\n", passed ? "PASS" : "FAIL");
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+/**
+ * Checks coalescing of identical requests in flight.
+ *
+ * A batch against mock-helix gets several requests for the same page and one
+ * for another page. Only two requests have to reach the server, and every
+ * callback has to get its own list with the same games, so each caller can
+ * free its list on its own. A request for the same page made after the first
+ * one has finished goes to the server again.
+ *
+ * Usage: coalesce-test path/to/mock-helix
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <ctwitch/ctwitch.h>
+#include <ctwitch/client.h>
+#include <ctwitch/stats.h>
+#include <ctwitch/helix.h>
+
+#include "mock-server.h"
+
+#define SAME_REQUESTS 5
+#define RESULTS_COUNT (SAME_REQUESTS + 2)
+
+/** Results **/
+
+typedef struct {
+	twitch_helix_batch *batch;
+	twitch_helix_game_list *lists[RESULTS_COUNT];
+	int count;           // Number of callbacks called.
+	int failed;          // Number of failed requests.
+	bool repeated;       // Whether the other page was requested again.
+} batch_results;
+
+void collect(twitch_error *error, void *list, const char *next, void *data) {
+	(void)next;
+	batch_results *results = (batch_results *)data;
+
+	if (error->curl_code != 0) {
+		results->failed++;
+	}
+
+	if (results->count < RESULTS_COUNT) {
+		results->lists[results->count] = (twitch_helix_game_list *)list;
+	} else {
+		twitch_helix_game_list_free((twitch_helix_game_list *)list);
+	}
+	results->count++;
+}
+
+/**
+ * Collects the result, and requests the same page once more, after the first
+ * request for it has finished.
+ */
+void repeat(twitch_error *error, void *list, const char *next, void *data) {
+	batch_results *results = (batch_results *)data;
+	collect(error, list, next, data);
+
+	if (!results->repeated) {
+		results->repeated = true;
+		twitch_helix_batch_get_top_games(results->batch, 6, NULL, repeat, data);
+	}
+}
+
+/** Helpers **/
+
+/**
+ * Prints the failure and returns false, if the condition doesn't hold.
+ */
+bool expect(bool condition, const char *name, const char *message) {
+	if (!condition) {
+		fprintf(stderr, " ! %s: %s\n", name, message);
+	}
+	return condition;
+}
+
+/**
+ * Returns the number of requests the client sent to given endpoint.
+ */
+unsigned long count_requests(twitch_client *client, const char *path) {
+	twitch_stats *stats = twitch_client_get_stats(client);
+	unsigned long count = 0;
+
+	for (int idx = 0; idx < stats->count; idx++) {
+		if (strcmp(stats->items[idx]->endpoint, path) == 0) {
+			count = stats->items[idx]->requests;
+		}
+	}
+
+	twitch_stats_free(stats);
+	return count;
+}
+
+/**
+ * Checks that two lists have the same games, without sharing any memory.
+ */
+bool same_games(twitch_helix_game_list *a, twitch_helix_game_list *b) {
+	if (a == NULL || b == NULL || a == b || a->count != b->count) {
+		return false;
+	}
+
+	for (int idx = 0; idx < a->count; idx++) {
+		twitch_helix_game *game_a = a->items[idx], *game_b = b->items[idx];
+		if (
+			game_a == game_b ||
+			game_a->id == game_b->id ||
+			game_a->name == game_b->name ||
+			strcmp(game_a->id, game_b->id) != 0 ||
+			strcmp(game_a->name, game_b->name) != 0
+		) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Finds the collected lists of given size.
+ *
+ * @return Number of lists found.
+ */
+int find_lists(
+	batch_results *results,
+	int size,
+	twitch_helix_game_list **lists
+) {
+	int found = 0;
+	for (int idx = 0; idx < results->count && idx < RESULTS_COUNT; idx++) {
+		twitch_helix_game_list *list = results->lists[idx];
+		if (list != NULL && list->count == size) {
+			lists[found++] = list;
+		}
+	}
+	return found;
+}
+
+/** Test **/
+
+bool check_server(const mock_server *server) {
+	const char *name = "server";
+	twitch_client *client = twitch_client_alloc();
+	twitch_client_set_api_url(client, server->url);
+
+	batch_results results;
+	memset(&results, 0, sizeof(results));
+	results.batch = twitch_helix_batch_alloc(client, "id", "token");
+
+	twitch_helix_batch *batch = results.batch;
+	for (int idx = 0; idx < SAME_REQUESTS; idx++) {
+		twitch_helix_batch_get_top_games(batch, 5, NULL, collect, &results);
+	}
+	twitch_helix_batch_get_top_games(batch, 6, NULL, repeat, &results);
+	twitch_helix_batch_perform(batch);
+
+	bool passed = expect(
+		results.count == RESULTS_COUNT && results.failed == 0,
+		name,
+		"requests failed"
+	);
+
+	// Two pages at once, and the second one again after it has finished.
+	passed = expect(
+		count_requests(client, "/helix/games/top") == 3,
+		name,
+		"identical requests not coalesced"
+	) && passed;
+
+	twitch_helix_game_list *same[RESULTS_COUNT];
+	passed = expect(
+		find_lists(&results, 5, same) == SAME_REQUESTS,
+		name,
+		"wrong results of coalesced requests"
+	) && passed;
+	for (int idx = 1; passed && idx < SAME_REQUESTS; idx++) {
+		passed = expect(
+			same_games(same[0], same[idx]),
+			name,
+			"coalesced requests got different or shared lists"
+		);
+	}
+
+	twitch_helix_game_list *other[RESULTS_COUNT];
+	passed = expect(
+		find_lists(&results, 6, other) == 2 && same_games(other[0], other[1]),
+		name,
+		"wrong results of repeated request"
+	) && passed;
+
+	// Each list is freed on its own.
+	for (int idx = 0; idx < results.count && idx < RESULTS_COUNT; idx++) {
+		twitch_helix_game_list_free(results.lists[idx]);
+	}
+	twitch_helix_batch_free(batch);
+	twitch_client_free(client);
+
+	return passed;
+}
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s path/to/mock-helix\n", argv[0]);
+		return 1;
+	}
+
+	twitch_helix_init();
+
+	// Responses are delayed, so the requests are in flight together.
+	const char *options[] = { "--latency=50", NULL };
+	mock_server server;
+	bool passed = mock_server_start(&server, argv[1], options);
+	if (passed) {
+		passed = check_server(&server);
+		mock_server_stop(&server);
+	}
+
+	printf("%s\n", passed ? "PASS" : "FAIL");
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "mock-server.h"
+
+#define MAX_OPTIONS 8
+
+bool mock_server_start(
+	mock_server *server,
+	const char *path,
+	const char **options
+) {
+	memset(server, 0, sizeof(mock_server));
+
+	char *argv[MAX_OPTIONS + 3] = { (char *)path, "--port=0" };
+	int argc = 2;
+	for (int idx = 0; options != NULL && options[idx] != NULL; idx++) {
+		if (argc == MAX_OPTIONS + 2) {
+			return false;
+		}
+		argv[argc++] = (char *)options[idx];
+	}
+	argv[argc] = NULL;
+
+	int fds[2];
+	if (pipe(fds) != 0) {
+		return false;
+	}
+
+	server->pid = fork();
+	if (server->pid < 0) {
+		close(fds[0]);
+		close(fds[1]);
+		return false;
+	}
+
+	if (server->pid == 0) {
+		dup2(fds[1], STDOUT_FILENO);
+		close(fds[0]);
+		close(fds[1]);
+		execv(path, argv);
+		_exit(127);
+	}
+
+	// The server prints its URL once it listens.
+	close(fds[1]);
+	FILE *output = fdopen(fds[0], "r");
+	char line[256] = "";
+	const char *banner = "Mock Helix API on http://127.0.0.1:%d";
+	bool started = output != NULL &&
+		fgets(line, sizeof(line), output) != NULL &&
+		sscanf(line, banner, &server->port) == 1;
+
+	if (output != NULL) {
+		fclose(output);
+	} else {
+		close(fds[0]);
+	}
+
+	if (!started) {
+		fprintf(stderr, "Failed to start %s\n", path);
+		mock_server_stop(server);
+		return false;
+	}
+
+	snprintf(
+		server->url,
+		sizeof(server->url),
+		"http://127.0.0.1:%d",
+		server->port
+	);
+	return true;
+}
+
+void mock_server_stop(mock_server *server) {
+	if (server->pid <= 0) {
+		return;
+	}
+
+	kill(server->pid, SIGTERM);
+	waitpid(server->pid, NULL, 0);
+	server->pid = 0;
+}
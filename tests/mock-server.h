@@ -0,0 +1,47 @@
+/**
+ * Mock Helix API server for tests.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ *
+ * Runs bench/mock-helix in a child process on a free port, so tests can make
+ * real requests without network access. The path to the executable is given
+ * to tests on the command line by ctest.
+ */
+
+#ifndef _H_TESTS_MOCK_SERVER
+#define _H_TESTS_MOCK_SERVER
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+typedef struct {
+	pid_t pid;
+	int port;
+	char url[64];  // Base URL to pass to twitch_client_set_api_url().
+} mock_server;
+
+/**
+ * Starts the server and waits until it listens.
+ *
+ * @param server Returns the running server.
+ * @param path Path to mock-helix executable.
+ * @param options NULL-terminated list of mock-helix options, like
+ * "--rate-limit=120". Port is picked by the server.
+ *
+ * @return true if the server is running.
+ */
+bool mock_server_start(
+	mock_server *server,
+	const char *path,
+	const char **options
+);
+
+/**
+ * Stops the server and waits for it to exit.
+ *
+ * @param server Server to stop.
+ */
+void mock_server_stop(mock_server *server);
+
+#endif
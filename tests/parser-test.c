@@ -0,0 +1,862 @@
+/**
+ * Checks that the single-pass JSON parser gives the same trees as the bundled
+ * two-pass parser, with and without the structural index built by each
+ * kernel, and that all kernels build the same index. Pages of entities are
+ * also decoded by the streaming page decoder, which has to give the same
+ * items, cursor and total as helix_parse_page() does from the tree, whether
+ * the page is decoded at once or received in chunks by the cURL write
+ * callback. Whole pages are split at every offset, and broken ones at a few
+ * random offsets.
+ *
+ * Each fixture in the directory given as the argument is parsed whole, cut
+ * at every length, and with every byte replaced, as well as with random spans
+ * deleted, duplicated or overwritten, so most of the inputs are broken. Both
+ * parsers have to either reject an input or build equal trees from it. Cut
+ * and randomly mutated inputs are parsed with comments enabled too. The test
+ * fails on the first input the parsers disagree on in each fixture, and
+ * prints it.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <ctwitch/common.h>
+
+#include "json/json.h"
+#include "utils/json/json_single.h"
+#include "utils/json/json_index.h"
+#include "utils/network/helix.h"
+#include "utils/parser/parser.h"
+#include "utils/parser/page_decoder.h"
+
+#define RANDOM_MUTATIONS 2000
+
+/** Fixtures **/
+
+typedef struct {
+	const char *name;
+	parser_func parser;  // Parser of page items, or NULL if it's not a page.
+} fixture;
+
+const fixture fixtures[] = {
+	{ "users.json", &parse_helix_user },
+	{ "streams.json", &parse_helix_stream },
+	{ "games.json", &parse_helix_game },
+	{ "videos.json", &parse_helix_video },
+	{ "search-channels.json", &parse_helix_channel_search_item },
+	{ "search-categories.json", &parse_helix_category },
+	{ "teams.json", &parse_helix_team },
+	{ "followers.json", &parse_helix_follower },
+	{ "followed.json", &parse_helix_channel_follow },
+	{ "values.json", NULL }
+};
+
+/**
+ * Reads the whole file into memory.
+ *
+ * @param dir Directory of the file.
+ * @param name File name.
+ * @param size Returns file size.
+ *
+ * @return File contents, or NULL on error.
+ */
+char *read_fixture(const char *dir, const char *name, size_t *size) {
+	char path[1024];
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+	FILE *file = fopen(path, "rb");
+	if (file == NULL) {
+		return NULL;
+	}
+
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	char *data = malloc(length > 0 ? length : 1);
+	if (data == NULL || fread(data, 1, length, file) != (size_t)length) {
+		free(data);
+		fclose(file);
+		return NULL;
+	}
+
+	fclose(file);
+	*size = length;
+	return data;
+}
+
+/** Mutations **/
+
+uint64_t random_state = 0x9E3779B97F4A7C15ULL;
+
+/**
+ * Returns next number of a fixed xorshift sequence, so every run checks the
+ * same inputs.
+ */
+uint64_t next_random() {
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return random_state;
+}
+
+/**
+ * Bytes that are most likely to change how JSON text is read, the null
+ * character included.
+ */
+const char interesting[] = "{}[]:,\"\\/*ntfue-.0 \x7f\x80\xff\0";
+
+/**
+ * Mutation of a document. Each kind is applied to every position in turn,
+ * except random ones.
+ */
+typedef enum {
+	MUTATION_NONE,
+	MUTATION_TRUNCATE,  // Cut at the position.
+	MUTATION_REPLACE,   // Replace the byte at the position.
+	MUTATION_RANDOM     // Delete, duplicate or overwrite a random span.
+} mutation_kind;
+
+typedef struct {
+	char *text;
+	size_t length;
+	char label[128];
+} mutation;
+
+/**
+ * Builds the mutated document number `step` of given kind.
+ *
+ * @return false once there are no more documents of this kind.
+ */
+bool mutate(
+	mutation *result,
+	const char *data,
+	size_t size,
+	mutation_kind kind,
+	size_t step
+) {
+	size_t offset = 0, span = 0;
+	char byte = 0;
+	int operation = 0;
+
+	switch (kind) {
+		case MUTATION_NONE:
+			if (step > 0) {
+				return false;
+			}
+			memcpy(result->text, data, size);
+			result->length = size;
+			snprintf(result->label, sizeof(result->label), "whole");
+			return true;
+
+		case MUTATION_TRUNCATE:
+			if (step >= size) {
+				return false;
+			}
+			memcpy(result->text, data, step);
+			result->length = step;
+			snprintf(result->label, sizeof(result->label), "cut at %zu", step);
+			return true;
+
+		case MUTATION_REPLACE:
+			if (step >= size) {
+				return false;
+			}
+			offset = step;
+			byte = (step % 2 == 0)
+				? interesting[(step / 2) % (sizeof(interesting) - 1)]
+				: (char)next_random();
+			memcpy(result->text, data, size);
+			result->text[offset] = byte;
+			result->length = size;
+			snprintf(
+				result->label,
+				sizeof(result->label),
+				"byte %zu set to 0x%02x",
+				offset,
+				(unsigned char)byte
+			);
+			return true;
+
+		case MUTATION_RANDOM:
+			if (step >= RANDOM_MUTATIONS || size == 0) {
+				return false;
+			}
+			offset = next_random() % size;
+			span = 1 + next_random() % 16;
+			if (span > size - offset) {
+				span = size - offset;
+			}
+			operation = next_random() % 3;
+
+			// Text before the span is the same for all operations.
+			memcpy(result->text, data, offset);
+			result->length = offset;
+			if (operation == 1) {
+				memcpy(result->text + result->length, data + offset, span);
+				result->length += span;
+				memcpy(result->text + result->length, data + offset, span);
+				result->length += span;
+			} else if (operation == 2) {
+				for (size_t idx = 0; idx < span; idx++) {
+					result->text[result->length++] = (char)next_random();
+				}
+			}
+			memcpy(
+				result->text + result->length,
+				data + offset + span,
+				size - offset - span
+			);
+			result->length += size - offset - span;
+
+			snprintf(
+				result->label,
+				sizeof(result->label),
+				"%s %zu bytes at %zu",
+				operation == 0 ? "deleted" :
+					operation == 1 ? "duplicated" : "overwrote",
+				span,
+				offset
+			);
+			return true;
+	}
+
+	return false;
+}
+
+/** Comparison **/
+
+/**
+ * Compares two JSON trees, including parent links.
+ *
+ * @return Whether the trees hold the same values.
+ */
+bool same_values(
+	const json_value *a,
+	const json_value *b,
+	const json_value *a_parent,
+	const json_value *b_parent
+) {
+	if (a->type != b->type || a->parent != a_parent || b->parent != b_parent) {
+		return false;
+	}
+
+	switch (a->type) {
+		case json_object:
+			if (a->u.object.length != b->u.object.length) {
+				return false;
+			}
+			for (unsigned int idx = 0; idx < a->u.object.length; idx++) {
+				const json_object_entry *x = &a->u.object.values[idx];
+				const json_object_entry *y = &b->u.object.values[idx];
+				if (
+					x->name_length != y->name_length ||
+					memcmp(x->name, y->name, x->name_length + 1) != 0 ||
+					!same_values(x->value, y->value, a, b)
+				) {
+					return false;
+				}
+			}
+			return true;
+
+		case json_array:
+			if (a->u.array.length != b->u.array.length) {
+				return false;
+			}
+			for (unsigned int idx = 0; idx < a->u.array.length; idx++) {
+				if (!same_values(
+					a->u.array.values[idx],
+					b->u.array.values[idx],
+					a,
+					b
+				)) {
+					return false;
+				}
+			}
+			return true;
+
+		case json_integer:
+			return a->u.integer == b->u.integer;
+
+		case json_double:
+			return memcmp(&a->u.dbl, &b->u.dbl, sizeof(double)) == 0;
+
+		case json_string:
+			return a->u.string.length == b->u.string.length && memcmp(
+				a->u.string.ptr,
+				b->u.string.ptr,
+				a->u.string.length + 1
+			) == 0;
+
+		case json_boolean:
+			return a->u.boolean == b->u.boolean;
+
+		default:
+			return true;
+	}
+}
+
+/**
+ * Compares two C strings, either of which can be NULL.
+ */
+bool same_strings(const char *a, const char *b) {
+	return (a == NULL && b == NULL) ||
+		(a != NULL && b != NULL && strcmp(a, b) == 0);
+}
+
+bool same_string_lists(const twitch_string_list *a, const twitch_string_list *b) {
+	if (a->count != b->count) {
+		return false;
+	}
+
+	for (int idx = 0; idx < a->count; idx++) {
+		if (!same_strings(a->items[idx], b->items[idx])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Compares two entities field by field.
+ *
+ * @return Whether the entities hold the same values.
+ */
+bool same_entities(const entity_schema *schema, const void *a, const void *b) {
+	for (int idx = 0; idx < schema->count; idx++) {
+		const field_spec *spec = &schema->fields[idx];
+		const void *x = (const char *)a + spec->offset;
+		const void *y = (const char *)b + spec->offset;
+		const twitch_string_list *x_list = NULL, *y_list = NULL;
+
+		switch (spec->type) {
+			case FIELD_STRING:
+				if (!same_strings(*((char **)x), *((char **)y))) {
+					return false;
+				}
+				break;
+			case FIELD_INT:
+				if (*((int *)x) != *((int *)y)) {
+					return false;
+				}
+				break;
+			case FIELD_LONG:
+				if (*((long *)x) != *((long *)y)) {
+					return false;
+				}
+				break;
+			case FIELD_BOOL:
+				if (*((bool *)x) != *((bool *)y)) {
+					return false;
+				}
+				break;
+			case FIELD_STRINGS:
+				if (!same_string_lists(x, y)) {
+					return false;
+				}
+				break;
+			case FIELD_STRING_LIST:
+			case FIELD_ENTITY_LIST:
+				// All lists share the same layout.
+				x_list = *((const twitch_string_list **)x);
+				y_list = *((const twitch_string_list **)y);
+				if (x_list == NULL || y_list == NULL) {
+					if (x_list != y_list) {
+						return false;
+					}
+					break;
+				}
+				if (spec->type == FIELD_STRING_LIST) {
+					if (!same_string_lists(x_list, y_list)) {
+						return false;
+					}
+					break;
+				}
+				if (x_list->count != y_list->count) {
+					return false;
+				}
+				for (int item = 0; item < x_list->count; item++) {
+					if (!same_entities(
+						spec->items,
+						x_list->items[item],
+						y_list->items[item]
+					)) {
+						return false;
+					}
+				}
+				break;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Page of entities with its cursor and total.
+ */
+typedef struct {
+	void **items;
+	int size;
+	char *next;
+	int total;
+} page;
+
+/**
+ * Compares two pages item by item.
+ */
+bool same_pages(const entity_schema *schema, const page *a, const page *b) {
+	if (
+		a->size != b->size ||
+		a->total != b->total ||
+		!same_strings(a->next, b->next)
+	) {
+		return false;
+	}
+
+	for (int idx = 0; idx < a->size; idx++) {
+		if (!same_entities(schema, a->items[idx], b->items[idx])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void free_page(const entity_schema *schema, page *page) {
+	for (int idx = 0; idx < page->size; idx++) {
+		schema->free(page->items[idx]);
+	}
+	free(page->items);
+	free(page->next);
+}
+
+/** Test **/
+
+const json_index_kernel kernels[] = {
+	JSON_INDEX_SCALAR,
+	JSON_INDEX_SSE2,
+	JSON_INDEX_AVX2
+};
+
+#define KERNELS_COUNT (int)(sizeof(kernels) / sizeof(kernels[0]))
+
+typedef struct {
+	json_single_scratch *scratch;
+	json_settings settings;
+	bool kernels[KERNELS_COUNT];  // Kernels available on this CPU.
+	json_index expected;          // Index built by the scalar kernel.
+	json_index actual;
+	const char *failed;           // How the differing tree was parsed.
+	int inputs;                   // Inputs checked.
+	int accepted;                 // Inputs both parsers accepted.
+	int pages;                    // Pages decoded to some items.
+	char cut[64];                 // Chunks of the differing page.
+} parser_check;
+
+/**
+ * Parses the input with the bundled parser, and with the single-pass one
+ * without the index and with the index built by each kernel.
+ *
+ * @return Whether the parsers agree.
+ */
+bool check_tree(parser_check *check, const char *text, size_t length) {
+	json_value *expected = json_parse_ex(&check->settings, text, length, NULL);
+	bool same = true, accepted = expected != NULL;
+
+	// Short inputs, and inputs that can have comments, aren't indexed.
+	int kernels_count = (
+		length >= JSON_SINGLE_INDEX_MIN &&
+		!(check->settings.settings & json_enable_comments)
+	) ? KERNELS_COUNT : 0;
+
+	for (int kernel = -1; kernel < kernels_count && same; kernel++) {
+		if (kernel >= 0) {
+			if (!check->kernels[kernel]) {
+				continue;
+			}
+			json_index_use(kernels[kernel]);
+		}
+		json_single_scratch_set_indexing(check->scratch, kernel >= 0);
+
+		json_value *actual = json_single_parse(
+			check->scratch,
+			&check->settings,
+			text,
+			length,
+			NULL
+		);
+
+		same = (expected == NULL && actual == NULL) || (
+			expected != NULL &&
+			actual != NULL &&
+			same_values(expected, actual, NULL, NULL)
+		);
+		accepted = accepted && actual != NULL;
+		check->failed = (kernel >= 0) ? json_index_kernel_name() : "no index";
+
+		if (actual != NULL) {
+			json_value_free(actual);
+		}
+	}
+
+	check->inputs++;
+	check->accepted += accepted;
+
+	if (expected != NULL) {
+		json_value_free(expected);
+	}
+
+	return same;
+}
+
+/**
+ * Indexes the input with each vector kernel and compares the index with the
+ * one built by the scalar kernel.
+ *
+ * @return Whether all kernels give the same index.
+ */
+bool check_index(parser_check *check, const char *text, size_t length) {
+	json_index_use(JSON_INDEX_SCALAR);
+	json_index_build(&check->expected, text, length);
+
+	for (int kernel = 1; kernel < KERNELS_COUNT; kernel++) {
+		if (!check->kernels[kernel]) {
+			continue;
+		}
+
+		json_index_use(kernels[kernel]);
+		json_index_build(&check->actual, text, length);
+		if (
+			check->actual.count != check->expected.count ||
+			memcmp(
+				check->actual.positions,
+				check->expected.positions,
+				check->actual.count * sizeof(uint32_t)
+			) != 0
+		) {
+			check->failed = json_index_kernel_name();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Receives the input the way a successful response is received, passing the
+ * chunks between given offsets to the cURL write callback one by one, and
+ * finishes the page.
+ *
+ * @param cuts Offsets of chunk boundaries, ascending. If NULL, every byte is
+ * a separate chunk.
+ * @param count Number of boundaries.
+ *
+ * @return Whether the page is the same as the expected one.
+ */
+bool check_chunks(
+	parser_func parser,
+	const page *expected,
+	const char *text,
+	size_t length,
+	const size_t *cuts,
+	int count
+) {
+	const entity_schema *schema = parser_schema(parser);
+	string_t *output = string_init();
+	helix_response response;
+	helix_response_init(&response, output, schema);
+	helix_response_start(&response, 200);
+
+	size_t offset = 0;
+	for (int idx = 0; cuts != NULL && idx <= count; idx++) {
+		size_t cut = (idx < count) ? cuts[idx] : length;
+		helix_response_write((char *)text + offset, 1, cut - offset, &response);
+		offset = cut;
+	}
+	for (; cuts == NULL && offset < length; offset++) {
+		helix_response_write((char *)text + offset, 1, 1, &response);
+	}
+
+	page actual = { NULL, 0, NULL, -1 };
+	actual.items = helix_response_page(
+		&response,
+		NULL,
+		"fixture",
+		parser,
+		&actual.size,
+		&actual.next,
+		&actual.total
+	);
+
+	// Successful responses are never kept as text.
+	bool same = output->len == 0 && same_pages(schema, expected, &actual);
+
+	free_page(schema, &actual);
+	helix_response_clear(&response);
+	string_free(output);
+	return same;
+}
+
+/**
+ * Receives the input as the body of a failed response, which has to be kept
+ * as it is for the caller.
+ *
+ * @return Whether the received body is the same as the input.
+ */
+bool check_error_body(parser_func parser, const char *text, size_t length) {
+	string_t *output = string_init();
+	helix_response response;
+	helix_response_init(&response, output, parser_schema(parser));
+	helix_response_start(&response, 404);
+
+	size_t half = length / 2;
+	helix_response_write((char *)text, 1, half, &response);
+	helix_response_write((char *)text + half, 1, length - half, &response);
+
+	bool same = output->len == length &&
+		memcmp(output->ptr, text, length) == 0;
+
+	helix_response_clear(&response);
+	string_free(output);
+	return same;
+}
+
+/**
+ * Decodes the input as a page of entities, at once and in chunks, and
+ * compares the result with the page materialized from the tree of the
+ * bundled parser.
+ *
+ * @param every_cut Whether to try splitting the input into two chunks at
+ * every offset, and into chunks of one byte, or only at a few random ones.
+ *
+ * @return Whether the pages are the same.
+ */
+bool check_page(
+	parser_check *check,
+	parser_func parser,
+	const char *text,
+	size_t length,
+	bool every_cut
+) {
+	const entity_schema *schema = parser_schema(parser);
+	page expected = { NULL, 0, NULL, -1 };
+	page actual = { NULL, 0, NULL, -1 };
+
+	json_value *value = json_parse(text, length);
+	expected.items = helix_parse_page(
+		value,
+		parser,
+		&expected.size,
+		&expected.next,
+		&expected.total
+	);
+	if (value != NULL) {
+		json_value_free(value);
+	}
+
+	actual.items = page_decode(
+		schema,
+		text,
+		length,
+		&actual.size,
+		&actual.next,
+		&actual.total
+	);
+
+	bool same = same_pages(schema, &expected, &actual);
+	check->failed = "at once";
+	check->pages += (same && actual.size > 0);
+	free_page(schema, &actual);
+
+	if (every_cut) {
+		for (size_t cut = 0; cut <= length && same; cut++) {
+			same = check_chunks(parser, &expected, text, length, &cut, 1);
+			snprintf(check->cut, sizeof(check->cut), "cut at %zu", cut);
+			check->failed = check->cut;
+		}
+
+		if (same) {
+			same = check_chunks(parser, &expected, text, length, NULL, 0);
+			check->failed = "byte by byte";
+		}
+
+		if (same) {
+			same = check_error_body(parser, text, length);
+			check->failed = "error body";
+		}
+	} else if (same) {
+		size_t cuts[3];
+		for (int idx = 0; idx < 3; idx++) {
+			cuts[idx] = next_random() % (length + 1);
+		}
+		for (int idx = 1; idx < 3; idx++) {
+			for (int at = idx; at > 0 && cuts[at - 1] > cuts[at]; at--) {
+				size_t swap = cuts[at];
+				cuts[at] = cuts[at - 1];
+				cuts[at - 1] = swap;
+			}
+		}
+
+		same = check_chunks(parser, &expected, text, length, cuts, 3);
+		snprintf(
+			check->cut,
+			sizeof(check->cut),
+			"cut at %zu, %zu and %zu",
+			cuts[0],
+			cuts[1],
+			cuts[2]
+		);
+		check->failed = check->cut;
+	}
+
+	free_page(schema, &expected);
+	return same;
+}
+
+/**
+ * Runs all mutations of one fixture.
+ *
+ * @return Whether the parsers agreed on all of them.
+ */
+bool check_fixture(
+	parser_check *check,
+	const fixture *fixture,
+	const char *data,
+	size_t size
+) {
+	const char *name = fixture->name;
+	mutation current;
+	current.text = malloc(size * 2 + 1);
+	if (current.text == NULL) {
+		fprintf(stderr, "Failed to allocate memory for mutations.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	bool passed = true;
+	for (int kind = MUTATION_NONE; kind <= MUTATION_RANDOM && passed; kind++) {
+		for (size_t step = 0; passed; step++) {
+			if (!mutate(&current, data, size, kind, step)) {
+				break;
+			}
+
+			if (!check_index(check, current.text, current.length)) {
+				fprintf(
+					stderr,
+					" ! %s, %s: %s index differs\n",
+					name,
+					current.label,
+					check->failed
+				);
+				passed = false;
+				break;
+			}
+
+			int modes = (kind == MUTATION_REPLACE) ? 1 : 2;
+			for (int comments = 0; comments < modes && passed; comments++) {
+				check->settings.settings = comments ? json_enable_comments : 0;
+				if (!check_tree(check, current.text, current.length)) {
+					fprintf(
+						stderr,
+						" ! %s, %s%s: trees differ, %s\n",
+						name,
+						current.label,
+						comments ? ", comments enabled" : "",
+						check->failed
+					);
+					passed = false;
+				}
+			}
+
+			if (
+				passed &&
+				fixture->parser != NULL &&
+				!check_page(
+					check,
+					fixture->parser,
+					current.text,
+					current.length,
+					kind == MUTATION_NONE
+				)
+			) {
+				fprintf(
+					stderr,
+					" ! %s, %s: pages differ, %s\n",
+					name,
+					current.label,
+					check->failed
+				);
+				passed = false;
+			}
+		}
+	}
+
+	free(current.text);
+	return passed;
+}
+
+int main(int argc, char **argv) {
+	if (argc != 2) {
+		fprintf(stderr, "Usage: parser-test fixtures-dir\n");
+		return 1;
+	}
+
+	parser_check check;
+	memset(&check, 0, sizeof(check));
+	check.scratch = json_single_scratch_init();
+	for (int kernel = 0; kernel < KERNELS_COUNT; kernel++) {
+		check.kernels[kernel] = json_index_use(kernels[kernel]);
+		if (check.kernels[kernel]) {
+			fprintf(stderr, "Kernel %s\n", json_index_kernel_name());
+		}
+	}
+
+	bool passed = true;
+	int count = sizeof(fixtures) / sizeof(fixtures[0]);
+	for (int idx = 0; idx < count; idx++) {
+		size_t size = 0;
+		char *data = read_fixture(argv[1], fixtures[idx].name, &size);
+		if (data == NULL) {
+			fprintf(stderr, " ! %s: failed to read\n", fixtures[idx].name);
+			passed = false;
+			continue;
+		}
+
+		// A fresh parser has to agree too, not just a warmed up one.
+		json_value *value = json_single_parse(NULL, NULL, data, size, NULL);
+		if (value == NULL) {
+			fprintf(stderr, " ! %s: not parsed\n", fixtures[idx].name);
+			passed = false;
+		} else {
+			json_value_free(value);
+		}
+
+		if (check_fixture(&check, &fixtures[idx], data, size)) {
+			fprintf(stderr, "   %s\n", fixtures[idx].name);
+		} else {
+			passed = false;
+		}
+		free(data);
+	}
+
+	fprintf(
+		stderr,
+		"%d inputs, %d accepted by both parsers, %d decoded to items\n",
+		check.inputs,
+		check.accepted,
+		check.pages
+	);
+	json_single_scratch_free(check.scratch);
+	json_index_clear(&check.expected);
+	json_index_clear(&check.actual);
+	json_index_use(JSON_INDEX_AUTO);
+
+	printf("%s\n", passed ? "PASS" : "FAIL");
+	return passed ? 0 : 1;
+}
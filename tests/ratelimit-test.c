@@ -0,0 +1,332 @@
+/**
+ * Checks the rate limit scheduler.
+ *
+ * The local token bucket of a client ID is fed with rate limit headers the
+ * way responses would feed it, and has to hand out exactly the points the
+ * server reported, then tell how long to wait for the next one: until a point
+ * drips in or the bucket resets, whichever comes first.
+ *
+ * Then mock-helix, with a small rate limit, is asked for more pages in a row
+ * than the limit allows. With scheduling, requests over the limit wait for
+ * the bucket instead of failing, and the server never answers with 429.
+ * Without it, the same requests are rejected.
+ *
+ * Usage: ratelimit-test path/to/mock-helix
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include <ctwitch/ctwitch.h>
+#include <ctwitch/client.h>
+#include <ctwitch/stats.h>
+#include <ctwitch/helix.h>
+
+#include "utils/network/ratelimit.h"
+#include "mock-server.h"
+
+#define SERVER_LIMIT 120
+#define SERVER_REQUESTS (SERVER_LIMIT + 4)
+
+/** Helpers **/
+
+double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Makes headers of a response that reports given bucket state.
+ */
+helix_ratelimit_headers make_headers(long limit, long remaining, long reset) {
+	helix_ratelimit_headers headers;
+	helix_ratelimit_reset_headers(&headers);
+	headers.limit = limit;
+	headers.remaining = remaining;
+	headers.reset = reset;
+	return headers;
+}
+
+/**
+ * Prints the failure and returns false, if the condition doesn't hold.
+ */
+bool expect(bool condition, const char *name, const char *message) {
+	if (!condition) {
+		fprintf(stderr, " ! %s: %s\n", name, message);
+	}
+	return condition;
+}
+
+/**
+ * Takes points until the bucket runs out.
+ *
+ * @return Number of points taken, and the delay until the next one.
+ */
+int drain(twitch_client *client, const char *client_id, double *delay) {
+	int taken = 0;
+	while ((*delay = helix_ratelimit_acquire(client, client_id)) == 0) {
+		if (++taken > 1000) {
+			break;
+		}
+	}
+	return taken;
+}
+
+/** Cases **/
+
+/**
+ * Bucket hands out the points left, then waits for one to drip in.
+ */
+bool check_bucket() {
+	const char *name = "bucket";
+	twitch_client *client = twitch_client_alloc();
+
+	// Unknown bucket lets the first request through.
+	bool passed = expect(
+		helix_ratelimit_acquire(client, name) == 0,
+		name,
+		"first request delayed"
+	);
+
+	helix_ratelimit_headers headers = make_headers(60, 3, (long)now() + 30);
+	helix_ratelimit_update(client, name, &headers, 200);
+
+	double delay = 0;
+	int taken = drain(client, name, &delay);
+	passed = expect(taken == 3, name, "points taken differ from remaining") &&
+		passed;
+
+	// 60 points a minute drip in one per second.
+	passed = expect(delay > 0.9 && delay <= 1, name, "wrong delay") && passed;
+
+	twitch_rate_limit budget;
+	passed = expect(
+		twitch_client_get_rate_limit(client, name, &budget) &&
+			budget.limit == 60 &&
+			budget.remaining == 0 &&
+			budget.reset == headers.reset,
+		name,
+		"wrong budget"
+	) && passed;
+
+	twitch_client_free(client);
+	return passed;
+}
+
+/**
+ * Empty bucket that resets soon waits for the reset, not for the next point.
+ */
+bool check_reset() {
+	const char *name = "reset";
+	twitch_client *client = twitch_client_alloc();
+
+	helix_ratelimit_headers headers = make_headers(6, 0, (long)now() + 2);
+	helix_ratelimit_update(client, name, &headers, 200);
+
+	double delay = helix_ratelimit_acquire(client, name);
+	bool passed = expect(
+		delay > 0 && delay <= headers.reset - now() + 0.01,
+		name,
+		"wrong delay"
+	);
+
+	twitch_client_free(client);
+	return passed;
+}
+
+/**
+ * Requests sent before the first response are counted against the budget
+ * reported by it.
+ */
+bool check_in_flight() {
+	const char *name = "in flight";
+	twitch_client *client = twitch_client_alloc();
+
+	for (int idx = 0; idx < 3; idx++) {
+		helix_ratelimit_acquire(client, name);
+	}
+
+	// The server saw one of the three requests.
+	helix_ratelimit_headers headers = make_headers(100, 50, (long)now() + 60);
+	helix_ratelimit_update(client, name, &headers, 200);
+
+	double delay = 0;
+	int taken = drain(client, name, &delay);
+	bool passed = expect(taken == 48, name, "requests in flight not counted");
+
+	twitch_client_free(client);
+	return passed;
+}
+
+/**
+ * 429 drains the bucket until Retry-After, and is retried only if scheduling
+ * is enabled.
+ */
+bool check_too_many() {
+	const char *name = "429";
+	twitch_client *client = twitch_client_alloc();
+
+	helix_ratelimit_headers headers = make_headers(-1, -1, -1);
+	headers.retry_after = 3;
+	bool passed = expect(
+		helix_ratelimit_update(client, name, &headers, 429),
+		name,
+		"not retried"
+	);
+
+	double delay = helix_ratelimit_acquire(client, name);
+	passed = expect(delay > 2.9 && delay <= 3, name, "wrong delay") && passed;
+
+	twitch_client_set_rate_limiting(client, false);
+	passed = expect(
+		!helix_ratelimit_update(client, name, &headers, 429),
+		name,
+		"retried without scheduling"
+	) && passed;
+	passed = expect(
+		helix_ratelimit_acquire(client, name) == 0,
+		name,
+		"delayed without scheduling"
+	) && passed;
+
+	twitch_client_free(client);
+	return passed;
+}
+
+/**
+ * Returns the number of responses with given status to requests of given
+ * endpoint.
+ */
+unsigned long count_status(twitch_client *client, const char *path, long code) {
+	twitch_stats *stats = twitch_client_get_stats(client);
+	unsigned long count = 0;
+
+	for (int idx = 0; idx < stats->count; idx++) {
+		twitch_endpoint_stats *endpoint = stats->items[idx];
+		if (strcmp(endpoint->endpoint, path) != 0) {
+			continue;
+		}
+
+		for (int status = 0; status < endpoint->statuses_count; status++) {
+			if (endpoint->statuses[status].code == code) {
+				count = endpoint->statuses[status].count;
+			}
+		}
+	}
+
+	twitch_stats_free(stats);
+	return count;
+}
+
+/**
+ * Requests more pages than the server allows.
+ *
+ * @return Number of successful requests.
+ */
+int crawl(twitch_client *client, const char *client_id) {
+	int succeeded = 0;
+
+	for (int idx = 0; idx < SERVER_REQUESTS; idx++) {
+		twitch_error error = { 0 };
+		twitch_helix_game_list *games = twitch_helix_get_top_games(
+			client,
+			client_id,
+			"token",
+			&error,
+			1,
+			NULL,
+			NULL
+		);
+
+		if (error.curl_code == 0 && games != NULL && games->count == 1) {
+			succeeded++;
+		}
+		twitch_helix_game_list_free(games);
+		twitch_error_clear(&error);
+	}
+
+	return succeeded;
+}
+
+bool check_server(const mock_server *server) {
+	const char *name = "server";
+	twitch_client *client = twitch_client_alloc();
+	twitch_client_set_api_url(client, server->url);
+
+	// Points over the limit drip in at 2 per second.
+	double start = now();
+	int succeeded = crawl(client, "scheduled");
+	double elapsed = now() - start;
+
+	bool passed = expect(
+		succeeded == SERVER_REQUESTS,
+		name,
+		"scheduled requests failed"
+	);
+	passed = expect(
+		count_status(client, "/helix/games/top", 429) == 0,
+		name,
+		"server rejected scheduled requests"
+	) && passed;
+	passed = expect(elapsed > 1, name, "requests were not paced") && passed;
+
+	twitch_rate_limit budget;
+	passed = expect(
+		twitch_client_get_rate_limit(client, "scheduled", &budget) &&
+			budget.limit == SERVER_LIMIT &&
+			budget.remaining <= 1,
+		name,
+		"wrong budget"
+	) && passed;
+
+	// The same requests fail without scheduling.
+	twitch_client_set_rate_limiting(client, false);
+	succeeded = crawl(client, "unscheduled");
+	passed = expect(
+		succeeded < SERVER_REQUESTS &&
+			count_status(client, "/helix/games/top", 429) > 0,
+		name,
+		"server didn't limit unscheduled requests"
+	) && passed;
+
+	twitch_client_free(client);
+	return passed;
+}
+
+/** Test **/
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s path/to/mock-helix\n", argv[0]);
+		return 1;
+	}
+
+	twitch_helix_init();
+
+	bool passed = check_bucket();
+	passed = check_reset() && passed;
+	passed = check_in_flight() && passed;
+	passed = check_too_many() && passed;
+
+	char limit[32];
+	snprintf(limit, sizeof(limit), "--rate-limit=%d", SERVER_LIMIT);
+	const char *options[] = { limit, NULL };
+
+	mock_server server;
+	if (mock_server_start(&server, argv[1], options)) {
+		passed = check_server(&server) && passed;
+		mock_server_stop(&server);
+	} else {
+		passed = false;
+	}
+
+	printf("%s\n", passed ? "PASS" : "FAIL");
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,272 @@
+/**
+ * Checks that a Helix request whose token gets rejected is repeated against
+ * the same Helix URL after the client fetches a new token.
+ *
+ * Runs a local server that plays both the auth server and Helix: it gives out
+ * numbered tokens and rejects the first one with 401. The client manages app
+ * credentials, so it fetches a token, gets 401, fetches another token and
+ * repeats the request. The test fails if the request doesn't succeed or if the
+ * server saw anything but the expected requests in this order.
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <ctwitch/ctwitch.h>
+#include <ctwitch/client.h>
+#include <ctwitch/credentials.h>
+#include <ctwitch/helix.h>
+
+#define MAX_REQUESTS 16
+#define MAX_REQUEST_SIZE 8192
+
+/** Server **/
+
+typedef struct {
+	int listener;
+	int tokens;                  // Tokens given out so far.
+	int requests;                // Requests seen so far.
+	char log[MAX_REQUESTS][64];  // Method and path of each request.
+} test_server;
+
+/**
+ * Reads request head from the socket.
+ *
+ * @return Request head length, or 0 if the connection was closed first.
+ */
+size_t read_request(int socket, char *text, size_t size) {
+	size_t length = 0;
+	while (length + 1 < size) {
+		ssize_t received = recv(socket, text + length, size - length - 1, 0);
+		if (received <= 0) {
+			return 0;
+		}
+		length += received;
+		text[length] = '\0';
+
+		if (strstr(text, "\r\n\r\n") != NULL) {
+			return length;
+		}
+	}
+
+	return 0;
+}
+
+void send_response(int socket, int status, const char *body) {
+	char head[256];
+	int length = snprintf(
+		head,
+		sizeof(head),
+		"HTTP/1.1 %d %s\r\n"
+		"Content-Type: application/json\r\n"
+		"Content-Length: %zu\r\n"
+		"Connection: close\r\n"
+		"\r\n",
+		status,
+		status == 200 ? "OK" : status == 401 ? "Unauthorized" : "Not Found",
+		strlen(body)
+	);
+	send(socket, head, length, 0);
+	send(socket, body, strlen(body), 0);
+}
+
+void serve_request(test_server *server, int socket) {
+	char text[MAX_REQUEST_SIZE];
+	if (read_request(socket, text, sizeof(text)) == 0) {
+		return;
+	}
+
+	char method[16] = "", path[1024] = "";
+	sscanf(text, "%15s %1023s", method, path);
+	if (server->requests < MAX_REQUESTS) {
+		snprintf(
+			server->log[server->requests],
+			sizeof(server->log[0]),
+			"%s %.*s",
+			method,
+			(int)strcspn(path, "?"),
+			path
+		);
+	}
+	server->requests++;
+
+	if (
+		strcmp(method, "POST") == 0 &&
+		strncmp(path, "/oauth2/token", 13) == 0
+	) {
+		char body[128];
+		snprintf(
+			body,
+			sizeof(body),
+			"{\"access_token\":\"token%d\",\"expires_in\":3600,"
+			"\"token_type\":\"bearer\"}",
+			++server->tokens
+		);
+		send_response(socket, 200, body);
+		return;
+	}
+
+	if (strcmp(method, "GET") != 0 || strncmp(path, "/helix/", 7) != 0) {
+		send_response(socket, 404, "{}");
+		return;
+	}
+
+	// The first token is rejected as if it had been revoked.
+	if (strstr(text, "Bearer token1\r\n") != NULL) {
+		send_response(
+			socket,
+			401,
+			"{\"error\":\"Unauthorized\",\"status\":401,"
+			"\"message\":\"Invalid OAuth token\"}"
+		);
+		return;
+	}
+
+	send_response(
+		socket,
+		200,
+		"{\"data\":[{\"id\":\"12826\",\"login\":\"twitch\","
+		"\"display_name\":\"Twitch\",\"type\":\"\","
+		"\"broadcaster_type\":\"partner\",\"description\":\"\","
+		"\"profile_image_url\":\"\",\"offline_image_url\":\"\","
+		"\"view_count\":0,\"created_at\":\"2007-05-22T10:39:54Z\"}]}"
+	);
+}
+
+void *server_run(void *data) {
+	test_server *server = data;
+
+	// Shutting the listener down from the test ends the loop.
+	while (true) {
+		int socket = accept(server->listener, NULL, NULL);
+		if (socket < 0) {
+			break;
+		}
+
+		serve_request(server, socket);
+		close(socket);
+	}
+
+	return NULL;
+}
+
+int open_listener(int *port) {
+	int listener = socket(AF_INET, SOCK_STREAM, 0);
+	if (listener < 0) {
+		return -1;
+	}
+
+	struct sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = 0;
+
+	socklen_t length = sizeof(address);
+	if (
+		bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+		listen(listener, 16) != 0 ||
+		getsockname(listener, (struct sockaddr *)&address, &length) != 0
+	) {
+		close(listener);
+		return -1;
+	}
+
+	*port = ntohs(address.sin_port);
+	return listener;
+}
+
+/** Test **/
+
+int main() {
+	const char *expected[] = {
+		"POST /oauth2/token",
+		"GET /helix/users",
+		"POST /oauth2/token",
+		"GET /helix/users"
+	};
+	int expected_size = sizeof(expected) / sizeof(expected[0]);
+
+	test_server server;
+	memset(&server, 0, sizeof(server));
+
+	int port = 0;
+	server.listener = open_listener(&port);
+	if (server.listener < 0) {
+		fprintf(stderr, "Failed to open listener\n");
+		return 1;
+	}
+
+	pthread_t thread;
+	pthread_create(&thread, NULL, server_run, &server);
+
+	char url[64];
+	snprintf(url, sizeof(url), "http://127.0.0.1:%d", port);
+
+	twitch_helix_init();
+	twitch_client *client = twitch_client_alloc();
+	twitch_client_set_api_url(client, url);
+	twitch_client_set_auth_url(client, url);
+	twitch_client_set_app_credentials(client, "test", "secret");
+
+	twitch_error error = { 0 };
+	twitch_helix_user *user = twitch_helix_get_user(
+		client,
+		NULL,
+		NULL,
+		&error,
+		"twitch"
+	);
+
+	shutdown(server.listener, SHUT_RDWR);
+	pthread_join(thread, NULL);
+	close(server.listener);
+
+	bool passed = true;
+	if (
+		user == NULL ||
+		user->login == NULL ||
+		strcmp(user->login, "twitch") != 0
+	) {
+		fprintf(
+			stderr,
+			"Request failed: curl code %ld, HTTP code %ld\n",
+			error.curl_code,
+			error.http_code
+		);
+		passed = false;
+	}
+
+	if (server.requests != expected_size) {
+		fprintf(
+			stderr,
+			"Expected %d requests, server saw %d\n",
+			expected_size,
+			server.requests
+		);
+		passed = false;
+	}
+
+	for (int idx = 0; idx < server.requests && idx < MAX_REQUESTS; idx++) {
+		bool matches = idx < expected_size &&
+			strcmp(server.log[idx], expected[idx]) == 0;
+		fprintf(stderr, "%s %s\n", matches ? "   " : " ! ", server.log[idx]);
+		passed = passed && matches;
+	}
+
+	twitch_helix_user_free(user);
+	twitch_error_clear(&error);
+	twitch_client_free(client);
+
+	printf("%s\n", passed ? "PASS" : "FAIL");
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,270 @@
+/**
+ * Checks retries of failed requests.
+ *
+ * Delays before retries are sampled many times for each attempt, and have to
+ * stay between the exponential delay, capped by the policy, and the same delay
+ * shortened by the jitter share, while spreading over most of that range.
+ *
+ * Then a crawl of several pages is made against mock-helix failing every
+ * other request with 503. With retries, every failed page is requested again
+ * and the crawl returns each item once, in order. With a single attempt, the
+ * crawl fails with the status of the server.
+ *
+ * Usage: retry-test path/to/mock-helix
+ *
+ * @author Alexander Rogachev
+ * @version 0.1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <ctwitch/ctwitch.h>
+#include <ctwitch/client.h>
+#include <ctwitch/stats.h>
+#include <ctwitch/helix.h>
+
+#include "utils/network/retry.h"
+#include "mock-server.h"
+
+#define SAMPLES 1000
+#define MAX_ATTEMPTS 6
+#define CRAWL_ITEMS 250
+#define FIRST_ID 500000  // ID of the first mock game.
+
+const long retryable[] = { 503 };
+
+/** Helpers **/
+
+/**
+ * Prints the failure and returns false, if the condition doesn't hold.
+ */
+bool expect(bool condition, const char *name, const char *message) {
+	if (!condition) {
+		fprintf(stderr, " ! %s: %s\n", name, message);
+	}
+	return condition;
+}
+
+twitch_retry_policy make_policy(int max_attempts, double jitter) {
+	twitch_retry_policy policy = {
+		max_attempts,
+		100,
+		1000,
+		jitter,
+		1,
+		retryable
+	};
+	return policy;
+}
+
+/** Cases **/
+
+/**
+ * Delays grow twice with every attempt up to the cap, and the jitter takes a
+ * random share of them off.
+ */
+bool check_delay(double jitter) {
+	char name[32];
+	snprintf(name, sizeof(name), "delay, jitter %.1f", jitter);
+
+	twitch_client *client = twitch_client_alloc();
+	twitch_retry_policy policy = make_policy(MAX_ATTEMPTS, jitter);
+	twitch_client_set_retry_policy(client, &policy);
+
+	bool passed = true;
+	for (int attempt = 1; attempt <= MAX_ATTEMPTS; attempt++) {
+		double cap = 0.1 * (1 << (attempt - 1));
+		if (cap > 1) {
+			cap = 1;
+		}
+
+		double lowest = cap, highest = 0;
+		for (int idx = 0; idx < SAMPLES; idx++) {
+			double delay = helix_retry_delay(client, attempt);
+			lowest = (delay < lowest) ? delay : lowest;
+			highest = (delay > highest) ? delay : highest;
+		}
+
+		// Samples cover the range, up to a tenth of it at each end.
+		double floor = cap * (1 - jitter);
+		double margin = (cap - floor) / 10 + 1e-9;
+		passed = expect(
+			lowest >= floor - 1e-9 && highest <= cap + 1e-9,
+			name,
+			"delay out of bounds"
+		) && passed;
+		passed = expect(
+			lowest <= floor + margin && highest >= cap - margin,
+			name,
+			"delays don't spread over the jitter range"
+		) && passed;
+	}
+
+	twitch_client_free(client);
+	return passed;
+}
+
+/**
+ * Only transient failures are retried, as many times as the policy allows.
+ */
+bool check_should() {
+	const char *name = "should";
+	twitch_client *client = twitch_client_alloc();
+	twitch_retry_policy policy = make_policy(3, 1);
+	twitch_client_set_retry_policy(client, &policy);
+
+	CURLcode http = CURLE_HTTP_RETURNED_ERROR;
+	bool passed = expect(
+		helix_retry_should(client, 1, http, 503) &&
+			helix_retry_should(client, 2, http, 503) &&
+			!helix_retry_should(client, 3, http, 503),
+		name,
+		"wrong number of attempts"
+	);
+	passed = expect(
+		!helix_retry_should(client, 1, http, 500) &&
+			!helix_retry_should(client, 1, http, 404),
+		name,
+		"status not in the policy retried"
+	) && passed;
+	passed = expect(
+		helix_retry_should(client, 1, CURLE_COULDNT_CONNECT, 0) &&
+			!helix_retry_should(client, 1, CURLE_URL_MALFORMAT, 0) &&
+			!helix_retry_should(client, 1, CURLE_OK, 200),
+		name,
+		"wrong transfer errors retried"
+	) && passed;
+	passed = expect(
+		!helix_retry_should(NULL, 1, http, 503),
+		name,
+		"retried without a client"
+	) && passed;
+
+	twitch_client_free(client);
+	return passed;
+}
+
+/**
+ * Returns statistics of one endpoint from a snapshot, or NULL if it was never
+ * requested.
+ */
+twitch_endpoint_stats *find_endpoint(twitch_stats *stats, const char *path) {
+	for (int idx = 0; idx < stats->count; idx++) {
+		if (strcmp(stats->items[idx]->endpoint, path) == 0) {
+			return stats->items[idx];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Checks that a crawl returned every item once, in order.
+ */
+bool is_complete(twitch_helix_game_list *games) {
+	if (games == NULL || games->count != CRAWL_ITEMS) {
+		return false;
+	}
+
+	for (int idx = 0; idx < games->count; idx++) {
+		twitch_helix_game *game = games->items[idx];
+		bool expected = game != NULL &&
+			game->id != NULL &&
+			atoi(game->id) == FIRST_ID + idx;
+		if (!expected) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool check_server(const mock_server *server) {
+	const char *name = "server";
+	twitch_client *client = twitch_client_alloc();
+	twitch_client_set_api_url(client, server->url);
+
+	twitch_retry_policy policy = make_policy(3, 1);
+	policy.base_delay = 1;
+	policy.max_delay = 10;
+	twitch_client_set_retry_policy(client, &policy);
+
+	twitch_error error = { 0 };
+	twitch_helix_game_list *games = twitch_helix_get_all_top_games(
+		client,
+		"id",
+		"token",
+		&error,
+		CRAWL_ITEMS
+	);
+	bool passed = expect(
+		error.curl_code == 0 && is_complete(games),
+		name,
+		"crawl with retries failed"
+	);
+	twitch_helix_game_list_free(games);
+	twitch_error_clear(&error);
+
+	// Every other request failed, and was retried once.
+	twitch_stats *stats = twitch_client_get_stats(client);
+	twitch_endpoint_stats *endpoint = find_endpoint(stats, "/helix/games/top");
+	passed = expect(
+		endpoint != NULL &&
+			endpoint->retries > 0 &&
+			endpoint->errors == endpoint->retries &&
+			endpoint->requests == endpoint->retries * 2 + 1,
+		name,
+		"wrong number of retries"
+	) && passed;
+	twitch_stats_free(stats);
+
+	policy.max_attempts = 1;
+	twitch_client_set_retry_policy(client, &policy);
+	games = twitch_helix_get_all_top_games(
+		client,
+		"id",
+		"token",
+		&error,
+		CRAWL_ITEMS
+	);
+	passed = expect(
+		error.http_code == 503 && !is_complete(games),
+		name,
+		"crawl without retries succeeded"
+	) && passed;
+	twitch_helix_game_list_free(games);
+	twitch_error_clear(&error);
+
+	twitch_client_free(client);
+	return passed;
+}
+
+/** Test **/
+
+int main(int argc, char **argv) {
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s path/to/mock-helix\n", argv[0]);
+		return 1;
+	}
+
+	twitch_helix_init();
+
+	bool passed = check_delay(0);
+	passed = check_delay(0.5) && passed;
+	passed = check_delay(1) && passed;
+	passed = check_should() && passed;
+
+	const char *options[] = { "--fail-every=2", NULL };
+	mock_server server;
+	if (mock_server_start(&server, argv[1], options)) {
+		passed = check_server(&server) && passed;
+		mock_server_stop(&server);
+	} else {
+		passed = false;
+	}
+
+	printf("%s\n", passed ? "PASS" : "FAIL");
+	return passed ? 0 : 1;
+}